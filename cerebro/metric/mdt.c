@@ -69,7 +69,7 @@ _get_metric_value (unsigned int *metric_value_type,
     char *buf = xmalloc (CEREBRO_MAX_DATA_STRING_LEN);
     int retval = -1;
 
-    if (lmt_mdt_string_v3 (ctx, buf, CEREBRO_MAX_DATA_STRING_LEN) < 0)
+    if (lmt_mdt_string_v4 (ctx, buf, CEREBRO_MAX_DATA_STRING_LEN) < 0)
         goto done;
     *metric_value_type = CEREBRO_DATA_VALUE_TYPE_STRING;
     *metric_value_len = strlen (buf) + 1;
@@ -48,7 +48,7 @@
 #include "lmtdb.h"
 
 #define MONITOR_NAME            "lmt_mysql"
-#define METRIC_NAMES            "lmt_mdt,lmt_ost,lmt_router"
+#define METRIC_NAMES            "lmt_mdt,lmt_ost,lmt_router,lmt_osc"
 #define LEGACY_METRIC_NAMES     "lmt_oss,lmt_mds"
 
 static int
@@ -98,13 +98,21 @@ _metric_update (const char *nodename,
         goto done;
     }
     /* current metrics */
-    if (!strcmp (metric_name, "lmt_ost") && vers == 2) {
-        lmt_db_insert_ost_v2 (s);
-    } else if (!strcmp (metric_name, "lmt_mdt") && vers == 3) {
-        lmt_db_insert_mdt_v3 (s);
+    if (!strcmp (metric_name, "lmt_ost") && vers == 3) {
+        lmt_db_insert_ost_v3 (s);
+    } else if (!strcmp (metric_name, "lmt_mdt") && vers == 4) {
+        lmt_db_insert_mdt_v4 (s);
+    } else if (!strcmp (metric_name, "lmt_router") && vers == 2) {
+        lmt_db_insert_router_v2 (s);
+    } else if (!strcmp (metric_name, "lmt_osc") && vers == 1) {
+        lmt_db_insert_osc_v1 (s);
+    /* legacy metrics */
     } else if (!strcmp (metric_name, "lmt_router") && vers == 1) {
         lmt_db_insert_router_v1 (s);
-    /* legacy metrics */
+    } else if (!strcmp (metric_name, "lmt_mdt") && vers == 3) {
+        lmt_db_insert_mdt_v3 (s);
+    } else if (!strcmp (metric_name, "lmt_ost") && vers == 2) {
+        lmt_db_insert_ost_v2 (s);
     } else if (!strcmp (metric_name, "lmt_mdt") && vers == 2) {
         lmt_db_insert_mdt_v2 (s);
     } else if (!strcmp (metric_name, "lmt_oss") && vers == 1) {
@@ -0,0 +1,192 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <errno.h>
+#include <sys/utsname.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+#include "stat.h"
+#include "meminfo.h"
+#include "lustre.h"
+
+#include "lmt.h"
+#include "client.h"
+#include "util.h"
+#include "lmtconf.h"
+#include "common.h"
+
+/* private arg structure for _client_cb () */
+struct clipass_struct {
+    char *s;
+    int len;
+    time_t now;
+};
+
+static tgttab_t client_tab = NULL; /* one target per mount */
+
+/* Append "name;secs;" and the mount's activity since its last read.
+ * The first read of a mount is a baseline with secs of 0.
+ */
+static int
+_client_cb (clistat_t *c, void *arg)
+{
+    struct clipass_struct *p = arg;
+    int used = strlen (p->s);
+    tgtstate_t *m;
+    clistat_t *last, d;
+    int secs;
+
+    m = tgttab_target (client_tab, c->name);
+    if (!(last = m->data)) {
+        last = m->data = xmalloc (sizeof (*last));
+        memset (last, 0, sizeof (*last));
+    }
+    secs = m->t ? (int)(p->now - m->t) : 0;
+    memset (&d, 0, sizeof (d));
+    if (secs > 0) {
+        d.read_bytes = counter_delta (c->read_bytes, last->read_bytes);
+        d.write_bytes = counter_delta (c->write_bytes, last->write_bytes);
+        d.open = counter_delta (c->open, last->open);
+        d.close = counter_delta (c->close, last->close);
+        d.getattr = counter_delta (c->getattr, last->getattr);
+        d.read_rpcs = counter_delta (c->read_rpcs, last->read_rpcs);
+        d.write_rpcs = counter_delta (c->write_rpcs, last->write_rpcs);
+        d.read_pages = counter_delta (c->read_pages, last->read_pages);
+        d.write_pages = counter_delta (c->write_pages, last->write_pages);
+    }
+    d.in_flight = c->in_flight;
+    *last = *c;
+    m->t = p->now;
+    if (snprintf (p->s + used, p->len - used, "%s;%d;%"PRIu64";%"PRIu64";%"
+                  PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64
+                  ";%"PRIu64";%"PRIu64";", c->name, secs, d.read_bytes,
+                  d.write_bytes, d.open, d.close, d.getattr, d.read_rpcs,
+                  d.write_rpcs, d.read_pages, d.write_pages, d.in_flight)
+                  >= p->len - used) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("string overflow");
+        return -1;
+    }
+    return 0;
+}
+
+int
+lmt_client_string_v1 (pctx_t ctx, char *s, int len)
+{
+    struct clipass_struct p;
+    struct utsname uts;
+    int retval = -1;
+
+    if (!client_tab)
+        client_tab = tgttab_create (0, 0);
+    tgttab_next_pass (client_tab);
+    if (uname (&uts) < 0) {
+        err ("uname");
+        goto done;
+    }
+    if (snprintf (s, len, "1;%s;", uts.nodename) >= len) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("string overflow");
+        goto done;
+    }
+    p.s = s;
+    p.len = len;
+    p.now = time (NULL);
+    if (proc_lustre_clientstats (ctx, _client_cb, &p) < 0) {
+        if (errno == ENOENT)
+            errno = 0; /* not a lustre client */
+        goto done;
+    }
+    /* forget unmounted file systems */
+    tgttab_prune_targets (client_tab);
+    retval = 0;
+done:
+    return retval;
+}
+
+int
+lmt_client_decode_v1 (const char *s, char **hostp, List *mntinfop)
+{
+    int retval = -1;
+    char *host = xmalloc (strlen (s) + 1);
+    List mntinfo = list_create ((ListDelF)free);
+    char *cpy;
+
+    if (sscanf (s, "%*f;%[^;];", host) != 1 || !(s = strskip (s, 2, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_client_v1: parse error: host component");
+        goto done;
+    }
+    while (*s) {
+        if (!(cpy = strskipcpy (&s, 12, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_client_v1: parse error: mount component");
+            goto done;
+        }
+        list_append (mntinfo, cpy);
+    }
+    *hostp = host;
+    *mntinfop = mntinfo;
+    retval = 0;
+done:
+    if (retval < 0) {
+        free (host);
+        list_destroy (mntinfo);
+    }
+    return retval;
+}
+
+int
+lmt_client_decode_v1_mntinfo (const char *s, int *secsp, clistat_t *c)
+{
+    memset (c, 0, sizeof (*c));
+    if (sscanf (s, "%63[^;];%d;%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";%"
+                PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64,
+                c->name, secsp, &c->read_bytes, &c->write_bytes, &c->open,
+                &c->close, &c->getattr, &c->read_rpcs, &c->write_rpcs,
+                &c->read_pages, &c->write_pages, &c->in_flight) != 12) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_client_v1: parse error: mntinfo");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,14 @@
+/* lmt_client v1: "1;host;" followed by "name;secs;read_bytes;write_bytes;
+ * open;close;getattr;read_rpcs;write_rpcs;read_pages;write_pages;in_flight;"
+ * per lustre client mount, where the counts are the mount's activity in the
+ * secs seconds since it was last read (0 the first time), and in_flight is
+ * the number of RPCs in flight now.
+ */
+int lmt_client_string_v1 (pctx_t ctx, char *s, int len);
+
+int lmt_client_decode_v1 (const char *s, char **hostp, List *mntinfop);
+int lmt_client_decode_v1_mntinfo (const char *s, int *secsp, clistat_t *c);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
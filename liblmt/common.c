@@ -27,20 +27,27 @@
 #endif /* HAVE_CONFIG_H */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
 #if STDC_HEADERS
 #include <string.h>
 #endif /* STDC_HEADERS */
 #include <inttypes.h>
+#include <time.h>
+#include <assert.h>
 
 #include "list.h"
 #include "hash.h"
 #include "error.h"
 #include "proc.h"
+#include "stat.h"
+#include "meminfo.h"
 #include "lustre.h"
 
 #include "lmt.h"
 #include "util.h"
 #include "lmtconf.h"
+#include "common.h"
 
 int
 get_recovstr (pctx_t ctx, char *name, char *s, int len)
@@ -76,6 +83,337 @@ done:
     return res;
 }
 
+/* Services that are not running here are left out.  The count is
+ * prepended once the list is complete.
+ */
+int
+get_svcstring (pctx_t ctx, const char **svcs, int nsvcs, char *s, int len)
+{
+    svcstat_t st;
+    char num[16];
+    int i, n, nlen, used = 0, count = 0;
+
+    if (len < 1)
+        goto overflow;
+    s[0] = '\0';
+    for (i = 0; i < nsvcs; i++) {
+        if (proc_lustre_svcstats (ctx, svcs[i], &st) < 0) {
+            if (errno != ENOENT && lmt_conf_get_proto_debug ())
+                err ("error reading lustre %s service stats", svcs[i]);
+            continue;
+        }
+        n = snprintf (s + used, len - used, "%s;%"PRIu64";%"PRIu64";%"PRIu64
+                      ";%"PRIu64";%"PRIu64";%"PRIu64";", svcs[i], st.reqs,
+                      st.wait_usecs, st.qdepth, st.active,
+                      st.threads_started, st.threads_max);
+        if (n >= len - used)
+            goto overflow;
+        used += n;
+        count++;
+    }
+    nlen = snprintf (num, sizeof (num), "%d;", count);
+    if (used + nlen >= len)
+        goto overflow;
+    memmove (s + nlen, s, used + 1);
+    memcpy (s, num, nlen);
+    return 0;
+overflow:
+    if (lmt_conf_get_proto_debug ())
+        msg ("string overflow");
+    return -1;
+}
+
+/* Copy each item of the service list at *sp to svcinfo, and advance
+ * *sp past the list.
+ */
+int
+split_svcstring (const char **sp, List svcinfo)
+{
+    char *cpy;
+    int i, nsvc;
+
+    if (sscanf (*sp, "%d;", &nsvc) != 1 || !(*sp = strskip (*sp, 1, ';')))
+        return -1;
+    for (i = 0; i < nsvc; i++) {
+        if (!(cpy = strskipcpy (sp, 7, ';')))
+            return -1;
+        list_append (svcinfo, cpy);
+    }
+    return 0;
+}
+
+int
+lmt_decode_svcinfo (const char *s, char **namep, uint64_t *reqsp,
+                    uint64_t *wait_usecsp, uint64_t *qdepthp,
+                    uint64_t *activep, uint64_t *threads_startedp,
+                    uint64_t *threads_maxp)
+{
+    char *name = xmalloc (strlen (s) + 1);
+    uint64_t reqs, wait_usecs, qdepth, active, started, max;
+
+    if (sscanf (s, "%[^;];%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64
+                ";%"PRIu64, name, &reqs, &wait_usecs, &qdepth, &active,
+                &started, &max) != 7) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("parse error: svcinfo");
+        free (name);
+        return -1;
+    }
+    *namep = name;
+    *reqsp = reqs;
+    *wait_usecsp = wait_usecs;
+    *qdepthp = qdepth;
+    *activep = active;
+    *threads_startedp = started;
+    *threads_maxp = max;
+    return 0;
+}
+
+int
+get_hoststring (cpuusage_t *cpu, meminfo_t *mem, char *s, int len)
+{
+    int n;
+
+    n = snprintf (s, len, "%d;%f;%f;%f;%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64
+                  ";", cpu->ncpu, cpu->pct_maxcpu, cpu->pct_iowait,
+                  cpu->pct_softirq, mem->cached, mem->slab, mem->dirty,
+                  mem->writeback);
+    if (n >= len) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("string overflow");
+        return -1;
+    }
+    return 0;
+}
+
+int
+lmt_decode_hostinfo (const char *s, int *ncpup, float *pct_maxcpup,
+                     float *pct_iowaitp, float *pct_softirqp,
+                     uint64_t *kcachedp, uint64_t *kslabp,
+                     uint64_t *kdirtyp, uint64_t *kwritebackp)
+{
+    int ncpu;
+    float pct_maxcpu, pct_iowait, pct_softirq;
+    uint64_t kcached, kslab, kdirty, kwriteback;
+
+    if (sscanf (s, "%d;%f;%f;%f;%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64,
+                &ncpu, &pct_maxcpu, &pct_iowait, &pct_softirq, &kcached,
+                &kslab, &kdirty, &kwriteback) != 8) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("parse error: hostinfo");
+        return -1;
+    }
+    *ncpup = ncpu;
+    *pct_maxcpup = pct_maxcpu;
+    *pct_iowaitp = pct_iowait;
+    *pct_softirqp = pct_softirq;
+    *kcachedp = kcached;
+    *kslabp = kslab;
+    *kdirtyp = kdirty;
+    *kwritebackp = kwriteback;
+    return 0;
+}
+
+uint64_t
+counter_delta (uint64_t new, uint64_t old)
+{
+    return new >= old ? new - old : new;
+}
+
+void
+topk_init (topk_t *k, int max)
+{
+    assert (max > 0 && max <= TOPK_MAX);
+    k->n = 0;
+    k->max = max;
+}
+
+/* Offer an item to the heap, O(log K).
+ */
+int
+topk_offer (topk_t *k, uint64_t key)
+{
+    int i, c, slot;
+
+    if (key == 0)
+        return -1;
+    if (k->n < k->max) {
+        slot = k->n;
+        for (i = k->n++; i > 0; i = c) {
+            c = (i - 1) / 2;
+            if (k->key[k->heap[c]] <= key)
+                break;
+            k->heap[i] = k->heap[c];
+        }
+    } else {
+        slot = k->heap[0];
+        if (key <= k->key[slot])
+            return -1;
+        for (i = 0; (c = 2 * i + 1) < k->n; i = c) {
+            if (c + 1 < k->n && k->key[k->heap[c + 1]] < k->key[k->heap[c]])
+                c++;
+            if (k->key[k->heap[c]] >= key)
+                break;
+            k->heap[i] = k->heap[c];
+        }
+    }
+    k->heap[i] = slot;
+    k->key[slot] = key;
+    return slot;
+}
+
+#define TGTTAB_MAGIC        0x74677462
+
+struct tgttab_struct {
+    int magic;
+    List targets;               /* tgtstate_t */
+    unsigned int pass;
+    int hsize;                  /* entry hash size, 0 if no entries */
+    int max;                    /* limit on entries, 0 if none */
+    int count;                  /* entries over all targets */
+};
+
+static void
+_destroy_tgtstate (tgtstate_t *t)
+{
+    if (t->ents)
+        hash_destroy (t->ents);
+    if (t->data)
+        free (t->data);
+    free (t->name);
+    free (t);
+}
+
+static int
+_match_tgtstate (tgtstate_t *t, char *name)
+{
+    return !strcmp (t->name, name);
+}
+
+static int
+_unseen_tgtent (tgtent_t *e, const void *key, unsigned int *pass)
+{
+    return e->pass != *pass;
+}
+
+tgttab_t
+tgttab_create (int hsize, int max)
+{
+    tgttab_t tab = xmalloc (sizeof (*tab));
+
+    tab->magic = TGTTAB_MAGIC;
+    tab->targets = list_create ((ListDelF)_destroy_tgtstate);
+    tab->pass = 0;
+    tab->hsize = hsize;
+    tab->max = max;
+    tab->count = 0;
+    return tab;
+}
+
+void
+tgttab_destroy (tgttab_t tab)
+{
+    assert (tab->magic == TGTTAB_MAGIC);
+    list_destroy (tab->targets);
+    tab->magic = 0;
+    free (tab);
+}
+
+void
+tgttab_next_pass (tgttab_t tab)
+{
+    assert (tab->magic == TGTTAB_MAGIC);
+    tab->pass++;
+}
+
+/* Find or create the state of the named target and mark it seen.
+ */
+tgtstate_t *
+tgttab_target (tgttab_t tab, const char *name)
+{
+    tgtstate_t *t;
+
+    assert (tab->magic == TGTTAB_MAGIC);
+    if (!(t = list_find_first (tab->targets, (ListFindF)_match_tgtstate,
+                               (void *)name))) {
+        t = xmalloc (sizeof (*t));
+        memset (t, 0, sizeof (*t));
+        t->name = xstrdup ((char *)name);
+        if (tab->hsize > 0)
+            t->ents = hash_create (tab->hsize, (hash_key_f)hash_key_string,
+                                   (hash_cmp_f)strcmp, (hash_del_f)free);
+        list_append (tab->targets, t);
+    }
+    t->pass = tab->pass;
+    return t;
+}
+
+/* Find or create the entry for key and mark it seen.  A new entry is
+ * size bytes, zeroed, so all of its first read counts as growth.
+ * Returns NULL if the entry is not tracked because the table is full.
+ */
+void *
+tgttab_entry (tgttab_t tab, tgtstate_t *t, const char *key, int size)
+{
+    tgtent_t *e;
+
+    assert (tab->magic == TGTTAB_MAGIC);
+    assert (t->ents != NULL);
+    assert (size >= sizeof (tgtent_t));
+    if (!(e = hash_find (t->ents, key))) {
+        if (tab->max > 0 && tab->count >= tab->max)
+            return NULL;
+        e = xmalloc (size);
+        memset (e, 0, size);
+        snprintf (e->key, sizeof (e->key), "%s", key);
+        if (!hash_insert (t->ents, e->key, e)) {
+            free (e);
+            return NULL;
+        }
+        tab->count++;
+    }
+    e->pass = tab->pass;
+    return e;
+}
+
+/* Forget entries of t not seen this pass, e.g. finished jobs.
+ */
+void
+tgttab_prune_entries (tgttab_t tab, tgtstate_t *t)
+{
+    assert (tab->magic == TGTTAB_MAGIC);
+    if (t->ents)
+        tab->count -= hash_delete_if (t->ents, (hash_arg_f)_unseen_tgtent,
+                                      &tab->pass);
+}
+
+/* Forget targets not seen this pass, e.g. after failback.
+ */
+void
+tgttab_prune_targets (tgttab_t tab)
+{
+    ListIterator itr;
+    tgtstate_t *t;
+
+    assert (tab->magic == TGTTAB_MAGIC);
+    itr = list_iterator_create (tab->targets);
+    while ((t = list_next (itr))) {
+        if (t->pass != tab->pass) {
+            if (t->ents)
+                tab->count -= hash_count (t->ents);
+            _destroy_tgtstate (list_remove (itr));
+        }
+    }
+    list_iterator_destroy (itr);
+}
+
+int
+tgttab_count (tgttab_t tab)
+{
+    assert (tab->magic == TGTTAB_MAGIC);
+    return tab->count;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
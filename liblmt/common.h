@@ -5,6 +5,107 @@
 int
 get_recovstr (pctx_t ctx, char *name, char *s, int len);
 
+/* Service list carried by lmt_ost_v3 and lmt_mdt_v4: "nsvc;" followed
+ * by "name;reqs;wait_usecs;qdepth;active;threads_started;threads_max;"
+ * for each of the named ptlrpc services running on this server.
+ */
+int
+get_svcstring (pctx_t ctx, const char **svcs, int nsvcs, char *s, int len);
+
+int
+split_svcstring (const char **sp, List svcinfo);
+
+int
+lmt_decode_svcinfo (const char *s, char **namep, uint64_t *reqsp,
+                    uint64_t *wait_usecsp, uint64_t *qdepthp,
+                    uint64_t *activep, uint64_t *threads_startedp,
+                    uint64_t *threads_maxp);
+
+/* Host resource block carried by lmt_ost_v3 and lmt_mdt_v4:
+ * "ncpu;pct_maxcpu;pct_iowait;pct_softirq;kcached;kslab;kdirty;kwriteback;"
+ * where pct_maxcpu is the usage of the busiest cpu.
+ */
+#define HOSTINFO_FIELDS     8
+
+int
+get_hoststring (cpuusage_t *cpu, meminfo_t *mem, char *s, int len);
+
+int
+lmt_decode_hostinfo (const char *s, int *ncpup, float *pct_maxcpup,
+                     float *pct_iowaitp, float *pct_softirqp,
+                     uint64_t *kcachedp, uint64_t *kslabp,
+                     uint64_t *kdirtyp, uint64_t *kwritebackp);
+
+/* Growth of a counter since its last read.  A counter that went
+ * backwards was cleared (e.g. stats reset or remount), so its new value
+ * is all growth.
+ */
+uint64_t
+counter_delta (uint64_t new, uint64_t old);
+
+/* The busiest of up to TOPK_MAX items seen so far, as a min-heap on key.
+ * topk_offer () returns the slot (0 to max - 1) the caller should store
+ * the item in, or -1 if it is not kept.  Idle items (key 0) are not kept.
+ */
+#define TOPK_MAX            16
+
+typedef struct {
+    uint64_t key[TOPK_MAX];     /* key by slot */
+    int heap[TOPK_MAX];         /* slots in heap order */
+    int n;
+    int max;
+} topk_t;
+
+void
+topk_init (topk_t *k, int max);
+
+int
+topk_offer (topk_t *k, uint64_t key);
+
+/* Counter state kept per target between reads, e.g. per job id or per
+ * client nid.  Entries are caller structs beginning with a tgtent_t.
+ * Each read starts a new pass; entries and targets not seen during the
+ * pass are pruned.  A table may limit its entries over all targets.
+ */
+typedef struct {
+    char key[64];
+    unsigned int pass;          /* last pass the entry was seen */
+} tgtent_t;
+
+typedef struct {
+    char *name;
+    time_t t;                   /* time of last read, 0 if never */
+    unsigned int pass;          /* last pass the target was seen */
+    hash_t ents;                /* tgtent_t by key, NULL if hsize is 0 */
+    void *data;                 /* caller state, freed with the target */
+} tgtstate_t;
+
+typedef struct tgttab_struct *tgttab_t;
+
+tgttab_t
+tgttab_create (int hsize, int max);
+
+void
+tgttab_destroy (tgttab_t tab);
+
+void
+tgttab_next_pass (tgttab_t tab);
+
+tgtstate_t *
+tgttab_target (tgttab_t tab, const char *name);
+
+void *
+tgttab_entry (tgttab_t tab, tgtstate_t *t, const char *key, int size);
+
+void
+tgttab_prune_entries (tgttab_t tab, tgtstate_t *t);
+
+void
+tgttab_prune_targets (tgttab_t tab);
+
+int
+tgttab_count (tgttab_t tab);
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
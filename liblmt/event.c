@@ -0,0 +1,254 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <assert.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+
+#include "osc.h"
+#include "event.h"
+#include "util.h"
+
+#define EVTRACK_HASH_SIZE   1024
+#define EVTRACK_MAGIC       0x45567472
+
+/* Per target (key = target name) or per MDS OSC (key = "mds:ostname").
+ */
+typedef struct {
+    char *key;
+    char *home;                 /* target: server first seen on */
+    char *server;               /* target: current server */
+    char *state;                /* target: recovery status, osc: state */
+    int recovering;             /* target: recovery in progress */
+} evstate_t;
+
+struct lmt_evtrack_struct {
+    int magic;
+    hash_t states;
+};
+
+static const char *event_names[] = {
+    [LMT_EVENT_RECOVERY_START]  = "RECOVERY_START",
+    [LMT_EVENT_RECOVERY_END]    = "RECOVERY_END",
+    [LMT_EVENT_FAILOVER]        = "FAILOVER",
+    [LMT_EVENT_FAILBACK]        = "FAILBACK",
+    [LMT_EVENT_OSC_STATE]       = "OSC_STATE",
+};
+
+const char *
+lmt_event_name (lmt_event_t e)
+{
+    return event_names[e];
+}
+
+int
+lmt_recov_active (const char *recov_status)
+{
+    if (!recov_status || *recov_status == '\0')
+        return 0;
+    if (!strncmp (recov_status, "COMPLETE", 8))
+        return 0;
+    if (!strncmp (recov_status, "INACTIVE", 8))
+        return 0;
+    return 1;
+}
+
+static void
+_destroy_evstate (evstate_t *es)
+{
+    free (es->key);
+    if (es->home)
+        free (es->home);
+    if (es->server)
+        free (es->server);
+    free (es->state);
+    free (es);
+}
+
+static evstate_t *
+_create_evstate (const char *key, const char *state)
+{
+    evstate_t *es = xmalloc (sizeof (*es));
+
+    memset (es, 0, sizeof (*es));
+    es->key = xstrdup (key);
+    es->state = xstrdup (state);
+    return es;
+}
+
+static void
+_set_str (char **sp, const char *s)
+{
+    free (*sp);
+    *sp = xstrdup (s);
+}
+
+lmt_evtrack_t
+lmt_evtrack_create (void)
+{
+    lmt_evtrack_t t = xmalloc (sizeof (*t));
+
+    t->magic = EVTRACK_MAGIC;
+    t->states = hash_create (EVTRACK_HASH_SIZE, (hash_key_f)hash_key_string,
+                             (hash_cmp_f)strcmp, (hash_del_f)_destroy_evstate);
+    return t;
+}
+
+void
+lmt_evtrack_destroy (lmt_evtrack_t t)
+{
+    assert (t->magic == EVTRACK_MAGIC);
+    hash_destroy (t->states);
+    t->magic = 0;
+    free (t);
+}
+
+static int
+_match_all (void *data, const void *key, void *arg)
+{
+    return 1;
+}
+
+void
+lmt_evtrack_clear (lmt_evtrack_t t)
+{
+    assert (t->magic == EVTRACK_MAGIC);
+    hash_delete_if (t->states, (hash_arg_f)_match_all, NULL);
+}
+
+void
+lmt_evtrack_target (lmt_evtrack_t t, const char *target, const char *server,
+                    const char *recov_status, lmt_event_f cb, void *arg)
+{
+    evstate_t *es;
+    int recovering = lmt_recov_active (recov_status);
+    char *comment;
+
+    assert (t->magic == EVTRACK_MAGIC);
+    if (!(es = hash_find (t->states, target))) {
+        es = _create_evstate (target, recov_status);
+        es->home = xstrdup (server);
+        es->server = xstrdup (server);
+        es->recovering = recovering;
+        if (!hash_insert (t->states, es->key, es))
+            _destroy_evstate (es);
+        return;
+    }
+    if (strcmp (es->server, server) != 0) {
+        comment = xmalloc (strlen (es->server) + strlen (server) + 5);
+        sprintf (comment, "%s -> %s", es->server, server);
+        cb (strcmp (server, es->home) ? LMT_EVENT_FAILOVER
+                                      : LMT_EVENT_FAILBACK,
+            target, server, comment, arg);
+        free (comment);
+        _set_str (&es->server, server);
+    }
+    if (recovering != es->recovering)
+        cb (recovering ? LMT_EVENT_RECOVERY_START : LMT_EVENT_RECOVERY_END,
+            target, server, recov_status, arg);
+    es->recovering = recovering;
+    _set_str (&es->state, recov_status);
+}
+
+/* Fold the state of one OSC into the per-OST list for this metric.
+ */
+static void
+_fold_osc (List folded, const char *name, const char *state)
+{
+    ListIterator itr = list_iterator_create (folded);
+    evstate_t *es;
+
+    while ((es = list_next (itr))) {
+        if (!strcmp (es->key, name))
+            break;
+    }
+    list_iterator_destroy (itr);
+    if (!es)
+        list_append (folded, _create_evstate (name, state));
+    else if (!strcmp (es->state, "F"))
+        _set_str (&es->state, state);
+}
+
+void
+lmt_evtrack_osc_v1 (lmt_evtrack_t t, const char *val, lmt_event_f cb,
+                    void *arg)
+{
+    char *mdsname, *oscname, *state, *key;
+    List oscinfo, folded;
+    ListIterator itr;
+    evstate_t *es, *prev;
+    char *s;
+
+    assert (t->magic == EVTRACK_MAGIC);
+    if (lmt_osc_decode_v1 (val, &mdsname, &oscinfo) < 0)
+        return;
+    folded = list_create ((ListDelF)_destroy_evstate);
+    itr = list_iterator_create (oscinfo);
+    while ((s = list_next (itr))) {
+        if (lmt_osc_decode_v1_oscinfo (s, &oscname, &state) < 0)
+            continue;
+        _fold_osc (folded, oscname, state);
+        free (oscname);
+        free (state);
+    }
+    list_iterator_destroy (itr);
+
+    itr = list_iterator_create (folded);
+    while ((es = list_next (itr))) {
+        key = xmalloc (strlen (mdsname) + strlen (es->key) + 2);
+        sprintf (key, "%s:%s", mdsname, es->key);
+        if (!(prev = hash_find (t->states, key))) {
+            prev = _create_evstate (key, es->state);
+            if (!hash_insert (t->states, prev->key, prev))
+                _destroy_evstate (prev);
+        } else if (strcmp (prev->state, es->state) != 0) {
+            s = xmalloc (strlen (prev->state) + strlen (es->state) + 5);
+            sprintf (s, "%s -> %s", prev->state, es->state);
+            cb (LMT_EVENT_OSC_STATE, es->key, mdsname, s, arg);
+            free (s);
+            _set_str (&prev->state, es->state);
+        }
+        free (key);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (folded);
+    list_destroy (oscinfo);
+    free (mdsname);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,53 @@
+/* Transitions detected by lmt_evtrack_*.  lmt_event_name () returns the
+ * EVENT_INFO.EVENT_NAME under which an event is stored.
+ */
+typedef enum {
+    LMT_EVENT_RECOVERY_START,
+    LMT_EVENT_RECOVERY_END,
+    LMT_EVENT_FAILOVER,
+    LMT_EVENT_FAILBACK,
+    LMT_EVENT_OSC_STATE,
+} lmt_event_t;
+
+const char *lmt_event_name (lmt_event_t e);
+
+/* Return 1 if recovery_status (as sent in lmt_ost/lmt_mdt) indicates
+ * recovery is in progress.
+ */
+int lmt_recov_active (const char *recov_status);
+
+/* Called once per transition.  For target events, server is the OSS/MDS
+ * now serving the target; for OSC events, it is the MDS whose OSC for
+ * the OST (target) changed state.
+ */
+typedef void (*lmt_event_f) (lmt_event_t e, const char *target,
+                             const char *server, const char *comment,
+                             void *arg);
+
+typedef struct lmt_evtrack_struct *lmt_evtrack_t;
+
+lmt_evtrack_t lmt_evtrack_create (void);
+void lmt_evtrack_destroy (lmt_evtrack_t t);
+
+/* Forget all state, e.g. when the data source jumps backwards in time.
+ */
+void lmt_evtrack_clear (lmt_evtrack_t t);
+
+/* Feed the server and recovery status of an OST or MDT.  The first
+ * report for a target only records its state; the server it is first
+ * seen on is its home, and a later move back there is a failback.
+ */
+void lmt_evtrack_target (lmt_evtrack_t t, const char *target,
+                         const char *server, const char *recov_status,
+                         lmt_event_f cb, void *arg);
+
+/* Feed an lmt_osc_v1 metric value.  The OSCs an MDS has for one OST
+ * (one per MDT) are folded into a single state: the first one that is
+ * not FULL, or FULL.
+ */
+void lmt_evtrack_osc_v1 (lmt_evtrack_t t, const char *val,
+                         lmt_event_f cb, void *arg);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
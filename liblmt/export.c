@@ -0,0 +1,364 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <errno.h>
+#include <sys/utsname.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+#include "stat.h"
+#include "meminfo.h"
+#include "lustre.h"
+
+#include "lmt.h"
+#include "export.h"
+#include "util.h"
+#include "lmtconf.h"
+#include "common.h"
+
+#define EXP_TOPK        5       /* clients sent per target, per key */
+#define EXP_HASH_SIZE   1024
+
+typedef enum { BY_BYTES, BY_OPS, BY_LOCKS } topkey_t;
+
+/* Counters of a client export at the last read of its target.
+ * There is no limit on the number tracked: exports exist only while
+ * the client is connected, so this is bounded by the client count.
+ */
+typedef struct {
+    tgtent_t ent;               /* key is the client nid */
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t ops;
+    uint64_t locks;
+} expent_t;
+
+/* Client activity since the last read.
+ */
+typedef struct {
+    char nid[64];
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t ops;
+    uint64_t locks;
+} expdelta_t;
+
+/* The busiest EXP_TOPK clients seen so far, by slot.
+ */
+typedef struct {
+    topk_t k;
+    expdelta_t ent[EXP_TOPK];
+} exptop_t;
+
+/* private arg structure for _export_cb () */
+struct exppass_struct {
+    tgtstate_t *tgt;
+    int baseline;
+    exptop_t top[3];            /* indexed by topkey_t */
+};
+
+static tgttab_t exp_tab = NULL;
+
+static uint64_t
+_topk_key (topkey_t by, expdelta_t *d)
+{
+    switch (by) {
+        case BY_OPS:
+            return d->ops;
+        case BY_LOCKS:
+            return d->locks;
+        default:
+            return d->read_bytes + d->write_bytes;
+    }
+}
+
+static int
+_cmp_expdelta_bybytes (const void *a1, const void *a2)
+{
+    const expdelta_t *d1 = a1;
+    const expdelta_t *d2 = a2;
+    uint64_t b1 = d1->read_bytes + d1->write_bytes;
+    uint64_t b2 = d2->read_bytes + d2->write_bytes;
+
+    return b1 < b2 ? 1 : b1 > b2 ? -1 : 0;
+}
+
+static int
+_export_cb (expstat_t *x, void *arg)
+{
+    struct exppass_struct *p = arg;
+    expent_t *e;
+    expdelta_t d;
+    int i, slot;
+
+    /* a client connected since the last read is zeroed, so counts in full */
+    if (!(e = tgttab_entry (exp_tab, p->tgt, x->nid, sizeof (*e))))
+        return 0;
+    if (!p->baseline) {
+        snprintf (d.nid, sizeof (d.nid), "%s", x->nid);
+        d.read_bytes = counter_delta (x->read_bytes, e->read_bytes);
+        d.write_bytes = counter_delta (x->write_bytes, e->write_bytes);
+        d.ops = counter_delta (x->ops, e->ops);
+        d.locks = counter_delta (x->locks, e->locks);
+        for (i = 0; i < 3; i++)
+            if ((slot = topk_offer (&p->top[i].k, _topk_key (i, &d))) >= 0)
+                p->top[i].ent[slot] = d;
+    }
+    e->read_bytes = x->read_bytes;
+    e->write_bytes = x->write_bytes;
+    e->ops = x->ops;
+    e->locks = x->locks;
+    return 0;
+}
+
+static int
+_append_expdelta (char *s, int len, expdelta_t *d)
+{
+    int used = strlen (s);
+
+    return snprintf (s + used, len - used, "%s;%"PRIu64";%"PRIu64";%"PRIu64
+                     ";%"PRIu64";", d->nid, d->read_bytes, d->write_bytes,
+                     d->ops, d->locks) >= len - used ? -1 : 0;
+}
+
+/* Append "target;secs;nclients;" and the target's busiest clients to s.
+ * A target whose exports cannot be read is left out.
+ */
+static int
+_get_exportstring (pctx_t ctx, char *name, char *s, int len)
+{
+    struct exppass_struct p;
+    expdelta_t top[3 * EXP_TOPK];
+    time_t now = time (NULL);
+    int i, j, k, n, used, retval = -1;
+    tgtstate_t *t;
+
+    t = tgttab_target (exp_tab, name);
+    memset (&p, 0, sizeof (p));
+    p.tgt = t;
+    p.baseline = (t->t == 0);
+    for (k = BY_BYTES; k <= BY_LOCKS; k++)
+        topk_init (&p.top[k].k, EXP_TOPK);
+    if (proc_lustre_exportstats (ctx, name, _export_cb, &p) < 0) {
+        if (lmt_conf_get_proto_debug ())
+            err ("error reading lustre %s exports from proc", name);
+        return 0;
+    }
+    tgttab_prune_entries (exp_tab, t); /* forget disconnected clients */
+
+    /* busiest by bytes in order, then any others busiest by ops or locks */
+    n = p.top[BY_BYTES].k.n;
+    memcpy (top, p.top[BY_BYTES].ent, n * sizeof (top[0]));
+    qsort (top, n, sizeof (top[0]), _cmp_expdelta_bybytes);
+    for (k = BY_OPS; k <= BY_LOCKS; k++) {
+        for (i = 0; i < p.top[k].k.n; i++) {
+            for (j = 0; j < n; j++)
+                if (!strcmp (p.top[k].ent[i].nid, top[j].nid))
+                    break;
+            if (j == n)
+                top[n++] = p.top[k].ent[i];
+        }
+    }
+    used = strlen (s);
+    if (snprintf (s + used, len - used, "%s;%d;%d;", name,
+                  p.baseline ? 0 : (int)(now - t->t), n) >= len - used)
+        goto done;
+    for (i = 0; i < n; i++)
+        if (_append_expdelta (s, len, &top[i]) < 0)
+            goto done;
+    retval = 0;
+done:
+    t->t = now;
+    if (retval < 0 && lmt_conf_get_proto_debug ())
+        msg ("string overflow");
+    return retval;
+}
+
+int
+lmt_export_string_v1 (pctx_t ctx, char *s, int len)
+{
+    ListIterator itr = NULL;
+    List ostlist = NULL;
+    List mdtlist = NULL;
+    struct utsname uts;
+    int n, retval = -1;
+    char *name;
+
+    if (!exp_tab)
+        exp_tab = tgttab_create (EXP_HASH_SIZE, 0);
+    tgttab_next_pass (exp_tab);
+    if (proc_lustre_ostlist (ctx, &ostlist) < 0)
+        goto done;
+    if (proc_lustre_mdtlist (ctx, &mdtlist) < 0)
+        goto done;
+    if (list_count (ostlist) == 0 && list_count (mdtlist) == 0) {
+        errno = 0;
+        goto done;
+    }
+    if (uname (&uts) < 0) {
+        err ("uname");
+        goto done;
+    }
+    n = snprintf (s, len, "1;%s;", uts.nodename);
+    if (n >= len) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("string overflow");
+        goto done;
+    }
+    itr = list_iterator_create (ostlist);
+    while ((name = list_next (itr)))
+        if (_get_exportstring (ctx, name, s, len) < 0)
+            goto done;
+    list_iterator_destroy (itr);
+    itr = list_iterator_create (mdtlist);
+    while ((name = list_next (itr)))
+        if (_get_exportstring (ctx, name, s, len) < 0)
+            goto done;
+    retval = 0;
+done:
+    /* forget targets no longer on this server, e.g. after failback */
+    if (ostlist && mdtlist)
+        tgttab_prune_targets (exp_tab);
+    if (itr)
+        list_iterator_destroy (itr);
+    if (ostlist)
+        list_destroy (ostlist);
+    if (mdtlist)
+        list_destroy (mdtlist);
+    return retval;
+}
+
+int
+lmt_export_decode_v1 (const char *s, char **hostp, List *tgtinfop)
+{
+    int retval = -1;
+    char *host = xmalloc (strlen (s) + 1);
+    List tgtinfo = list_create ((ListDelF)free);
+    char *cpy;
+    int nclients;
+
+    if (sscanf (s, "%*f;%[^;];", host) != 1 || !(s = strskip (s, 2, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_export_v1: parse error: host component");
+        goto done;
+    }
+    while (*s) {
+        if (sscanf (s, "%*[^;];%*d;%d;", &nclients) != 1 || nclients < 0
+                || !(cpy = strskipcpy (&s, 3 + 5 * nclients, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_export_v1: parse error: target component");
+            goto done;
+        }
+        list_append (tgtinfo, cpy);
+    }
+    *hostp = host;
+    *tgtinfop = tgtinfo;
+    retval = 0;
+done:
+    if (retval < 0) {
+        free (host);
+        list_destroy (tgtinfo);
+    }
+    return retval;
+}
+
+int
+lmt_export_decode_v1_tgtinfo (const char *s, char **tgtnamep, int *secsp,
+                              List *clientinfop)
+{
+    int retval = -1;
+    char *tgtname = xmalloc (strlen (s) + 1);
+    List clientinfo = list_create ((ListDelF)free);
+    char *cpy;
+    int i, secs, nclients;
+
+    if (sscanf (s, "%[^;];%d;%d", tgtname, &secs, &nclients) != 3
+                || !(s = strskip (s, 3, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_export_v1: parse error: tgtinfo");
+        goto done;
+    }
+    for (i = 0; i < nclients; i++) {
+        if (!(cpy = strskipcpy (&s, 5, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_export_v1: parse error: clientinfo");
+            goto done;
+        }
+        list_append (clientinfo, cpy);
+    }
+    *tgtnamep = tgtname;
+    *secsp = secs;
+    *clientinfop = clientinfo;
+    retval = 0;
+done:
+    if (retval < 0) {
+        free (tgtname);
+        list_destroy (clientinfo);
+    }
+    return retval;
+}
+
+int
+lmt_export_decode_v1_clientinfo (const char *s, char **nidp,
+                                 uint64_t *read_bytesp, uint64_t *write_bytesp,
+                                 uint64_t *opsp, uint64_t *locksp)
+{
+    int retval = -1;
+    char *nid = xmalloc (strlen (s) + 1);
+    uint64_t read_bytes, write_bytes, ops, locks;
+
+    if (sscanf (s, "%[^;];%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64, nid,
+                &read_bytes, &write_bytes, &ops, &locks) != 5) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_export_v1: parse error: clientinfo");
+        goto done;
+    }
+    *nidp = nid;
+    *read_bytesp = read_bytes;
+    *write_bytesp = write_bytes;
+    *opsp = ops;
+    *locksp = locks;
+    retval = 0;
+done:
+    if (retval < 0)
+        free (nid);
+    return retval;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
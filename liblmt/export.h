@@ -0,0 +1,19 @@
+/* lmt_export v1: "1;host;" followed by "target;secs;nclients;" per OST/MDT
+ * and "nid;read_bytes;write_bytes;ops;locks;" per client, where the counts
+ * are the client's activity in the secs seconds since the target was last
+ * read.  Only the busiest clients of each target (by bytes, by ops and by
+ * lock enqueues) are sent.
+ */
+int lmt_export_string_v1 (pctx_t ctx, char *s, int len);
+
+int lmt_export_decode_v1 (const char *s, char **hostp, List *tgtinfop);
+int lmt_export_decode_v1_tgtinfo (const char *s, char **tgtnamep, int *secsp,
+                                  List *clientinfop);
+int lmt_export_decode_v1_clientinfo (const char *s, char **nidp,
+                                     uint64_t *read_bytesp,
+                                     uint64_t *write_bytesp,
+                                     uint64_t *opsp, uint64_t *locksp);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
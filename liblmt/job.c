@@ -0,0 +1,361 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <errno.h>
+#include <sys/utsname.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+#include "stat.h"
+#include "meminfo.h"
+#include "lustre.h"
+
+#include "lmt.h"
+#include "job.h"
+#include "util.h"
+#include "lmtconf.h"
+#include "common.h"
+
+#define JOB_TOPK        5       /* jobs sent per target, by bytes and ops */
+#define JOB_TABLE_MAX   16384   /* jobs tracked over all targets */
+#define JOB_HASH_SIZE   256
+
+/* Counters of a job at the last read of its target.
+ */
+typedef struct {
+    tgtent_t ent;               /* key is the job id */
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t ops;
+} jobent_t;
+
+/* Job activity since the last read.
+ */
+typedef struct {
+    char id[64];
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t ops;
+} jobdelta_t;
+
+/* The busiest JOB_TOPK jobs seen so far, by slot.
+ */
+typedef struct {
+    topk_t k;
+    jobdelta_t ent[JOB_TOPK];
+} jobtop_t;
+
+/* private arg structure for _job_cb () */
+struct jobpass_struct {
+    tgtstate_t *tgt;
+    int baseline;
+    int dropped;
+    jobtop_t bybytes;
+    jobtop_t byops;
+};
+
+static tgttab_t job_tab = NULL;
+
+static void
+_jobtop_offer (jobtop_t *top, uint64_t key, jobdelta_t *d)
+{
+    int slot;
+
+    if ((slot = topk_offer (&top->k, key)) >= 0)
+        top->ent[slot] = *d;
+}
+
+static int
+_cmp_jobdelta_bybytes (const void *a1, const void *a2)
+{
+    const jobdelta_t *d1 = a1;
+    const jobdelta_t *d2 = a2;
+    uint64_t b1 = d1->read_bytes + d1->write_bytes;
+    uint64_t b2 = d2->read_bytes + d2->write_bytes;
+
+    return b1 < b2 ? 1 : b1 > b2 ? -1 : 0;
+}
+
+static int
+_job_cb (jobstat_t *j, void *arg)
+{
+    struct jobpass_struct *p = arg;
+    jobent_t *e;
+    jobdelta_t d;
+    char *c;
+
+    if (j->job_id[0] == '\0')
+        return 0;
+    /* a job new since the last read is zeroed, so counts in full */
+    if (!(e = tgttab_entry (job_tab, p->tgt, j->job_id, sizeof (*e)))) {
+        p->dropped++;
+        return 0;
+    }
+    if (!p->baseline) {
+        snprintf (d.id, sizeof (d.id), "%s", j->job_id);
+        for (c = d.id; *c; c++)
+            if (*c == ';')
+                *c = '_';
+        d.read_bytes = counter_delta (j->read_bytes, e->read_bytes);
+        d.write_bytes = counter_delta (j->write_bytes, e->write_bytes);
+        d.ops = counter_delta (j->ops, e->ops);
+        _jobtop_offer (&p->bybytes, d.read_bytes + d.write_bytes, &d);
+        _jobtop_offer (&p->byops, d.ops, &d);
+    }
+    e->read_bytes = j->read_bytes;
+    e->write_bytes = j->write_bytes;
+    e->ops = j->ops;
+    return 0;
+}
+
+static int
+_append_jobdelta (char *s, int len, jobdelta_t *d)
+{
+    int used = strlen (s);
+
+    return snprintf (s + used, len - used, "%s;%"PRIu64";%"PRIu64";%"PRIu64
+                     ";", d->id, d->read_bytes, d->write_bytes, d->ops)
+                     >= len - used ? -1 : 0;
+}
+
+/* Append "target;secs;njobs;" and the target's busiest jobs to s.
+ * A target without job_stats is left out.
+ */
+static int
+_get_jobstring (pctx_t ctx, char *name, char *s, int len)
+{
+    struct jobpass_struct p;
+    jobdelta_t top[2 * JOB_TOPK];
+    time_t now = time (NULL);
+    int i, j, n, used, retval = -1;
+    tgtstate_t *t;
+
+    t = tgttab_target (job_tab, name);
+    memset (&p, 0, sizeof (p));
+    p.tgt = t;
+    p.baseline = (t->t == 0);
+    topk_init (&p.bybytes.k, JOB_TOPK);
+    topk_init (&p.byops.k, JOB_TOPK);
+    if (proc_lustre_jobstats (ctx, name, _job_cb, &p) < 0) {
+        if (lmt_conf_get_proto_debug ())
+            err ("error reading lustre %s job_stats from proc", name);
+        return 0;
+    }
+    if (p.dropped > 0 && lmt_conf_get_proto_debug ())
+        msg ("%s: %d jobs not tracked (limit %d)", name, p.dropped,
+             JOB_TABLE_MAX);
+    tgttab_prune_entries (job_tab, t); /* forget jobs dropped from job_stats */
+
+    /* busiest by bytes in order, then any others busiest by ops */
+    n = p.bybytes.k.n;
+    memcpy (top, p.bybytes.ent, n * sizeof (top[0]));
+    qsort (top, n, sizeof (top[0]), _cmp_jobdelta_bybytes);
+    for (i = 0; i < p.byops.k.n; i++) {
+        for (j = 0; j < p.bybytes.k.n; j++)
+            if (!strcmp (p.byops.ent[i].id, top[j].id))
+                break;
+        if (j == p.bybytes.k.n)
+            top[n++] = p.byops.ent[i];
+    }
+    used = strlen (s);
+    if (snprintf (s + used, len - used, "%s;%d;%d;", name,
+                  p.baseline ? 0 : (int)(now - t->t), n) >= len - used)
+        goto done;
+    for (i = 0; i < n; i++)
+        if (_append_jobdelta (s, len, &top[i]) < 0)
+            goto done;
+    retval = 0;
+done:
+    t->t = now;
+    if (retval < 0 && lmt_conf_get_proto_debug ())
+        msg ("string overflow");
+    return retval;
+}
+
+int
+lmt_job_string_v1 (pctx_t ctx, char *s, int len)
+{
+    ListIterator itr = NULL;
+    List ostlist = NULL;
+    List mdtlist = NULL;
+    struct utsname uts;
+    int n, retval = -1;
+    char *name;
+
+    if (!job_tab)
+        job_tab = tgttab_create (JOB_HASH_SIZE, JOB_TABLE_MAX);
+    tgttab_next_pass (job_tab);
+    if (proc_lustre_ostlist (ctx, &ostlist) < 0)
+        goto done;
+    if (proc_lustre_mdtlist (ctx, &mdtlist) < 0)
+        goto done;
+    if (list_count (ostlist) == 0 && list_count (mdtlist) == 0) {
+        errno = 0;
+        goto done;
+    }
+    if (uname (&uts) < 0) {
+        err ("uname");
+        goto done;
+    }
+    n = snprintf (s, len, "1;%s;", uts.nodename);
+    if (n >= len) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("string overflow");
+        goto done;
+    }
+    itr = list_iterator_create (ostlist);
+    while ((name = list_next (itr)))
+        if (_get_jobstring (ctx, name, s, len) < 0)
+            goto done;
+    list_iterator_destroy (itr);
+    itr = list_iterator_create (mdtlist);
+    while ((name = list_next (itr)))
+        if (_get_jobstring (ctx, name, s, len) < 0)
+            goto done;
+    retval = 0;
+done:
+    /* forget targets no longer on this server, e.g. after failback */
+    if (ostlist && mdtlist)
+        tgttab_prune_targets (job_tab);
+    if (itr)
+        list_iterator_destroy (itr);
+    if (ostlist)
+        list_destroy (ostlist);
+    if (mdtlist)
+        list_destroy (mdtlist);
+    return retval;
+}
+
+int
+lmt_job_decode_v1 (const char *s, char **hostp, List *tgtinfop)
+{
+    int retval = -1;
+    char *host = xmalloc (strlen (s) + 1);
+    List tgtinfo = list_create ((ListDelF)free);
+    char *cpy;
+    int njobs;
+
+    if (sscanf (s, "%*f;%[^;];", host) != 1 || !(s = strskip (s, 2, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_job_v1: parse error: host component");
+        goto done;
+    }
+    while (*s) {
+        if (sscanf (s, "%*[^;];%*d;%d;", &njobs) != 1 || njobs < 0
+                || !(cpy = strskipcpy (&s, 3 + 4 * njobs, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_job_v1: parse error: target component");
+            goto done;
+        }
+        list_append (tgtinfo, cpy);
+    }
+    *hostp = host;
+    *tgtinfop = tgtinfo;
+    retval = 0;
+done:
+    if (retval < 0) {
+        free (host);
+        list_destroy (tgtinfo);
+    }
+    return retval;
+}
+
+int
+lmt_job_decode_v1_tgtinfo (const char *s, char **tgtnamep, int *secsp,
+                           List *jobinfop)
+{
+    int retval = -1;
+    char *tgtname = xmalloc (strlen (s) + 1);
+    List jobinfo = list_create ((ListDelF)free);
+    char *cpy;
+    int i, secs, njobs;
+
+    if (sscanf (s, "%[^;];%d;%d", tgtname, &secs, &njobs) != 3
+                || !(s = strskip (s, 3, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_job_v1: parse error: tgtinfo");
+        goto done;
+    }
+    for (i = 0; i < njobs; i++) {
+        if (!(cpy = strskipcpy (&s, 4, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_job_v1: parse error: jobinfo");
+            goto done;
+        }
+        list_append (jobinfo, cpy);
+    }
+    *tgtnamep = tgtname;
+    *secsp = secs;
+    *jobinfop = jobinfo;
+    retval = 0;
+done:
+    if (retval < 0) {
+        free (tgtname);
+        list_destroy (jobinfo);
+    }
+    return retval;
+}
+
+int
+lmt_job_decode_v1_jobinfo (const char *s, char **jobidp,
+                           uint64_t *read_bytesp, uint64_t *write_bytesp,
+                           uint64_t *opsp)
+{
+    int retval = -1;
+    char *jobid = xmalloc (strlen (s) + 1);
+    uint64_t read_bytes, write_bytes, ops;
+
+    if (sscanf (s, "%[^;];%"PRIu64";%"PRIu64";%"PRIu64, jobid,
+                &read_bytes, &write_bytes, &ops) != 4) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_job_v1: parse error: jobinfo");
+        goto done;
+    }
+    *jobidp = jobid;
+    *read_bytesp = read_bytes;
+    *write_bytesp = write_bytes;
+    *opsp = ops;
+    retval = 0;
+done:
+    if (retval < 0)
+        free (jobid);
+    return retval;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,17 @@
+/* lmt_job v1: "1;host;" followed by "target;secs;njobs;" per OST/MDT and
+ * "jobid;read_bytes;write_bytes;ops;" per job, where the counts are the
+ * job's activity in the secs seconds since the target was last read.
+ * Only the busiest jobs of each target (by bytes and by ops) are sent.
+ */
+int lmt_job_string_v1 (pctx_t ctx, char *s, int len);
+
+int lmt_job_decode_v1 (const char *s, char **hostp, List *tgtinfop);
+int lmt_job_decode_v1_tgtinfo (const char *s, char **tgtnamep, int *secsp,
+                               List *jobinfop);
+int lmt_job_decode_v1_jobinfo (const char *s, char **jobidp,
+                               uint64_t *read_bytesp, uint64_t *write_bytesp,
+                               uint64_t *opsp);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -43,8 +43,17 @@
 #include <lauxlib.h>
 #endif
 
+#include "hostlist.h"
+
 #include "lmtconf.h"
 
+/* Router group, with id = its position in the table (from 1).
+ */
+typedef struct {
+    char *name;
+    hostlist_t hosts;
+} rtrgroup_t;
+
 typedef struct {
     char *db_rwuser;
     char *db_rwpasswd;
@@ -56,6 +65,11 @@ typedef struct {
     int db_autoconf;
     int cbr_debug;
     int proto_debug;
+    int export_enable;
+    int client_sample;
+    int client_period;
+    rtrgroup_t *router_groups;
+    int router_group_count;
 } config_t;
 
 static config_t config = {
@@ -69,6 +83,11 @@ static config_t config = {
     .db_autoconf = 1,
     .cbr_debug = 0,
     .proto_debug = 0,
+    .export_enable = 0,
+    .client_sample = 0,
+    .client_period = 30,
+    .router_groups = NULL,
+    .router_group_count = 0,
 };
 
 #define PATH_LMTCONF        X_SYSCONFDIR "/" PACKAGE "/lmt.conf"
@@ -128,6 +147,92 @@ void lmt_conf_set_cbr_debug (int i) { config.cbr_debug = i; }
 int lmt_conf_get_proto_debug (void) { return config.proto_debug; }
 void lmt_conf_set_proto_debug (int i) { config.proto_debug = i; }
 
+int lmt_conf_get_export_enable (void) { return config.export_enable; }
+void lmt_conf_set_export_enable (int i) { config.export_enable = i; }
+
+int lmt_conf_get_client_sample (void) { return config.client_sample; }
+void lmt_conf_set_client_sample (int i) { config.client_sample = i; }
+
+int lmt_conf_get_client_period (void) { return config.client_period; }
+void lmt_conf_set_client_period (int i) { config.client_period = i; }
+
+int
+lmt_conf_get_router_group_count (void)
+{
+    return config.router_group_count;
+}
+
+char *
+lmt_conf_get_router_group_name (int id)
+{
+    if (id < 1 || id > config.router_group_count)
+        return NULL;
+    return config.router_groups[id - 1].name;
+}
+
+int
+lmt_conf_get_router_group (const char *host)
+{
+    char shortname[256], *p;
+    int i;
+
+    snprintf (shortname, sizeof (shortname), "%s", host);
+    if ((p = strchr (shortname, '.')))
+        *p = '\0';
+    for (i = 0; i < config.router_group_count; i++) {
+        if (hostlist_find (config.router_groups[i].hosts, host) >= 0
+                || hostlist_find (config.router_groups[i].hosts,
+                                  shortname) >= 0)
+            return i + 1;
+    }
+    return 0;
+}
+
+static void
+_clear_router_groups (void)
+{
+    int i;
+
+    for (i = 0; i < config.router_group_count; i++) {
+        free (config.router_groups[i].name);
+        hostlist_destroy (config.router_groups[i].hosts);
+    }
+    free (config.router_groups);
+    config.router_groups = NULL;
+    config.router_group_count = 0;
+}
+
+int
+lmt_conf_add_router_group (char *name, char *hosts)
+{
+    rtrgroup_t *new;
+    hostlist_t hl;
+    char *cpy;
+
+    if (!(hl = hostlist_create (hosts))) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(cpy = strdup (name))) {
+        hostlist_destroy (hl);
+        errno = ENOMEM;
+        return -1;
+    }
+    new = realloc (config.router_groups,
+                   (config.router_group_count + 1) * sizeof (rtrgroup_t));
+    if (!new) {
+        free (cpy);
+        hostlist_destroy (hl);
+        errno = ENOMEM;
+        return -1;
+    }
+    new[config.router_group_count].name = cpy;
+    new[config.router_group_count].hosts = hl;
+    config.router_groups = new;
+    config.router_group_count++;
+    return 0;
+}
+
 #ifdef HAVE_LUA_H
 static int
 _lua_getglobal_int (int vopt, char *path, lua_State *L, char *key, int *ip)
@@ -183,11 +288,73 @@ done:
     lua_pop (L, 1);
     return res;
 }
+
+/* Read a table of router groups, e.g.
+ *   lmt_router_groups = {
+ *       { name = "east", hosts = "rtr[1-32]" },
+ *       { name = "west", hosts = "rtr[33-64]" },
+ *   }
+ */
+static int
+_lua_getglobal_rtrgroups (int vopt, char *path, lua_State *L, char *key)
+{
+    int i, res = 0;
+    char *name, *hosts;
+
+    lua_getglobal (L, key);
+    if (lua_isnil (L, -1))
+        goto done;
+    res = -1;
+    errno = EIO;
+    if (!lua_istable (L, -1)) {
+        if (vopt)
+            fprintf (stderr, "%s: `%s' should be table\n", path, key);
+        goto done;
+    }
+    for (i = 1; ; i++) {
+        lua_rawgeti (L, -1, i);
+        if (lua_isnil (L, -1)) {
+            lua_pop (L, 1);
+            break;
+        }
+        if (!lua_istable (L, -1)) {
+            if (vopt)
+                fprintf (stderr, "%s: `%s' entry %d should be table\n",
+                         path, key, i);
+            lua_pop (L, 1);
+            goto done;
+        }
+        lua_getfield (L, -1, "name");
+        lua_getfield (L, -2, "hosts");
+        if (!lua_isstring (L, -2) || !lua_isstring (L, -1)) {
+            if (vopt)
+                fprintf (stderr, "%s: `%s' entry %d should have string name"
+                         " and hosts\n", path, key, i);
+            lua_pop (L, 3);
+            goto done;
+        }
+        name = (char *)lua_tostring (L, -2);
+        hosts = (char *)lua_tostring (L, -1);
+        if (lmt_conf_add_router_group (name, hosts) < 0) {
+            if (vopt)
+                fprintf (stderr, "%s: `%s' entry %d: bad hostlist `%s'\n",
+                         path, key, i, hosts);
+            lua_pop (L, 3);
+            goto done;
+        }
+        lua_pop (L, 3);
+    }
+    res = 0;
+done:
+    lua_pop (L, 1);
+    return res;
+}
 #endif /* HAVE_LUA_H */
 
 int
 lmt_conf_init (int vopt, char *path)
 {
+    _clear_router_groups (); /* groups are reloaded, not appended */
 #ifdef HAVE_LUA_H
     lua_State *L;
     int res = -1;
@@ -235,6 +402,17 @@ lmt_conf_init (int vopt, char *path)
         if (_lua_getglobal_int (vopt, path, L, "lmt_proto_debug",
                                                 &config.proto_debug) < 0)
             goto done;
+        if (_lua_getglobal_int (vopt, path, L, "lmt_export_enable",
+                                                &config.export_enable) < 0)
+            goto done;
+        if (_lua_getglobal_int (vopt, path, L, "lmt_client_sample",
+                                                &config.client_sample) < 0)
+            goto done;
+        if (_lua_getglobal_int (vopt, path, L, "lmt_client_period",
+                                                &config.client_period) < 0)
+            goto done;
+        if (_lua_getglobal_rtrgroups (vopt, path, L, "lmt_router_groups") < 0)
+            goto done;
         res = 0;
 done:
         lua_close(L);
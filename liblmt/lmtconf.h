@@ -30,6 +30,24 @@ void  lmt_conf_set_cbr_debug (int i);
 int   lmt_conf_get_proto_debug (void);
 void  lmt_conf_set_proto_debug (int i);
 
+int   lmt_conf_get_export_enable (void);
+void  lmt_conf_set_export_enable (int i);
+
+int   lmt_conf_get_client_sample (void);
+void  lmt_conf_set_client_sample (int i);
+
+int   lmt_conf_get_client_period (void);
+void  lmt_conf_set_client_period (int i);
+
+/* Router groups are numbered from 1 in the order they are defined.
+ * lmt_conf_get_router_group () returns the group whose hostlist holds
+ * host (with or without its domain), or 0 if none does.
+ */
+int   lmt_conf_get_router_group (const char *host);
+char *lmt_conf_get_router_group_name (int id);
+int   lmt_conf_get_router_group_count (void);
+int   lmt_conf_add_router_group (char *name, char *hosts);
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -48,6 +48,7 @@
 
 #include "lmt.h"
 #include "mdt.h"
+#include "ost.h"
 #include "util.h"
 #include "lmtconf.h"
 #include "common.h"
@@ -198,6 +199,14 @@ const int optablen_mdt_v1 = sizeof (optab_mdt_v1) / sizeof(optab_mdt_v1[0]);
 const int optablen_mdt_v2 = sizeof (optab_mdt_v1) / sizeof(optab_mdt_v1[0]);
 const int optablen_mdt_v3 = sizeof (optab_mdt_v3) / sizeof(optab_mdt_v3[0]);
 
+/* ptlrpc services carried by lmt_mdt_v4 */
+static const char *svctab_mdt_v4[] = {
+    "mdt",
+    "mdt_readpage",
+};
+static const int svctablen_mdt_v4 = sizeof (svctab_mdt_v4)
+                                  / sizeof (svctab_mdt_v4[0]);
+
 /*  create a list of all the opnames
  *  this list will likely include copies but that doesn't matter
  */
@@ -206,6 +215,7 @@ List get_all_opnames()
         List opnames = list_create ((ListDelF)free);
         int i;
         char *copy_buf;
+        const char *opname;
         int len;
 
         /* for mdt_v2, which has the same operations */
@@ -221,21 +231,32 @@ List get_all_opnames()
                 strncpy(copy_buf, optab_mdt_v3[i], len + 1);
                 list_append(opnames, copy_buf);
         }
+        /* ost ops carried by lmt_ost_v3 */
+        for (i = 0; (opname = get_ost_opname_v3 (i)); i++)
+                list_append(opnames, xstrdup (opname));
 
         return opnames;
 }
 
-static int
-_get_mem_usage (pctx_t ctx, double *fp)
+/*  return the name of the op at position i in an lmt_mdt_v3 mdtinfo,
+ *  or NULL if i is out of range
+ */
+const char *get_opname_v3 (int i)
 {
-    uint64_t kfree, ktot;
+        if (i < 0 || i >= optablen_mdt_v3)
+                return NULL;
+        return optab_mdt_v3[i];
+}
 
-    if (proc_meminfo (ctx, &ktot, &kfree) < 0) {
+static int
+_get_mem_usage (pctx_t ctx, meminfo_t *mp, double *fp)
+{
+    if (proc_meminfo2 (ctx, mp) < 0) {
         if (lmt_conf_get_proto_debug ())
             err ("error reading memory usage from proc");
         return -1;
     }
-    *fp = ((double)(ktot - kfree) / (double)(ktot)) * 100.0;
+    *fp = ((double)(mp->total - mp->free) / (double)(mp->total)) * 100.0;
     return 0;
 }
 
@@ -318,16 +339,17 @@ done:
     return retval;
 }
 
-int
-lmt_mdt_string_v3 (pctx_t ctx, char *s, int len)
+static int
+_get_mdsstring (pctx_t ctx, char *s, int len, int version)
 {
-    static uint64_t cpuused = 0, cputot = 0;
+    static cpustate_t cpustate;
     struct utsname uts;
     int n, used, retval = -1;
-    double cpupct, mempct;
+    cpuusage_t cpu;
+    meminfo_t mem;
+    double mempct;
     List mdtlist = NULL;
     ListIterator itr = NULL;
-    char verstr[2]="3";
     char *name;
 
     if (proc_lustre_mdtlist (ctx, &mdtlist) < 0)
@@ -340,20 +362,30 @@ lmt_mdt_string_v3 (pctx_t ctx, char *s, int len)
         err ("uname");
         goto done;
     }
-    if (proc_stat2 (ctx, &cpuused, &cputot, &cpupct) < 0) {
+    if (proc_stat3 (ctx, &cpustate, &cpu) < 0) {
         if (lmt_conf_get_proto_debug ())
             err ("error reading cpu usage from proc");
         goto done;
     }
-    if (_get_mem_usage (ctx, &mempct) < 0) {
+    if (_get_mem_usage (ctx, &mem, &mempct) < 0) {
         goto done;
     }
-    n = snprintf (s, len, "%s;%s;%f;%f;", verstr, uts.nodename, cpupct, mempct);
+    n = snprintf (s, len, "%d;%s;%f;%f;", version, uts.nodename, cpu.pct_cpu,
+                  mempct);
     if (n >= len) {
         if (lmt_conf_get_proto_debug ())
             msg ("string overflow");
         goto done;
     }
+    if (version >= 4) {
+        used = strlen (s);
+        if (get_svcstring (ctx, svctab_mdt_v4, svctablen_mdt_v4, s + used,
+                           len - used) < 0)
+            goto done;
+        used = strlen (s);
+        if (get_hoststring (&cpu, &mem, s + used, len - used) < 0)
+            goto done;
+    }
     itr = list_iterator_create (mdtlist);
     while ((name = list_next (itr))) {
         used = strlen (s);
@@ -371,6 +403,18 @@ done:
     return retval;
 }
 
+int
+lmt_mdt_string_v3 (pctx_t ctx, char *s, int len)
+{
+    return _get_mdsstring (ctx, s, len, 3);
+}
+
+int
+lmt_mdt_string_v4 (pctx_t ctx, char *s, int len)
+{
+    return _get_mdsstring (ctx, s, len, 4);
+}
+
 /* parse the src, extracting mds information.  If fail, return NULL.
  * otherwise, return pointer to first char after the mds info
  */
@@ -391,9 +435,10 @@ _parse_and_skip_mds_info_v1 (const char *src, char *mdsname, float *pct_cpu,
     return src;
 }
 
-int
-lmt_mdt_decode_v1_v2_v3 (const char *s, char **mdsnamep, float *pct_cpup,
-                   float *pct_memp, List *mdtinfop, int version)
+static int
+_decode_mds (const char *s, char **mdsnamep, float *pct_cpup,
+             float *pct_memp, List *svcinfop, char **hostinfop,
+             List *mdtinfop, int version)
 {
     int mdtfields = -1;
     int retval = -1;
@@ -401,18 +446,31 @@ lmt_mdt_decode_v1_v2_v3 (const char *s, char **mdsnamep, float *pct_cpup,
     char *cpy = NULL;
     float pct_mem, pct_cpu;
     List mdtinfo = list_create ((ListDelF)free);
+    List svcinfo = list_create ((ListDelF)free);
+    char *hostinfo = NULL;
 
-    assert (version == 1 || version == 2 || version == 3);
+    assert (version >= 1 && version <= 4);
 
-    /* lmt_mdt_v1, lmt_mdt_v2, and lmt_mdt_v3 mds info portion is the same */
+    /* lmt_mdt_v1 through lmt_mdt_v4 mds info portion is the same */
     if ( ! (s = _parse_and_skip_mds_info_v1 (s, mdsname, &pct_cpu, &pct_mem)))
         goto done;
+    if (version >= 4 && split_svcstring (&s, svcinfo) < 0) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_mdt_v%d: parse error: service", version);
+        goto done;
+    }
+    if (version >= 4
+            && !(hostinfo = strskipcpy (&s, HOSTINFO_FIELDS, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_mdt_v%d: parse error: host", version);
+        goto done;
+    }
 
     if (version == 1)
         mdtfields = 5 + 3 * optablen_mdt_v1;
     else if (version == 2)
         mdtfields = 6 + 3 * optablen_mdt_v2;
-    else // version == 3
+    else // version == 3 or 4
         mdtfields = 6 + 3 * optablen_mdt_v3;
 
     while ((cpy = strskipcpy (&s, mdtfields, ';')))
@@ -426,15 +484,45 @@ lmt_mdt_decode_v1_v2_v3 (const char *s, char **mdsnamep, float *pct_cpup,
     *pct_cpup = pct_cpu;
     *pct_memp = pct_mem;
     *mdtinfop = mdtinfo;
+    if (svcinfop)
+        *svcinfop = svcinfo;
+    else
+        list_destroy (svcinfo);
+    if (hostinfop)
+        *hostinfop = hostinfo;
+    else if (hostinfo)
+        free (hostinfo);
     retval = 0;
 done:
     if (retval < 0) {
         free (mdsname);
         list_destroy (mdtinfo);
+        list_destroy (svcinfo);
+        if (hostinfo)
+            free (hostinfo);
     }
     return retval;
 }
 
+int
+lmt_mdt_decode_v1_v2_v3 (const char *s, char **mdsnamep, float *pct_cpup,
+                   float *pct_memp, List *mdtinfop, int version)
+{
+    assert (version == 1 || version == 2 || version == 3);
+
+    return _decode_mds (s, mdsnamep, pct_cpup, pct_memp, NULL, NULL, mdtinfop,
+                        version);
+}
+
+int
+lmt_mdt_decode_v4 (const char *s, char **mdsnamep, float *pct_cpup,
+                   float *pct_memp, List *svcinfop, char **hostinfop,
+                   List *mdtinfop)
+{
+    return _decode_mds (s, mdsnamep, pct_cpup, pct_memp, svcinfop, hostinfop,
+                        mdtinfop, 4);
+}
+
 static int
 _lmt_mdt_decode_mdtinfo_helper (const char *s, char **mdtnamep,
                            uint64_t *inodes_freep, uint64_t *inodes_totalp,
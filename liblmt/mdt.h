@@ -1,8 +1,17 @@
 int lmt_mdt_string_v3 (pctx_t ctx, char *s, int len);
+int lmt_mdt_string_v4 (pctx_t ctx, char *s, int len);
 
 int lmt_mdt_decode_v1_v2_v3 (const char *s, char **mdsnamep,
                              float *pct_cpup, float *pct_memp, List *mdtinfo,
                              int version);
+/* v4 is v3 with a list of MDS ptlrpc services and the MDS host resource
+ * block (hostinfo) ahead of the MDTs.  svcinfo items are decoded with
+ * lmt_decode_svcinfo (), hostinfo with lmt_decode_hostinfo (), and
+ * mdtinfo items with lmt_mdt_decode_v3_mdtinfo ().
+ */
+int lmt_mdt_decode_v4 (const char *s, char **mdsnamep,
+                       float *pct_cpup, float *pct_memp, List *svcinfop,
+                       char **hostinfop, List *mdtinfop);
 int lmt_mdt_decode_v3_mdtinfo (const char *s, char **mdtnamep,
                         uint64_t *inodes_freep, uint64_t *inodes_totalp,
                         uint64_t *kbytes_freep, uint64_t *kbytes_totalp,
@@ -11,6 +20,7 @@ int lmt_mdt_decode_v1_mdops (const char *s, char **opnamep, uint64_t *samplesp,
                         uint64_t *sump, uint64_t *sumsquaresp);
 
 List get_all_opnames ();
+const char *get_opname_v3 (int i);
 
 /* legacy */
 
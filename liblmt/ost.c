@@ -44,6 +44,9 @@
 #include "stat.h"
 #include "meminfo.h"
 #include "lustre.h"
+#include "netdev.h"
+#include "zfs.h"
+#include "diskstats.h"
 
 #include "lmt.h"
 #include "ost.h"
@@ -51,17 +54,59 @@
 #include "lmtconf.h"
 #include "common.h"
 
-static int
-_get_mem_usage (pctx_t ctx, double *fp)
+/* Operations carried by lmt_ost_v3, in wire order.  Counts only
+ * (no sum/sumsq) so the metric stays compact.  preprw/commitrw are
+ * the 1.8 obdfilter names for bulk read/write.
+ */
+static const char *optab_ost_v3[] = {
+    "read",
+    "write",
+    "getattr",
+    "setattr",
+    "punch",
+    "sync",
+    "destroy",
+    "create",
+    "statfs",
+    "get_info",
+    "set_info",
+    "set_info_async",
+    "quotactl",
+    "preprw",
+    "commitrw",
+    "ping",
+};
+static const int optablen_ost_v3 = sizeof (optab_ost_v3)
+                                 / sizeof (optab_ost_v3[0]);
+
+/* ptlrpc services carried by lmt_ost_v3 */
+static const char *svctab_ost_v3[] = {
+    "ost_io",
+    "ost",
+};
+static const int svctablen_ost_v3 = sizeof (svctab_ost_v3)
+                                  / sizeof (svctab_ost_v3[0]);
+
+/*  return the name of the op at position i in an lmt_ost_v3 ostinfo,
+ *  or NULL if i is out of range
+ */
+const char *
+get_ost_opname_v3 (int i)
 {
-    uint64_t kfree, ktot;
+    if (i < 0 || i >= optablen_ost_v3)
+        return NULL;
+    return optab_ost_v3[i];
+}
 
-    if (proc_meminfo (ctx, &ktot, &kfree) < 0) {
+static int
+_get_mem_usage (pctx_t ctx, meminfo_t *mp, double *fp)
+{
+    if (proc_meminfo2 (ctx, mp) < 0) {
         if (lmt_conf_get_proto_debug ())
             err ("error reading memory usage from proc");
         return -1;
     }
-    *fp = ((double)(ktot - kfree) / (double)(ktot)) * 100.0;
+    *fp = ((double)(mp->total - mp->free) / (double)(mp->total)) * 100.0;
     return 0;
 }
 
@@ -90,7 +135,7 @@ _get_iops (pctx_t ctx, char *name, uint64_t *iopsp)
 }
 
 static int
-_get_oststring_v2 (pctx_t ctx, char *name, char *s, int len)
+_get_oststring (pctx_t ctx, char *name, char *s, int len)
 {
     char *uuid = NULL;
     uint64_t filesfree, filestotal;
@@ -99,8 +144,9 @@ _get_oststring_v2 (pctx_t ctx, char *name, char *s, int len)
     uint64_t iops=0, num_exports;
     uint64_t lock_count, grant_rate, cancel_rate;
     uint64_t connect, reconnect;
+    uint64_t count;
     hash_t stats_hash = NULL;
-    int n, retval = -1;
+    int i, n, used, retval = -1;
     char recov_str[RECOVERY_STR_SIZE];
 
     if (proc_lustre_uuid (ctx, name, &uuid) < 0) {
@@ -172,7 +218,18 @@ _get_oststring_v2 (pctx_t ctx, char *name, char *s, int len)
     if (n >= len) {
         if (lmt_conf_get_proto_debug ())
             msg ("string overflow");
-        return -1;
+        goto done;
+    }
+    for (i = 0; i < optablen_ost_v3; i++) {
+        proc_lustre_parsestat (stats_hash, optab_ost_v3[i], &count,
+                               NULL, NULL, NULL, NULL);
+        used = strlen (s);
+        n = snprintf (s + used, len - used, "%"PRIu64";", count);
+        if (n >= len - used) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("string overflow");
+            goto done;
+        }
     }
     retval = 0;
 done:
@@ -183,14 +240,223 @@ done:
     return retval;
 }
 
+/* Append "nif;" followed by "name;rx;tx;errs;link;rate;" per interface.
+ * Missing /proc/net/dev is not fatal - it is reported as zero interfaces.
+ */
+static int
+_get_ifstring (pctx_t ctx, char *s, int len)
+{
+    List netdevs = NULL;
+    ListIterator itr = NULL;
+    netdev_t *n;
+    int used, nlen, retval = -1;
+
+    if (proc_netdev (ctx, &netdevs) < 0) {
+        if (errno != ENOENT && lmt_conf_get_proto_debug ())
+            err ("error reading network interfaces from proc");
+        netdevs = list_create ((ListDelF)free);
+    }
+    nlen = snprintf (s, len, "%d;", list_count (netdevs));
+    if (nlen >= len)
+        goto overflow;
+    itr = list_iterator_create (netdevs);
+    while ((n = list_next (itr))) {
+        used = strlen (s);
+        nlen = snprintf (s + used, len - used, "%s;%"PRIu64";%"PRIu64
+                         ";%"PRIu64";%d;%"PRIu64";", n->name, n->rx_bytes,
+                         n->tx_bytes, n->errors, n->link, n->rate);
+        if (nlen >= len - used)
+            goto overflow;
+    }
+    retval = 0;
+    goto done;
+overflow:
+    if (lmt_conf_get_proto_debug ())
+        msg ("string overflow");
+done:
+    if (itr)
+        list_iterator_destroy (itr);
+    list_destroy (netdevs);
+    return retval;
+}
+
+/* OSTs backed by one zpool */
+typedef struct {
+    char *pool;
+    char *osts;                     /* comma separated target names */
+    zpoolstat_t stat;
+} zpoolmap_t;
+
+static void
+_destroy_zpoolmap (zpoolmap_t *z)
+{
+    free (z->pool);
+    free (z->osts);
+    free (z);
+}
+
+static int
+_match_zpoolmap (zpoolmap_t *z, char *pool)
+{
+    return !strcmp (z->pool, pool);
+}
+
+/* Group the OSTs in ostlist by the zpool backing them, leaving out
+ * ldiskfs OSTs and pools whose kstats cannot be read.
+ */
+static List
+_map_zpools (pctx_t ctx, List ostlist)
+{
+    List pools = list_create ((ListDelF)_destroy_zpoolmap);
+    ListIterator itr;
+    zpoolmap_t *z;
+    char *name, *pool;
+
+    itr = list_iterator_create (ostlist);
+    while ((name = list_next (itr))) {
+        if (proc_lustre_zfs_pool (ctx, name, &pool) < 0)
+            continue;
+        if ((z = list_find_first (pools, (ListFindF)_match_zpoolmap, pool))) {
+            strappendfield (&z->osts, name, ',');
+            free (pool);
+        } else {
+            z = xmalloc (sizeof (*z));
+            z->pool = pool;
+            z->osts = xstrdup (name);
+            list_append (pools, z);
+        }
+    }
+    list_iterator_destroy (itr);
+
+    itr = list_iterator_create (pools);
+    while ((z = list_next (itr))) {
+        if (proc_zfs_pool (ctx, z->pool, &z->stat) < 0) {
+            if (lmt_conf_get_proto_debug ())
+                err ("error reading zpool %s kstats from proc", z->pool);
+            _destroy_zpoolmap (list_remove (itr));
+        }
+    }
+    list_iterator_destroy (itr);
+    return pools;
+}
+
+/* Append "hits;misses;size;c_max;npool;" for the ARC followed by
+ * "pool;osts;nread;nwritten;reads;writes;txg;txg_sync_ns;" for each
+ * zpool backing an OST.  On ldiskfs this is all zeroes.
+ */
+static int
+_get_zfsstring (pctx_t ctx, List ostlist, char *s, int len)
+{
+    List pools = _map_zpools (ctx, ostlist);
+    ListIterator itr = NULL;
+    arcstat_t arc;
+    zpoolmap_t *z;
+    int used, n, retval = -1;
+
+    if (proc_zfs_arcstats (ctx, &arc) < 0) {
+        if (errno != ENOENT && lmt_conf_get_proto_debug ())
+            err ("error reading zfs arcstats from proc");
+        memset (&arc, 0, sizeof (arc));
+    }
+    n = snprintf (s, len, "%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";%d;",
+                  arc.hits, arc.misses, arc.size, arc.c_max,
+                  list_count (pools));
+    if (n >= len)
+        goto overflow;
+    itr = list_iterator_create (pools);
+    while ((z = list_next (itr))) {
+        used = strlen (s);
+        n = snprintf (s + used, len - used, "%s;%s;%"PRIu64";%"PRIu64
+                      ";%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";",
+                      z->pool, z->osts, z->stat.nread, z->stat.nwritten,
+                      z->stat.reads, z->stat.writes, z->stat.txg,
+                      z->stat.txg_sync_ns);
+        if (n >= len - used)
+            goto overflow;
+    }
+    retval = 0;
+    goto done;
+overflow:
+    if (lmt_conf_get_proto_debug ())
+        msg ("string overflow");
+done:
+    if (itr)
+        list_iterator_destroy (itr);
+    list_destroy (pools);
+    return retval;
+}
+
+/* Append "ndisk;" followed by
+ * "ost;dev;reads;read_ms;writes;write_ms;in_flight;io_ms;queue_ms;" for
+ * each ldiskfs OST whose block device is in /proc/diskstats.  The file
+ * is read once for all OSTs.
+ */
+static int
+_get_diskstring (pctx_t ctx, List ostlist, char *s, int len)
+{
+    List disks = NULL;
+    List items = list_create ((ListDelF)free);
+    ListIterator itr = NULL;
+    diskstat_t *d;
+    char *name, *dev, *item;
+    char buf[256];
+    int used, n, retval = -1;
+
+    if (proc_diskstats (ctx, &disks) < 0) {
+        if (errno != ENOENT && lmt_conf_get_proto_debug ())
+            err ("error reading diskstats from proc");
+    } else {
+        itr = list_iterator_create (ostlist);
+        while ((name = list_next (itr))) {
+            if (proc_lustre_ldiskfs_dev (ctx, name, &dev) < 0)
+                continue;
+            if ((d = proc_diskstats_find (ctx, disks, dev))) {
+                snprintf (buf, sizeof (buf), "%s;%s;%"PRIu64";%"PRIu64
+                          ";%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64
+                          ";", name, d->name, d->reads, d->read_ms,
+                          d->writes, d->write_ms, d->in_flight, d->io_ms,
+                          d->queue_ms);
+                list_append (items, xstrdup (buf));
+            } else if (lmt_conf_get_proto_debug ())
+                msg ("%s: %s not found in diskstats", name, dev);
+            free (dev);
+        }
+        list_iterator_destroy (itr);
+    }
+    n = snprintf (s, len, "%d;", list_count (items));
+    if (n >= len)
+        goto overflow;
+    itr = list_iterator_create (items);
+    while ((item = list_next (itr))) {
+        used = strlen (s);
+        n = snprintf (s + used, len - used, "%s", item);
+        if (n >= len - used)
+            goto overflow;
+    }
+    retval = 0;
+    goto done;
+overflow:
+    if (lmt_conf_get_proto_debug ())
+        msg ("string overflow");
+done:
+    if (itr)
+        list_iterator_destroy (itr);
+    if (disks)
+        list_destroy (disks);
+    list_destroy (items);
+    return retval;
+}
+
 int
-lmt_ost_string_v2 (pctx_t ctx, char *s, int len)
+lmt_ost_string_v3 (pctx_t ctx, char *s, int len)
 {
-    static uint64_t cpuused = 0, cputot = 0;
+    static cpustate_t cpustate;
     ListIterator itr = NULL;
     List ostlist = NULL;
     struct utsname uts;
-    double cpupct, mempct;
+    cpuusage_t cpu;
+    meminfo_t mem;
+    double mempct;
     int used, n, retval = -1;
     char *name;
 
@@ -204,26 +470,42 @@ lmt_ost_string_v2 (pctx_t ctx, char *s, int len)
         err ("uname");
         goto done;
     }
-    if (proc_stat2 (ctx, &cpuused, &cputot, &cpupct) < 0) {
+    if (proc_stat3 (ctx, &cpustate, &cpu) < 0) {
         if (lmt_conf_get_proto_debug ())
             err ("error reading cpu usage from proc");
         goto done;
     }
-    if (_get_mem_usage (ctx, &mempct) < 0)
+    if (_get_mem_usage (ctx, &mem, &mempct) < 0)
         goto done;
-    n = snprintf (s, len, "2;%s;%f;%f;",
+    n = snprintf (s, len, "3;%s;%f;%f;",
                   uts.nodename,
-                  cpupct,
+                  cpu.pct_cpu,
                   mempct);
     if (n >= len) {
         if (lmt_conf_get_proto_debug ())
             msg ("string overflow");
         goto done;
     }
+    used = strlen (s);
+    if (_get_ifstring (ctx, s + used, len - used) < 0)
+        goto done;
+    used = strlen (s);
+    if (get_svcstring (ctx, svctab_ost_v3, svctablen_ost_v3, s + used,
+                       len - used) < 0)
+        goto done;
+    used = strlen (s);
+    if (_get_zfsstring (ctx, ostlist, s + used, len - used) < 0)
+        goto done;
+    used = strlen (s);
+    if (_get_diskstring (ctx, ostlist, s + used, len - used) < 0)
+        goto done;
+    used = strlen (s);
+    if (get_hoststring (&cpu, &mem, s + used, len - used) < 0)
+        goto done;
     itr = list_iterator_create (ostlist);
     while ((name = list_next (itr))) {
         used = strlen (s);
-        if (_get_oststring_v2 (ctx, name, s + used, len - used) < 0)
+        if (_get_oststring (ctx, name, s + used, len - used) < 0)
             goto done;
     }
     retval = 0;
@@ -235,46 +517,161 @@ done:
     return retval;
 }
 
-int
-lmt_ost_decode_v2 (const char *s, char **ossnamep, float *pct_cpup,
-                   float *pct_memp, List *ostinfop)
+static int
+_decode_oss (const char *s, char **ossnamep, float *pct_cpup,
+             float *pct_memp, List *ifinfop, List *svcinfop, char **arcinfop,
+             List *zpoolinfop, List *diskinfop, char **hostinfop,
+             List *ostinfop, int version)
 {
+    int ostfields = version >= 3 ? 15 + optablen_ost_v3 : 15;
     int retval = -1;
     char *ossname =  xmalloc (strlen(s) + 1);
     char *cpy = NULL;
     float pct_mem, pct_cpu;
     List ostinfo = list_create ((ListDelF)free);
+    List ifinfo = list_create ((ListDelF)free);
+    List svcinfo = list_create ((ListDelF)free);
+    List zpoolinfo = list_create ((ListDelF)free);
+    List diskinfo = list_create ((ListDelF)free);
+    char *arcinfo = NULL;
+    char *hostinfo = NULL;
+    int i, nif, npool, ndisk;
 
     if (sscanf (s, "%*f;%[^;];%f;%f;", ossname, &pct_cpu, &pct_mem) != 3) {
         if (lmt_conf_get_proto_debug ())
-            msg ("lmt_ost_v2: parse error: oss component");
+            msg ("lmt_ost_v%d: parse error: oss component", version);
         goto done;
     }
     if (!(s = strskip (s, 4, ';'))) {
         if (lmt_conf_get_proto_debug ())
-            msg ("lmt_ost_v2: parse error: skipping oss component");
+            msg ("lmt_ost_v%d: parse error: skipping oss component",
+                 version);
         goto done;
     }
-    while ((cpy = strskipcpy (&s, 15, ';')))
+    if (version >= 3) {
+        if (sscanf (s, "%d;", &nif) != 1 || !(s = strskip (s, 1, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_ost_v%d: parse error: interface count", version);
+            goto done;
+        }
+        for (i = 0; i < nif; i++) {
+            if (!(cpy = strskipcpy (&s, 6, ';'))) {
+                if (lmt_conf_get_proto_debug ())
+                    msg ("lmt_ost_v%d: parse error: interface", version);
+                goto done;
+            }
+            list_append (ifinfo, cpy);
+        }
+        if (split_svcstring (&s, svcinfo) < 0) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_ost_v%d: parse error: service", version);
+            goto done;
+        }
+        if (!(arcinfo = strskipcpy (&s, 4, ';'))
+                || sscanf (s, "%d;", &npool) != 1
+                || !(s = strskip (s, 1, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_ost_v%d: parse error: arc", version);
+            goto done;
+        }
+        for (i = 0; i < npool; i++) {
+            if (!(cpy = strskipcpy (&s, 8, ';'))) {
+                if (lmt_conf_get_proto_debug ())
+                    msg ("lmt_ost_v%d: parse error: zpool", version);
+                goto done;
+            }
+            list_append (zpoolinfo, cpy);
+        }
+        if (sscanf (s, "%d;", &ndisk) != 1 || !(s = strskip (s, 1, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_ost_v%d: parse error: disk count", version);
+            goto done;
+        }
+        for (i = 0; i < ndisk; i++) {
+            if (!(cpy = strskipcpy (&s, 9, ';'))) {
+                if (lmt_conf_get_proto_debug ())
+                    msg ("lmt_ost_v%d: parse error: disk", version);
+                goto done;
+            }
+            list_append (diskinfo, cpy);
+        }
+        if (!(hostinfo = strskipcpy (&s, HOSTINFO_FIELDS, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_ost_v%d: parse error: host", version);
+            goto done;
+        }
+    }
+    while ((cpy = strskipcpy (&s, ostfields, ';')))
         list_append (ostinfo, cpy);
     if (strlen (s) > 0) {
         if (lmt_conf_get_proto_debug ())
-            msg ("lmt_ost_v2: parse error: string not exhausted");
+            msg ("lmt_ost_v%d: parse error: string not exhausted", version);
         goto done;
     }
     *ossnamep = ossname;
     *pct_cpup = pct_cpu;
     *pct_memp = pct_mem;
     *ostinfop = ostinfo;
+    if (ifinfop)
+        *ifinfop = ifinfo;
+    else
+        list_destroy (ifinfo);
+    if (svcinfop)
+        *svcinfop = svcinfo;
+    else
+        list_destroy (svcinfo);
+    if (arcinfop)
+        *arcinfop = arcinfo;
+    else if (arcinfo)
+        free (arcinfo);
+    if (zpoolinfop)
+        *zpoolinfop = zpoolinfo;
+    else
+        list_destroy (zpoolinfo);
+    if (diskinfop)
+        *diskinfop = diskinfo;
+    else
+        list_destroy (diskinfo);
+    if (hostinfop)
+        *hostinfop = hostinfo;
+    else if (hostinfo)
+        free (hostinfo);
     retval = 0;
 done:
     if (retval < 0) {
         free (ossname);
         list_destroy (ostinfo);
+        list_destroy (ifinfo);
+        list_destroy (svcinfo);
+        list_destroy (zpoolinfo);
+        list_destroy (diskinfo);
+        if (arcinfo)
+            free (arcinfo);
+        if (hostinfo)
+            free (hostinfo);
     }
     return retval;
 }
 
+int
+lmt_ost_decode_v2 (const char *s, char **ossnamep, float *pct_cpup,
+                   float *pct_memp, List *ostinfop)
+{
+    return _decode_oss (s, ossnamep, pct_cpup, pct_memp, NULL, NULL, NULL,
+                        NULL, NULL, NULL, ostinfop, 2);
+}
+
+int
+lmt_ost_decode_v3 (const char *s, char **ossnamep, float *pct_cpup,
+                   float *pct_memp, List *ifinfop, List *svcinfop,
+                   char **arcinfop, List *zpoolinfop, List *diskinfop,
+                   char **hostinfop, List *ostinfop)
+{
+    return _decode_oss (s, ossnamep, pct_cpup, pct_memp, ifinfop, svcinfop,
+                        arcinfop, zpoolinfop, diskinfop, hostinfop, ostinfop,
+                        3);
+}
+
 int
 lmt_ost_decode_v2_ostinfo (const char *s, char **ostnamep,
                            uint64_t *read_bytesp, uint64_t *write_bytesp,
@@ -331,6 +728,212 @@ done:
     return retval;
 }
 
+/* The v3 ostinfo is the v2 ostinfo followed by one count per op in
+ * optab_ost_v3.  Ops are returned as "count;opname" strings to be
+ * picked apart with lmt_ost_decode_v3_ostops ().
+ */
+int
+lmt_ost_decode_v3_ostinfo (const char *s, char **ostnamep,
+                           uint64_t *read_bytesp, uint64_t *write_bytesp,
+                           uint64_t *kbytes_freep, uint64_t *kbytes_totalp,
+                           uint64_t *inodes_freep, uint64_t *inodes_totalp,
+                           uint64_t *iopsp, uint64_t *num_exportsp,
+                           uint64_t *lock_countp, uint64_t *grant_ratep,
+                           uint64_t *cancel_ratep,
+                           uint64_t *connectp, uint64_t *reconnectp,
+                           char **recov_statusp, List *opsp)
+{
+    int retval = -1;
+    char *ostname = NULL;
+    char *recov_status = NULL;
+    List ops = list_create ((ListDelF)free);
+    char *cpy;
+    int i = 0;
+
+    if (lmt_ost_decode_v2_ostinfo (s, &ostname, read_bytesp, write_bytesp,
+                                   kbytes_freep, kbytes_totalp,
+                                   inodes_freep, inodes_totalp,
+                                   iopsp, num_exportsp,
+                                   lock_countp, grant_ratep, cancel_ratep,
+                                   connectp, reconnectp, &recov_status) < 0)
+        goto done;
+    if (!(s = strskip (s, 15, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_ost_v3: parse error: skipping ostinfo");
+        goto done;
+    }
+    while ((cpy = strskipcpy (&s, 1, ';'))) {
+        if (i >= optablen_ost_v3) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_ost_v3: parse error: too many ops");
+            free (cpy);
+            goto done;
+        }
+        strappendfield (&cpy, optab_ost_v3[i++], ';');
+        list_append (ops, cpy);
+    }
+    if (strlen (s) > 0 || i < optablen_ost_v3) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_ost_v3: parse error: ostinfo: wrong number of ops");
+        goto done;
+    }
+    *ostnamep = ostname;
+    *recov_statusp = recov_status;
+    *opsp = ops;
+    retval = 0;
+done:
+    if (retval < 0) {
+        if (ostname)
+            free (ostname);
+        if (recov_status)
+            free (recov_status);
+        list_destroy (ops);
+    }
+    return retval;
+}
+
+int
+lmt_ost_decode_v3_ostops (const char *s, char **opnamep, uint64_t *samplesp)
+{
+    int retval = -1;
+    char *opname = xmalloc (strlen (s) + 1);
+    uint64_t samples;
+
+    if (sscanf (s, "%"PRIu64";%[^;]", &samples, opname) != 2) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_ost_v3: parse error: ops");
+        goto done;
+    }
+    *opnamep = opname;
+    *samplesp = samples;
+    retval = 0;
+done:
+    if (retval < 0)
+        free (opname);
+    return retval;
+}
+
+int
+lmt_ost_decode_v3_ifinfo (const char *s, char **ifnamep,
+                          uint64_t *rx_bytesp, uint64_t *tx_bytesp,
+                          uint64_t *errorsp, int *linkp, uint64_t *ratep)
+{
+    int retval = -1;
+    char *ifname = xmalloc (strlen (s) + 1);
+    uint64_t rx_bytes, tx_bytes, errors, rate;
+    int link;
+
+    if (sscanf (s, "%[^;];%"PRIu64";%"PRIu64";%"PRIu64";%d;%"PRIu64,
+                ifname, &rx_bytes, &tx_bytes, &errors, &link, &rate) != 6) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_ost_v3: parse error: ifinfo");
+        goto done;
+    }
+    *ifnamep = ifname;
+    *rx_bytesp = rx_bytes;
+    *tx_bytesp = tx_bytes;
+    *errorsp = errors;
+    *linkp = link;
+    *ratep = rate;
+    retval = 0;
+done:
+    if (retval < 0)
+        free (ifname);
+    return retval;
+}
+
+int
+lmt_ost_decode_v3_arcinfo (const char *s, uint64_t *hitsp, uint64_t *missesp,
+                           uint64_t *sizep, uint64_t *c_maxp)
+{
+    uint64_t hits, misses, size, c_max;
+
+    if (sscanf (s, "%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64,
+                &hits, &misses, &size, &c_max) != 4) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_ost_v3: parse error: arcinfo");
+        return -1;
+    }
+    *hitsp = hits;
+    *missesp = misses;
+    *sizep = size;
+    *c_maxp = c_max;
+    return 0;
+}
+
+int
+lmt_ost_decode_v3_zpoolinfo (const char *s, char **poolp, char **ostsp,
+                             uint64_t *nreadp, uint64_t *nwrittenp,
+                             uint64_t *readsp, uint64_t *writesp,
+                             uint64_t *txgp, uint64_t *txg_sync_nsp)
+{
+    int retval = -1;
+    char *pool = xmalloc (strlen (s) + 1);
+    char *osts = xmalloc (strlen (s) + 1);
+    uint64_t nread, nwritten, reads, writes, txg, txg_sync_ns;
+
+    if (sscanf (s, "%[^;];%[^;];%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64
+                ";%"PRIu64";%"PRIu64, pool, osts, &nread, &nwritten, &reads,
+                &writes, &txg, &txg_sync_ns) != 8) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_ost_v3: parse error: zpoolinfo");
+        goto done;
+    }
+    *poolp = pool;
+    *ostsp = osts;
+    *nreadp = nread;
+    *nwrittenp = nwritten;
+    *readsp = reads;
+    *writesp = writes;
+    *txgp = txg;
+    *txg_sync_nsp = txg_sync_ns;
+    retval = 0;
+done:
+    if (retval < 0) {
+        free (pool);
+        free (osts);
+    }
+    return retval;
+}
+
+int
+lmt_ost_decode_v3_diskinfo (const char *s, char **ostnamep, char **devp,
+                            uint64_t *readsp, uint64_t *read_msp,
+                            uint64_t *writesp, uint64_t *write_msp,
+                            uint64_t *in_flightp, uint64_t *io_msp,
+                            uint64_t *queue_msp)
+{
+    int retval = -1;
+    char *ostname = xmalloc (strlen (s) + 1);
+    char *dev = xmalloc (strlen (s) + 1);
+    uint64_t reads, read_ms, writes, write_ms, in_flight, io_ms, queue_ms;
+
+    if (sscanf (s, "%[^;];%[^;];%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64
+                ";%"PRIu64";%"PRIu64";%"PRIu64, ostname, dev, &reads,
+                &read_ms, &writes, &write_ms, &in_flight, &io_ms,
+                &queue_ms) != 9) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_ost_v3: parse error: diskinfo");
+        goto done;
+    }
+    *ostnamep = ostname;
+    *devp = dev;
+    *readsp = reads;
+    *read_msp = read_ms;
+    *writesp = writes;
+    *write_msp = write_ms;
+    *in_flightp = in_flight;
+    *io_msp = io_ms;
+    *queue_msp = queue_ms;
+    retval = 0;
+done:
+    if (retval < 0) {
+        free (ostname);
+        free (dev);
+    }
+    return retval;
+}
+
 /**
  ** Legacy
  **/
@@ -1,4 +1,52 @@
-int lmt_ost_string_v2 (pctx_t ctx, char *s, int len);
+int lmt_ost_string_v3 (pctx_t ctx, char *s, int len);
+
+/* v3 is v2 with one count per op (see get_ost_opname_v3 ()) appended to
+ * each ostinfo, decoded with lmt_ost_decode_v3_ostinfo (), and with the
+ * following ahead of the OSTs:
+ * - a list of OSS network interfaces (ifinfo)
+ * - a list of OSS ptlrpc services (svcinfo), decoded with
+ *   lmt_decode_svcinfo ()
+ * - ZFS ARC counters (arcinfo) and a list of the zpools backing the
+ *   OSTs (zpoolinfo).  The osts field of a zpoolinfo item is a comma
+ *   separated list of OST names.
+ * - the /proc/diskstats counters of the block device under each ldiskfs
+ *   OST (diskinfo).  Times are in ms.
+ * - the OSS host resource block (hostinfo), decoded with
+ *   lmt_decode_hostinfo ()
+ */
+int lmt_ost_decode_v3 (const char *s, char **ossnamep,
+                        float *pct_cpup, float *pct_memp, List *ifinfop,
+                        List *svcinfop, char **arcinfop, List *zpoolinfop,
+                        List *diskinfop, char **hostinfop, List *ostinfop);
+int lmt_ost_decode_v3_ostinfo (const char *s, char **ostnamep,
+                        uint64_t *read_bytesp, uint64_t *write_bytesp,
+                        uint64_t *kbytes_freep, uint64_t *kbytes_totalp,
+                        uint64_t *inodes_freep, uint64_t *inodes_totalp,
+                        uint64_t *iopsp, uint64_t *num_exportsp,
+                        uint64_t *lock_countp, uint64_t *grant_ratep,
+                        uint64_t *cancel_ratep, uint64_t *connectp,
+                        uint64_t *reconnectp, char **recov_statusp,
+                        List *opsp);
+int lmt_ost_decode_v3_ostops (const char *s, char **opnamep,
+                        uint64_t *samplesp);
+int lmt_ost_decode_v3_ifinfo (const char *s, char **ifnamep,
+                        uint64_t *rx_bytesp, uint64_t *tx_bytesp,
+                        uint64_t *errorsp, int *linkp, uint64_t *ratep);
+int lmt_ost_decode_v3_arcinfo (const char *s, uint64_t *hitsp,
+                        uint64_t *missesp, uint64_t *sizep, uint64_t *c_maxp);
+int lmt_ost_decode_v3_zpoolinfo (const char *s, char **poolp, char **ostsp,
+                        uint64_t *nreadp, uint64_t *nwrittenp,
+                        uint64_t *readsp, uint64_t *writesp,
+                        uint64_t *txgp, uint64_t *txg_sync_nsp);
+int lmt_ost_decode_v3_diskinfo (const char *s, char **ostnamep, char **devp,
+                        uint64_t *readsp, uint64_t *read_msp,
+                        uint64_t *writesp, uint64_t *write_msp,
+                        uint64_t *in_flightp, uint64_t *io_msp,
+                        uint64_t *queue_msp);
+
+const char *get_ost_opname_v3 (int i);
+
+/* legacy */
 
 int lmt_ost_decode_v2 (const char *s, char **ossnamep,
                         float *pct_cpup, float *pct_memp, List *ostinfop);
@@ -11,8 +59,6 @@ int lmt_ost_decode_v2_ostinfo (const char *s, char **ostnamep,
                         uint64_t *cancel_ratep, uint64_t *connectp,
                         uint64_t *reconnectp, char **recov_statusp);
 
-/* legacy */
-
 int lmt_oss_decode_v1 (const char *s, char **ossnamep, float *pct_cpup,
                        float *pct_memp);
 int lmt_ost_decode_v1 (const char *s, char **ossnamep, char **ostnamep,
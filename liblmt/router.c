@@ -44,12 +44,19 @@
 #include "stat.h"
 #include "meminfo.h"
 #include "lustre.h"
+#include "lnet.h"
 
 #include "lmt.h"
 #include "router.h"
 #include "util.h"
 #include "lmtconf.h"
 
+/* The most starved peers sent in lmt_router_v2 */
+#define RTR_MAX_PEERS   8
+
+/* NIs beyond this are left out of lmt_router_v2 */
+#define RTR_MAX_NIS     16
+
 typedef struct {
     uint64_t    usage[2];
     uint64_t    total[2];
@@ -70,14 +77,70 @@ _get_mem_usage (pctx_t ctx, double *fp)
     return 0;
 }
 
-int
-lmt_router_string_v1 (pctx_t ctx, char *s, int len)
+/* Append "drops;nni;" then "nid;up;peer;max;tx;min;" per NI, then
+ * "npeer;nstarved;queue;nworst;" and "nid;max;tx;min;queue;" for each of
+ * the most starved peers.  Missing nis or peers tables are reported as
+ * empty.
+ */
+static int
+_get_lnetstring (pctx_t ctx, uint64_t drops, char *s, int len)
+{
+    lnetni_t ni[RTR_MAX_NIS];
+    lnetpeer_t peer[RTR_MAX_PEERS];
+    lnetpeersum_t sum;
+    int i, used, n, nni, npeer;
+
+    if (proc_lnet_nis (ctx, ni, RTR_MAX_NIS, &nni) < 0) {
+        if (errno != ENOENT && lmt_conf_get_proto_debug ())
+            err ("error reading lnet nis from proc");
+        nni = 0;
+    }
+    if (proc_lnet_peers (ctx, peer, RTR_MAX_PEERS, &npeer, &sum) < 0) {
+        if (errno != ENOENT && lmt_conf_get_proto_debug ())
+            err ("error reading lnet peers from proc");
+        npeer = 0;
+        memset (&sum, 0, sizeof (sum));
+    }
+    n = snprintf (s, len, "%"PRIu64";%d;", drops, nni);
+    if (n >= len)
+        goto overflow;
+    for (i = 0; i < nni; i++) {
+        used = strlen (s);
+        n = snprintf (s + used, len - used, "%s;%d;%d;%d;%d;%d;", ni[i].nid,
+                      ni[i].up, ni[i].peer_credits, ni[i].max_credits,
+                      ni[i].tx_credits, ni[i].min_credits);
+        if (n >= len - used)
+            goto overflow;
+    }
+    used = strlen (s);
+    n = snprintf (s + used, len - used, "%d;%d;%"PRIu64";%d;", sum.npeers,
+                  sum.nstarved, sum.queue, npeer);
+    if (n >= len - used)
+        goto overflow;
+    for (i = 0; i < npeer; i++) {
+        used = strlen (s);
+        n = snprintf (s + used, len - used, "%s;%d;%d;%d;%"PRIu64";",
+                      peer[i].nid, peer[i].max_credits, peer[i].tx_credits,
+                      peer[i].min_credits, peer[i].queue);
+        if (n >= len - used)
+            goto overflow;
+    }
+    return 0;
+overflow:
+    if (lmt_conf_get_proto_debug ())
+        msg ("string overflow");
+    return -1;
+}
+
+static int
+_get_rtrstring (pctx_t ctx, char *s, int len, int version)
 {
     static uint64_t cpuusage = 0, cputot = 0;
     int retval = -1;
     struct utsname uts;
     double mempct, cpupct;
     uint64_t newbytes;
+    lnetstat_t stats;
     int n, ena;
 
     if (proc_lustre_lnet_routing_enabled (ctx, &ena) < 0)
@@ -98,24 +161,50 @@ lmt_router_string_v1 (pctx_t ctx, char *s, int len)
     if (_get_mem_usage (ctx, &mempct) < 0) {
         goto done;
     }
-    if (proc_lustre_lnet_newbytes (ctx, &newbytes) < 0) {
-        if (lmt_conf_get_proto_debug ())
-            err ("error reading lustre lnet newbytes from proc");
-        goto done;
+    if (version == 1) {
+        if (proc_lustre_lnet_newbytes (ctx, &newbytes) < 0) {
+            if (lmt_conf_get_proto_debug ())
+                err ("error reading lustre lnet newbytes from proc");
+            goto done;
+        }
+        /* N.B. Use 1.0 not 1 for version for backwards compat - issue 34 */
+        n = snprintf (s, len, "1.0;%s;%f;%f;%"PRIu64,
+                      uts.nodename, cpupct, mempct, newbytes);
+    } else {
+        if (proc_lnet_stats (ctx, &stats) < 0) {
+            if (lmt_conf_get_proto_debug ())
+                err ("error reading lnet stats from proc");
+            goto done;
+        }
+        n = snprintf (s, len, "%d;%s;%f;%f;%"PRIu64";",
+                      version, uts.nodename, cpupct, mempct,
+                      stats.route_length);
     }
-    /* N.B. Use 1.0 not 1 for version for backwards compat - issue 34 */
-    n = snprintf (s, len, "1.0;%s;%f;%f;%"PRIu64,
-                  uts.nodename, cpupct, mempct, newbytes);
     if (n >= len) {
         if (lmt_conf_get_proto_debug ())
             msg ("string overflow");
         goto done;
     }
+    if (version >= 2 && _get_lnetstring (ctx, stats.drop_count, s + n,
+                                         len - n) < 0)
+        goto done;
     retval = 0;
 done:
     return retval;
 }
 
+int
+lmt_router_string_v1 (pctx_t ctx, char *s, int len)
+{
+    return _get_rtrstring (ctx, s, len, 1);
+}
+
+int
+lmt_router_string_v2 (pctx_t ctx, char *s, int len)
+{
+    return _get_rtrstring (ctx, s, len, 2);
+}
+
 int
 lmt_router_decode_v1 (const char *s, char **namep, float *pct_cpup,
                       float *pct_memp, uint64_t *bytesp)
@@ -142,6 +231,137 @@ done:
     return retval;
 }
 
+int
+lmt_router_decode_v2 (const char *s, char **namep, float *pct_cpup,
+                      float *pct_memp, uint64_t *bytesp, uint64_t *dropsp,
+                      List *niinfop, int *npeerp, int *nstarvedp,
+                      uint64_t *queuep, List *peerinfop)
+{
+    int retval = -1;
+    char *name = xmalloc (strlen (s) + 1);
+    char *cpy;
+    float pct_mem, pct_cpu;
+    uint64_t bytes, drops, queue;
+    List niinfo = list_create ((ListDelF)free);
+    List peerinfo = list_create ((ListDelF)free);
+    int i, nni, npeer, nstarved, nworst;
+
+    if (sscanf (s, "%*f;%[^;];%f;%f;%"PRIu64";%"PRIu64";%d;",
+                name, &pct_cpu, &pct_mem, &bytes, &drops, &nni) != 6
+                                    || !(s = strskip (s, 7, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_router_v2: parse error: router component");
+        goto done;
+    }
+    for (i = 0; i < nni; i++) {
+        if (!(cpy = strskipcpy (&s, 6, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_router_v2: parse error: ni");
+            goto done;
+        }
+        list_append (niinfo, cpy);
+    }
+    if (sscanf (s, "%d;%d;%"PRIu64";%d;", &npeer, &nstarved, &queue,
+                &nworst) != 4 || !(s = strskip (s, 4, ';'))) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_router_v2: parse error: peer summary");
+        goto done;
+    }
+    for (i = 0; i < nworst; i++) {
+        if (!(cpy = strskipcpy (&s, 5, ';'))) {
+            if (lmt_conf_get_proto_debug ())
+                msg ("lmt_router_v2: parse error: peer");
+            goto done;
+        }
+        list_append (peerinfo, cpy);
+    }
+    if (strlen (s) > 0) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_router_v2: parse error: string not exhausted");
+        goto done;
+    }
+    *namep = name;
+    *pct_cpup = pct_cpu;
+    *pct_memp = pct_mem;
+    *bytesp = bytes;
+    *dropsp = drops;
+    *npeerp = npeer;
+    *nstarvedp = nstarved;
+    *queuep = queue;
+    if (niinfop)
+        *niinfop = niinfo;
+    else
+        list_destroy (niinfo);
+    if (peerinfop)
+        *peerinfop = peerinfo;
+    else
+        list_destroy (peerinfo);
+    retval = 0;
+done:
+    if (retval < 0) {
+        free (name);
+        list_destroy (niinfo);
+        list_destroy (peerinfo);
+    }
+    return retval;
+}
+
+int
+lmt_router_decode_v2_niinfo (const char *s, char **nidp, int *upp,
+                             int *peer_creditsp, int *max_creditsp,
+                             int *tx_creditsp, int *min_creditsp)
+{
+    int retval = -1;
+    char *nid = xmalloc (strlen (s) + 1);
+    int up, peer_credits, max_credits, tx_credits, min_credits;
+
+    if (sscanf (s, "%[^;];%d;%d;%d;%d;%d", nid, &up, &peer_credits,
+                &max_credits, &tx_credits, &min_credits) != 6) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_router_v2: parse error: niinfo");
+        goto done;
+    }
+    *nidp = nid;
+    *upp = up;
+    *peer_creditsp = peer_credits;
+    *max_creditsp = max_credits;
+    *tx_creditsp = tx_credits;
+    *min_creditsp = min_credits;
+    retval = 0;
+done:
+    if (retval < 0)
+        free (nid);
+    return retval;
+}
+
+int
+lmt_router_decode_v2_peerinfo (const char *s, char **nidp,
+                               int *max_creditsp, int *tx_creditsp,
+                               int *min_creditsp, uint64_t *queuep)
+{
+    int retval = -1;
+    char *nid = xmalloc (strlen (s) + 1);
+    int max_credits, tx_credits, min_credits;
+    uint64_t queue;
+
+    if (sscanf (s, "%[^;];%d;%d;%d;%"PRIu64, nid, &max_credits,
+                &tx_credits, &min_credits, &queue) != 5) {
+        if (lmt_conf_get_proto_debug ())
+            msg ("lmt_router_v2: parse error: peerinfo");
+        goto done;
+    }
+    *nidp = nid;
+    *max_creditsp = max_credits;
+    *tx_creditsp = tx_credits;
+    *min_creditsp = min_credits;
+    *queuep = queue;
+    retval = 0;
+done:
+    if (retval < 0)
+        free (nid);
+    return retval;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -1,8 +1,23 @@
 int lmt_router_string_v1 (pctx_t ctx, char *s, int len);
+int lmt_router_string_v2 (pctx_t ctx, char *s, int len);
 
 int lmt_router_decode_v1 (const char *s, char **namep, float *pct_cpup,
                           float *pct_memp, uint64_t *bytesp);
 
+/* v2 is v1 with the lnet drop count, the lnet NIs, and a summary of the
+ * peer table with its most credit starved peers.
+ */
+int lmt_router_decode_v2 (const char *s, char **namep, float *pct_cpup,
+                          float *pct_memp, uint64_t *bytesp, uint64_t *dropsp,
+                          List *niinfop, int *npeerp, int *nstarvedp,
+                          uint64_t *queuep, List *peerinfop);
+int lmt_router_decode_v2_niinfo (const char *s, char **nidp, int *upp,
+                                 int *peer_creditsp, int *max_creditsp,
+                                 int *tx_creditsp, int *min_creditsp);
+int lmt_router_decode_v2_peerinfo (const char *s, char **nidp,
+                                   int *max_creditsp, int *tx_creditsp,
+                                   int *min_creditsp, uint64_t *queuep);
+
 
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
@@ -0,0 +1,144 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <errno.h>
+#include <assert.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "rtrgroup.h"
+#include "lmtconf.h"
+#include "util.h"
+
+#define RTRGROUP_HASH_SIZE  1024
+#define RTRGROUP_MAGIC      0x52746772
+
+/* Per router (key = router hostname).
+ */
+typedef struct {
+    char *name;
+    int group;                  /* router group id, 0 if none */
+    uint64_t bytes;             /* last forwarded byte count reported */
+} rtrstate_t;
+
+typedef struct {
+    uint64_t bytes;             /* growth of its routers' byte counts */
+    int nrouter;                /* routers seen in the group */
+} grpstate_t;
+
+struct lmt_rtrgroup_struct {
+    int magic;
+    hash_t routers;
+    int ngroup;
+    grpstate_t *groups;         /* indexed by group id, 0 = no group */
+};
+
+static void
+_destroy_rtrstate (rtrstate_t *rs)
+{
+    free (rs->name);
+    free (rs);
+}
+
+lmt_rtrgroup_t
+lmt_rtrgroup_create (void)
+{
+    lmt_rtrgroup_t g = xmalloc (sizeof (*g));
+
+    g->magic = RTRGROUP_MAGIC;
+    g->routers = hash_create (RTRGROUP_HASH_SIZE, (hash_key_f)hash_key_string,
+                              (hash_cmp_f)strcmp,
+                              (hash_del_f)_destroy_rtrstate);
+    g->ngroup = lmt_conf_get_router_group_count ();
+    g->groups = xmalloc ((g->ngroup + 1) * sizeof (grpstate_t));
+    memset (g->groups, 0, (g->ngroup + 1) * sizeof (grpstate_t));
+    return g;
+}
+
+void
+lmt_rtrgroup_destroy (lmt_rtrgroup_t g)
+{
+    assert (g->magic == RTRGROUP_MAGIC);
+    hash_destroy (g->routers);
+    free (g->groups);
+    g->magic = 0;
+    free (g);
+}
+
+int
+lmt_rtrgroup_update (lmt_rtrgroup_t g, const char *router, uint64_t bytes)
+{
+    rtrstate_t *rs;
+    int id;
+
+    assert (g->magic == RTRGROUP_MAGIC);
+    if (!(rs = hash_find (g->routers, router))) {
+        id = lmt_conf_get_router_group (router);
+        rs = xmalloc (sizeof (*rs));
+        rs->name = xstrdup (router);
+        rs->group = id <= g->ngroup ? id : 0;
+        rs->bytes = bytes;
+        if (!hash_insert (g->routers, rs->name, rs))
+            msg_exit ("out of memory");
+        g->groups[rs->group].nrouter++;
+        return rs->group;
+    }
+    /* a smaller count means the router restarted counting from zero */
+    if (bytes >= rs->bytes)
+        g->groups[rs->group].bytes += bytes - rs->bytes;
+    else
+        g->groups[rs->group].bytes += bytes;
+    rs->bytes = bytes;
+    return rs->group;
+}
+
+int
+lmt_rtrgroup_get (lmt_rtrgroup_t g, int id, uint64_t *bytesp, int *nrouterp)
+{
+    assert (g->magic == RTRGROUP_MAGIC);
+    if (id < 0 || id > g->ngroup) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (bytesp)
+        *bytesp = g->groups[id].bytes;
+    if (nrouterp)
+        *nrouterp = g->groups[id].nrouter;
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,25 @@
+/* Per router group forwarding totals, kept up to date as each router
+ * reports, so the cost of a report does not depend on how many routers
+ * there are.  Groups are those of lmt_router_groups in lmt.conf.
+ */
+typedef struct lmt_rtrgroup_struct *lmt_rtrgroup_t;
+
+lmt_rtrgroup_t lmt_rtrgroup_create (void);
+void lmt_rtrgroup_destroy (lmt_rtrgroup_t g);
+
+/* Feed the forwarded byte count of a router and return its group id
+ * (0 if it belongs to no group).  A group's byte count is the sum of
+ * the growth of its routers' counts since each was first fed, so it
+ * keeps increasing when a router restarts.
+ */
+int lmt_rtrgroup_update (lmt_rtrgroup_t g, const char *router,
+                         uint64_t bytes);
+
+/* Get the byte count of a group and the number of routers fed to it.
+ */
+int lmt_rtrgroup_get (lmt_rtrgroup_t g, int id, uint64_t *bytesp,
+                      int *nrouterp);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -47,9 +47,12 @@
 #include "ost.h"
 #include "mdt.h"
 #include "router.h"
+#include "event.h"
+#include "rtrgroup.h"
 #include "lmtmysql.h"
 #include "lmtconf.h"
 #include "lmt.h"
+#include "util.h"
 
 /* FIXME [schema 1.1]:
  *
@@ -142,12 +145,83 @@ _svc_to_db (char *name)
 }
 
 /**
- ** Handlers for incoming strings.
+ ** Event detection.
  **/
 
-/* Helper for lmt_db_insert_ost_v2 () */
+static lmt_evtrack_t evtrack = NULL;
+
 static void
-_insert_ostinfo (char *ossname, float pct_cpu, float pct_mem, char *s)
+_insert_event (lmt_event_t e, const char *target, const char *server,
+               const char *comment, void *arg)
+{
+    lmt_db_t db;
+    char *ost = NULL, *oss = NULL, *mdt = NULL, *mds = NULL;
+
+    if (!(db = _svc_to_db ((char *)target)))
+        return;
+    if (lmt_conf_get_db_debug ())
+        msg ("%s: %s %s %s", target, lmt_event_name (e), server, comment);
+    if (e == LMT_EVENT_OSC_STATE) {
+        ost = (char *)target;
+        mds = (char *)server;
+    } else if (strstr (target, "-OST")) {
+        ost = (char *)target;
+        oss = (char *)server;
+    } else
+        mdt = (char *)target;
+    if (lmt_db_insert_event_data (db, lmt_event_name (e), oss, ost, mds, mdt,
+                                  (char *)comment) < 0)
+        _trigger_db_reconnect ();
+}
+
+static void
+_track_target (char *target, char *server, char *recov_status)
+{
+    if (!evtrack)
+        evtrack = lmt_evtrack_create ();
+    lmt_evtrack_target (evtrack, target, server,
+                        recov_status ? recov_status : "", _insert_event, NULL);
+}
+
+/**
+ ** Handlers for incoming strings.
+ **/
+
+/* helper for _insert_ostinfo () */
+static int
+_insert_ost_ops (lmt_db_t db, char *ostname, List ops)
+{
+    ListIterator itr;
+    int nops = list_count (ops);
+    char **opnames = xmalloc (nops * sizeof (char *));
+    uint64_t *samples = xmalloc (nops * sizeof (uint64_t));
+    char *op;
+    int i, n = 0, retval = -1;
+
+    itr = list_iterator_create (ops);
+    while ((op = list_next (itr))) {
+        if (lmt_ost_decode_v3_ostops (op, &opnames[n], &samples[n]) < 0)
+            continue;
+        n++;
+    }
+    list_iterator_destroy (itr);
+    if (lmt_db_insert_ost_ops_data (db, ostname, n, opnames, samples) < 0)
+        goto done;
+    retval = 0;
+done:
+    for (i = 0; i < n; i++)
+        free (opnames[i]);
+    free (opnames);
+    free (samples);
+    return retval;
+}
+
+/* Helper for lmt_db_insert_ost_v2_v3 ().
+ * Return the database the OST belongs to, or NULL.
+ */
+static lmt_db_t
+_insert_ostinfo (char *ossname, float pct_cpu, float pct_mem, char *s,
+                 int ver)
 {
     lmt_db_t db;
     char *ostname = NULL;
@@ -158,15 +232,26 @@ _insert_ostinfo (char *ossname, float pct_cpu, float pct_mem, char *s)
     uint64_t lock_count, grant_rate, cancel_rate;
     uint64_t connect, reconnect;
     char *recov_status = NULL;
+    List ops = NULL;
+    lmt_db_t retval = NULL;
+    int rc;
 
-    if (lmt_ost_decode_v2_ostinfo (s, &ostname, &read_bytes, &write_bytes,
+    if (ver >= 3)
+        rc = lmt_ost_decode_v3_ostinfo (s, &ostname, &read_bytes, &write_bytes,
                                    &kbytes_free, &kbytes_total,
                                    &inodes_free, &inodes_total, &iops,
                                    &num_exports, &lock_count, &grant_rate,
                                    &cancel_rate, &connect, &reconnect,
-                                   &recov_status) < 0) {
+                                   &recov_status, &ops);
+    else
+        rc = lmt_ost_decode_v2_ostinfo (s, &ostname, &read_bytes, &write_bytes,
+                                   &kbytes_free, &kbytes_total,
+                                   &inodes_free, &inodes_total, &iops,
+                                   &num_exports, &lock_count, &grant_rate,
+                                   &cancel_rate, &connect, &reconnect,
+                                   &recov_status);
+    if (rc < 0)
         goto done;
-    }
     if (!(db = _svc_to_db (ostname)))
         goto done;
     if (lmt_db_insert_ost_data (db, ossname, ostname, read_bytes, write_bytes,
@@ -175,39 +260,119 @@ _insert_ostinfo (char *ossname, float pct_cpu, float pct_mem, char *s)
         _trigger_db_reconnect ();
         goto done;
     }
+    if (ops && _insert_ost_ops (db, ostname, ops) < 0) {
+        _trigger_db_reconnect ();
+        goto done;
+    }
     if (lmt_db_insert_oss_data (db, 0, ossname, pct_cpu, pct_mem) < 0) {
         _trigger_db_reconnect ();
         goto done;
     }
+    _track_target (ostname, ossname, recov_status);
+    retval = db;
 done:
     if (ostname)
         free (ostname);
     if (recov_status)
         free (recov_status);
+    if (ops)
+        list_destroy (ops);
+    return retval;
 }
 
-/* lmt_ost_v2: oss + multiple ost's */
-void
-lmt_db_insert_ost_v2 (char *s)
+/* Helper for lmt_db_insert_ost_v2_v3 () */
+static void
+_insert_ifinfo (lmt_db_t db, char *ossname, char *s)
+{
+    char *ifname = NULL;
+    uint64_t rx_bytes, tx_bytes, errors, rate;
+    int link;
+
+    if (lmt_ost_decode_v3_ifinfo (s, &ifname, &rx_bytes, &tx_bytes, &errors,
+                                  &link, &rate) < 0)
+        goto done;
+    if (lmt_db_insert_oss_interface_data (db, ossname, ifname, rx_bytes,
+                                          tx_bytes, errors, link, rate) < 0) {
+        _trigger_db_reconnect ();
+        goto done;
+    }
+done:
+    if (ifname)
+        free (ifname);
+}
+
+static int
+_match_db (lmt_db_t db, lmt_db_t key)
+{
+    return (db == key);
+}
+
+/* lmt_ost_v2 and lmt_ost_v3: oss + multiple ost's
+ * v3 adds per-ost op counts and oss network interfaces.  Interfaces are
+ * stored in each database that one of the oss's ost's belongs to.  The
+ * v3 service, ZFS, disk and host resource stats are not stored.
+ */
+static void
+lmt_db_insert_ost_v2_v3 (char *s, int ver)
 {
     ListIterator itr = NULL;
     char *ostr, *ossname = NULL;
     float pct_cpu, pct_mem;
     List ostinfo = NULL;
+    List ifinfo = NULL;
+    List ossdbs = NULL;
+    lmt_db_t db;
+    int rc;
 
     if (_init_db_ifneeded () < 0)
         goto done;
-    if (lmt_ost_decode_v2 (s, &ossname, &pct_cpu, &pct_mem, &ostinfo) < 0)
+    if (ver == 3)
+        rc = lmt_ost_decode_v3 (s, &ossname, &pct_cpu, &pct_mem, &ifinfo,
+                                NULL, NULL, NULL, NULL, NULL, &ostinfo);
+    else
+        rc = lmt_ost_decode_v2 (s, &ossname, &pct_cpu, &pct_mem, &ostinfo);
+    if (rc < 0)
         goto done;
+    ossdbs = list_create (NULL);
     itr = list_iterator_create (ostinfo);
-    while ((ostr = list_next (itr)))
-        _insert_ostinfo (ossname, pct_cpu, pct_mem, ostr);
+    while ((ostr = list_next (itr))) {
+        db = _insert_ostinfo (ossname, pct_cpu, pct_mem, ostr, ver);
+        if (db && !list_find_first (ossdbs, (ListFindF)_match_db, db))
+            list_append (ossdbs, db);
+    }
     list_iterator_destroy (itr);
+    if (ifinfo && list_count (ifinfo) > 0) {
+        itr = list_iterator_create (ossdbs);
+        while ((db = list_next (itr))) {
+            ListIterator iitr = list_iterator_create (ifinfo);
+
+            while ((ostr = list_next (iitr)))
+                _insert_ifinfo (db, ossname, ostr);
+            list_iterator_destroy (iitr);
+        }
+        list_iterator_destroy (itr);
+    }
 done:
     if (ossname)
         free (ossname);
     if (ostinfo)
         list_destroy (ostinfo);
+    if (ifinfo)
+        list_destroy (ifinfo);
+    if (ossdbs)
+        list_destroy (ossdbs);
+}
+
+void
+lmt_db_insert_ost_v3 (char *s)
+{
+    lmt_db_insert_ost_v2_v3 (s, 3);
+}
+
+void
+lmt_db_insert_ost_v2 (char *s)
+{
+    lmt_db_insert_ost_v2_v3 (s, 2);
 }
 
 /* helper for _insert_mds () */
@@ -229,7 +394,7 @@ done:
         free (opname);
 }
 
-/* helper for lmt_db_insert_mdt_v1_v2_v3 () */
+/* helper for lmt_db_insert_mdt_v1_v2_v3_v4 () */
 static void
 _insert_mds (char *mdsname, float pct_cpu, float pct_mem, char *s, int ver)
 {
@@ -249,7 +414,7 @@ _insert_mds (char *mdsname, float pct_cpu, float pct_mem, char *s, int ver)
         rc = lmt_mdt_decode_v2_mdtinfo (s, &mdtname, &inodes_free,
                     &inodes_total, &kbytes_free, &kbytes_total, &recov_status,
                     &mdops);
-    else if (ver==3)
+    else if (ver==3 || ver==4)
         rc = lmt_mdt_decode_v3_mdtinfo (s, &mdtname, &inodes_free,
                     &inodes_total, &kbytes_free, &kbytes_total, &recov_status,
                     &mdops);
@@ -271,6 +436,8 @@ _insert_mds (char *mdsname, float pct_cpu, float pct_mem, char *s, int ver)
     while ((op = list_next (itr)))
         _insert_mds_ops (db, mdtname, op);
     list_iterator_destroy (itr);
+    if (ver >= 2)
+        _track_target (mdtname, mdsname, recov_status);
 done:
     if (recov_status)
         free (recov_status);
@@ -280,18 +447,25 @@ done:
         list_destroy (mdops);
 }
 
-/* lmt_mdt_v1 and lmt_mdt_v2 and lmt_mdt_v3 helper */
+/* lmt_mdt_v1 through lmt_mdt_v4 helper */
 void
-lmt_db_insert_mdt_v1_v2_v3 (char *s, int ver)
+lmt_db_insert_mdt_v1_v2_v3_v4 (char *s, int ver)
 {
     ListIterator itr;
     char *mdt, *mdsname = NULL;
     float pct_cpu, pct_mem;
     List mdtinfo = NULL;
+    int rc;
 
     if (_init_db_ifneeded () < 0)
         goto done;
-    if (lmt_mdt_decode_v1_v2_v3 (s, &mdsname, &pct_cpu, &pct_mem, &mdtinfo, ver) < 0)
+    if (ver == 4)
+        rc = lmt_mdt_decode_v4 (s, &mdsname, &pct_cpu, &pct_mem, NULL, NULL,
+                                &mdtinfo);
+    else
+        rc = lmt_mdt_decode_v1_v2_v3 (s, &mdsname, &pct_cpu, &pct_mem,
+                                      &mdtinfo, ver);
+    if (rc < 0)
         goto done;
     itr = list_iterator_create (mdtinfo);
     while ((mdt = list_next (itr)))
@@ -308,14 +482,14 @@ done:
 void
 lmt_db_insert_mdt_v1 (char *s)
 {
-    lmt_db_insert_mdt_v1_v2_v3 (s, 1);
+    lmt_db_insert_mdt_v1_v2_v3_v4 (s, 1);
 }
 
 /* lmt_mdt_v2: mds + multipe mdt's w/ recovery info */
 void
 lmt_db_insert_mdt_v2 (char *s)
 {
-    lmt_db_insert_mdt_v1_v2_v3 (s, 2);
+    lmt_db_insert_mdt_v1_v2_v3_v4 (s, 2);
 }
 
 /*  lmt_mdt_v3: mds + multipe mdt's w/ recovery info
@@ -324,29 +498,74 @@ lmt_db_insert_mdt_v2 (char *s)
 void
 lmt_db_insert_mdt_v3 (char *s)
 {
-    lmt_db_insert_mdt_v1_v2_v3 (s, 3);
+    lmt_db_insert_mdt_v1_v2_v3_v4 (s, 3);
 }
 
-/* lmt_router_v1: router */
+/* lmt_mdt_v4: lmt_mdt_v3 + mds service stats and host resources,
+ * which are not stored
+ */
 void
-lmt_db_insert_router_v1 (char *s)
+lmt_db_insert_mdt_v4 (char *s)
+{
+    lmt_db_insert_mdt_v1_v2_v3_v4 (s, 4);
+}
+
+/* lmt_osc_v1: mds + per-ost osc state.  Only state transitions are stored.
+ */
+void
+lmt_db_insert_osc_v1 (char *s)
+{
+    if (_init_db_ifneeded () < 0)
+        return;
+    if (!evtrack)
+        evtrack = lmt_evtrack_create ();
+    lmt_evtrack_osc_v1 (evtrack, s, _insert_event, NULL);
+}
+
+/* Router group totals, updated by each router report.
+ */
+static lmt_rtrgroup_t rtrgroup = NULL;
+
+/* lmt_router_v1 and lmt_router_v2: router
+ * The v2 lnet NI and peer credits are not stored.
+ */
+static void
+lmt_db_insert_router_v1_v2 (char *s, int ver)
 {
     ListIterator itr;
     lmt_db_t db;
     char *rtrname = NULL;
     float pct_cpu, pct_mem;
-    uint64_t bytes;
+    uint64_t bytes, drops, queue, group_bytes;
+    int npeer, nstarved, group, nrouters;
+    int rc;
 
     if (_init_db_ifneeded () < 0)
         goto done;
-    if (lmt_router_decode_v1 (s, &rtrname, &pct_cpu, &pct_mem, &bytes) < 0)
+    if (ver == 2)
+        rc = lmt_router_decode_v2 (s, &rtrname, &pct_cpu, &pct_mem, &bytes,
+                                   &drops, NULL, &npeer, &nstarved, &queue,
+                                   NULL);
+    else
+        rc = lmt_router_decode_v1 (s, &rtrname, &pct_cpu, &pct_mem, &bytes);
+    if (rc < 0)
         goto done;
+    if (!rtrgroup)
+        rtrgroup = lmt_rtrgroup_create ();
+    group = lmt_rtrgroup_update (rtrgroup, rtrname, bytes);
+    if (group > 0)
+        (void)lmt_rtrgroup_get (rtrgroup, group, &group_bytes, &nrouters);
     itr = list_iterator_create (dbs);
     while ((db = list_next (itr))) {
         if (lmt_db_insert_router_data (db, rtrname, bytes, pct_cpu) < 0) {
             _trigger_db_reconnect ();
             break;
         }
+        if (group > 0 && lmt_db_insert_router_group_data (db, group,
+                                           group_bytes, nrouters) < 0) {
+            _trigger_db_reconnect ();
+            break;
+        }
     }
     list_iterator_destroy (itr);
 done:
@@ -354,6 +573,18 @@ done:
         free (rtrname);
 }
 
+void
+lmt_db_insert_router_v2 (char *s)
+{
+    lmt_db_insert_router_v1_v2 (s, 2);
+}
+
+void
+lmt_db_insert_router_v1 (char *s)
+{
+    lmt_db_insert_router_v1_v2 (s, 1);
+}
+
 /**
  ** Legacy
  **/
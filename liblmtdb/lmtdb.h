@@ -1,7 +1,11 @@
-void lmt_db_insert_ost_v2 (char *s);
-void lmt_db_insert_mdt_v3 (char *s);
-void lmt_db_insert_router_v1 (char *s);
+void lmt_db_insert_ost_v3 (char *s);
+void lmt_db_insert_mdt_v4 (char *s);
+void lmt_db_insert_router_v2 (char *s);
+void lmt_db_insert_osc_v1 (char *s);
+void lmt_db_insert_router_v1 (char *s); // legacy
+void lmt_db_insert_ost_v2 (char *s); // legacy
 void lmt_db_insert_mdt_v1 (char *s); // legacy
+void lmt_db_insert_mdt_v3 (char *s); // legacy
 void lmt_db_insert_mdt_v2 (char *s); // legacy
 void lmt_db_insert_mds_v2 (char *s); // legacy
 void lmt_db_insert_oss_v1 (char *s); // legacy
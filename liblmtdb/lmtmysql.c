@@ -55,6 +55,8 @@
 /* track if unknown opnames have been encountered */
 static int seen_unknown_opnames = 0;
 
+static int _prepare_stmt (lmt_db_t db, MYSQL_STMT **sp, const char *sql);
+
 typedef struct {
     char *key;
     uint64_t id;
@@ -71,8 +73,29 @@ struct lmt_db_struct {
     MYSQL_STMT *ins_mds_data;
     MYSQL_STMT *ins_mds_ops_data;
     MYSQL_STMT *ins_oss_data;
+    MYSQL_STMT *ins_oss_interface_data;
     MYSQL_STMT *ins_ost_data;
     MYSQL_STMT *ins_router_data;
+    MYSQL_STMT *ins_event_data;
+
+    /* multi-row OST_OPS_DATA insert, prepared on first use for
+     * ins_ost_ops_rows rows */
+    MYSQL_STMT *ins_ost_ops_data;
+    int ins_ost_ops_rows;
+
+    /* ROUTER_GROUP_DATA insert, prepared on first use since databases
+     * created before router groups lack the table.  If the prepare fails,
+     * inserts are skipped for the life of the handle, i.e. until the
+     * next reconnect. */
+    MYSQL_STMT *ins_router_group_data;
+    int router_group_data_failed;
+
+    /* prepared statements for historical queries, prepared on first use */
+    MYSQL_STMT *sel_ost_data_range;
+    MYSQL_STMT *sel_mds_data_range;
+    MYSQL_STMT *sel_mds_ops_data_range;
+    MYSQL_STMT *sel_ost_hour_range;
+    MYSQL_STMT *sel_mds_hour_range;
 
     /* cached most recent TIMESTAMP_INFO insertion */
     uint64_t timestamp;
@@ -100,15 +123,104 @@ const char *sql_ins_oss_data =
     "insert into OSS_DATA "
     "(OSS_ID, TS_ID, PCT_CPU, PCT_MEMORY) "
     "values (?, ?, ?, ?)";
+const char *sql_ins_oss_interface_data =
+    "insert into OSS_INTERFACE_DATA "
+    "(OSS_INTERFACE_ID, TS_ID, READ_BYTES, WRITE_BYTES, ERROR_COUNT, "
+    "LINK_STATUS, ACTUAL_RATE) "
+    "values (?, ?, ?, ?, ?, ?, ?)";
 const char *sql_ins_ost_data =
     "insert into OST_DATA "
     "(OST_ID, TS_ID, READ_BYTES, WRITE_BYTES, KBYTES_FREE, KBYTES_USED, "
     "INODES_FREE, INODES_USED) "
     "values ( ?, ?, ?, ?, ?, ?, ?, ?)";
+const char *sql_ins_ost_ops_data =
+    "insert into OST_OPS_DATA "
+    "(OST_ID, TS_ID, OPERATION_ID, SAMPLES) "
+    "values ";
+const char *sql_ins_ost_ops_data_row = "(?, ?, ?, ?)";
+const char *sql_ins_router_group_data =
+    "insert into ROUTER_GROUP_DATA "
+    "(ROUTER_GROUP_ID, TS_ID, BYTES, NUM_ROUTERS) "
+    "values ( ?, ?, ?, ?) "
+    "on duplicate key update BYTES = values(BYTES), "
+    "NUM_ROUTERS = values(NUM_ROUTERS)";
 const char *sql_ins_router_data =
     "insert into ROUTER_DATA "
     "(ROUTER_ID, TS_ID, BYTES, PCT_CPU) "
     "values (?, ?, ?, ?)";
+const char *sql_ins_event_data =
+    "insert into EVENT_DATA "
+    "(EVENT_ID, TS_ID, OSS_ID, OST_ID, MDS_ID, COMMENT) "
+    "values (?, ?, ?, ?, ?, ?)";
+
+/* sql for prepared historical queries */
+const char *sql_sel_ost_data_range =
+    "select UNIX_TIMESTAMP(t.TIMESTAMP), d.OST_ID, "
+    "COALESCE(d.READ_BYTES,0), COALESCE(d.WRITE_BYTES,0), "
+    "COALESCE(d.KBYTES_FREE,0), COALESCE(d.KBYTES_USED,0), "
+    "COALESCE(d.INODES_FREE,0), COALESCE(d.INODES_USED,0) "
+    "from OST_DATA d join TIMESTAMP_INFO t on d.TS_ID = t.TS_ID "
+    "where t.TIMESTAMP >= FROM_UNIXTIME(?) and t.TIMESTAMP < FROM_UNIXTIME(?) "
+    "order by d.TS_ID";
+const char *sql_sel_mds_data_range =
+    "select UNIX_TIMESTAMP(t.TIMESTAMP), d.MDS_ID, COALESCE(d.PCT_CPU,0), "
+    "COALESCE(d.KBYTES_FREE,0), COALESCE(d.KBYTES_USED,0), "
+    "COALESCE(d.INODES_FREE,0), COALESCE(d.INODES_USED,0) "
+    "from MDS_DATA d join TIMESTAMP_INFO t on d.TS_ID = t.TS_ID "
+    "where t.TIMESTAMP >= FROM_UNIXTIME(?) and t.TIMESTAMP < FROM_UNIXTIME(?) "
+    "order by d.TS_ID";
+const char *sql_sel_mds_ops_data_range =
+    "select UNIX_TIMESTAMP(t.TIMESTAMP), d.MDS_ID, d.OPERATION_ID, "
+    "COALESCE(d.SAMPLES,0), COALESCE(d.SUM,0), COALESCE(d.SUMSQUARES,0) "
+    "from MDS_OPS_DATA d join TIMESTAMP_INFO t on d.TS_ID = t.TS_ID "
+    "where t.TIMESTAMP >= FROM_UNIXTIME(?) and t.TIMESTAMP < FROM_UNIXTIME(?) "
+    "order by d.TS_ID";
+
+const char *sql_sel_ost_hour_range =
+    "select UNIX_TIMESTAMP(t.TIMESTAMP), a.OST_ID, "
+    "CAST(SUM(IF(v.VARIABLE_NAME='READ_BYTES',a.AGGREGATE,0)) AS UNSIGNED), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='WRITE_BYTES',a.AGGREGATE,0)) AS UNSIGNED), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='KBYTES_FREE',a.AVERAGE,0)) AS UNSIGNED), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='KBYTES_USED',a.AVERAGE,0)) AS UNSIGNED), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='INODES_FREE',a.AVERAGE,0)) AS UNSIGNED), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='INODES_USED',a.AVERAGE,0)) AS UNSIGNED) "
+    "from OST_AGGREGATE_HOUR a "
+    "join TIMESTAMP_INFO t on a.TS_ID = t.TS_ID "
+    "join OST_VARIABLE_INFO v on a.VARIABLE_ID = v.VARIABLE_ID "
+    "where t.TIMESTAMP >= FROM_UNIXTIME(?) and t.TIMESTAMP < FROM_UNIXTIME(?) "
+    "group by a.TS_ID, a.OST_ID order by a.TS_ID";
+const char *sql_sel_mds_hour_range =
+    "select UNIX_TIMESTAMP(t.TIMESTAMP), a.MDS_ID, "
+    "SUM(IF(v.VARIABLE_NAME='PCT_CPU',a.AVERAGE,0)), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='KBYTES_FREE',a.AVERAGE,0)) AS UNSIGNED), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='KBYTES_USED',a.AVERAGE,0)) AS UNSIGNED), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='INODES_FREE',a.AVERAGE,0)) AS UNSIGNED), "
+    "CAST(SUM(IF(v.VARIABLE_NAME='INODES_USED',a.AVERAGE,0)) AS UNSIGNED) "
+    "from MDS_AGGREGATE_HOUR a "
+    "join TIMESTAMP_INFO t on a.TS_ID = t.TS_ID "
+    "join MDS_VARIABLE_INFO v on a.VARIABLE_ID = v.VARIABLE_ID "
+    "where t.TIMESTAMP >= FROM_UNIXTIME(?) and t.TIMESTAMP < FROM_UNIXTIME(?) "
+    "group by a.TS_ID, a.MDS_ID order by a.TS_ID";
+
+/* sql for event history (not prepared: queried once per time range) */
+const char *sql_sel_event_range_tmpl =
+    "select UNIX_TIMESTAMP(t.TIMESTAMP), i.EVENT_NAME, "
+    "COALESCE(ost.OST_NAME, mds.MDS_NAME, ''), "
+    "COALESCE(oss.HOSTNAME, mds.HOSTNAME, ''), COALESCE(e.COMMENT, '') "
+    "from EVENT_DATA e join TIMESTAMP_INFO t on e.TS_ID = t.TS_ID "
+    "join EVENT_INFO i on e.EVENT_ID = i.EVENT_ID "
+    "left join OST_INFO ost on e.OST_ID = ost.OST_ID "
+    "left join OSS_INFO oss on e.OSS_ID = oss.OSS_ID "
+    "left join MDS_INFO mds on e.MDS_ID = mds.MDS_ID "
+    "where t.TIMESTAMP >= FROM_UNIXTIME(%lu) "
+    "and t.TIMESTAMP < FROM_UNIXTIME(%lu) "
+    "order by e.TS_ID";
+
+/* sql for mapping targets to servers */
+const char *sql_sel_ost_host =
+    "select OST_NAME, HOSTNAME from OST_INFO";
+const char *sql_sel_mdt_host =
+    "select MDS_NAME, HOSTNAME from MDS_INFO";
 
 /* sql for populating the idcache in bulk */
 const char *sql_sel_mds_info =
@@ -119,10 +231,16 @@ const char *sql_sel_oss_info =
     "select HOSTNAME, OSS_ID from OSS_INFO";
 const char *sql_sel_ost_info =
     "select OST_NAME, OST_ID from OST_INFO";
+const char *sql_sel_oss_interface_info =
+    "select concat(o.HOSTNAME, ':', i.OSS_INTERFACE_NAME), "
+    "i.OSS_INTERFACE_ID from OSS_INTERFACE_INFO i "
+    "join OSS_INFO o on i.OSS_ID = o.OSS_ID";
 const char *sql_sel_router_info =
     "select HOSTNAME, ROUTER_ID from ROUTER_INFO";
 const char *sql_sel_operation_info =
     "select OPERATION_NAME, OPERATION_ID from OPERATION_INFO";
+const char *sql_sel_event_info =
+    "select EVENT_NAME, EVENT_ID from EVENT_INFO";
 
 /* sql for database autoconfig */
 const char *sql_ins_mds_info_tmpl =
@@ -137,10 +255,18 @@ const char *sql_ins_ost_info_tmpl =
     "insert into OST_INFO "
     "(OSS_ID, OST_NAME, HOSTNAME, DEVICE_NAME, OFFLINE) "
     "values (%"PRIu64",'%s', '%s', '', '0')";
+const char *sql_ins_oss_interface_info_tmpl =
+    "insert into OSS_INTERFACE_INFO "
+    "(OSS_ID, OSS_INTERFACE_NAME, EXPECTED_RATE) "
+    "values (%"PRIu64", '%s', %"PRIu64")";
 const char *sql_ins_router_info_tmpl =
     "insert into ROUTER_INFO "
     "(ROUTER_NAME, HOSTNAME, ROUTER_GROUP_ID) "
-    "values ('%s', '%s', 0)";
+    "values ('%s', '%s', %d)";
+const char *sql_ins_event_info_tmpl =
+    "insert into EVENT_INFO "
+    "(EVENT_NAME) "
+    "values ('%s')";
 
 /* sql for populating the idcache with individual values */
 const char *sql_sel_mds_info_tmpl =
@@ -151,8 +277,15 @@ const char *sql_sel_oss_info_tmpl =
     "select HOSTNAME, OSS_ID from OSS_INFO where HOSTNAME = '%s'";
 const char *sql_sel_ost_info_tmpl =
     "select OST_NAME, OST_ID from OST_INFO where OST_NAME = '%s'";
+const char *sql_sel_oss_interface_info_tmpl =
+    "select concat(o.HOSTNAME, ':', i.OSS_INTERFACE_NAME), "
+    "i.OSS_INTERFACE_ID from OSS_INTERFACE_INFO i "
+    "join OSS_INFO o on i.OSS_ID = o.OSS_ID "
+    "where concat(o.HOSTNAME, ':', i.OSS_INTERFACE_NAME) = '%s'";
 const char *sql_sel_router_info_tmpl =
     "select HOSTNAME, ROUTER_ID from ROUTER_INFO where HOSTNAME = '%s'";
+const char *sql_sel_event_info_tmpl =
+    "select EVENT_NAME, EVENT_ID from EVENT_INFO where EVENT_NAME = '%s'";
 
 /* sql for lmtinit */
 const char *sql_drop_fs =
@@ -310,12 +443,18 @@ _populate_idhash (lmt_db_t db)
     /* OST_INFO:    OST_NAME -> OST_ID */
     if (_populate_idhash_all (db, "ost", sql_sel_ost_info) < 0)
         goto done;
+    /* OSS_INTERFACE_INFO: HOSTNAME:OSS_INTERFACE_NAME -> OSS_INTERFACE_ID */
+    if (_populate_idhash_all (db, "ossif", sql_sel_oss_interface_info) < 0)
+        goto done;
     /* ROUTER_INFO: HOSTNAME -> ROUTER_ID */
     if (_populate_idhash_all (db, "router", sql_sel_router_info) < 0)
         goto done;
     /* OPERATION_INFO: OPERATION_NAME -> OPERATION_ID */
     if (_populate_idhash_all (db, "op", sql_sel_operation_info) < 0)
         goto done;
+    /* EVENT_INFO: EVENT_NAME -> EVENT_ID */
+    if (_populate_idhash_all (db, "event", sql_sel_event_info) < 0)
+        goto done;
     retval = 0;
 done:
     return retval;
@@ -385,6 +524,87 @@ lmt_db_server_map (lmt_db_t db, char *svctype, lmt_db_map_f mf, void *arg)
     return (m.error ? -1 : 0);
 }
 
+/* private arg structure for _revmapfun () */
+struct revmap_struct {
+    char *svctype;
+    uint64_t id;
+    char *name;
+};
+
+static int
+_revmapfun (void *data, const void *key, void *arg)
+{
+    struct revmap_struct *rp = (struct revmap_struct *)arg;
+    svcid_t *s = (svcid_t *)data;
+    char *p = strchr (s->key, '_');
+
+    if (!rp->name && s->id == rp->id && p
+                  && strlen (rp->svctype) == p - s->key
+                  && !strncmp (s->key, rp->svctype, p - s->key))
+        rp->name = p + 1;
+    return 0;
+}
+
+int
+lmt_db_lookup_id (lmt_db_t db, char *svctype, char *name, uint64_t *idp)
+{
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+
+    return _lookup_idhash (db, svctype, name, idp);
+}
+
+/* N.B. This is a linear scan of the idhash.  Callers decoding many rows
+ * should cache the result.
+ */
+char *
+lmt_db_lookup_name (lmt_db_t db, char *svctype, uint64_t id)
+{
+    struct revmap_struct r;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+
+    r.svctype = svctype;
+    r.id = id;
+    r.name = NULL;
+    hash_for_each (db->idhash, (hash_arg_f)_revmapfun, &r);
+    return r.name;
+}
+
+int
+lmt_db_host_map (lmt_db_t db, char *svctype, lmt_db_host_map_f mf, void *arg)
+{
+    const char *sql = !strcmp (svctype, "ost") ? sql_sel_ost_host
+                                                : sql_sel_mdt_host;
+    MYSQL_RES *res = NULL;
+    MYSQL_ROW row;
+    int retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+
+    if (mysql_query (db->conn, sql)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error querying %s %s hosts: %s", lmt_db_fsname (db),
+                 svctype, mysql_error (db->conn));
+        goto done;
+    }
+    if (!(res = mysql_use_result (db->conn)))
+        goto done;
+    while ((row = mysql_fetch_row (res))) {
+        if (row[0] && row[1] && mf (row[0], row[1], arg) < 0) {
+            while (mysql_fetch_row (res))
+                ; /* drain unbuffered result */
+            goto done;
+        }
+    }
+    if (mysql_errno (db->conn))
+        goto done;
+    retval = 0;
+done:
+    if (res)
+        mysql_free_result (res);
+    return retval;
+}
+
 /**
  ** Database *_INFO insert functions
  ** Used to implement semi-automatic MySQL configuration, new for lmt3.
@@ -494,15 +714,54 @@ done:
     return retval;
 }
 
+static int
+_insert_oss_interface_info (lmt_db_t db, char *ossname, char *ifname,
+                            uint64_t rate, uint64_t *idp)
+{
+    int retval = -1;
+    uint64_t id, oss_id;
+    int len = strlen (sql_ins_oss_interface_info_tmpl)
+            + strlen (ifname) + 16 + 16 + 1;
+    char *qry = xmalloc (len);
+    char *key = xmalloc (strlen (ossname) + strlen (ifname) + 2);
+
+    if (_lookup_idhash (db, "oss", ossname, &oss_id) < 0) {
+        if (_insert_oss_info (db, ossname, &oss_id) < 0)
+            goto done;
+    }
+    snprintf (qry, len, sql_ins_oss_interface_info_tmpl, oss_id, ifname, rate);
+    if (mysql_query (db->conn, qry)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error inserting %s OSS_INTERFACE_INFO %s: %s",
+                 lmt_db_fsname (db), ifname, mysql_error (db->conn));
+        goto done;
+    }
+    sprintf (key, "%s:%s", ossname, ifname);
+    if (_populate_idhash_one (db, "ossif", sql_sel_oss_interface_info_tmpl,
+                              key, &id) < 0) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error querying %s of %s from OSS_INTERFACE_INFO after "
+                 "insert: %s", lmt_db_fsname (db), key, mysql_error (db->conn));
+        goto done;
+    }
+    *idp = id;
+    retval = 0;
+done:
+    free (key);
+    free (qry);
+    return retval;
+}
+
 static int
 _insert_router_info (lmt_db_t db, char *rtrname, uint64_t *idp)
 {
     int retval = -1;
     uint64_t id;
-    int len = strlen (sql_ins_router_info_tmpl) + strlen (rtrname)*2 + 1;
+    int len = strlen (sql_ins_router_info_tmpl) + strlen (rtrname)*2 + 16;
     char *qry = xmalloc (len);
 
-    snprintf (qry, len, sql_ins_router_info_tmpl, rtrname, rtrname);
+    snprintf (qry, len, sql_ins_router_info_tmpl, rtrname, rtrname,
+              lmt_conf_get_router_group (rtrname));
     if (mysql_query (db->conn, qry)) {
         if (lmt_conf_get_db_debug ())
             msg ("error inserting %s ROUTER_INFO %s: %s",
@@ -523,6 +782,38 @@ done:
     return retval;
 }
 
+/* Databases created before events were recorded have an empty EVENT_INFO,
+ * so event names are added on first use.
+ */
+static int
+_insert_event_info (lmt_db_t db, const char *event, uint64_t *idp)
+{
+    int retval = -1;
+    uint64_t id;
+    int len = strlen (sql_ins_event_info_tmpl) + strlen (event) + 1;
+    char *qry = xmalloc (len);
+
+    snprintf (qry, len, sql_ins_event_info_tmpl, event);
+    if (mysql_query (db->conn, qry)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error inserting %s EVENT_INFO %s: %s",
+                 lmt_db_fsname (db), event, mysql_error (db->conn));
+        goto done;
+    }
+    if (_populate_idhash_one (db, "event", sql_sel_event_info_tmpl,
+                              (char *)event, &id) < 0) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error querying %s of %s from EVENT_INFO after insert: %s",
+                 lmt_db_fsname (db), event, mysql_error (db->conn));
+        goto done;
+    }
+    *idp = id;
+    retval = 0;
+done:
+    free (qry);
+    return retval;
+}
+
 /**
  ** Database *_DATA and TIMESTAMP_INFO insert functions
  ** -1 return will cause disconnect/reconnect in lmtdb.c.
@@ -843,6 +1134,149 @@ done:
     return retval;
 }
 
+int
+lmt_db_insert_oss_interface_data (lmt_db_t db, char *ossname, char *ifname,
+                                  uint64_t read_bytes, uint64_t write_bytes,
+                                  uint64_t errors, int link, uint64_t rate)
+{
+    MYSQL_BIND param[7];
+    uint64_t if_id;
+    char *key = xmalloc (strlen (ossname) + strlen (ifname) + 2);
+    int retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+    if (!db->ins_oss_interface_data) {
+        if (lmt_conf_get_db_debug ())
+            msg ("no permission to insert into %s OSS_INTERFACE_DATA",
+                 lmt_db_fsname (db));
+        goto done;
+    }
+    sprintf (key, "%s:%s", ossname, ifname);
+    if (_lookup_idhash (db, "ossif", key, &if_id) < 0) {
+        if (lmt_conf_get_db_autoconf ()) {
+            if (lmt_conf_get_db_debug ())
+                msg ("adding %s to %s OSS_INTERFACE_INFO", key,
+                     lmt_db_fsname (db));
+            if (_insert_oss_interface_info (db, ossname, ifname, rate,
+                                            &if_id) < 0)
+                goto done;
+        } else {
+            if (lmt_conf_get_db_debug ())
+                msg ("%s: no entry in %s OSS_INTERFACE_INFO and db_autoconf "
+                     "disabled", key, lmt_db_fsname (db));
+            retval = 0; /* avoid a reconnect */
+            goto done;
+        }
+    }
+    if (_update_timestamp (db) < 0)
+        goto done;
+
+    memset (param, 0, sizeof (param));
+    assert (mysql_stmt_param_count (db->ins_oss_interface_data) == 7);
+    _param_init_int (&param[0], MYSQL_TYPE_LONG, &if_id);
+    _param_init_int (&param[1], MYSQL_TYPE_LONG, &db->timestamp_id);
+    _param_init_int (&param[2], MYSQL_TYPE_LONGLONG, &read_bytes);
+    _param_init_int (&param[3], MYSQL_TYPE_LONGLONG, &write_bytes);
+    _param_init_int (&param[4], MYSQL_TYPE_LONG, &errors);
+    _param_init_int (&param[5], MYSQL_TYPE_LONG, &link);
+    _param_init_int (&param[6], MYSQL_TYPE_LONG, &rate);
+
+    if (mysql_stmt_bind_param (db->ins_oss_interface_data, param)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error binding parameters for insert into %s "
+                 "OSS_INTERFACE_DATA: %s",
+                 lmt_db_fsname (db), mysql_error (db->conn));
+        goto done;
+    }
+    if (mysql_stmt_execute (db->ins_oss_interface_data)) {
+        if (mysql_errno (db->conn) == ER_DUP_ENTRY) {
+            retval = 0; /* expected failure if previous insert was delayed */
+            goto done;
+        }
+        if (lmt_conf_get_db_debug ())
+            msg ("error executing insert into %s OSS_INTERFACE_DATA: %s",
+                 lmt_db_fsname (db), mysql_error (db->conn));
+        goto done;
+    }
+    retval = 0;
+done:
+    free (key);
+    return retval;
+}
+
+/* helper for lmt_db_insert_event_data () */
+static void
+_param_init_id (lmt_db_t db, MYSQL_BIND *p, char *svctype, char *name,
+                uint64_t *idp)
+{
+    if (name && _lookup_idhash (db, svctype, name, idp) == 0)
+        _param_init_int (p, MYSQL_TYPE_LONG, idp);
+    else
+        p->buffer_type = MYSQL_TYPE_NULL;
+}
+
+int
+lmt_db_insert_event_data (lmt_db_t db, const char *event, char *ossname,
+                          char *ostname, char *mdsname, char *mdtname,
+                          char *comment)
+{
+    MYSQL_BIND param[6];
+    uint64_t event_id, oss_id, ost_id, mds_id;
+    unsigned long comment_len = comment ? strlen (comment) : 0;
+    int retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+    if (!db->ins_event_data) {
+        if (lmt_conf_get_db_debug ())
+            msg ("no permission to insert into %s EVENT_DATA",
+                 lmt_db_fsname (db));
+        goto done;
+    }
+    if (_lookup_idhash (db, "event", (char *)event, &event_id) < 0) {
+        if (lmt_conf_get_db_debug ())
+            msg ("adding %s to %s EVENT_INFO", event, lmt_db_fsname (db));
+        if (_insert_event_info (db, event, &event_id) < 0)
+            goto done;
+    }
+    if (_update_timestamp (db) < 0)
+        goto done;
+
+    memset (param, 0, sizeof (param));
+    assert (mysql_stmt_param_count (db->ins_event_data) == 6);
+    _param_init_int (&param[0], MYSQL_TYPE_LONG, &event_id);
+    _param_init_int (&param[1], MYSQL_TYPE_LONG, &db->timestamp_id);
+    _param_init_id (db, &param[2], "oss", ossname, &oss_id);
+    _param_init_id (db, &param[3], "ost", ostname, &ost_id);
+    /* MDS_INFO has one row per MDT, so prefer the MDT if known */
+    if (mdtname)
+        _param_init_id (db, &param[4], "mdt", mdtname, &mds_id);
+    else
+        _param_init_id (db, &param[4], "mds", mdsname, &mds_id);
+    if (comment) {
+        param[5].buffer_type = MYSQL_TYPE_STRING;
+        param[5].buffer = comment;
+        param[5].buffer_length = comment_len;
+        param[5].length = &comment_len;
+    } else
+        param[5].buffer_type = MYSQL_TYPE_NULL;
+
+    if (mysql_stmt_bind_param (db->ins_event_data, param)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error binding parameters for insert into %s EVENT_DATA: %s",
+                lmt_db_fsname (db), mysql_error (db->conn));
+        goto done;
+    }
+    if (mysql_stmt_execute (db->ins_event_data)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error executing insert into %s EVENT_DATA: %s",
+                 lmt_db_fsname (db), mysql_error (db->conn));
+        goto done;
+    }
+    retval = 0;
+done:
+    return retval;
+}
+
 int
 lmt_db_insert_ost_data (lmt_db_t db, char *ossname, char *ostname,
                         uint64_t read_bytes, uint64_t write_bytes,
@@ -909,6 +1343,117 @@ done:
     return retval;
 }
 
+static int
+_prepare_ost_ops_data (lmt_db_t db, int rows)
+{
+    int i, len = strlen (sql_ins_ost_ops_data)
+                 + rows * (strlen (sql_ins_ost_ops_data_row) + 1) + 1;
+    char *sql = xmalloc (len);
+    int retval;
+
+    strcpy (sql, sql_ins_ost_ops_data);
+    for (i = 0; i < rows; i++) {
+        if (i > 0)
+            strcat (sql, ",");
+        strcat (sql, sql_ins_ost_ops_data_row);
+    }
+    if (db->ins_ost_ops_data) {
+        mysql_stmt_close (db->ins_ost_ops_data);
+        db->ins_ost_ops_data = NULL;
+    }
+    if ((retval = _prepare_stmt (db, &db->ins_ost_ops_data, sql)) == 0)
+        db->ins_ost_ops_rows = rows;
+    free (sql);
+    return retval;
+}
+
+/* Insert all of one OST's op counters with a single multi-row insert,
+ * at the timestamp of the preceding lmt_db_insert_ost_data ().
+ * Ops missing from OPERATION_INFO are skipped.
+ */
+int
+lmt_db_insert_ost_ops_data (lmt_db_t db, char *ostname, int nops,
+                            char **opnames, uint64_t *samples)
+{
+    MYSQL_BIND *param = NULL;
+    uint64_t ost_id;
+    uint64_t *op_id = xmalloc (nops * sizeof (uint64_t));
+    uint64_t *val = xmalloc (nops * sizeof (uint64_t));
+    int i, n = 0, retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+    if (_lookup_idhash (db, "ost", ostname, &ost_id) < 0) {
+        if (lmt_conf_get_db_debug ())
+            msg ("%s: no entry in %s OST_INFO", ostname, lmt_db_fsname (db));
+        retval = 0; /* avoid a reconnect */
+        goto done;
+    }
+    for (i = 0; i < nops; i++) {
+        if (_lookup_idhash (db, "op", opnames[i], &op_id[n]) < 0) {
+            if (lmt_conf_get_db_debug ())
+                msg ("%s: no entry in %s OPERATION_INFO", opnames[i],
+                     lmt_db_fsname (db));
+            if (!seen_unknown_opnames) {
+                msg ("opname '%s' not recognized by database for file "
+                     "system '%s'. data not inserted. "
+                     "To update the database with the "
+                     "latest opnames use 'lmtinit -u <user> -o %s'",
+                     opnames[i], lmt_db_fsname (db), lmt_db_fsname (db));
+                seen_unknown_opnames = 1;
+            }
+            continue;
+        }
+        val[n++] = samples[i];
+    }
+    if (n == 0) {
+        retval = 0;
+        goto done;
+    }
+    if (!db->ins_ost_ops_data || db->ins_ost_ops_rows != n) {
+        if (_prepare_ost_ops_data (db, n) < 0) {
+            if (lmt_conf_get_db_debug ())
+                msg ("no permission to insert into %s OST_OPS_DATA",
+                     lmt_db_fsname (db));
+            retval = 0; /* avoid a reconnect */
+            goto done;
+        }
+    }
+
+    param = xmalloc (4 * n * sizeof (MYSQL_BIND));
+    memset (param, 0, 4 * n * sizeof (MYSQL_BIND));
+    assert (mysql_stmt_param_count (db->ins_ost_ops_data) == 4 * n);
+    for (i = 0; i < n; i++) {
+        _param_init_int (&param[4*i + 0], MYSQL_TYPE_LONG, &ost_id);
+        _param_init_int (&param[4*i + 1], MYSQL_TYPE_LONG, &db->timestamp_id);
+        _param_init_int (&param[4*i + 2], MYSQL_TYPE_LONG, &op_id[i]);
+        _param_init_int (&param[4*i + 3], MYSQL_TYPE_LONGLONG, &val[i]);
+    }
+
+    if (mysql_stmt_bind_param (db->ins_ost_ops_data, param)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error binding parameters for insert into %s OST_OPS_DATA: %s",
+                lmt_db_fsname (db), mysql_error (db->conn));
+        goto done;
+    }
+    if (mysql_stmt_execute (db->ins_ost_ops_data)) {
+        if (mysql_errno (db->conn) == ER_DUP_ENTRY) {
+            retval = 0; /* expected failure if previous insert was delayed */
+            goto done;
+        }
+        if (lmt_conf_get_db_debug ())
+            msg ("error executing insert into %s OST_OPS_DATA: %s",
+                 lmt_db_fsname (db), mysql_error (db->conn));
+        goto done;
+    }
+    retval = 0;
+done:
+    if (param)
+        free (param);
+    free (op_id);
+    free (val);
+    return retval;
+}
+
 int
 lmt_db_insert_router_data (lmt_db_t db, char *rtrname, uint64_t bytes,
                            float pct_cpu)
@@ -969,6 +1514,64 @@ done:
     return retval;
 }
 
+/* Set the byte count of a router group at the current timestamp,
+ * replacing the count stored there by an earlier router of the group.
+ */
+int
+lmt_db_insert_router_group_data (lmt_db_t db, int group_id, uint64_t bytes,
+                                 int nrouters)
+{
+    MYSQL_BIND param[4];
+    uint64_t id = group_id;
+    uint64_t n = nrouters;
+    int retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+    if (db->router_group_data_failed) {
+        retval = 0;
+        goto done;
+    }
+    if (!db->ins_router_group_data) {
+        if (_prepare_stmt (db, &db->ins_router_group_data,
+                           sql_ins_router_group_data) < 0) {
+            msg ("cannot insert into ROUTER_GROUP_DATA for file system '%s'. "
+                 "router group data not inserted. "
+                 "To add the table, apply its definition from "
+                 "create_schema-1.1.sql and restart",
+                 lmt_db_fsname (db));
+            db->router_group_data_failed = 1;
+            retval = 0; /* avoid a reconnect */
+            goto done;
+        }
+    }
+    if (_update_timestamp (db) < 0)
+        goto done;
+
+    memset (param, 0, sizeof (param));
+    assert (mysql_stmt_param_count (db->ins_router_group_data) == 4);
+    _param_init_int (&param[0], MYSQL_TYPE_LONG, &id);
+    _param_init_int (&param[1], MYSQL_TYPE_LONG, &db->timestamp_id);
+    _param_init_int (&param[2], MYSQL_TYPE_LONGLONG, &bytes);
+    _param_init_int (&param[3], MYSQL_TYPE_LONG, &n);
+
+    if (mysql_stmt_bind_param (db->ins_router_group_data, param)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error binding parameters for insert into %s "
+                 "ROUTER_GROUP_DATA: %s", lmt_db_fsname (db),
+                 mysql_error (db->conn));
+        goto done;
+    }
+    if (mysql_stmt_execute (db->ins_router_group_data)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error executing insert into %s ROUTER_GROUP_DATA: %s",
+                 lmt_db_fsname (db), mysql_error (db->conn));
+        goto done;
+    }
+    retval = 0;
+done:
+    return retval;
+}
+
 /**
  ** Database handle functions
  **/
@@ -993,6 +1596,407 @@ done:
 
 }
 
+/**
+ ** Historical query functions
+ ** Results are not buffered on the client (no mysql_stmt_store_result ()),
+ ** so rows are pulled from the server as they are fetched.
+ **/
+
+/* Convert a List of target names to an array of database id's.
+ * Names not known to the database are skipped.
+ */
+static uint64_t *
+_create_idset (lmt_db_t db, char *svctype, List names, int *np)
+{
+    uint64_t *ids = xmalloc (sizeof (uint64_t) * (list_count (names) + 1));
+    ListIterator itr;
+    char *name;
+    int n = 0;
+
+    itr = list_iterator_create (names);
+    while ((name = list_next (itr))) {
+        if (_lookup_idhash (db, svctype, name, &ids[n]) == 0)
+            n++;
+    }
+    list_iterator_destroy (itr);
+    *np = n;
+    return ids;
+}
+
+/* Copy a range query, restricting it to rows whose col is one of the
+ * n ids, so that the server does the filtering.  The condition goes
+ * at the end of the where clause, before "group by" or "order by".
+ */
+static char *
+_create_range_sql (const char *sql, const char *col, uint64_t *ids, int n)
+{
+    const char *tail;
+    int i, len, head;
+    char *qry;
+
+    if (!(tail = strstr (sql, "group by ")))
+        tail = strstr (sql, "order by ");
+    assert (tail != NULL);
+    head = tail - sql;
+    len = strlen (sql) + strlen (col) + 16 + n * 22;
+    qry = xmalloc (len);
+    snprintf (qry, len, "%.*sand %s in (", head, sql, col);
+    for (i = 0; i < n; i++)
+        snprintf (qry + strlen (qry), len - strlen (qry), "%s%"PRIu64,
+                  i > 0 ? "," : "", ids[i]);
+    snprintf (qry + strlen (qry), len - strlen (qry), ") %s", tail);
+    return qry;
+}
+
+/* Set up a range query of the named targets (all if names is NULL).
+ * A restricted query is prepared into *fsp, to be closed by the caller,
+ * and *spp is pointed at it, otherwise the cached statement *spp is used.
+ * Returns 0 if none of the names are known, so there is nothing to query.
+ */
+static int
+_filter_range (lmt_db_t db, char *svctype, List names, const char *col,
+               const char **sqlp, MYSQL_STMT ***spp, MYSQL_STMT **fsp,
+               char **fsqlp)
+{
+    uint64_t *ids;
+    int n;
+
+    if (!names)
+        return 1;
+    ids = _create_idset (db, svctype, names, &n);
+    if (n > 0) {
+        *fsqlp = _create_range_sql (*sqlp, col, ids, n);
+        *sqlp = *fsqlp;
+        *spp = fsp;
+    }
+    free (ids);
+    return n;
+}
+
+/* Prepare (if needed) and execute a range query, and bind its result
+ * columns.  Rows are then retrieved with _fetch_range ().
+ */
+static int
+_execute_range (lmt_db_t db, MYSQL_STMT **sp, const char *sql,
+                const char *tbl, time_t t0, time_t t1, MYSQL_BIND *res)
+{
+    MYSQL_BIND param[2];
+    uint64_t start = t0, end = t1;
+    int retval = -1;
+
+    if (!*sp && _prepare_stmt (db, sp, sql) < 0) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error preparing query of %s %s: %s",
+                 lmt_db_fsname (db), tbl, mysql_error (db->conn));
+        goto done;
+    }
+    memset (param, 0, sizeof (param));
+    assert (mysql_stmt_param_count (*sp) == 2);
+    _param_init_int (&param[0], MYSQL_TYPE_LONGLONG, &start);
+    _param_init_int (&param[1], MYSQL_TYPE_LONGLONG, &end);
+
+    if (mysql_stmt_bind_param (*sp, param)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error binding parameters for query of %s %s: %s",
+                lmt_db_fsname (db), tbl, mysql_stmt_error (*sp));
+        goto done;
+    }
+    if (mysql_stmt_execute (*sp)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error executing query of %s %s: %s",
+                 lmt_db_fsname (db), tbl, mysql_stmt_error (*sp));
+        goto done;
+    }
+    if (mysql_stmt_bind_result (*sp, res)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error binding results for query of %s %s: %s",
+                lmt_db_fsname (db), tbl, mysql_stmt_error (*sp));
+        mysql_stmt_reset (*sp);
+        goto done;
+    }
+    retval = 0;
+done:
+    return retval;
+}
+
+/* Fetch the next row of a range query into the bound result buffers.
+ * Returns 1 if a row was fetched, 0 at the end of the result set, -1 on error.
+ */
+static int
+_fetch_range (lmt_db_t db, MYSQL_STMT *s, const char *tbl)
+{
+    switch (mysql_stmt_fetch (s)) {
+        case 0:
+            return 1;
+        case MYSQL_NO_DATA:
+            return 0;
+        case MYSQL_DATA_TRUNCATED:
+            if (lmt_conf_get_db_debug ())
+                msg ("truncated column in query of %s %s",
+                     lmt_db_fsname (db), tbl);
+            return 1;
+        default:
+            if (lmt_conf_get_db_debug ())
+                msg ("error fetching from query of %s %s: %s",
+                     lmt_db_fsname (db), tbl, mysql_stmt_error (s));
+            return -1;
+    }
+}
+
+/* Release the result set.  If the query was interrupted, rows remaining
+ * on the server are discarded so the connection can be reused.
+ */
+static void
+_finish_range (MYSQL_STMT *s, int interrupted)
+{
+    mysql_stmt_free_result (s);
+    if (interrupted)
+        mysql_stmt_reset (s);
+}
+
+static int
+_query_ost_range (lmt_db_t db, MYSQL_STMT **sp, const char *sql,
+                  const char *tbl, const char *col, time_t t0, time_t t1,
+                  List names, lmt_db_ost_batch_f cb, void *arg)
+{
+    MYSQL_BIND res[8];
+    uint64_t row[8];
+    lmt_db_ost_batch_t *b = xmalloc (sizeof (*b));
+    MYSQL_STMT *fs = NULL;
+    char *fsql = NULL;
+    int i, rc = 0, retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+
+    if (_filter_range (db, "ost", names, col, &sql, &sp, &fs, &fsql) == 0) {
+        retval = 0;
+        goto done;
+    }
+    memset (res, 0, sizeof (res));
+    for (i = 0; i < 8; i++)
+        _param_init_int (&res[i], MYSQL_TYPE_LONGLONG, &row[i]);
+    if (_execute_range (db, sp, sql, tbl, t0, t1, res) < 0)
+        goto done;
+    b->nrows = 0;
+    while ((rc = _fetch_range (db, *sp, tbl)) > 0) {
+        i = b->nrows++;
+        b->timestamp[i] =   row[0];
+        b->ost_id[i] =      row[1];
+        b->read_bytes[i] =  row[2];
+        b->write_bytes[i] = row[3];
+        b->kbytes_free[i] = row[4];
+        b->kbytes_used[i] = row[5];
+        b->inodes_free[i] = row[6];
+        b->inodes_used[i] = row[7];
+        if (b->nrows == LMT_DB_BATCH_ROWS) {
+            if ((rc = cb (b, arg)) < 0)
+                break;
+            b->nrows = 0;
+        }
+    }
+    if (rc == 0 && b->nrows > 0)
+        rc = cb (b, arg);
+    _finish_range (*sp, rc != 0);
+    if (rc < 0)
+        goto done;
+    retval = 0;
+done:
+    if (fs)
+        mysql_stmt_close (fs);
+    if (fsql)
+        free (fsql);
+    free (b);
+    return retval;
+}
+
+int
+lmt_db_query_ost_range (lmt_db_t db, time_t t0, time_t t1, List names,
+                        lmt_db_ost_batch_f cb, void *arg)
+{
+    return _query_ost_range (db, &db->sel_ost_data_range,
+                             sql_sel_ost_data_range, "OST_DATA", "d.OST_ID",
+                             t0, t1, names, cb, arg);
+}
+
+int
+lmt_db_query_ost_hour_range (lmt_db_t db, time_t t0, time_t t1, List names,
+                             lmt_db_ost_batch_f cb, void *arg)
+{
+    return _query_ost_range (db, &db->sel_ost_hour_range,
+                             sql_sel_ost_hour_range, "OST_AGGREGATE_HOUR",
+                             "a.OST_ID", t0, t1, names, cb, arg);
+}
+
+static int
+_query_mds_range (lmt_db_t db, MYSQL_STMT **sp, const char *sql,
+                  const char *tbl, const char *col, time_t t0, time_t t1,
+                  List names, lmt_db_mds_batch_f cb, void *arg)
+{
+    MYSQL_BIND res[7];
+    uint64_t row[7];
+    float pct_cpu;
+    lmt_db_mds_batch_t *b = xmalloc (sizeof (*b));
+    MYSQL_STMT *fs = NULL;
+    char *fsql = NULL;
+    int i, rc = 0, retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+
+    if (_filter_range (db, "mdt", names, col, &sql, &sp, &fs, &fsql) == 0) {
+        retval = 0;
+        goto done;
+    }
+    memset (res, 0, sizeof (res));
+    for (i = 0; i < 7; i++)
+        _param_init_int (&res[i], MYSQL_TYPE_LONGLONG, &row[i]);
+    _param_init_int (&res[2], MYSQL_TYPE_FLOAT, &pct_cpu);
+    if (_execute_range (db, sp, sql, tbl, t0, t1, res) < 0)
+        goto done;
+    b->nrows = 0;
+    while ((rc = _fetch_range (db, *sp, tbl)) > 0) {
+        i = b->nrows++;
+        b->timestamp[i] =   row[0];
+        b->mds_id[i] =      row[1];
+        b->pct_cpu[i] =     pct_cpu;
+        b->kbytes_free[i] = row[3];
+        b->kbytes_used[i] = row[4];
+        b->inodes_free[i] = row[5];
+        b->inodes_used[i] = row[6];
+        if (b->nrows == LMT_DB_BATCH_ROWS) {
+            if ((rc = cb (b, arg)) < 0)
+                break;
+            b->nrows = 0;
+        }
+    }
+    if (rc == 0 && b->nrows > 0)
+        rc = cb (b, arg);
+    _finish_range (*sp, rc != 0);
+    if (rc < 0)
+        goto done;
+    retval = 0;
+done:
+    if (fs)
+        mysql_stmt_close (fs);
+    if (fsql)
+        free (fsql);
+    free (b);
+    return retval;
+}
+
+int
+lmt_db_query_mds_range (lmt_db_t db, time_t t0, time_t t1, List names,
+                        lmt_db_mds_batch_f cb, void *arg)
+{
+    return _query_mds_range (db, &db->sel_mds_data_range,
+                             sql_sel_mds_data_range, "MDS_DATA", "d.MDS_ID",
+                             t0, t1, names, cb, arg);
+}
+
+int
+lmt_db_query_mds_hour_range (lmt_db_t db, time_t t0, time_t t1, List names,
+                             lmt_db_mds_batch_f cb, void *arg)
+{
+    return _query_mds_range (db, &db->sel_mds_hour_range,
+                             sql_sel_mds_hour_range, "MDS_AGGREGATE_HOUR",
+                             "a.MDS_ID", t0, t1, names, cb, arg);
+}
+
+int
+lmt_db_query_mds_ops_range (lmt_db_t db, time_t t0, time_t t1, List names,
+                            lmt_db_mds_ops_batch_f cb, void *arg)
+{
+    MYSQL_BIND res[6];
+    uint64_t row[6];
+    lmt_db_mds_ops_batch_t *b = xmalloc (sizeof (*b));
+    MYSQL_STMT **sp = &db->sel_mds_ops_data_range, *fs = NULL;
+    const char *sql = sql_sel_mds_ops_data_range;
+    char *fsql = NULL;
+    int i, rc = 0, retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+
+    if (_filter_range (db, "mdt", names, "d.MDS_ID", &sql, &sp, &fs,
+                       &fsql) == 0) {
+        retval = 0;
+        goto done;
+    }
+    memset (res, 0, sizeof (res));
+    for (i = 0; i < 6; i++)
+        _param_init_int (&res[i], MYSQL_TYPE_LONGLONG, &row[i]);
+    if (_execute_range (db, sp, sql, "MDS_OPS_DATA", t0, t1, res) < 0)
+        goto done;
+    b->nrows = 0;
+    while ((rc = _fetch_range (db, *sp, "MDS_OPS_DATA")) > 0) {
+        i = b->nrows++;
+        b->timestamp[i] =   row[0];
+        b->mds_id[i] =      row[1];
+        b->op_id[i] =       row[2];
+        b->samples[i] =     row[3];
+        b->sum[i] =         row[4];
+        b->sumsquares[i] =  row[5];
+        if (b->nrows == LMT_DB_BATCH_ROWS) {
+            if ((rc = cb (b, arg)) < 0)
+                break;
+            b->nrows = 0;
+        }
+    }
+    if (rc == 0 && b->nrows > 0)
+        rc = cb (b, arg);
+    _finish_range (*sp, rc != 0);
+    if (rc < 0)
+        goto done;
+    retval = 0;
+done:
+    if (fs)
+        mysql_stmt_close (fs);
+    if (fsql)
+        free (fsql);
+    free (b);
+    return retval;
+}
+
+int
+lmt_db_query_events (lmt_db_t db, time_t t0, time_t t1, lmt_db_event_f cb,
+                     void *arg)
+{
+    int len = strlen (sql_sel_event_range_tmpl) + 2*16 + 1;
+    char *qry = xmalloc (len);
+    MYSQL_RES *res = NULL;
+    MYSQL_ROW row;
+    int retval = -1;
+
+    assert (db->magic == LMT_DBHANDLE_MAGIC);
+
+    snprintf (qry, len, sql_sel_event_range_tmpl, (unsigned long)t0,
+              (unsigned long)t1);
+    if (mysql_query (db->conn, qry)) {
+        if (lmt_conf_get_db_debug ())
+            msg ("error querying %s EVENT_DATA: %s", lmt_db_fsname (db),
+                 mysql_error (db->conn));
+        goto done;
+    }
+    if (!(res = mysql_use_result (db->conn)))
+        goto done;
+    while ((row = mysql_fetch_row (res))) {
+        if (!row[0] || !row[1])
+            continue;
+        if (cb (strtoul (row[0], NULL, 10), row[1], row[2], row[3], row[4],
+                arg) < 0) {
+            while (mysql_fetch_row (res))
+                ; /* drain unbuffered result */
+            goto done;
+        }
+    }
+    if (mysql_errno (db->conn))
+        goto done;
+    retval = 0;
+done:
+    if (res)
+        mysql_free_result (res);
+    free (qry);
+    return retval;
+}
+
 void
 lmt_db_destroy (lmt_db_t db)
 {
@@ -1008,10 +2012,28 @@ lmt_db_destroy (lmt_db_t db)
         mysql_stmt_close (db->ins_mds_ops_data);
     if (db->ins_oss_data)
         mysql_stmt_close (db->ins_oss_data);
+    if (db->ins_oss_interface_data)
+        mysql_stmt_close (db->ins_oss_interface_data);
     if (db->ins_ost_data)
         mysql_stmt_close (db->ins_ost_data);
     if (db->ins_router_data)
         mysql_stmt_close (db->ins_router_data);
+    if (db->ins_ost_ops_data)
+        mysql_stmt_close (db->ins_ost_ops_data);
+    if (db->ins_router_group_data)
+        mysql_stmt_close (db->ins_router_group_data);
+    if (db->ins_event_data)
+        mysql_stmt_close (db->ins_event_data);
+    if (db->sel_ost_data_range)
+        mysql_stmt_close (db->sel_ost_data_range);
+    if (db->sel_mds_data_range)
+        mysql_stmt_close (db->sel_mds_data_range);
+    if (db->sel_mds_ops_data_range)
+        mysql_stmt_close (db->sel_mds_ops_data_range);
+    if (db->sel_ost_hour_range)
+        mysql_stmt_close (db->sel_ost_hour_range);
+    if (db->sel_mds_hour_range)
+        mysql_stmt_close (db->sel_mds_hour_range);
     if (db->idhash)
         hash_destroy (db->idhash);
     if (db->conn)
@@ -1055,14 +2077,19 @@ lmt_db_create (int readonly, const char *dbname, lmt_db_t *dbp)
             prepfail++;
         if (_prepare_stmt (db, &db->ins_oss_data, sql_ins_oss_data) < 0)
             prepfail++;
+        if (_prepare_stmt (db, &db->ins_oss_interface_data,
+                                sql_ins_oss_interface_data) < 0)
+            prepfail++;
         if (_prepare_stmt (db, &db->ins_ost_data, sql_ins_ost_data) < 0)
             prepfail++;
         if (_prepare_stmt (db, &db->ins_router_data, sql_ins_router_data) < 0)
             prepfail++;
+        if (_prepare_stmt (db, &db->ins_event_data, sql_ins_event_data) < 0)
+            prepfail++;
     }
     if (prepfail) {
         if (lmt_conf_get_db_debug ())
-            msg ("lmt_db_create: %s: failed to prepare %d/6 inserts",
+            msg ("lmt_db_create: %s: failed to prepare %d/8 inserts",
                  dbname, prepfail);
         goto done;
     }
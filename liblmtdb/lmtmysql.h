@@ -21,12 +21,28 @@ int lmt_db_insert_mds_ops_data (lmt_db_t db, char *mdtname, char *opname,
                         uint64_t samples, uint64_t sum, uint64_t sumsquares);
 int lmt_db_insert_oss_data (lmt_db_t db, int quiet_noexist, char *name,
                         float pctcpu, float pctmem);
+int lmt_db_insert_oss_interface_data (lmt_db_t db, char *ossname,
+                        char *ifname, uint64_t read_bytes,
+                        uint64_t write_bytes, uint64_t errors, int link,
+                        uint64_t rate);
 int lmt_db_insert_ost_data (lmt_db_t db, char *ossname, char *ostname,
                         uint64_t read_bytes, uint64_t write_bytes,
                         uint64_t kbytes_free, uint64_t kbytes_used,
                         uint64_t inodes_free, uint64_t inodes_used);
+int lmt_db_insert_ost_ops_data (lmt_db_t db, char *ostname, int nops,
+                        char **opnames, uint64_t *samples);
 int lmt_db_insert_router_data (lmt_db_t db, char *name,
                         uint64_t bytes, float pct_cpu);
+int lmt_db_insert_router_group_data (lmt_db_t db, int group_id,
+                        uint64_t bytes, int nrouters);
+
+/* Record an event (an EVENT_INFO name) against whichever of the servers
+ * and targets are non-NULL.  MDS_ID is taken from mdtname if set,
+ * otherwise from the mdsname hostname.
+ */
+int lmt_db_insert_event_data (lmt_db_t db, const char *event,
+                        char *ossname, char *ostname, char *mdsname,
+                        char *mdtname, char *comment);
 
 int lmt_db_update_ops(char *user, char *pass, char *fs);
 
@@ -40,6 +56,100 @@ typedef int (*lmt_db_map_f) (const char *key, void *arg);
 
 int lmt_db_server_map (lmt_db_t db, char *svctype, lmt_db_map_f mf, void *arg);
 
+/* historical queries */
+
+/* Rows are returned to the caller in batches of up to LMT_DB_BATCH_ROWS,
+ * one array per column, in timestamp order.  The result set is streamed
+ * from the server so client memory use does not depend on the size of
+ * the time range.  Timestamps are unix time.
+ */
+#define LMT_DB_BATCH_ROWS   256
+
+typedef struct {
+    int         nrows;
+    uint64_t    timestamp[LMT_DB_BATCH_ROWS];
+    uint64_t    ost_id[LMT_DB_BATCH_ROWS];
+    uint64_t    read_bytes[LMT_DB_BATCH_ROWS];
+    uint64_t    write_bytes[LMT_DB_BATCH_ROWS];
+    uint64_t    kbytes_free[LMT_DB_BATCH_ROWS];
+    uint64_t    kbytes_used[LMT_DB_BATCH_ROWS];
+    uint64_t    inodes_free[LMT_DB_BATCH_ROWS];
+    uint64_t    inodes_used[LMT_DB_BATCH_ROWS];
+} lmt_db_ost_batch_t;
+
+typedef struct {
+    int         nrows;
+    uint64_t    timestamp[LMT_DB_BATCH_ROWS];
+    uint64_t    mds_id[LMT_DB_BATCH_ROWS];
+    float       pct_cpu[LMT_DB_BATCH_ROWS];
+    uint64_t    kbytes_free[LMT_DB_BATCH_ROWS];
+    uint64_t    kbytes_used[LMT_DB_BATCH_ROWS];
+    uint64_t    inodes_free[LMT_DB_BATCH_ROWS];
+    uint64_t    inodes_used[LMT_DB_BATCH_ROWS];
+} lmt_db_mds_batch_t;
+
+typedef struct {
+    int         nrows;
+    uint64_t    timestamp[LMT_DB_BATCH_ROWS];
+    uint64_t    mds_id[LMT_DB_BATCH_ROWS];
+    uint64_t    op_id[LMT_DB_BATCH_ROWS];
+    uint64_t    samples[LMT_DB_BATCH_ROWS];
+    uint64_t    sum[LMT_DB_BATCH_ROWS];
+    uint64_t    sumsquares[LMT_DB_BATCH_ROWS];
+} lmt_db_mds_ops_batch_t;
+
+/* A callback returning -1 stops the query, which then returns -1.
+ * The connection is busy until the query returns, so callbacks must not
+ * call back into the same lmt_db_t.
+ */
+typedef int (*lmt_db_ost_batch_f) (lmt_db_ost_batch_t *b, void *arg);
+typedef int (*lmt_db_mds_batch_f) (lmt_db_mds_batch_t *b, void *arg);
+typedef int (*lmt_db_mds_ops_batch_f) (lmt_db_mds_ops_batch_t *b, void *arg);
+
+/* Query data in the time range [t0, t1).  If names is non-NULL, only rows
+ * for the listed OST (or MDT) names are returned.
+ */
+int lmt_db_query_ost_range (lmt_db_t db, time_t t0, time_t t1, List names,
+                            lmt_db_ost_batch_f cb, void *arg);
+int lmt_db_query_mds_range (lmt_db_t db, time_t t0, time_t t1, List names,
+                            lmt_db_mds_batch_f cb, void *arg);
+int lmt_db_query_mds_ops_range (lmt_db_t db, time_t t0, time_t t1,
+                            List names, lmt_db_mds_ops_batch_f cb, void *arg);
+
+/* Query the hourly aggregates (OST_AGGREGATE_HOUR, MDS_AGGREGATE_HOUR)
+ * in the time range [t0, t1).  read_bytes and write_bytes are the bytes
+ * transferred during the hour; the other values are hourly averages.
+ */
+int lmt_db_query_ost_hour_range (lmt_db_t db, time_t t0, time_t t1,
+                            List names, lmt_db_ost_batch_f cb, void *arg);
+int lmt_db_query_mds_hour_range (lmt_db_t db, time_t t0, time_t t1,
+                            List names, lmt_db_mds_batch_f cb, void *arg);
+
+/* Call mf for each (target name, hostname) pair in OST_INFO (svctype "ost")
+ * or MDS_INFO (svctype "mdt").
+ */
+typedef int (*lmt_db_host_map_f) (const char *name, const char *host,
+                                  void *arg);
+
+int lmt_db_host_map (lmt_db_t db, char *svctype, lmt_db_host_map_f mf,
+                     void *arg);
+
+/* Call cb for each EVENT_DATA row in the time range [t0, t1), in time
+ * order.  target is the OST or MDT name and server the OSS or MDS
+ * hostname; either may be empty.  A callback returning -1 stops the query.
+ */
+typedef int (*lmt_db_event_f) (time_t t, const char *event,
+                               const char *target, const char *server,
+                               const char *comment, void *arg);
+
+int lmt_db_query_events (lmt_db_t db, time_t t0, time_t t1,
+                         lmt_db_event_f cb, void *arg);
+
+/* Map database id's back to names for decoding query results.
+ */
+int lmt_db_lookup_id (lmt_db_t db, char *svctype, char *name, uint64_t *idp);
+char *lmt_db_lookup_name (lmt_db_t db, char *svctype, uint64_t id);
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -0,0 +1,125 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h> /* PATH_MAX */
+
+#include "list.h"
+#include "error.h"
+
+#include "proc.h"
+#include "diskstats.h"
+
+#define PROC_DISKSTATS          "diskstats"
+#define SYS_BLOCK_DM_NAME       "block/%s/dm/name"
+
+/* Parse /proc/diskstats:
+ *   8  16 sdb 1234 5 9872 456 789 10 6312 1011 0 1200 1467 [discard ...]
+ * i.e. major, minor, name, then reads completed, merged, sectors, ms,
+ * the same four for writes, I/Os in progress, ms busy, weighted ms.
+ * Kernels before 2.6.25 list partitions with only four counters; such
+ * lines are skipped.
+ */
+int
+proc_diskstats (pctx_t ctx, List *lp)
+{
+    List l = list_create ((ListDelF)free);
+    char buf[512];
+    diskstat_t *d;
+    int n, ret = -1;
+
+    if (proc_open (ctx, PROC_DISKSTATS) < 0)
+        goto done;
+    while (proc_gets (ctx, NULL, buf, sizeof (buf)) == 0) {
+        if (!(d = malloc (sizeof (*d))))
+            msg_exit ("out of memory");
+        memset (d, 0, sizeof (*d));
+        n = sscanf (buf, " %*u %*u %63s %"PRIu64" %*u %*u %"PRIu64
+                         " %"PRIu64" %*u %*u %"PRIu64" %"PRIu64
+                         " %"PRIu64" %"PRIu64,
+                    d->name, &d->reads, &d->read_ms, &d->writes,
+                    &d->write_ms, &d->in_flight, &d->io_ms,
+                    &d->queue_ms);
+        if (n != 8) {
+            free (d);
+            continue;
+        }
+        list_append (l, d);
+    }
+    proc_close (ctx);
+    *lp = l;
+    ret = 0;
+done:
+    if (ret < 0)
+        list_destroy (l);
+    return ret;
+}
+
+static int
+_match_diskstat (diskstat_t *d, char *name)
+{
+    return !strcmp (d->name, name);
+}
+
+/* /dev/mapper/<name> is a link to /dev/dm-N, which lists <name> in sysfs.
+ */
+static diskstat_t *
+_find_dm (pctx_t ctx, List l, const char *name)
+{
+    char path[PATH_MAX];
+    char dmname[DISKSTAT_NAME_SIZE];
+    ListIterator itr;
+    diskstat_t *d;
+
+    itr = list_iterator_create (l);
+    while ((d = list_next (itr))) {
+        if (strncmp (d->name, "dm-", 3) != 0)
+            continue;
+        snprintf (path, sizeof (path), SYS_BLOCK_DM_NAME, d->name);
+        if (proc_gets (ctx, path, dmname, sizeof (dmname)) == 0
+                                            && !strcmp (dmname, name))
+            break;
+    }
+    list_iterator_destroy (itr);
+    return d;
+}
+
+diskstat_t *
+proc_diskstats_find (pctx_t ctx, List l, const char *dev)
+{
+    const char *name = strrchr (dev, '/');
+    diskstat_t *d;
+
+    name = name ? name + 1 : dev;
+    if ((d = list_find_first (l, (ListFindF)_match_diskstat, (void *)name)))
+        return d;
+    return _find_dm (ctx, l, name);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
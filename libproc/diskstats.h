@@ -0,0 +1,29 @@
+#define DISKSTAT_NAME_SIZE  64
+
+/* Counters of one block device from /proc/diskstats (times in ms).
+ */
+typedef struct {
+    char name[DISKSTAT_NAME_SIZE];
+    uint64_t reads;                 /* reads completed */
+    uint64_t read_ms;               /* time spent reading */
+    uint64_t writes;                /* writes completed */
+    uint64_t write_ms;              /* time spent writing */
+    uint64_t in_flight;             /* I/Os currently in progress */
+    uint64_t io_ms;                 /* time the device was busy */
+    uint64_t queue_ms;              /* busy time weighted by queue depth */
+} diskstat_t;
+
+/* Return a list of diskstat_t (free with list_destroy) for the block
+ * devices in /proc/diskstats.
+ */
+int proc_diskstats (pctx_t ctx, List *lp);
+
+/* Look up the device node dev (e.g. /dev/sdb or /dev/mapper/ost0) in a
+ * list returned by proc_diskstats ().  Device mapper names are resolved
+ * through sysfs.  Returns NULL if the device is not in the list.
+ */
+diskstat_t *proc_diskstats_find (pctx_t ctx, List l, const char *dev);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,233 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "proc.h"
+#include "lnet.h"
+
+/* lnet moved from /proc/sys/lnet to debugfs in Lustre 2.11 */
+#define PROC_SYS_LNET           "sys/lnet/%s"
+#define DEBUGFS_LNET            "kernel/debug/lnet/%s"
+
+#define LNET_MAX_COLS           16
+
+static int
+_lnet_open (pctx_t ctx, const char *name)
+{
+    if (proc_openf (ctx, PROC_SYS_LNET, name) == 0)
+        return 0;
+    if (errno != ENOENT)
+        return -1;
+    return proc_openf (ctx, DEBUGFS_LNET, name);
+}
+
+/* Split s in place into at most max whitespace separated words.
+ */
+static int
+_split (char *s, char **word, int max)
+{
+    char *p, *save = NULL;
+    int n = 0;
+
+    for (p = strtok_r (s, " \t", &save); p && n < max;
+                                         p = strtok_r (NULL, " \t", &save))
+        word[n++] = p;
+    return n;
+}
+
+static int
+_column (char **word, int n, const char *name)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (!strcmp (word[i], name))
+            return i;
+    }
+    return -1;
+}
+
+/* Parse lnet/stats:
+ *   msgs_alloc msgs_max errors send_count recv_count route_count
+ *   drop_count send_length recv_length route_length drop_length
+ */
+int
+proc_lnet_stats (pctx_t ctx, lnetstat_t *sp)
+{
+    lnetstat_t s;
+    int n;
+
+    if (_lnet_open (ctx, "stats") < 0)
+        return -1;
+    n = proc_scanf (ctx, NULL, "%*u %*u %*u %"PRIu64" %"PRIu64" %"PRIu64
+                    " %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64,
+                    &s.send_count, &s.recv_count, &s.route_count,
+                    &s.drop_count, &s.send_length, &s.recv_length,
+                    &s.route_length, &s.drop_length);
+    proc_close (ctx);
+    if (n != 8) {
+        errno = EIO;
+        return -1;
+    }
+    *sp = s;
+    return 0;
+}
+
+/* Parse lnet/nis.  The columns are found from the header, which is
+ *   nid refs peer rtr max tx min                    (1.8)
+ *   nid status alive refs peer rtr max tx min       (2.x)
+ * where min, following tx, is the tx credit low water mark.
+ */
+int
+proc_lnet_nis (pctx_t ctx, lnetni_t *nip, int maxni, int *nnip)
+{
+    char buf[256];
+    char *word[LNET_MAX_COLS];
+    int ncol, i, status, peer, max, tx;
+    int nni = 0, retval = -1;
+    lnetni_t ni;
+
+    if (_lnet_open (ctx, "nis") < 0)
+        return -1;
+    if (proc_gets (ctx, NULL, buf, sizeof (buf)) < 0)
+        goto done;
+    ncol = _split (buf, word, LNET_MAX_COLS);
+    status = _column (word, ncol, "status");
+    peer = _column (word, ncol, "peer");
+    max = _column (word, ncol, "max");
+    tx = _column (word, ncol, "tx");
+    if (peer < 0 || max < 0 || tx < 0 || tx + 1 >= ncol
+                                      || strcmp (word[tx + 1], "min") != 0)
+        goto done;
+    while (proc_gets (ctx, NULL, buf, sizeof (buf)) == 0) {
+        if (_split (buf, word, LNET_MAX_COLS) != ncol)
+            continue;
+        if (!strcmp (word[0], "0@lo"))
+            continue;
+        memset (&ni, 0, sizeof (ni));
+        snprintf (ni.nid, sizeof (ni.nid), "%s", word[0]);
+        ni.up = status < 0 || !strcmp (word[status], "up");
+        ni.peer_credits = strtol (word[peer], NULL, 10);
+        ni.max_credits = strtol (word[max], NULL, 10);
+        ni.tx_credits = strtol (word[tx], NULL, 10);
+        ni.min_credits = strtol (word[tx + 1], NULL, 10);
+        for (i = 0; i < nni; i++) {
+            if (!strcmp (nip[i].nid, ni.nid))
+                break;
+        }
+        if (i == nni) {
+            if (nni == maxni)
+                continue;
+            nni++;
+        } else if (nip[i].min_credits <= ni.min_credits)
+            continue;
+        nip[i] = ni;
+    }
+    *nnip = nni;
+    retval = 0;
+done:
+    proc_close (ctx);
+    if (retval < 0)
+        errno = EIO;
+    return retval;
+}
+
+/* True if peer p1 is more starved than p2.
+ */
+static int
+_starved (lnetpeer_t *p1, lnetpeer_t *p2)
+{
+    if (p1->min_credits != p2->min_credits)
+        return p1->min_credits < p2->min_credits;
+    return p1->queue > p2->queue;
+}
+
+/* Parse lnet/peers.  The columns are found from the header, which is
+ *   nid refs state max rtr min tx min queue         (1.8)
+ *   nid refs state last max rtr min tx min queue    (2.x)
+ * where the min following tx is the tx credit low water mark.
+ */
+int
+proc_lnet_peers (pctx_t ctx, lnetpeer_t *pp, int maxpeer, int *npp,
+                 lnetpeersum_t *sp)
+{
+    char buf[256];
+    char *word[LNET_MAX_COLS];
+    int ncol, i, max, tx, queue;
+    int np = 0, retval = -1;
+    lnetpeersum_t sum;
+    lnetpeer_t p;
+
+    if (_lnet_open (ctx, "peers") < 0)
+        return -1;
+    if (proc_gets (ctx, NULL, buf, sizeof (buf)) < 0)
+        goto done;
+    ncol = _split (buf, word, LNET_MAX_COLS);
+    max = _column (word, ncol, "max");
+    tx = _column (word, ncol, "tx");
+    queue = _column (word, ncol, "queue");
+    if (max < 0 || queue < 0 || tx < 0 || tx + 1 >= ncol
+                                       || strcmp (word[tx + 1], "min") != 0)
+        goto done;
+    memset (&sum, 0, sizeof (sum));
+    while (proc_gets (ctx, NULL, buf, sizeof (buf)) == 0) {
+        if (_split (buf, word, LNET_MAX_COLS) != ncol)
+            continue;
+        memset (&p, 0, sizeof (p));
+        p.max_credits = strtol (word[max], NULL, 10);
+        p.tx_credits = strtol (word[tx], NULL, 10);
+        p.min_credits = strtol (word[tx + 1], NULL, 10);
+        p.queue = strtoull (word[queue], NULL, 10);
+        sum.npeers++;
+        if (p.min_credits < 0)
+            sum.nstarved++;
+        sum.queue += p.queue;
+
+        /* insertion into the sorted, bounded array of the worst peers */
+        if (np == maxpeer && (np == 0 || !_starved (&p, &pp[np - 1])))
+            continue;
+        if (np < maxpeer)
+            np++;
+        for (i = np - 1; i > 0 && _starved (&p, &pp[i - 1]); i--)
+            pp[i] = pp[i - 1];
+        snprintf (p.nid, sizeof (p.nid), "%s", word[0]);
+        pp[i] = p;
+    }
+    *npp = np;
+    *sp = sum;
+    retval = 0;
+done:
+    proc_close (ctx);
+    if (retval < 0)
+        errno = EIO;
+    return retval;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,63 @@
+#define LNET_NID_SIZE       64
+
+/* Counters from lnet/stats.
+ */
+typedef struct {
+    uint64_t send_count;            /* messages sent */
+    uint64_t recv_count;            /* messages received */
+    uint64_t route_count;           /* messages forwarded */
+    uint64_t drop_count;            /* messages dropped */
+    uint64_t send_length;           /* bytes sent */
+    uint64_t recv_length;           /* bytes received */
+    uint64_t route_length;          /* bytes forwarded */
+    uint64_t drop_length;           /* bytes dropped */
+} lnetstat_t;
+
+/* One network interface from lnet/nis.  Releases with a credit pool
+ * per CPU partition list an NI once per partition, in which case this
+ * describes its most depleted partition.
+ */
+typedef struct {
+    char nid[LNET_NID_SIZE];
+    int up;                         /* status is up (1 if not reported) */
+    int peer_credits;               /* tx credits allowed per peer */
+    int max_credits;                /* tx credits of the NI */
+    int tx_credits;                 /* available now (< 0: msgs waiting) */
+    int min_credits;                /* low water mark of tx_credits */
+} lnetni_t;
+
+/* One peer from lnet/peers.
+ */
+typedef struct {
+    char nid[LNET_NID_SIZE];
+    int max_credits;                /* tx credits allowed to the peer */
+    int tx_credits;                 /* available now (< 0: msgs waiting) */
+    int min_credits;                /* low water mark of tx_credits */
+    uint64_t queue;                 /* bytes waiting for credits */
+} lnetpeer_t;
+
+/* Totals over the whole peer table.
+ */
+typedef struct {
+    int npeers;
+    int nstarved;                   /* peers whose min_credits went < 0 */
+    uint64_t queue;                 /* bytes waiting for credits */
+} lnetpeersum_t;
+
+int proc_lnet_stats (pctx_t ctx, lnetstat_t *sp);
+
+/* Fill nip with up to maxni non-loopback NIs and set *nnip to their
+ * number.
+ */
+int proc_lnet_nis (pctx_t ctx, lnetni_t *nip, int maxni, int *nnip);
+
+/* Fill pp with the (up to) maxpeer most credit starved peers, lowest
+ * min_credits first, and sum up the whole table in *sp.  The table is
+ * read a line at a time, so memory use does not grow with its size.
+ */
+int proc_lnet_peers (pctx_t ctx, lnetpeer_t *pp, int maxpeer, int *npp,
+                     lnetpeersum_t *sp);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -73,11 +73,33 @@
 
 #define PROC_FS_LUSTRE_MDT_EXPORTS      "%s/%s/exports"
 #define PROC_FS_LUSTRE_MDT_EXPORT_STATS "%s/%s/exports/%s/stats"
+#define PROC_FS_LUSTRE_MDT_EXPORT_LDLM_STATS \
+                                        "%s/%s/exports/%s/ldlm_stats"
+#define PROC_FS_LUSTRE_OST_EXPORTS      "fs/lustre/obdfilter/%s/exports"
+#define PROC_FS_LUSTRE_OST_EXPORT_STATS "fs/lustre/obdfilter/%s/exports/%s/stats"
+#define PROC_FS_LUSTRE_OST_EXPORT_LDLM_STATS \
+                                "fs/lustre/obdfilter/%s/exports/%s/ldlm_stats"
+
+#define PROC_FS_LUSTRE_LLITE_DIR        "fs/lustre/llite"
+#define DEBUGFS_LLITE_DIR               "kernel/debug/lustre/llite"
+#define PROC_FS_LUSTRE_LLITE_STATS      "%s/%s/stats"
+#define DEBUGFS_OSC_DIR                 "kernel/debug/lustre/osc"
+#define PROC_FS_LUSTRE_OSC_RPC_STATS    "fs/lustre/osc/%s/rpc_stats"
+#define DEBUGFS_OSC_RPC_STATS           "kernel/debug/lustre/osc/%s/rpc_stats"
+
+#define PROC_FS_LUSTRE_OSS_SVC          "fs/lustre/ost/OSS/%s/%s"
+#define DEBUGFS_OSS_SVC                 "kernel/debug/lustre/ost/OSS/%s/%s"
+#define PROC_FS_LUSTRE_MDS_SVC          "fs/lustre/mds/MDS/%s/%s"
+#define DEBUGFS_MDS_SVC                 "kernel/debug/lustre/mds/MDS/%s/%s"
 
 #define PROC_FS_LUSTRE_OST_BRW_STATS   "fs/lustre/obdfilter/%s/brw_stats"
 #define PROC_FS_LUSTRE_OSD_ZFS_BRW_STATS "fs/lustre/osd-zfs/%s/brw_stats"
 #define DEBUGFS_OST_BRW_STATS     "kernel/debug/lustre/osd-zfs/%s/brw_stats"
 
+#define PROC_FS_LUSTRE_OSD_ZFS_MNTDEV  "fs/lustre/osd-zfs/%s/mntdev"
+#define PROC_FS_LUSTRE_OSD_LDISKFS_MNTDEV "fs/lustre/osd-ldiskfs/%s/mntdev"
+#define PROC_FS_LUSTRE_1_8_OST_MNTDEV  "fs/lustre/obdfilter/%s/mntdev"
+
 #define PROC_FS_LUSTRE_OSD_LDISKFS_BRW_STATS "fs/lustre/osd-ldiskfs/%s/brw_stats"
 #define DEBUGFS_OST_LDISKFS_BRW_STATS     "kernel/debug/lustre/osd-ldiskfs/%s/brw_stats"
 
@@ -86,6 +108,9 @@
 #define PROC_FS_LUSTRE_MDT_RECOVERY_STATUS \
                                         "%s/recovery_status"
 
+#define PROC_FS_LUSTRE_OST_JOB_STATS    "fs/lustre/obdfilter/%s/job_stats"
+#define PROC_FS_LUSTRE_MDT_JOB_STATS    "%s/job_stats"
+
 #define PROC_FS_LUSTRE_OST_NUM_EXPORTS  "fs/lustre/obdfilter/%s/num_exports"
 #define PROC_FS_LUSTRE_MDT_NUM_EXPORTS  "%s/num_exports"
 
@@ -653,8 +678,12 @@ _cmp_subdir_entries (char *e1, char *e2)
     return strcmp (e1, e2);
 }
 
+/* List the subdirectories of path.  Client-instantiated osc's
+ * (e.g. lc1-OST0005-osc-ffff81007f018c00) are left out, or if clients
+ * is set, are the only ones listed.
+ */
 static int
-_subdirlist (pctx_t ctx, const char *path, List *lp)
+_dirlist (pctx_t ctx, const char *path, int clients, List *lp)
 {
     List l = list_create((ListDelF)free);
     int ret;
@@ -664,9 +693,9 @@ _subdirlist (pctx_t ctx, const char *path, List *lp)
     if ((ret = proc_open (ctx, path)) < 0)
         goto done;
     while ((ret = proc_readdir (ctx, PROC_READDIR_NOFILE, &name)) >= 0) {
-        if (strstr (name, "-osc-") && !strstr (name, "MDT"))
-            free (name);            /* ignore client-instantiated osc's */
-        else                        /*  e.g. lc1-OST0005-osc-ffff81007f018c00 */
+        if ((strstr (name, "-osc-") && !strstr (name, "MDT")) == !clients)
+            free (name);
+        else
             list_append (l, name);
     }
     if (ret < 0 && errno == 0) /* treat EOF as success */
@@ -682,6 +711,12 @@ done:
     return ret;
 }
 
+static int
+_subdirlist (pctx_t ctx, const char *path, List *lp)
+{
+    return _dirlist (ctx, path, 0, lp);
+}
+
 int
 proc_lustre_ostlist (pctx_t ctx, List *lp)
 {
@@ -718,6 +753,19 @@ proc_lustre_osclist (pctx_t ctx, List *lp)
     return _subdirlist (ctx, osc_dir, lp);
 }
 
+int
+proc_lustre_ost_exportlist (pctx_t ctx, char *name, List *lp)
+{
+    char export_path[256];
+
+    if (snprintf (export_path, sizeof (export_path), PROC_FS_LUSTRE_OST_EXPORTS,
+                  name) >= sizeof (export_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return _subdirlist (ctx, export_path, lp);
+}
+
 int
 proc_lustre_mdt_exportlist (pctx_t ctx, char *name, List *lp)
 {
@@ -1165,6 +1213,516 @@ done:
     return ret;
 }
 
+/* Return a pointer to the value following "key:" in a YAML flow mapping
+ * like "{ samples: 1, unit: bytes, sum: 4096 }", or NULL.
+ */
+static char *
+_flow_value (char *s, const char *key)
+{
+    int len = strlen (key);
+
+    while ((s = strstr (s, key))) {
+        if ((s[-1] == ' ' || s[-1] == '{') && s[len] == ':') {
+            s += len + 1;
+            while (isspace (*s))
+                s++;
+            return s;
+        }
+        s += len;
+    }
+    return NULL;
+}
+
+/* Parse one "  key: value" line of a job into j.
+ * Counters with unit bytes are read_bytes/write_bytes (read/write in
+ * early versions); the samples of everything else are requests.  Where
+ * both exist, read/write are latencies with one sample per RPC.
+ */
+static void
+_parse_jobstat_line (char *s, jobstat_t *j)
+{
+    char *key, *val, *unit;
+    uint64_t samples = 0, sum = 0;
+    int bytes;
+
+    while (isspace (*s))
+        s++;
+    key = s;
+    if (!(s = strchr (s, ':')))
+        return;
+    *s++ = '\0';
+    while (isspace (*s))
+        s++;
+    if (!strcmp (key, "snapshot_time")) {
+        j->snapshot_time = strtoull (s, NULL, 10);
+        return;
+    }
+    if (*s != '{')
+        return;
+    if ((val = _flow_value (s, "samples")))
+        samples = strtoull (val, NULL, 10);
+    if ((val = _flow_value (s, "sum")))
+        sum = strtoull (val, NULL, 10);
+    bytes = ((unit = _flow_value (s, "unit")) && !strncmp (unit, "bytes", 5));
+    if (bytes && (!strcmp (key, "read_bytes") || !strcmp (key, "read")))
+        j->read_bytes = sum;
+    else if (bytes && (!strcmp (key, "write_bytes") || !strcmp (key, "write")))
+        j->write_bytes = sum;
+    if (!bytes || !strcmp (key, "read") || !strcmp (key, "write"))
+        j->ops += samples;
+}
+
+/* Copy a job_id, which may be a quoted YAML scalar.
+ */
+static void
+_parse_jobid (char *s, jobstat_t *j)
+{
+    int i = 0, quoted = 0;
+
+    while (isspace (*s))
+        s++;
+    if (*s == '"') {
+        quoted = 1;
+        s++;
+    }
+    for (; *s && i < sizeof (j->job_id) - 1; s++) {
+        if (quoted && *s == '"')
+            break;
+        if (quoted && *s == '\\' && s[1])
+            s++;
+        else if (!quoted && isspace (*s))
+            break;
+        j->job_id[i++] = *s;
+    }
+    j->job_id[i] = '\0';
+}
+
+/* Stream the job_stats file of an OST or MDT, calling fn for each job.
+ * The file is a small subset of YAML: a "job_stats:" heading, then per
+ * job a "- job_id: ID" line followed by indented "key: value" lines.
+ * Only one job is held in memory at a time.  If fn returns -1, parsing
+ * stops and -1 is returned.
+ */
+int
+proc_lustre_jobstats (pctx_t ctx, char *name, jobstat_f fn, void *arg)
+{
+    char line[512];
+    char *tmpl = NULL;
+    jobstat_t j;
+    int injob = 0;
+    int ret = -1;
+
+    if (strstr (name, "-OST")) {
+        ret = proc_openf (ctx, PROC_FS_LUSTRE_OST_JOB_STATS, name);
+    } else if (strstr (name, "-MDT")) {
+        if ((ret = _build_mdt_path (ctx, PROC_FS_LUSTRE_MDT_JOB_STATS,
+                                    &tmpl)) < 0)
+            goto done;
+        ret = proc_openf (ctx, tmpl, name);
+    } else {
+        errno = EINVAL;
+    }
+    if (ret < 0)
+        goto done;
+    while ((ret = proc_gets (ctx, NULL, line, sizeof (line))) == 0) {
+        if (!strncmp (line, "- job_id:", 9)) {
+            if (injob && fn (&j, arg) < 0)
+                break;
+            memset (&j, 0, sizeof (j));
+            _parse_jobid (line + 9, &j);
+            injob = 1;
+        } else if (injob && isspace (line[0]))
+            _parse_jobstat_line (line, &j);
+    }
+    if (ret < 0 && errno == 0) { /* EOF */
+        ret = 0;
+        if (injob && fn (&j, arg) < 0)
+            ret = -1;
+    } else
+        ret = -1;
+    proc_close (ctx);
+done:
+    if (tmpl)
+        free (tmpl);
+    return ret;
+}
+
+/* Read the stats and ldlm_stats of one export of an OST or MDT into e.
+ * As in job_stats, samples of counters not in bytes are requests, but
+ * before read/write latencies were added (2.12) the read_bytes and
+ * write_bytes samples are the only count of bulk RPCs.  locks is the
+ * number of lock enqueues, or 0 if ldlm_stats is missing.
+ * Returns 1 on success, 0 if the client has since disconnected.
+ */
+static int
+_read_export (pctx_t ctx, char *mdt_dir, char *name, char *nid, expstat_t *e)
+{
+    char line[256], key[64], unit[16];
+    uint64_t samples, sum, rw_samples = 0;
+    int latency = 0;
+    int ret;
+
+    memset (e, 0, sizeof (*e));
+    snprintf (e->nid, sizeof (e->nid), "%s", nid);
+    if (mdt_dir)
+        ret = proc_openf (ctx, PROC_FS_LUSTRE_MDT_EXPORT_STATS, mdt_dir,
+                          name, nid);
+    else
+        ret = proc_openf (ctx, PROC_FS_LUSTRE_OST_EXPORT_STATS, name, nid);
+    if (ret < 0)
+        return errno == ENOENT ? 0 : -1;
+    while ((ret = proc_gets (ctx, NULL, line, sizeof (line))) == 0) {
+        sum = 0;
+        if (sscanf (line, "%63s %"PRIu64" samples [%15[^]]] %*u %*u %"PRIu64,
+                    key, &samples, unit, &sum) < 3)
+            continue; /* e.g. snapshot_time */
+        if (!strcmp (unit, "bytes")) {
+            if (!strcmp (key, "read_bytes"))
+                e->read_bytes = sum;
+            else if (!strcmp (key, "write_bytes"))
+                e->write_bytes = sum;
+            rw_samples += samples;
+        } else {
+            if (!strcmp (key, "read") || !strcmp (key, "write"))
+                latency = 1;
+            e->ops += samples;
+        }
+    }
+    proc_close (ctx);
+    if (!(ret < 0 && errno == 0))
+        return -1;
+    if (!latency)
+        e->ops += rw_samples;
+
+    if (mdt_dir)
+        ret = proc_openf (ctx, PROC_FS_LUSTRE_MDT_EXPORT_LDLM_STATS, mdt_dir,
+                          name, nid);
+    else
+        ret = proc_openf (ctx, PROC_FS_LUSTRE_OST_EXPORT_LDLM_STATS, name,
+                          nid);
+    if (ret == 0) {
+        while (proc_gets (ctx, NULL, line, sizeof (line)) == 0)
+            if (sscanf (line, "ldlm_enqueue %"PRIu64" samples",
+                        &e->locks) == 1)
+                break;
+        proc_close (ctx);
+    }
+    return 1;
+}
+
+/* Call fn for each client export of an OST or MDT.  Only one export is
+ * held in memory at a time.  If fn returns -1, -1 is returned.
+ */
+int
+proc_lustre_exportstats (pctx_t ctx, char *name, expstat_f fn, void *arg)
+{
+    List l = NULL;
+    ListIterator itr = NULL;
+    char *nid, *mdt_dir = NULL;
+    expstat_t e;
+    int ret = -1;
+
+    if (strstr (name, "-OST")) {
+        ret = proc_lustre_ost_exportlist (ctx, name, &l);
+    } else if (strstr (name, "-MDT")) {
+        mdt_dir = _find_mdt_dir (ctx);
+        ret = proc_lustre_mdt_exportlist (ctx, name, &l);
+    } else {
+        errno = EINVAL;
+    }
+    if (ret < 0)
+        goto done;
+    itr = list_iterator_create (l);
+    while ((nid = list_next (itr))) {
+        if ((ret = _read_export (ctx, mdt_dir, name, nid, &e)) < 0)
+            goto done;
+        if (ret > 0 && fn (&e, arg) < 0) {
+            ret = -1;
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    if (itr)
+        list_iterator_destroy (itr);
+    if (l)
+        list_destroy (l);
+    return ret;
+}
+
+/* Add the llite stats of a client mount to c.  Counters in bytes are
+ * summed, open/close/getattr are counted by samples.
+ */
+static int
+_read_llite (pctx_t ctx, const char *llite_dir, clistat_t *c)
+{
+    char line[256], key[64], unit[16];
+    uint64_t samples, sum;
+    int ret;
+
+    if (proc_openf (ctx, PROC_FS_LUSTRE_LLITE_STATS, llite_dir, c->name) < 0)
+        return -1;
+    while ((ret = proc_gets (ctx, NULL, line, sizeof (line))) == 0) {
+        sum = 0;
+        if (sscanf (line, "%63s %"PRIu64" samples [%15[^]]] %*u %*u %"PRIu64,
+                    key, &samples, unit, &sum) < 3)
+            continue; /* e.g. snapshot_time */
+        if (!strcmp (key, "read_bytes"))
+            c->read_bytes = sum;
+        else if (!strcmp (key, "write_bytes"))
+            c->write_bytes = sum;
+        else if (!strcmp (key, "open"))
+            c->open = samples;
+        else if (!strcmp (key, "close"))
+            c->close = samples;
+        else if (!strcmp (key, "getattr"))
+            c->getattr = samples;
+    }
+    proc_close (ctx);
+    return (ret < 0 && errno == 0) ? 0 : -1;
+}
+
+/* Parse a "pages: read_rpcs % cum% | write_rpcs % cum%" histogram line.
+ * This is done by hand as it is the bulk of lmt_client collection time.
+ */
+static int
+_parse_rpchist (char *s, uint64_t *pagesp, uint64_t *rp, uint64_t *wp)
+{
+    char *p;
+
+    *pagesp = strtoull (s, &p, 10);
+    if (p == s || *p != ':')
+        return -1;
+    *rp = strtoull (p + 1, &s, 10);
+    if (s == p + 1 || !(p = strchr (s, '|')))
+        return -1;
+    *wp = strtoull (p + 1, &s, 10);
+    if (s == p + 1)
+        return -1;
+    return 0;
+}
+
+/* Add the rpc_stats of a client osc to c.  The RPC and page counts are
+ * taken from the "pages per rpc" histogram, after which the rest of the
+ * file is not needed.  rpc_stats may be in debugfs even where the osc
+ * directories are in /proc or sysfs; *tmplp is switched to the debugfs
+ * path the first time it is found there.  An osc whose rpc_stats has
+ * gone away (e.g. unmounted since it was listed) is skipped.
+ */
+static int
+_read_rpcstats (pctx_t ctx, const char **tmplp, char *name, clistat_t *c)
+{
+    char line[256];
+    uint64_t pages, r, w, n;
+    int inpages = 0;
+    int ret;
+
+    if (proc_openf (ctx, *tmplp, name) < 0) {
+        if (errno != ENOENT || !strcmp (*tmplp, DEBUGFS_OSC_RPC_STATS))
+            return errno == ENOENT ? 0 : -1;
+        if (proc_openf (ctx, DEBUGFS_OSC_RPC_STATS, name) < 0)
+            return errno == ENOENT ? 0 : -1;
+        *tmplp = DEBUGFS_OSC_RPC_STATS;
+    }
+    while ((ret = proc_gets (ctx, NULL, line, sizeof (line))) == 0) {
+        if (inpages) {
+            if (_parse_rpchist (line, &pages, &r, &w) < 0)
+                break;
+            c->read_rpcs += r;
+            c->write_rpcs += w;
+            c->read_pages += r * pages;
+            c->write_pages += w * pages;
+        } else if (!strncmp (line, "pages per rpc", 13))
+            inpages = 1;
+        else if ((!strncmp (line, "read RPCs", 9)
+                    || !strncmp (line, "write RPCs", 10))
+                && sscanf (line, "%*s RPCs in flight: %"PRIu64, &n) == 1)
+            c->in_flight += n;
+    }
+    proc_close (ctx);
+    return (ret == 0 || errno == 0) ? 0 : -1;
+}
+
+/* True if osc (e.g. lc1-OST0005-osc-ffff81007f018c00) belongs to the
+ * client mount llite (e.g. lc1-ffff81007f018c00).
+ */
+static int
+_osc_of_mount (const char *osc, const char *llite)
+{
+    const char *inst = strrchr (llite, '-');
+    int fslen, n;
+
+    if (!inst)
+        return 0;
+    fslen = inst - llite;
+    n = strlen (osc) - strlen (inst);
+    return n > fslen && !strncmp (osc, llite, fslen + 1)
+                     && !strcmp (osc + n, inst)
+                     && n >= 4 && !strncmp (osc + n - 4, "-osc", 4);
+}
+
+/* Call fn for each lustre client mount on this node.  Returns -1 with
+ * errno ENOENT if there are none.
+ */
+int
+proc_lustre_clientstats (pctx_t ctx, clistat_f fn, void *arg)
+{
+    List llites = NULL, oscs = NULL;
+    ListIterator itr = NULL, oitr = NULL;
+    const char *llite_dir, *osc_dir, *rpc_tmpl;
+    char *name, *osc;
+    clistat_t c;
+    int ret = -1;
+
+    if (proc_exists (ctx, PROC_FS_LUSTRE_LLITE_DIR) == 0)
+        llite_dir = PROC_FS_LUSTRE_LLITE_DIR;
+    else
+        llite_dir = DEBUGFS_LLITE_DIR;
+    if (_subdirlist (ctx, llite_dir, &llites) < 0)
+        goto done;
+    if (proc_exists (ctx, PROC_FS_LUSTRE_OSC_DIR) == 0) {
+        osc_dir = PROC_FS_LUSTRE_OSC_DIR;
+        rpc_tmpl = PROC_FS_LUSTRE_OSC_RPC_STATS;
+    } else {
+        osc_dir = DEBUGFS_OSC_DIR;
+        rpc_tmpl = DEBUGFS_OSC_RPC_STATS;
+    }
+    if (_dirlist (ctx, osc_dir, 1, &oscs) < 0)
+        oscs = list_create ((ListDelF)free); /* no osc's, e.g. in recovery */
+    itr = list_iterator_create (llites);
+    oitr = list_iterator_create (oscs);
+    while ((name = list_next (itr))) {
+        memset (&c, 0, sizeof (c));
+        snprintf (c.name, sizeof (c.name), "%s", name);
+        if (_read_llite (ctx, llite_dir, &c) < 0) {
+            if (errno == ENOENT)
+                continue; /* unmounted since listed */
+            goto done;
+        }
+        list_iterator_reset (oitr);
+        while ((osc = list_next (oitr)))
+            if (_osc_of_mount (osc, name)
+                    && _read_rpcstats (ctx, &rpc_tmpl, osc, &c) < 0)
+                goto done;
+        if (fn (&c, arg) < 0)
+            goto done;
+    }
+    ret = 0;
+done:
+    if (oitr)
+        list_iterator_destroy (oitr);
+    if (itr)
+        list_iterator_destroy (itr);
+    if (oscs)
+        list_destroy (oscs);
+    if (llites)
+        list_destroy (llites);
+    return ret;
+}
+
+/* mntdev of an osd-zfs target is "pool/dataset".
+ */
+int
+proc_lustre_zfs_pool (pctx_t ctx, char *name, char **poolp)
+{
+    char s[256], *p;
+    int ret;
+
+    if ((ret = proc_openf (ctx, PROC_FS_LUSTRE_OSD_ZFS_MNTDEV, name)) < 0)
+        goto done;
+    if (proc_scanf (ctx, NULL, "%255s", s) != 1) {
+        errno = EIO;
+        ret = -1;
+    }
+    proc_close (ctx);
+    if (ret == 0) {
+        if ((p = strchr (s, '/')))
+            *p = '\0';
+        if (!(*poolp = strdup (s)))
+            msg_exit ("out of memory");
+    }
+done:
+    return ret;
+}
+
+/* mntdev of an ldiskfs target is its block device.  Before 2.4 it was
+ * reported by obdfilter.
+ */
+int
+proc_lustre_ldiskfs_dev (pctx_t ctx, char *name, char **devp)
+{
+    char s[256];
+    int ret;
+
+    if ((ret = proc_openf (ctx, PROC_FS_LUSTRE_OSD_LDISKFS_MNTDEV, name)) < 0
+        && (ret = proc_openf (ctx, PROC_FS_LUSTRE_1_8_OST_MNTDEV, name)) < 0)
+        goto done;
+    if (proc_scanf (ctx, NULL, "%255s", s) != 1) {
+        errno = EIO;
+        ret = -1;
+    }
+    proc_close (ctx);
+    /* zfs targets show up under obdfilter too */
+    if (ret == 0 && s[0] != '/') {
+        errno = ENOENT;
+        ret = -1;
+    }
+    if (ret == 0) {
+        if (!(*devp = strdup (s)))
+            msg_exit ("out of memory");
+    }
+done:
+    return ret;
+}
+
+/* Read the stats of ptlrpc service svc.  OSS services are named ost*,
+ * the rest are MDS services.  The stats file moved to debugfs in 2.15
+ * while the thread counts went to sysfs; the latter are optional.
+ * Returns -1 with errno ENOENT if the service is not running here.
+ */
+int
+proc_lustre_svcstats (pctx_t ctx, const char *svc, svcstat_t *sp)
+{
+    int oss = !strncmp (svc, "ost", 3);
+    hash_t h = NULL;
+    int ret;
+
+    memset (sp, 0, sizeof (*sp));
+    ret = proc_openf (ctx, oss ? PROC_FS_LUSTRE_OSS_SVC
+                               : PROC_FS_LUSTRE_MDS_SVC, svc, "stats");
+    if (ret < 0 && errno == ENOENT)
+        ret = proc_openf (ctx, oss ? DEBUGFS_OSS_SVC : DEBUGFS_MDS_SVC,
+                          svc, "stats");
+    if (ret < 0)
+        goto done;
+    h = hash_create (STATS_HASH_SIZE, (hash_key_f)hash_key_string,
+                    (hash_cmp_f)strcmp, (hash_del_f)_destroy_shash);
+    ret = _hash_stats (ctx, h);
+    proc_close (ctx);
+    if (ret < 0)
+        goto done;
+    proc_lustre_parsestat (h, "req_waittime", &sp->reqs, NULL, NULL,
+                           &sp->wait_usecs, NULL);
+    proc_lustre_parsestat (h, "req_qdepth", NULL, NULL, NULL,
+                           &sp->qdepth, NULL);
+    proc_lustre_parsestat (h, "req_active", NULL, NULL, NULL,
+                           &sp->active, NULL);
+    if (proc_openf (ctx, oss ? PROC_FS_LUSTRE_OSS_SVC : PROC_FS_LUSTRE_MDS_SVC,
+                    svc, "threads_started") == 0) {
+        (void)proc_scanf (ctx, NULL, "%"PRIu64, &sp->threads_started);
+        proc_close (ctx);
+    }
+    if (proc_openf (ctx, oss ? PROC_FS_LUSTRE_OSS_SVC : PROC_FS_LUSTRE_MDS_SVC,
+                    svc, "threads_max") == 0) {
+        (void)proc_scanf (ctx, NULL, "%"PRIu64, &sp->threads_max);
+        proc_close (ctx);
+    }
+done:
+    if (h)
+        hash_destroy (h);
+    return ret;
+}
+
 int
 proc_lustre_lnet_newbytes (pctx_t ctx, uint64_t *valp)
 {
@@ -2,6 +2,7 @@ int proc_lustre_ostlist (pctx_t ctx, List *lp);
 int proc_lustre_mdtlist (pctx_t ctx, List *lp);
 int proc_lustre_osclist (pctx_t ctx, List *lp);
 int proc_lustre_mdt_exportlist (pctx_t ctx, char *name, List *lp);
+int proc_lustre_ost_exportlist (pctx_t ctx, char *name, List *lp);
 
 
 int proc_lustre_files (pctx_t ctx, char *name, uint64_t *fp, uint64_t *tp);
@@ -45,6 +46,88 @@ int proc_lustre_hashstats (pctx_t ctx, char *name, hash_t *hp);
 
 int proc_lustre_hashrecov (pctx_t ctx, char *name, hash_t *hp);
 
+/* One job from an OST or MDT job_stats file.  Counters are cumulative
+ * since the job was first seen by the target.  ops is the number of
+ * requests of any kind.
+ */
+typedef struct {
+    char job_id[64];
+    uint64_t snapshot_time;
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t ops;
+} jobstat_t;
+
+typedef int (*jobstat_f) (jobstat_t *j, void *arg);
+
+int proc_lustre_jobstats (pctx_t ctx, char *name, jobstat_f fn, void *arg);
+
+/* One client export of an OST or MDT.  Counters are cumulative since
+ * the client connected.  ops is the number of requests of any kind and
+ * locks the number of lock enqueues.
+ */
+typedef struct {
+    char nid[64];
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t ops;
+    uint64_t locks;
+} expstat_t;
+
+typedef int (*expstat_f) (expstat_t *e, void *arg);
+
+int proc_lustre_exportstats (pctx_t ctx, char *name, expstat_f fn, void *arg);
+
+/* One lustre client mount.  Counters are cumulative since the mount.
+ * The RPC and page counts are summed over the mount's osc's from their
+ * "pages per rpc" histograms, and in_flight is the number of read and
+ * write RPCs in flight now.
+ */
+typedef struct {
+    char name[64];              /* llite instance, e.g. lc1-ffff81007f018c00 */
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t open;
+    uint64_t close;
+    uint64_t getattr;
+    uint64_t read_rpcs;
+    uint64_t write_rpcs;
+    uint64_t read_pages;
+    uint64_t write_pages;
+    uint64_t in_flight;
+} clistat_t;
+
+typedef int (*clistat_f) (clistat_t *c, void *arg);
+
+int proc_lustre_clientstats (pctx_t ctx, clistat_f fn, void *arg);
+
+/* One ptlrpc service (e.g. ost_io, mdt) of an OSS or MDS.  Counters are
+ * cumulative since the service started: reqs is the number of requests
+ * handled, and wait_usecs, qdepth and active are the sums over those
+ * requests of the time spent queued, the queue depth and the number of
+ * requests being serviced at arrival.
+ */
+typedef struct {
+    uint64_t reqs;
+    uint64_t wait_usecs;
+    uint64_t qdepth;
+    uint64_t active;
+    uint64_t threads_started;
+    uint64_t threads_max;
+} svcstat_t;
+
+int proc_lustre_svcstats (pctx_t ctx, const char *svc, svcstat_t *sp);
+
+/* Return the name of the zpool backing an osd-zfs target (free with
+ * free ()).  Fails with ENOENT if the target is not on ZFS.
+ */
+int proc_lustre_zfs_pool (pctx_t ctx, char *name, char **poolp);
+
+/* Return the block device (e.g. /dev/sdb) of an ldiskfs target (free
+ * with free ()).  Fails with ENOENT if the target is not on ldiskfs.
+ */
+int proc_lustre_ldiskfs_dev (pctx_t ctx, char *name, char **devp);
+
 typedef enum {
     BRW_RPC, BRW_DISPAGES, BRW_DISBLOCKS, BRW_FRAG, BRW_FLIGHT, BRW_IOTIME,
     BRW_IOSIZE,
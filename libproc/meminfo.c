@@ -24,6 +24,9 @@
 
 #include <errno.h>
 #include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "proc.h"
 #include "meminfo.h"
@@ -57,6 +60,51 @@ error:
     return ret;
 }
 
+static struct {
+    const char *key;
+    size_t off;
+} memtab[] = {
+    { "MemTotal",       offsetof (meminfo_t, total) },
+    { "MemFree",        offsetof (meminfo_t, free) },
+    { "Buffers",        offsetof (meminfo_t, buffers) },
+    { "Cached",         offsetof (meminfo_t, cached) },
+    { "Slab",           offsetof (meminfo_t, slab) },
+    { "Dirty",          offsetof (meminfo_t, dirty) },
+    { "Writeback",      offsetof (meminfo_t, writeback) },
+};
+static const int memtablen = sizeof (memtab) / sizeof (memtab[0]);
+
+/* Read the values in memtab from /proc/meminfo in one pass:
+ *    MemTotal:       16317004 kB
+ */
+int
+proc_meminfo2 (pctx_t ctx, meminfo_t *mp)
+{
+    char buf[128], key[64];
+    uint64_t val;
+    int i;
+
+    memset (mp, 0, sizeof (*mp));
+    if (proc_open (ctx, PROC_MEMINFO) < 0)
+        return -1;
+    while (proc_gets (ctx, NULL, buf, sizeof (buf)) == 0) {
+        if (sscanf (buf, "%63[^:]: %"PRIu64, key, &val) != 2)
+            continue;
+        for (i = 0; i < memtablen; i++) {
+            if (!strcmp (key, memtab[i].key)) {
+                *(uint64_t *)((char *)mp + memtab[i].off) = val;
+                break;
+            }
+        }
+    }
+    proc_close (ctx);
+    if (mp->total == 0) {
+        errno = EIO;
+        return -1;
+    }
+    return 0;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -1,5 +1,20 @@
 int proc_meminfo (pctx_t ctx, uint64_t *ktotp, uint64_t *kfreep);
 
+/* Selected /proc/meminfo values (kilobytes).  Fields missing from older
+ * kernels are zero.
+ */
+typedef struct {
+    uint64_t total;
+    uint64_t free;
+    uint64_t buffers;
+    uint64_t cached;            /* page cache */
+    uint64_t slab;
+    uint64_t dirty;             /* waiting to be written back */
+    uint64_t writeback;         /* being written back */
+} meminfo_t;
+
+int proc_meminfo2 (pctx_t ctx, meminfo_t *mp);
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -0,0 +1,261 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h> /* PATH_MAX */
+
+#include "list.h"
+#include "error.h"
+
+#include "proc.h"
+#include "netdev.h"
+
+#define PROC_NET_DEV            "net/dev"
+#define SYS_NET_OPERSTATE       "class/net/%s/operstate"
+#define SYS_NET_SPEED           "class/net/%s/speed"
+#define SYS_NET_TYPE            "class/net/%s/type"
+#define SYS_NET_MASTER          "class/net/%s/master"
+
+#define SYS_IB_DIR              "class/infiniband"
+#define SYS_IB_PORTS_DIR        "class/infiniband/%s/ports"
+#define SYS_IB_PORT_STATE       "class/infiniband/%s/ports/%s/state"
+#define SYS_IB_PORT_RATE        "class/infiniband/%s/ports/%s/rate"
+#define SYS_IB_PORT_COUNTER     "class/infiniband/%s/ports/%s/counters/%s"
+
+#define ARPHRD_INFINIBAND_TYPE  32      /* see <net/if_arp.h> */
+#define IB_PORT_ACTIVE          4
+
+static netdev_t *
+_create_netdev (const char *name)
+{
+    netdev_t *n = malloc (sizeof (*n));
+
+    if (!n)
+        msg_exit ("out of memory");
+    memset (n, 0, sizeof (*n));
+    snprintf (n->name, sizeof (n->name), "%s", name);
+    return n;
+}
+
+static int
+_read_u64 (pctx_t ctx, const char *path, uint64_t *vp)
+{
+    int n = proc_scanf (ctx, path, "%"PRIu64, vp);
+
+    if (n < 0)
+        return -1;
+    if (n != 1) {
+        errno = EIO;
+        return -1;
+    }
+    return 0;
+}
+
+static void
+_append_subdirs (pctx_t ctx, const char *path, List l)
+{
+    char *name;
+
+    if (proc_open (ctx, path) < 0)
+        return;
+    while (proc_readdir (ctx, PROC_READDIR_NOFILE, &name) >= 0)
+        list_append (l, name);
+    proc_close (ctx);
+}
+
+/* Fill in link state and speed of an ethernet-like interface from sysfs.
+ * Return -1 if the interface should not be reported: IPoIB interfaces
+ * are covered by the HCA port counters, and bonding slaves by their
+ * master.
+ */
+static int
+_net_sysfs (pctx_t ctx, netdev_t *n)
+{
+    char path[PATH_MAX];
+    char state[16];
+    uint64_t val;
+
+    snprintf (path, sizeof (path), SYS_NET_TYPE, n->name);
+    if (_read_u64 (ctx, path, &val) == 0 && val == ARPHRD_INFINIBAND_TYPE)
+        return -1;
+    snprintf (path, sizeof (path), SYS_NET_MASTER, n->name);
+    if (proc_exists (ctx, path) == 0)
+        return -1;
+    snprintf (path, sizeof (path), SYS_NET_OPERSTATE, n->name);
+    if (proc_gets (ctx, path, state, sizeof (state)) == 0)
+        n->link = (!strcmp (state, "up") || !strcmp (state, "unknown"));
+    /* speed reads as -1 or fails with EINVAL when the link is down */
+    snprintf (path, sizeof (path), SYS_NET_SPEED, n->name);
+    if (n->link && proc_scanf (ctx, path, "%"SCNd64, (int64_t *)&val) == 1
+                && (int64_t)val > 0)
+        n->rate = val;
+    return 0;
+}
+
+/* Parse /proc/net/dev:
+ *   Inter-|   Receive                          |  Transmit
+ *    face |bytes packets errs drop fifo frame ...|bytes packets errs ...
+ *     eth0: 1234 5 0 0 0 0 0 0 5678 9 0 0 0 0 0 0
+ */
+static int
+_read_net_dev (pctx_t ctx, List l)
+{
+    List tmp = list_create ((ListDelF)free);
+    ListIterator itr;
+    char buf[512], *name, *p;
+    uint64_t rxb, rxe, txb, txe;
+    netdev_t *n;
+    int ret = -1;
+
+    if (proc_open (ctx, PROC_NET_DEV) < 0)
+        goto done;
+    while (proc_gets (ctx, NULL, buf, sizeof (buf)) == 0) {
+        if (!(p = strchr (buf, ':')))
+            continue; /* header */
+        *p++ = '\0';
+        name = buf + strspn (buf, " ");
+        if (sscanf (p, " %"PRIu64" %*s %"PRIu64" %*s %*s %*s %*s %*s"
+                       " %"PRIu64" %*s %"PRIu64,
+                    &rxb, &rxe, &txb, &txe) != 4) {
+            proc_close (ctx);
+            errno = EIO;
+            goto done;
+        }
+        if (!strcmp (name, "lo"))
+            continue;
+        n = _create_netdev (name);
+        n->rx_bytes = rxb;
+        n->tx_bytes = txb;
+        n->errors = rxe + txe;
+        list_append (tmp, n);
+    }
+    proc_close (ctx);
+
+    /* N.B. sysfs lookups need the proc context, so do them after close */
+    itr = list_iterator_create (tmp);
+    while ((n = list_next (itr))) {
+        if (_net_sysfs (ctx, n) == 0)
+            list_append (l, list_remove (itr));
+    }
+    list_iterator_destroy (itr);
+    ret = 0;
+done:
+    list_destroy (tmp);
+    return ret;
+}
+
+static void
+_read_ib_port (pctx_t ctx, const char *hca, const char *port, List l)
+{
+    char path[PATH_MAX];
+    char name[NETDEV_NAME_SIZE];
+    uint64_t rcv, xmit, rcv_err = 0, xmit_discard = 0;
+    double gbps;
+    int state;
+    netdev_t *n;
+
+    /* port_{rcv,xmit}_data count octets divided by 4 */
+    snprintf (path, sizeof (path), SYS_IB_PORT_COUNTER, hca, port,
+              "port_rcv_data");
+    if (_read_u64 (ctx, path, &rcv) < 0)
+        return;
+    snprintf (path, sizeof (path), SYS_IB_PORT_COUNTER, hca, port,
+              "port_xmit_data");
+    if (_read_u64 (ctx, path, &xmit) < 0)
+        return;
+    snprintf (path, sizeof (path), SYS_IB_PORT_COUNTER, hca, port,
+              "port_rcv_errors");
+    (void)_read_u64 (ctx, path, &rcv_err);
+    snprintf (path, sizeof (path), SYS_IB_PORT_COUNTER, hca, port,
+              "port_xmit_discards");
+    (void)_read_u64 (ctx, path, &xmit_discard);
+
+    snprintf (name, sizeof (name), "%s:%s", hca, port);
+    n = _create_netdev (name);
+    n->rx_bytes = rcv * 4;
+    n->tx_bytes = xmit * 4;
+    n->errors = rcv_err + xmit_discard;
+
+    /* state: "4: ACTIVE", rate: "100 Gb/sec (4X EDR)" */
+    snprintf (path, sizeof (path), SYS_IB_PORT_STATE, hca, port);
+    if (proc_scanf (ctx, path, "%d", &state) == 1)
+        n->link = (state == IB_PORT_ACTIVE);
+    snprintf (path, sizeof (path), SYS_IB_PORT_RATE, hca, port);
+    if (n->link && proc_scanf (ctx, path, "%lf", &gbps) == 1)
+        n->rate = (uint64_t)(gbps * 1000);
+    list_append (l, n);
+}
+
+static void
+_read_ib (pctx_t ctx, List l)
+{
+    List hcas = list_create ((ListDelF)free);
+    List ports;
+    ListIterator itr, pitr;
+    char path[PATH_MAX];
+    char *hca, *port;
+
+    _append_subdirs (ctx, SYS_IB_DIR, hcas);
+    itr = list_iterator_create (hcas);
+    while ((hca = list_next (itr))) {
+        ports = list_create ((ListDelF)free);
+        snprintf (path, sizeof (path), SYS_IB_PORTS_DIR, hca);
+        _append_subdirs (ctx, path, ports);
+        pitr = list_iterator_create (ports);
+        while ((port = list_next (pitr)))
+            _read_ib_port (ctx, hca, port, l);
+        list_iterator_destroy (pitr);
+        list_destroy (ports);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (hcas);
+}
+
+static int
+_cmp_netdev (netdev_t *n1, netdev_t *n2)
+{
+    return strcmp (n1->name, n2->name);
+}
+
+int
+proc_netdev (pctx_t ctx, List *lp)
+{
+    List l = list_create ((ListDelF)free);
+
+    if (_read_net_dev (ctx, l) < 0) {
+        list_destroy (l);
+        return -1;
+    }
+    _read_ib (ctx, l);
+    list_sort (l, (ListCmpF)_cmp_netdev);
+    *lp = l;
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,20 @@
+#define NETDEV_NAME_SIZE    64
+
+typedef struct {
+    char name[NETDEV_NAME_SIZE];    /* ifname or hca:port */
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint64_t errors;                /* rx + tx errors (IB: discards) */
+    int link;                       /* 1 if link is up */
+    uint64_t rate;                  /* link speed in Mbit/s (0=unknown) */
+} netdev_t;
+
+/* Return a list of netdev_t (free with list_destroy) for the network
+ * interfaces in /proc/net/dev and the InfiniBand ports in sysfs.
+ * The loopback device, bonding slaves, and IPoIB interfaces are omitted.
+ */
+int proc_netdev (pctx_t ctx, List *lp);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
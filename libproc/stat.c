@@ -24,12 +24,19 @@
 
 #include <errno.h>
 #include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
 
 #include "proc.h"
 #include "stat.h"
 
 #define PROC_STAT   "stat"
 
+#define STAT_MAX_CPUS   65536
+
 /* Read the first line out of /proc/stat (aggregate cpu stats):
  *    cpu <usr> <nice> <sys> <idle> <iowait> <irq> <softirq> 0
  * See proc(5) for more info.
@@ -100,6 +107,126 @@ proc_stat2 (pctx_t ctx, uint64_t *usagep, uint64_t *totalp, double *pctp)
     return 0;
 }
 
+/* Read the cpu lines at the top of /proc/stat:
+ *    cpu <usr> <nice> <sys> <idle> <iowait> <irq> <softirq> ...
+ *    cpu0 <usr> <nice> <sys> <idle> <iowait> <irq> <softirq> ...
+ * stopping at the first other line, so the (long) intr line is not read.
+ */
+int
+proc_stat_cpus (pctx_t ctx, cpustat_t *allp, cpustat_t **cpup, int *ncpup)
+{
+    cpustat_t c, *cpu = NULL;
+    char buf[512], name[16], *end;
+    int n = 0, ret = -1;
+    long id;
+
+    if (proc_open (ctx, PROC_STAT) < 0)
+        return -1;
+    memset (allp, 0, sizeof (*allp));
+    while (proc_gets (ctx, NULL, buf, sizeof (buf)) == 0
+                                        && !strncmp (buf, "cpu", 3)) {
+        memset (&c, 0, sizeof (c));
+        if (sscanf (buf, "%15s %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64
+                    " %"PRIu64" %"PRIu64" %"PRIu64, name, &c.usr, &c.nice,
+                    &c.sys, &c.idle, &c.iowait, &c.irq, &c.softirq) != 8) {
+            errno = EIO;
+            goto done;
+        }
+        c.online = 1;
+        if (name[3] == '\0') {
+            *allp = c;
+            continue;
+        }
+        id = strtol (name + 3, &end, 10);
+        if (*end != '\0' || id < 0 || id >= STAT_MAX_CPUS) {
+            errno = EIO;
+            goto done;
+        }
+        if (id >= n) {
+            if (!(cpu = realloc (cpu, (id + 1) * sizeof (*cpu))))
+                msg_exit ("out of memory");
+            memset (cpu + n, 0, (id + 1 - n) * sizeof (*cpu));
+            n = id + 1;
+        }
+        cpu[id] = c;
+    }
+    if (!allp->online) {
+        errno = EIO;
+        goto done;
+    }
+    *cpup = cpu;
+    *ncpup = n;
+    ret = 0;
+done:
+    proc_close (ctx);
+    if (ret < 0 && cpu)
+        free (cpu);
+    return ret;
+}
+
+static uint64_t
+_busy (cpustat_t *c)
+{
+    return c->usr + c->nice + c->sys + c->irq + c->softirq;
+}
+
+static uint64_t
+_total (cpustat_t *c)
+{
+    return _busy (c) + c->idle + c->iowait;
+}
+
+/* N.B. iowait can go backwards on tickless kernels.
+ */
+static uint64_t
+_delta (uint64_t new, uint64_t old)
+{
+    return new > old ? new - old : 0;
+}
+
+static double
+_pct (uint64_t n, uint64_t total)
+{
+    return total > 0 ? (double)n / total * 100.0 : 0;
+}
+
+int
+proc_stat3 (pctx_t ctx, cpustate_t *sp, cpuusage_t *up)
+{
+    cpustat_t all, *cpu, zero, *o;
+    uint64_t total;
+    double pct;
+    int i, n;
+
+    if (proc_stat_cpus (ctx, &all, &cpu, &n) < 0)
+        return -1;
+    memset (up, 0, sizeof (*up));
+    memset (&zero, 0, sizeof (zero));
+
+    total = _delta (_total (&all), _total (&sp->all));
+    up->pct_cpu = _pct (_delta (_busy (&all), _busy (&sp->all)), total);
+    up->pct_iowait = _pct (_delta (all.iowait, sp->all.iowait), total);
+    up->pct_softirq = _pct (_delta (all.softirq, sp->all.softirq), total);
+    for (i = 0; i < n; i++) {
+        if (!cpu[i].online)
+            continue;
+        up->ncpu++;
+        /* a cpu that was offline last time is measured since boot */
+        o = i < sp->ncpu && sp->cpu[i].online ? &sp->cpu[i] : &zero;
+        pct = _pct (_delta (_busy (&cpu[i]), _busy (o)),
+                    _delta (_total (&cpu[i]), _total (o)));
+        if (pct > up->pct_maxcpu)
+            up->pct_maxcpu = pct;
+    }
+
+    if (sp->cpu)
+        free (sp->cpu);
+    sp->all = all;
+    sp->cpu = cpu;
+    sp->ncpu = n;
+    return 0;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -3,6 +3,40 @@ int proc_stat (pctx_t ctx, uint64_t *usrp, uint64_t *nicep, uint64_t *sysp,
                uint64_t *softirqp);
 int proc_stat2 (pctx_t ctx, uint64_t *usagep, uint64_t *totalp, double *pctp);
 
+/* Jiffies spent in each state by one cpu, or by all of them.
+ */
+typedef struct {
+    uint64_t usr, nice, sys, idle, iowait, irq, softirq;
+    int online;
+} cpustat_t;
+
+/* Read the aggregate and per-cpu lines of /proc/stat in one pass.
+ * *cpup is an array of *ncpup cpustat_t indexed by cpu number, where
+ * offline cpus are not marked online (free with free ()).
+ */
+int proc_stat_cpus (pctx_t ctx, cpustat_t *allp, cpustat_t **cpup,
+                    int *ncpup);
+
+/* Counters saved by proc_stat3 () for the next call (zero initialize).
+ */
+typedef struct {
+    cpustat_t all;
+    cpustat_t *cpu;
+    int ncpu;
+} cpustate_t;
+
+typedef struct {
+    double pct_cpu;             /* all cpus, as computed by proc_stat2 () */
+    double pct_maxcpu;          /* busiest single cpu */
+    double pct_iowait;          /* share of cpu time spent in iowait */
+    double pct_softirq;         /* share of cpu time spent in softirq */
+    int ncpu;                   /* cpus online */
+} cpuusage_t;
+
+/* Like proc_stat2 (), but also break usage down by cpu and state.
+ */
+int proc_stat3 (pctx_t ctx, cpustate_t *sp, cpuusage_t *up);
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
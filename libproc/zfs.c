@@ -0,0 +1,214 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h> /* PATH_MAX */
+
+#include "proc.h"
+#include "zfs.h"
+
+#define SPL_KSTAT_ZFS_ARCSTATS  "spl/kstat/zfs/arcstats"
+#define SPL_KSTAT_ZFS_POOL      "spl/kstat/zfs/%s"
+#define SPL_KSTAT_ZFS_POOL_IO   "spl/kstat/zfs/%s/io"
+#define SPL_KSTAT_ZFS_POOL_TXGS "spl/kstat/zfs/%s/txgs"
+
+#define KSTAT_MAXCOLS           16
+#define KSTAT_LINE_SIZE         512
+
+typedef int (*kstat_row_f) (char **col, char **val, int ncol, void *arg);
+
+static int
+_split (char *s, char **v, int max)
+{
+    char *tok, *saveptr = NULL;
+    int n = 0;
+
+    while (n < max && (tok = strtok_r (s, " \t", &saveptr))) {
+        v[n++] = tok;
+        s = NULL;
+    }
+    return n;
+}
+
+/* Return the value of the named column of a kstat row as a uint64_t.
+ */
+static int
+_colval (char **col, char **val, int ncol, const char *name, uint64_t *vp)
+{
+    int i;
+
+    for (i = 0; i < ncol; i++) {
+        if (!strcmp (col[i], name)) {
+            *vp = strtoull (val[i], NULL, 10);
+            return 0;
+        }
+    }
+    errno = EIO;
+    return -1;
+}
+
+static const char *
+_colstr (char **col, char **val, int ncol, const char *name)
+{
+    int i;
+
+    for (i = 0; i < ncol; i++) {
+        if (!strcmp (col[i], name))
+            return val[i];
+    }
+    errno = EIO;
+    return NULL;
+}
+
+/* Parse an SPL kstat in one pass:
+ *   6 1 0x01 91 4368 6082594960 2459542735837    (kstat header)
+ *   name                            type data     (column names)
+ *   hits                            4    1234     (one row per line)
+ * and call fn for each row.  Columns are looked up by name, so the
+ * layout may vary between ZFS releases.
+ */
+static int
+_read_kstat (pctx_t ctx, const char *path, kstat_row_f fn, void *arg)
+{
+    char hdr[KSTAT_LINE_SIZE], buf[KSTAT_LINE_SIZE];
+    char *col[KSTAT_MAXCOLS], *val[KSTAT_MAXCOLS];
+    int kid, ktype, ncol, n;
+    int ret = -1;
+
+    if (proc_open (ctx, path) < 0)
+        return -1;
+    if (proc_gets (ctx, NULL, buf, sizeof (buf)) < 0
+            || sscanf (buf, "%d %d", &kid, &ktype) != 2
+            || proc_gets (ctx, NULL, hdr, sizeof (hdr)) < 0
+            || (ncol = _split (hdr, col, KSTAT_MAXCOLS)) == 0) {
+        errno = EIO;
+        goto done;
+    }
+    while (proc_gets (ctx, NULL, buf, sizeof (buf)) == 0) {
+        if ((n = _split (buf, val, KSTAT_MAXCOLS)) == 0)
+            continue;
+        if (n != ncol) {
+            errno = EIO;
+            goto done;
+        }
+        if (fn (col, val, ncol, arg) < 0)
+            goto done;
+    }
+    ret = 0;
+done:
+    proc_close (ctx);
+    return ret;
+}
+
+static int
+_arcstats_row (char **col, char **val, int ncol, void *arg)
+{
+    arcstat_t *a = arg;
+    const char *name;
+    uint64_t v;
+
+    if (!(name = _colstr (col, val, ncol, "name"))
+            || _colval (col, val, ncol, "data", &v) < 0)
+        return -1;
+    if (!strcmp (name, "hits"))
+        a->hits = v;
+    else if (!strcmp (name, "misses"))
+        a->misses = v;
+    else if (!strcmp (name, "size"))
+        a->size = v;
+    else if (!strcmp (name, "c_max"))
+        a->c_max = v;
+    return 0;
+}
+
+int
+proc_zfs_arcstats (pctx_t ctx, arcstat_t *ap)
+{
+    memset (ap, 0, sizeof (*ap));
+    return _read_kstat (ctx, SPL_KSTAT_ZFS_ARCSTATS, _arcstats_row, ap);
+}
+
+static int
+_io_row (char **col, char **val, int ncol, void *arg)
+{
+    zpoolstat_t *z = arg;
+
+    if (_colval (col, val, ncol, "nread", &z->nread) < 0
+            || _colval (col, val, ncol, "nwritten", &z->nwritten) < 0
+            || _colval (col, val, ncol, "reads", &z->reads) < 0
+            || _colval (col, val, ncol, "writes", &z->writes) < 0)
+        return -1;
+    return 0;
+}
+
+/* The txgs kstat is a history of recent txgs, oldest first.  Keep the
+ * newest one that has finished syncing (state C).
+ */
+static int
+_txgs_row (char **col, char **val, int ncol, void *arg)
+{
+    zpoolstat_t *z = arg;
+    const char *state;
+    uint64_t txg, stime;
+
+    if (!(state = _colstr (col, val, ncol, "state"))
+            || _colval (col, val, ncol, "txg", &txg) < 0
+            || _colval (col, val, ncol, "stime", &stime) < 0)
+        return -1;
+    if (!strcmp (state, "C") && txg > z->txg) {
+        z->txg = txg;
+        z->txg_sync_ns = stime;
+    }
+    return 0;
+}
+
+int
+proc_zfs_pool (pctx_t ctx, const char *pool, zpoolstat_t *zp)
+{
+    char path[PATH_MAX];
+
+    memset (zp, 0, sizeof (*zp));
+    snprintf (path, sizeof (path), SPL_KSTAT_ZFS_POOL, pool);
+    if (proc_exists (ctx, path) < 0) {
+        errno = ENOENT;
+        return -1;
+    }
+    snprintf (zp->name, sizeof (zp->name), "%s", pool);
+    snprintf (path, sizeof (path), SPL_KSTAT_ZFS_POOL_IO, pool);
+    if (proc_exists (ctx, path) == 0
+            && _read_kstat (ctx, path, _io_row, zp) < 0)
+        return -1;
+    snprintf (path, sizeof (path), SPL_KSTAT_ZFS_POOL_TXGS, pool);
+    if (proc_exists (ctx, path) == 0
+            && _read_kstat (ctx, path, _txgs_row, zp) < 0)
+        return -1;
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,34 @@
+#define ZPOOL_NAME_SIZE     256
+
+/* ZFS adaptive replacement cache counters from spl/kstat/zfs/arcstats.
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t size;                  /* current ARC size (bytes) */
+    uint64_t c_max;                 /* ARC size limit (bytes) */
+} arcstat_t;
+
+/* Per-pool counters from spl/kstat/zfs/<pool>/io and txgs.
+ * Either kstat may be missing depending on the ZFS release, in which
+ * case its fields are zero.
+ */
+typedef struct {
+    char name[ZPOOL_NAME_SIZE];
+    uint64_t nread;                 /* bytes read */
+    uint64_t nwritten;              /* bytes written */
+    uint64_t reads;                 /* read operations */
+    uint64_t writes;                /* write operations */
+    uint64_t txg;                   /* newest committed txg (0 if none) */
+    uint64_t txg_sync_ns;           /* time spent syncing it */
+} zpoolstat_t;
+
+int proc_zfs_arcstats (pctx_t ctx, arcstat_t *ap);
+
+/* Fails with ENOENT if the pool has no kstats.
+ */
+int proc_zfs_pool (pctx_t ctx, const char *pool, zpoolstat_t *zp);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
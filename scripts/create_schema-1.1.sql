@@ -223,6 +223,16 @@ create table ROUTER_DATA (
     index(ROUTER_ID),
     index(TS_ID)
     ) MAX_ROWS=2000000000;
+create table ROUTER_GROUP_DATA (
+    ROUTER_GROUP_ID integer         not null comment 'ROUTER GROUP ID',
+    TS_ID           int unsigned    not null comment 'TS ID',
+    BYTES           bigint                   comment 'BYTES',
+    NUM_ROUTERS     integer                  comment 'ROUTERS',
+    primary key (ROUTER_GROUP_ID,TS_ID),
+    foreign key(TS_ID) references TIMESTAMP_INFO(TS_ID),
+    index(ROUTER_GROUP_ID),
+    index(TS_ID)
+    ) MAX_ROWS=2000000000;
 create table EVENT_DATA (
     EVENT_ID        integer         not null,
     TS_ID           int unsigned    not null comment 'TS ID',
@@ -325,6 +335,23 @@ create table OST_AGGREGATE_YEAR (
     index(TS_ID),
     index(VARIABLE_ID)
 );
+create table OST_OPS_AGGREGATE_HOUR (
+    OST_ID          integer         not null,
+    TS_ID           int unsigned    not null,
+    OPERATION_ID    integer         not null,
+    AGGREGATE       float,
+    MINVAL          float,
+    MAXVAL          float,
+    AVERAGE         float,
+    NUM_SAMPLES     integer,
+    primary key (OST_ID,TS_ID,OPERATION_ID),
+    foreign key(OST_ID) references OST_INFO(OST_ID),
+    foreign key(TS_ID) references TIMESTAMP_INFO(TS_ID),
+    foreign key(OPERATION_ID) references OPERATION_INFO(OPERATION_ID),
+    index(OST_ID),
+    index(TS_ID),
+    index(OPERATION_ID)
+    ) MAX_ROWS=2000000000;
 create table ROUTER_AGGREGATE_HOUR (
     ROUTER_ID       integer         not null,
     TS_ID           int unsigned    not null,
@@ -659,6 +686,9 @@ insert into OPERATION_INFO (OPERATION_NAME, UNITS) values ('register_lock_cancel
 insert into OPERATION_INFO (OPERATION_NAME, UNITS) values ('unregister_lock_cancel_cb', 'reqs');
 insert into OPERATION_INFO (OPERATION_NAME, UNITS) values ('read_bytes', 'reqs');
 insert into OPERATION_INFO (OPERATION_NAME, UNITS) values ('write_bytes', 'reqs');
+insert into OPERATION_INFO (OPERATION_NAME, UNITS) values ('read', 'reqs');
+insert into OPERATION_INFO (OPERATION_NAME, UNITS) values ('write', 'reqs');
+insert into OPERATION_INFO (OPERATION_NAME, UNITS) values ('set_info', 'reqs');
 insert into OSS_VARIABLE_INFO (VARIABLE_NAME,VARIABLE_LABEL,THRESH_TYPE) values ('PCT_MEM','%Mem', 0);
 insert into OSS_VARIABLE_INFO (VARIABLE_NAME,VARIABLE_LABEL,THRESH_TYPE) values ('READ_RATE','Read Rate', 0);
 insert into OSS_VARIABLE_INFO (VARIABLE_NAME,VARIABLE_LABEL,THRESH_TYPE) values ('WRITE_RATE','Write Rate', 0);
@@ -688,6 +718,11 @@ insert into ROUTER_VARIABLE_INFO (VARIABLE_NAME,VARIABLE_LABEL,THRESH_TYPE) valu
 insert into ROUTER_VARIABLE_INFO (VARIABLE_NAME,VARIABLE_LABEL,THRESH_TYPE) values ('RATE', 'Rate', 0);
 insert into ROUTER_VARIABLE_INFO (VARIABLE_NAME,VARIABLE_LABEL,THRESH_TYPE) values ('BANDWIDTH','Bandwidth', 0);
 insert into ROUTER_VARIABLE_INFO (VARIABLE_NAME,VARIABLE_LABEL,THRESH_TYPE, THRESH_VAL1, THRESH_VAL2) values ('PCT_CPU', '%CPU', 3, 90., 101.);
+insert into EVENT_INFO (EVENT_NAME) values ('RECOVERY_START');
+insert into EVENT_INFO (EVENT_NAME) values ('RECOVERY_END');
+insert into EVENT_INFO (EVENT_NAME) values ('FAILOVER');
+insert into EVENT_INFO (EVENT_NAME) values ('FAILBACK');
+insert into EVENT_INFO (EVENT_NAME) values ('OSC_STATE');
 #
 # LMT2 SCHEMA 1.1 - end
 #
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* tclientstats.c - test parsing of lustre client llite and osc stats */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+#include "lustre.h"
+
+static int
+print_client (clistat_t *c, void *arg)
+{
+    msg ("%s: read_bytes=%"PRIu64" write_bytes=%"PRIu64" open=%"PRIu64
+         " close=%"PRIu64" getattr=%"PRIu64, c->name, c->read_bytes,
+         c->write_bytes, c->open, c->close, c->getattr);
+    msg ("%s: read_rpcs=%"PRIu64" write_rpcs=%"PRIu64" read_pages=%"PRIu64
+         " write_pages=%"PRIu64" in_flight=%"PRIu64, c->name, c->read_rpcs,
+         c->write_rpcs, c->read_pages, c->write_pages, c->in_flight);
+    return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+    pctx_t ctx;
+
+    err_init (argv[0]);
+    if (argc != 2)
+        msg_exit ("missing proc argument");
+
+    ctx = proc_create (argv[1]);
+
+    if (proc_lustre_clientstats (ctx, print_client, NULL) < 0)
+        msg ("no client mounts");
+
+    proc_destroy (ctx);
+
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,95 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* tdiskstats.c - test parsing of diskstats for the devices under OSTs */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+#include "lustre.h"
+#include "diskstats.h"
+
+int
+main (int argc, char *argv[])
+{
+    pctx_t ctx;
+    List disks, l;
+    ListIterator itr;
+    diskstat_t *d;
+    char *name, *dev;
+
+    err_init (argv[0]);
+    if (argc != 2)
+        msg_exit ("missing proc argument");
+
+    ctx = proc_create (argv[1]);
+
+    if (proc_diskstats (ctx, &disks) < 0) {
+        msg ("diskstats: not available");
+        disks = NULL;
+    } else
+        msg ("diskstats: %d devices", list_count (disks));
+
+    if (proc_lustre_ostlist (ctx, &l) < 0)
+        err_exit ("proc_lustre_ostlist");
+    itr = list_iterator_create (l);
+    while ((name = list_next (itr))) {
+        if (proc_lustre_ldiskfs_dev (ctx, name, &dev) < 0) {
+            msg ("%s: not on ldiskfs", name);
+            continue;
+        }
+        if (!disks || !(d = proc_diskstats_find (ctx, disks, dev)))
+            msg ("%s: %s: not found", name, dev);
+        else
+            msg ("%s: %s: %s reads=%"PRIu64" read_ms=%"PRIu64
+                 " writes=%"PRIu64" write_ms=%"PRIu64" in_flight=%"PRIu64
+                 " io_ms=%"PRIu64" queue_ms=%"PRIu64, name, dev, d->name,
+                 d->reads, d->read_ms, d->writes, d->write_ms, d->in_flight,
+                 d->io_ms, d->queue_ms);
+        free (dev);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (l);
+    if (disks)
+        list_destroy (disks);
+
+    proc_destroy (ctx);
+
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
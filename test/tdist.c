@@ -0,0 +1,170 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* tdist.c - test streaming mean, stddev and quantile estimates */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "dist.h"
+
+#define NVALS       10000
+
+static int fails = 0;
+
+/* Deterministic uniform values in [0,1), independent of libc rand ().
+ */
+static double
+_uniform (unsigned long *seed)
+{
+    *seed = (*seed * 1103515245 + 12345) % 2147483648UL;
+    return (double)*seed / 2147483648.0;
+}
+
+static int
+_cmp_double (const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x < y ? -1 : x > y ? 1 : 0);
+}
+
+static void
+_check (const char *name, const char *what, double got, double want,
+        double tol)
+{
+    int ok = fabs (got - want) <= tol;
+
+    printf ("%s %s: %s\n", name, what, ok ? "ok" : "FAIL");
+    if (!ok) {
+        printf ("  got %f, want %f +/- %f\n", got, want, tol);
+        fails++;
+    }
+}
+
+/* Add the n values v to a fresh dist and check its mean and stddev
+ * against a two pass computation, and its quantiles against the sorted
+ * values.  Quantile estimates must be within qtol of the true value.
+ */
+static void
+_test (const char *name, double *v, int n, double qtol)
+{
+    const double p[DIST_NQ] = { 0.50, 0.95, 0.99 };
+    const char *pname[DIST_NQ] = { "p50", "p95", "p99" };
+    struct dist_struct d;
+    double mean = 0, var = 0, *sorted;
+    int i;
+
+    dist_reset (&d);
+    for (i = 0; i < n; i++) {
+        dist_add (&d, v[i]);
+        mean += v[i];
+    }
+    mean /= n;
+    for (i = 0; i < n; i++)
+        var += (v[i] - mean) * (v[i] - mean);
+    var /= n;
+
+    printf ("%s count: %s\n", name, dist_count (&d) == n ? "ok" : "FAIL");
+    if (dist_count (&d) != n)
+        fails++;
+    _check (name, "mean", dist_mean (&d), mean, 1e-12 * (fabs (mean) + 1));
+    _check (name, "stddev", dist_stddev (&d), n > 1 ? sqrt (var) : 0,
+            1e-6 * (sqrt (var) + 1));
+
+    sorted = malloc (n * sizeof (double));
+    if (!sorted) {
+        fprintf (stderr, "out of memory\n");
+        exit (1);
+    }
+    for (i = 0; i < n; i++)
+        sorted[i] = v[i];
+    qsort (sorted, n, sizeof (double), _cmp_double);
+    for (i = 0; i < DIST_NQ; i++)
+        _check (name, pname[i], dist_quantile (&d, i),
+                sorted[(int)(p[i] * (n - 1) + 0.5)], qtol);
+    free (sorted);
+}
+
+int
+main (int argc, char *argv[])
+{
+    static double v[NVALS];
+    unsigned long seed = 1;
+    struct dist_struct d;
+    int i;
+
+    /* no values */
+    dist_reset (&d);
+    printf ("empty count: %s\n", dist_count (&d) == 0 ? "ok" : "FAIL");
+    _check ("empty", "p50", dist_quantile (&d, 0), 0, 0);
+    _check ("empty", "stddev", dist_stddev (&d), 0, 0);
+
+    /* up to 5 values are kept and quantiles are exact */
+    v[0] = 3; v[1] = 1; v[2] = 2;
+    _test ("three", v, 3, 0);
+    v[3] = 10;
+    _test ("four", v, 4, 0);
+    v[0] = 5; v[1] = 4; v[2] = 3; v[3] = 2; v[4] = 1;
+    _test ("five", v, 5, 0);
+
+    /* all values the same */
+    for (i = 0; i < 100; i++)
+        v[i] = 7;
+    _test ("constant", v, 100, 0);
+    dist_reset (&d);
+    for (i = 0; i < 100; i++)
+        dist_add (&d, v[i]);
+    _check ("constant", "zscore", dist_zscore (&d, 7), 0, 0);
+
+    /* uniform on [0,1000) */
+    for (i = 0; i < NVALS; i++)
+        v[i] = 1000 * _uniform (&seed);
+    _test ("uniform", v, NVALS, 5);
+
+    /* uniform on a large offset, where a naive sum of squares fails */
+    for (i = 0; i < NVALS; i++)
+        v[i] = 1e9 + _uniform (&seed);
+    _test ("offset", v, NVALS, 0.01);
+
+    /* exponential with mean 100, a long upper tail */
+    for (i = 0; i < NVALS; i++)
+        v[i] = -100 * log (1 - _uniform (&seed));
+    _test ("exponential", v, NVALS, 10);
+
+    /* ascending order, the worst case for marker adjustment */
+    for (i = 0; i < NVALS; i++)
+        v[i] = i;
+    _test ("ascending", v, NVALS, 0.01 * NVALS);
+
+    exit (fails > 0 ? 1 : 0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
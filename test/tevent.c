@@ -0,0 +1,98 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* tevent.c - test recovery/failover/osc state transition detection */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "event.h"
+
+static void
+_print_event (lmt_event_t e, const char *target, const char *server,
+              const char *comment, void *arg)
+{
+    printf ("%s: %s %s %s\n", target, lmt_event_name (e), server, comment);
+}
+
+static void
+_target (lmt_evtrack_t t, const char *target, const char *server,
+         const char *recov)
+{
+    lmt_evtrack_target (t, target, server, recov, _print_event, NULL);
+}
+
+static void
+_osc (lmt_evtrack_t t, const char *val)
+{
+    lmt_evtrack_osc_v1 (t, val, _print_event, NULL);
+}
+
+int
+main (int argc, char *argv[])
+{
+    lmt_evtrack_t t;
+
+    err_init (argv[0]);
+    t = lmt_evtrack_create ();
+
+    /* first report only records state */
+    _target (t, "lc1-OST0000", "oss1", "COMPLETE");
+    _target (t, "lc1-MDT0000", "mds1", "RECOVERING 3/10");
+    _target (t, "lc1-OST0000", "oss1", "COMPLETE");
+
+    /* failover, recovery, failback */
+    _target (t, "lc1-OST0000", "oss2", "RECOVERING 0/12");
+    _target (t, "lc1-OST0000", "oss2", "RECOVERING 5/12");
+    _target (t, "lc1-OST0000", "oss2", "COMPLETE");
+    _target (t, "lc1-OST0000", "oss1", "INACTIVE");
+    _target (t, "lc1-MDT0000", "mds1", "COMPLETE");
+
+    /* OSCs for one OST on two MDTs fold into one state */
+    _osc (t, "1;mds1;lc1-OST0000;F;lc1-OST0000;F;lc1-OST0001;F");
+    _osc (t, "1;mds1;lc1-OST0000;F;lc1-OST0000;D;lc1-OST0001;F");
+    _osc (t, "1;mds1;lc1-OST0000;D;lc1-OST0000;D;lc1-OST0001;F");
+    _osc (t, "1;mds1;lc1-OST0000;F;lc1-OST0000;F;lc1-OST0001;F");
+    _osc (t, "garbage");
+
+    /* cleared state is re-learned without events */
+    lmt_evtrack_clear (t);
+    _target (t, "lc1-OST0000", "oss2", "COMPLETE");
+    _osc (t, "1;mds1;lc1-OST0000;D;lc1-OST0001;F");
+
+    lmt_evtrack_destroy (t);
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,95 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* texportstats.c - test parsing of lustre per-export stats */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+#include "lustre.h"
+
+static int
+print_export (expstat_t *e, void *arg)
+{
+    msg ("%s: nid=%s read_bytes=%"PRIu64" write_bytes=%"PRIu64
+         " ops=%"PRIu64" locks=%"PRIu64, (char *)arg, e->nid,
+         e->read_bytes, e->write_bytes, e->ops, e->locks);
+    return 0;
+}
+
+static void
+print_exportstats (pctx_t ctx, List l)
+{
+    ListIterator itr;
+    char *name;
+
+    itr = list_iterator_create (l);
+    while ((name = list_next (itr))) {
+        if (proc_lustre_exportstats (ctx, name, print_export, name) < 0)
+            msg ("%s: no exports", name);
+    }
+    list_iterator_destroy (itr);
+}
+
+int
+main (int argc, char *argv[])
+{
+    pctx_t ctx;
+    List l;
+
+    err_init (argv[0]);
+    if (argc != 2)
+        msg_exit ("missing proc argument");
+
+    ctx = proc_create (argv[1]);
+
+    if (proc_lustre_ostlist (ctx, &l) < 0)
+        err_exit ("error looking for ost's");
+    print_exportstats (ctx, l);
+    list_destroy (l);
+
+    if (proc_lustre_mdtlist (ctx, &l) < 0)
+        err_exit ("error looking for mdt's");
+    print_exportstats (ctx, l);
+    list_destroy (l);
+
+    proc_destroy (ctx);
+
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
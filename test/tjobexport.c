@@ -0,0 +1,147 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* tjobexport.c - test lmt_job and lmt_export over successive samples
+ *
+ * Each root is read in turn as the next sample of the same server, so
+ * the output shows the activity reported between consecutive roots.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "error.h"
+
+#include "proc.h"
+
+#include "job.h"
+#include "export.h"
+
+static void
+_print_job (const char *s)
+{
+    ListIterator itr, jitr;
+    List tgtinfo, jobinfo;
+    char *host, *tgt, *name, *job, *id;
+    uint64_t read_bytes, write_bytes, ops;
+    int secs;
+
+    if (lmt_job_decode_v1 (s, &host, &tgtinfo) < 0)
+        msg_exit ("lmt_job_decode_v1");
+    itr = list_iterator_create (tgtinfo);
+    while ((tgt = list_next (itr))) {
+        if (lmt_job_decode_v1_tgtinfo (tgt, &name, &secs, &jobinfo) < 0)
+            msg_exit ("lmt_job_decode_v1_tgtinfo");
+        printf ("%s: %d jobs\n", name, list_count (jobinfo));
+        jitr = list_iterator_create (jobinfo);
+        while ((job = list_next (jitr))) {
+            if (lmt_job_decode_v1_jobinfo (job, &id, &read_bytes,
+                                           &write_bytes, &ops) < 0)
+                msg_exit ("lmt_job_decode_v1_jobinfo");
+            printf ("  %s read_bytes=%"PRIu64" write_bytes=%"PRIu64
+                    " ops=%"PRIu64"\n", id, read_bytes, write_bytes, ops);
+            free (id);
+        }
+        list_iterator_destroy (jitr);
+        list_destroy (jobinfo);
+        free (name);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (tgtinfo);
+    free (host);
+}
+
+static void
+_print_export (const char *s)
+{
+    ListIterator itr, citr;
+    List tgtinfo, clientinfo;
+    char *host, *tgt, *name, *client, *nid;
+    uint64_t read_bytes, write_bytes, ops, locks;
+    int secs;
+
+    if (lmt_export_decode_v1 (s, &host, &tgtinfo) < 0)
+        msg_exit ("lmt_export_decode_v1");
+    itr = list_iterator_create (tgtinfo);
+    while ((tgt = list_next (itr))) {
+        if (lmt_export_decode_v1_tgtinfo (tgt, &name, &secs,
+                                          &clientinfo) < 0)
+            msg_exit ("lmt_export_decode_v1_tgtinfo");
+        printf ("%s: %d clients\n", name, list_count (clientinfo));
+        citr = list_iterator_create (clientinfo);
+        while ((client = list_next (citr))) {
+            if (lmt_export_decode_v1_clientinfo (client, &nid, &read_bytes,
+                                                 &write_bytes, &ops,
+                                                 &locks) < 0)
+                msg_exit ("lmt_export_decode_v1_clientinfo");
+            printf ("  %s read_bytes=%"PRIu64" write_bytes=%"PRIu64
+                    " ops=%"PRIu64" locks=%"PRIu64"\n", nid, read_bytes,
+                    write_bytes, ops, locks);
+            free (nid);
+        }
+        list_iterator_destroy (citr);
+        list_destroy (clientinfo);
+        free (name);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (tgtinfo);
+    free (host);
+}
+
+int
+main (int argc, char *argv[])
+{
+    char s[65536];
+    pctx_t ctx;
+    int i;
+
+    err_init (argv[0]);
+    if (argc < 3 || (strcmp (argv[1], "job") && strcmp (argv[1], "export")))
+        msg_exit ("Usage: tjobexport job|export root...");
+    for (i = 2; i < argc; i++) {
+        printf ("sample %d\n", i - 1);
+        ctx = proc_create (argv[i]);
+        if (!strcmp (argv[1], "job")) {
+            if (lmt_job_string_v1 (ctx, s, sizeof (s)) < 0)
+                err_exit ("lmt_job_string_v1");
+            _print_job (s);
+        } else {
+            if (lmt_export_string_v1 (ctx, s, sizeof (s)) < 0)
+                err_exit ("lmt_export_string_v1");
+            _print_export (s);
+        }
+        proc_destroy (ctx);
+    }
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -22,7 +22,7 @@
  *  http://www.gnu.org/licenses.
  *****************************************************************************/
 
-/* tlnet.c - test parsing of lnet routes and stats files */
+/* tlnet.c - test parsing of lnet routes, stats, nis and peers files */
 
 #if HAVE_CONFIG_H
 #include "config.h"
@@ -41,6 +41,10 @@
 
 #include "proc.h"
 #include "lustre.h"
+#include "lnet.h"
+
+#define MAX_NIS     4
+#define MAX_PEERS   4
 
 int
 main (int argc, char *argv[])
@@ -48,6 +52,11 @@ main (int argc, char *argv[])
     pctx_t ctx;
     uint64_t newbytes;
     int route_ena;
+    lnetstat_t stats;
+    lnetni_t ni[MAX_NIS];
+    lnetpeer_t peer[MAX_PEERS];
+    lnetpeersum_t sum;
+    int i, n;
 
 
     err_init (argv[0]);
@@ -63,6 +72,29 @@ main (int argc, char *argv[])
         err_exit ("proc_lustre_lnet_routing_enabled");
     msg ("routing: %s", route_ena ? "ON" : "OFF");
 
+    if (proc_lnet_stats (ctx, &stats) < 0)
+        err_exit ("proc_lnet_stats");
+    msg ("stats: %"PRIu64" route bytes, %"PRIu64" drops", stats.route_length,
+         stats.drop_count);
+    if (proc_lnet_nis (ctx, ni, MAX_NIS, &n) < 0)
+        msg ("nis: not available");
+    else {
+        for (i = 0; i < n; i++)
+            msg ("ni %s: %s peer=%d max=%d tx=%d min=%d", ni[i].nid,
+                 ni[i].up ? "up" : "down", ni[i].peer_credits,
+                 ni[i].max_credits, ni[i].tx_credits, ni[i].min_credits);
+    }
+    if (proc_lnet_peers (ctx, peer, MAX_PEERS, &n, &sum) < 0)
+        msg ("peers: not available");
+    else {
+        msg ("peers: %d total, %d starved, %"PRIu64" bytes queued",
+             sum.npeers, sum.nstarved, sum.queue);
+        for (i = 0; i < n; i++)
+            msg ("peer %s: max=%d tx=%d min=%d queue=%"PRIu64, peer[i].nid,
+                 peer[i].max_credits, peer[i].tx_credits,
+                 peer[i].min_credits, peer[i].queue);
+    }
+
     proc_destroy (ctx);
 
     exit (0);
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* tltoprec.c - test playback of damaged ltop recordings */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "ltoprec.h"
+
+#define REC_GOOD    "t23-good.rec"
+#define REC_TRUNC   "t23-trunc.rec"
+#define REC_BAD     "t23-bad.rec"
+#define REC_BADIX   "t23-badix.rec"
+
+#define FRAME_MAGIC 0x4c544652  /* "LTFR" */
+
+static void
+_die (const char *what)
+{
+    perror (what);
+    exit (1);
+}
+
+static char *
+_readfile (const char *path, size_t *lenp)
+{
+    struct stat sb;
+    FILE *f;
+    char *buf;
+
+    if (!(f = fopen (path, "r")) || fstat (fileno (f), &sb) < 0)
+        _die (path);
+    if (!(buf = malloc (sb.st_size)))
+        _die ("malloc");
+    if (fread (buf, 1, sb.st_size, f) != (size_t)sb.st_size)
+        _die (path);
+    fclose (f);
+    *lenp = sb.st_size;
+    return buf;
+}
+
+static void
+_writefile (const char *path, char *buf, size_t len)
+{
+    FILE *f;
+
+    if (!(f = fopen (path, "w")) || fwrite (buf, 1, len, f) != len)
+        _die (path);
+    fclose (f);
+}
+
+static void
+_append (ltoprec_t r, time_t t, const char *node, const char *val)
+{
+    if (ltoprec_append (r, t, t, node, "lmt_ost", val) < 0)
+        _die ("ltoprec_append");
+}
+
+static void
+_metric (char *node, char *name, char *val, time_t trcv, void *arg)
+{
+    printf ("  %s %s %s trcv=%lu\n", node, name, val, (unsigned long)trcv);
+}
+
+/* Play back a recording, printing every metric delivered.
+ */
+static void
+_play (const char *path)
+{
+    ltoprec_t r;
+    time_t t;
+    int n = 0;
+
+    printf ("%s:\n", path);
+    if (!(r = ltoprec_open (path)))
+        _die (path);
+    while (ltoprec_read (r, _metric, NULL, &t) == 0) {
+        printf (" frame t=%lu\n", (unsigned long)t);
+        n++;
+    }
+    ltoprec_close (r);
+    printf (" %d frames\n", n);
+}
+
+int
+main (int argc, char *argv[])
+{
+    ltoprec_t r;
+    char *buf;
+    size_t len, i, last = 0;
+    uint32_t magic = FRAME_MAGIC, nrec;
+    uint64_t ixoff, badoff = ~(uint64_t)0;
+
+    if (!(r = ltoprec_create (REC_GOOD)))
+        _die (REC_GOOD);
+    _append (r, 1, "oss1", "3;oss1;1.0;2.0;");
+    _append (r, 1, "oss2", "3;oss2;1.0;2.0;");
+    _append (r, 2, "oss1", "3;oss1;3.0;4.0;");
+    _append (r, 2, "oss2", "3;oss2;3.0;4.0;");
+    _append (r, 3, "oss1", "3;oss1;5.0;6.0;");
+    _append (r, 3, "oss2", "3;oss2;5.0;6.0;");
+    /* the first metric at t=4 writes out the frame at t=3 */
+    _append (r, 4, "oss1", "3;oss1;7.0;8.0;");
+
+    /* as if ltop died while writing the frame at t=3: no index, and
+     * the last record cut short */
+    buf = _readfile (REC_GOOD, &len);
+    _writefile (REC_TRUNC, buf, len - 8);
+    free (buf);
+
+    _append (r, 4, "oss2", "3;oss2;7.0;8.0;");
+    if (ltoprec_close (r) < 0)
+        _die (REC_GOOD);
+    _play (REC_GOOD);
+    _play (REC_TRUNC);
+
+    /* the last frame claims one more record than it holds */
+    buf = _readfile (REC_GOOD, &len);
+    for (i = 0; i + sizeof (magic) <= len; i++) {
+        if (memcmp (buf + i, &magic, sizeof (magic)) == 0)
+            last = i;
+    }
+    memcpy (&nrec, buf + last + sizeof (magic), sizeof (nrec));
+    nrec++;
+    memcpy (buf + last + sizeof (magic), &nrec, sizeof (nrec));
+    _writefile (REC_BAD, buf, len);
+    free (buf);
+    _play (REC_BAD);
+
+    /* the first index entry points past the frames */
+    buf = _readfile (REC_GOOD, &len);
+    memcpy (&ixoff, buf + len - sizeof (uint64_t), sizeof (ixoff));
+    memcpy (buf + ixoff + sizeof (uint64_t), &badoff, sizeof (badoff));
+    _writefile (REC_BADIX, buf, len);
+    free (buf);
+    _play (REC_BADIX);
+
+    unlink (REC_GOOD);
+    unlink (REC_TRUNC);
+    unlink (REC_BAD);
+    unlink (REC_BADIX);
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,74 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* tnetdev.c - test parsing of /proc/net/dev and infiniband port counters */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "list.h"
+#include "error.h"
+
+#include "proc.h"
+#include "netdev.h"
+
+int
+main (int argc, char *argv[])
+{
+    pctx_t ctx;
+    List l;
+    ListIterator itr;
+    netdev_t *n;
+
+    err_init (argv[0]);
+    if (argc != 2)
+        msg_exit ("missing proc argument");
+
+    ctx = proc_create (argv[1]);
+
+    if (proc_netdev (ctx, &l) < 0)
+        err_exit ("proc_netdev");
+    itr = list_iterator_create (l);
+    while ((n = list_next (itr))) {
+        msg ("%s: rx_bytes: %"PRIu64", tx_bytes: %"PRIu64", errors: %"PRIu64
+             ", link: %d, rate: %"PRIu64, n->name, n->rx_bytes, n->tx_bytes,
+             n->errors, n->link, n->rate);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (l);
+
+    proc_destroy (ctx);
+
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
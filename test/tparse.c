@@ -42,11 +42,17 @@
 #include "error.h"
 
 #include "proc.h"
+#include "stat.h"
+#include "meminfo.h"
+#include "lustre.h"
 
 #include "ost.h"
 #include "mdt.h"
 #include "osc.h"
 #include "router.h"
+#include "job.h"
+#include "export.h"
+#include "client.h"
 #include "util.h"
 #include "lmtconf.h"
 
@@ -70,11 +76,50 @@ const char *mds_v2_str =
 
 const char *router_v1_str =
     "1.0;alc42;0.100000;98.810898;1845066588";
+const char *router_v2_str =
+    "2;alc42;0.100000;98.810898;1845066588;17;"
+    "2;172.16.2.20@o2ib;1;8;256;250;-37;172.17.2.20@o2ib1;1;8;256;256;201;"
+    "4000;2;4718592;2;"
+    "172.16.2.3@o2ib;8;-5;-21;4718592;172.16.2.1@o2ib;8;2;-9;0;";
 const char *ost_v2_str =
     "2;tycho1;0.100000;98.810898;"
     "lc1-OST0000;15156;976;99880;116;18;28;42;128;2;1;1;1;1;COMPLETED 100/100;"
     "lc1-OST0008;15156;976;99880;116;18;28;42;128;1;1;1;1;1;COMPLETED 1/1;"
     "lc1-OST0010;15156;976;99880;116;18;28;42;128;0;1;1;1;1;RECOVERING 1/1009";
+const char *ost_v3_str =
+    "3;tycho1;0.100000;98.810898;"
+    "2;eth0;734562118;123456789;2;1;10000;mlx5_0:1;4096;8192;0;1;100000;"
+    "2;ost_io;3412580;1022345678;4125311;58123456;128;512;"
+    "ost;1234567;12345678;23456;2345678;64;512;"
+    "184350012;2048311;50123456512;67351212032;"
+    "2;tycho1-pool0;lc1-OST0000;0;0;0;0;1254312;1034567890;"
+    "tycho1-pool1;lc1-OST0008;1234567890;2345678901;12345;23456;"
+    "1198714;455667788;"
+    "2;lc1-OST0000;sdb;48273645;382746512;39283746;928374651;3;284736512;"
+    "1311121163;"
+    "lc1-OST0008;dm-1;27364512;201928374;19283746;501928374;0;182736451;"
+    "703856748;"
+    "16;12.500000;3.250000;0.750000;4194304;1048576;2048;0;"
+    "lc1-OST0000;15156;976;99880;116;18;28;42;128;2;1;1;1;1;COMPLETED 100/100;"
+    "12;34;5;2;0;1;0;3;77;4;0;9;0;0;0;120;"
+    "lc1-OST0008;15156;976;99880;116;18;28;42;128;1;1;1;1;1;COMPLETED 1/1;"
+    "1;2;3;4;5;6;7;8;9;10;11;12;13;14;15;16";
+const char *job_v1_str =
+    "1;tycho1;"
+    "lc1-OST0000;5;2;dd.1001;0;1073741824;1024;ior.2002;536870912;0;512;"
+    "lc1-OST0008;0;0;"
+    "lc1-MDT0000;5;1;tar.1001;0;196608;19688;";
+const char *export_v1_str =
+    "1;tycho1;"
+    "lc1-OST0000;5;2;10.0.0.11@o2ib;0;1073741824;1024;812;"
+    "10.0.0.12@o2ib;40960;0;15;3;"
+    "lc1-OST0008;0;0;"
+    "lc1-MDT0000;5;1;10.0.0.11@o2ib;0;0;21690;11500;";
+const char *client_v1_str =
+    "1;tycho-c1;"
+    "lc1-ffff81007f018c00;30;1073741824;536870912;120;118;960;"
+    "256;128;65536;32768;6;"
+    "lc2-ffff81007f018e00;0;0;0;0;0;0;0;0;0;0;2;";
 const char *mdt_v1_str =
     "1;tycho-mds2;0.000000;1.561927;"
     "lc1-MDT0000;413253193;467523892;1653012772;1688473892;"
@@ -110,6 +155,15 @@ const char *mdt_v3_str =
     "COMPLETE 4/4 0s remaining;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;"
     "0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;48;149;993;0;0;0;0;0;0;0;0;0;0;0;0;0;"
     "0;0;0;0;0;0;0;0;0;0;0;0;0;0";
+const char *mdt_v4_str =
+    "4;garter1;0.028121;50.132298;"
+    "2;mdt;2611234;231456789;3012345;31234567;96;1024;"
+    "mdt_readpage;302669;2563987;1234;312345;16;1024;"
+    "32;87.500000;0.125000;6.500000;16777216;8388608;512;64;"
+    "lflood-MDT0001;5274986125;5276127580;22183103872;22187903872;"
+    "COMPLETE 4/4 0s remaining;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;"
+    "0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;48;149;993;0;0;0;0;0;0;0;0;0;0;0;0;0;"
+    "0;0;0;0;0;0;0;0;0;0;0;0;0;0";
 const char *osc_v1_str =
     "1;tycho-mds1;"
     "lc1-OST0042_UUID;FULL;lc1-OST005b_UUID;FULL;lc1-OST0015_UUID;FULL;"
@@ -242,6 +296,305 @@ done:
     return retval;
 }
 
+int
+_parse_ost_v3_ostinfo (List ostinfo)
+{
+    int retval = -1;
+    char *ostname = NULL;
+    char *recov_status = NULL;
+    char *opname, *op;
+    uint64_t read_bytes, write_bytes;
+    uint64_t inodes_free, inodes_total;
+    uint64_t kbytes_free, kbytes_total;
+    uint64_t iops, num_exports;
+    uint64_t lock_count, grant_rate, cancel_rate;
+    uint64_t connect, reconnect, samples;
+    List ops = NULL;
+    ListIterator itr = NULL;
+    ListIterator opitr = NULL;
+    char *osi;
+
+    if (!(itr = list_iterator_create (ostinfo)))
+        goto done;
+    while ((osi = list_next (itr))) {
+        if (lmt_ost_decode_v3_ostinfo (osi, &ostname, &read_bytes, &write_bytes,
+                                       &kbytes_free, &kbytes_total,
+                                       &inodes_free, &inodes_total, &iops,
+                                       &num_exports, &lock_count, &grant_rate,
+                                       &cancel_rate, &connect, &reconnect,
+                                       &recov_status, &ops) < 0)
+            goto done;
+        free (ostname);
+        free (recov_status);
+        if (!(opitr = list_iterator_create (ops)))
+            goto done;
+        while ((op = list_next (opitr))) {
+            if (lmt_ost_decode_v3_ostops (op, &opname, &samples) < 0)
+                goto done;
+            free (opname);
+        }
+        list_iterator_destroy (opitr);
+        opitr = NULL;
+        list_destroy (ops);
+        ops = NULL;
+    }
+    retval = 0;
+done:
+    if (opitr)
+        list_iterator_destroy (opitr);
+    if (ops)
+        list_destroy (ops);
+    if (itr)
+        list_iterator_destroy (itr);
+    return retval;
+}
+
+int
+_parse_svcinfo (List svcinfo)
+{
+    int retval = -1;
+    char *name;
+    uint64_t reqs, wait_usecs, qdepth, active, started, max;
+    ListIterator itr;
+    char *svi;
+
+    if (!(itr = list_iterator_create (svcinfo)))
+        goto done;
+    while ((svi = list_next (itr))) {
+        if (lmt_decode_svcinfo (svi, &name, &reqs, &wait_usecs, &qdepth,
+                                &active, &started, &max) < 0)
+            goto done;
+        free (name);
+    }
+    retval = 0;
+done:
+    if (itr)
+        list_iterator_destroy (itr);
+    return retval;
+}
+
+int
+_parse_hostinfo (const char *s)
+{
+    int ncpu;
+    float pct_maxcpu, pct_iowait, pct_softirq;
+    uint64_t kcached, kslab, kdirty, kwriteback;
+
+    return lmt_decode_hostinfo (s, &ncpu, &pct_maxcpu, &pct_iowait,
+                                &pct_softirq, &kcached, &kslab, &kdirty,
+                                &kwriteback);
+}
+
+int
+_parse_ost_v3 (const char *s)
+{
+    int retval = -1;
+    char *ossname = NULL;
+    float pct_cpu, pct_mem;
+    List ifinfo = NULL;
+    List svcinfo = NULL;
+    char *arcinfo = NULL;
+    List zpoolinfo = NULL;
+    List diskinfo = NULL;
+    char *hostinfo = NULL;
+    List ostinfo = NULL;
+    ListIterator itr = NULL;
+    char *zpi, *pool, *osts;
+    char *dki, *ostname, *dev;
+    char *ifi, *ifname;
+    uint64_t hits, misses, size, c_max;
+    uint64_t nread, nwritten, reads, writes, txg, txg_sync_ns;
+    uint64_t read_ms, write_ms, in_flight, io_ms, queue_ms;
+    uint64_t rx_bytes, tx_bytes, errors, rate;
+    int link;
+
+    if (lmt_ost_decode_v3 (s, &ossname, &pct_cpu, &pct_mem, &ifinfo,
+                           &svcinfo, &arcinfo, &zpoolinfo, &diskinfo,
+                           &hostinfo, &ostinfo) < 0)
+        goto done;
+    if (!(itr = list_iterator_create (ifinfo)))
+        goto done;
+    while ((ifi = list_next (itr))) {
+        if (lmt_ost_decode_v3_ifinfo (ifi, &ifname, &rx_bytes, &tx_bytes,
+                                      &errors, &link, &rate) < 0)
+            goto done;
+        free (ifname);
+    }
+    list_iterator_destroy (itr);
+    itr = NULL;
+    if (_parse_svcinfo (svcinfo) < 0)
+        goto done;
+    if (lmt_ost_decode_v3_arcinfo (arcinfo, &hits, &misses, &size,
+                                   &c_max) < 0)
+        goto done;
+    if (!(itr = list_iterator_create (zpoolinfo)))
+        goto done;
+    while ((zpi = list_next (itr))) {
+        if (lmt_ost_decode_v3_zpoolinfo (zpi, &pool, &osts, &nread,
+                                         &nwritten, &reads, &writes, &txg,
+                                         &txg_sync_ns) < 0)
+            goto done;
+        free (pool);
+        free (osts);
+    }
+    list_iterator_destroy (itr);
+    itr = NULL;
+    if (!(itr = list_iterator_create (diskinfo)))
+        goto done;
+    while ((dki = list_next (itr))) {
+        if (lmt_ost_decode_v3_diskinfo (dki, &ostname, &dev, &reads,
+                                        &read_ms, &writes, &write_ms,
+                                        &in_flight, &io_ms, &queue_ms) < 0)
+            goto done;
+        free (ostname);
+        free (dev);
+    }
+    if (_parse_hostinfo (hostinfo) < 0)
+        goto done;
+    if (_parse_ost_v3_ostinfo (ostinfo) < 0)
+        goto done;
+    retval = 0;
+done:
+    if (itr)
+        list_iterator_destroy (itr);
+    if (ossname)
+        free (ossname);
+    if (ifinfo)
+        list_destroy (ifinfo);
+    if (svcinfo)
+        list_destroy (svcinfo);
+    if (arcinfo)
+        free (arcinfo);
+    if (zpoolinfo)
+        list_destroy (zpoolinfo);
+    if (diskinfo)
+        list_destroy (diskinfo);
+    if (hostinfo)
+        free (hostinfo);
+    if (ostinfo)
+        list_destroy (ostinfo);
+    return retval;
+}
+
+int
+_parse_job_v1 (const char *s)
+{
+    int retval = -1;
+    char *host = NULL;
+    char *tgtname, *jobid;
+    uint64_t read_bytes, write_bytes, ops;
+    int secs;
+    List tgtinfo = NULL;
+    List jobinfo;
+    ListIterator itr = NULL;
+    ListIterator itr2;
+    char *ti, *ji;
+
+    if (lmt_job_decode_v1 (s, &host, &tgtinfo) < 0)
+        goto done;
+    itr = list_iterator_create (tgtinfo);
+    while ((ti = list_next (itr))) {
+        if (lmt_job_decode_v1_tgtinfo (ti, &tgtname, &secs, &jobinfo) < 0)
+            goto done;
+        itr2 = list_iterator_create (jobinfo);
+        while ((ji = list_next (itr2))) {
+            if (lmt_job_decode_v1_jobinfo (ji, &jobid, &read_bytes,
+                                           &write_bytes, &ops) < 0)
+                break;
+            free (jobid);
+        }
+        list_iterator_destroy (itr2);
+        list_destroy (jobinfo);
+        free (tgtname);
+        if (ji)
+            goto done;
+    }
+    retval = 0;
+done:
+    if (host)
+        free (host);
+    if (itr)
+        list_iterator_destroy (itr);
+    if (tgtinfo)
+        list_destroy (tgtinfo);
+    return retval;
+}
+
+int
+_parse_export_v1 (const char *s)
+{
+    int retval = -1;
+    char *host = NULL;
+    char *tgtname, *nid;
+    uint64_t read_bytes, write_bytes, ops, locks;
+    int secs;
+    List tgtinfo = NULL;
+    List clientinfo;
+    ListIterator itr = NULL;
+    ListIterator itr2;
+    char *ti, *ci;
+
+    if (lmt_export_decode_v1 (s, &host, &tgtinfo) < 0)
+        goto done;
+    itr = list_iterator_create (tgtinfo);
+    while ((ti = list_next (itr))) {
+        if (lmt_export_decode_v1_tgtinfo (ti, &tgtname, &secs,
+                                          &clientinfo) < 0)
+            goto done;
+        itr2 = list_iterator_create (clientinfo);
+        while ((ci = list_next (itr2))) {
+            if (lmt_export_decode_v1_clientinfo (ci, &nid, &read_bytes,
+                                                 &write_bytes, &ops,
+                                                 &locks) < 0)
+                break;
+            free (nid);
+        }
+        list_iterator_destroy (itr2);
+        list_destroy (clientinfo);
+        free (tgtname);
+        if (ci)
+            goto done;
+    }
+    retval = 0;
+done:
+    if (host)
+        free (host);
+    if (itr)
+        list_iterator_destroy (itr);
+    if (tgtinfo)
+        list_destroy (tgtinfo);
+    return retval;
+}
+
+int
+_parse_client_v1 (const char *s)
+{
+    int retval = -1;
+    char *host = NULL;
+    List mntinfo = NULL;
+    ListIterator itr = NULL;
+    clistat_t c;
+    int secs;
+    char *mi;
+
+    if (lmt_client_decode_v1 (s, &host, &mntinfo) < 0)
+        goto done;
+    itr = list_iterator_create (mntinfo);
+    while ((mi = list_next (itr))) {
+        if (lmt_client_decode_v1_mntinfo (mi, &secs, &c) < 0)
+            goto done;
+    }
+    retval = 0;
+done:
+    if (host)
+        free (host);
+    if (itr)
+        list_iterator_destroy (itr);
+    if (mntinfo)
+        list_destroy (mntinfo);
+    return retval;
+}
+
 int
 _parse_mdt_v1_mdops (List mdops)
 {
@@ -396,6 +749,60 @@ done:
     return retval;
 }
 
+int
+_parse_mdt_v4 (const char *s)
+{
+    int retval = -1;
+    char *mdsname = NULL;
+    char *mdtname = NULL;
+    float pct_cpu, pct_mem;
+    uint64_t inodes_free, inodes_total;
+    uint64_t kbytes_free, kbytes_total;
+    List svcinfo = NULL;
+    char *hostinfo = NULL;
+    List mdtinfo = NULL;
+    List mdops = NULL;
+    ListIterator itr = NULL;
+    char *mdi;
+    char *recov_str;
+
+    if (lmt_mdt_decode_v4 (s, &mdsname, &pct_cpu, &pct_mem, &svcinfo,
+                           &hostinfo, &mdtinfo) < 0)
+        goto done;
+    if (_parse_svcinfo (svcinfo) < 0)
+        goto done;
+    if (_parse_hostinfo (hostinfo) < 0)
+        goto done;
+    if (!(itr = list_iterator_create (mdtinfo)))
+        goto done;
+    while ((mdi = list_next (itr))) {
+        if (lmt_mdt_decode_v3_mdtinfo (mdi, &mdtname, &inodes_free,
+                     &inodes_total, &kbytes_free, &kbytes_total, &recov_str,
+                     &mdops) < 0)
+            goto done;
+        free (mdtname);
+        free (recov_str);
+        if (_parse_mdt_v1_mdops (mdops) < 0) {
+            list_destroy (mdops);
+            goto done;
+        }
+        list_destroy (mdops);
+    }
+    retval = 0;
+done:
+    if (mdsname)
+        free (mdsname);
+    if (itr)
+        list_iterator_destroy (itr);
+    if (svcinfo)
+        list_destroy (svcinfo);
+    if (hostinfo)
+        free (hostinfo);
+    if (mdtinfo)
+        list_destroy (mdtinfo);
+    return retval;
+}
+
 int
 _parse_router_v1 (const char *s)
 {
@@ -413,6 +820,54 @@ done:
     return retval;
 }
 
+int
+_parse_router_v2 (const char *s)
+{
+    int retval = -1;
+    char *name = NULL;
+    float pct_cpu, pct_mem;
+    uint64_t bytes, drops, queue;
+    int npeer, nstarved;
+    List niinfo = NULL;
+    List peerinfo = NULL;
+    ListIterator itr = NULL;
+    char *s1, *nid;
+    int up, peer, max, tx, min;
+
+    if (lmt_router_decode_v2 (s, &name, &pct_cpu, &pct_mem, &bytes, &drops,
+                              &niinfo, &npeer, &nstarved, &queue,
+                              &peerinfo) < 0)
+        goto done;
+    if (!(itr = list_iterator_create (niinfo)))
+        goto done;
+    while ((s1 = list_next (itr))) {
+        if (lmt_router_decode_v2_niinfo (s1, &nid, &up, &peer, &max, &tx,
+                                         &min) < 0)
+            goto done;
+        free (nid);
+    }
+    list_iterator_destroy (itr);
+    if (!(itr = list_iterator_create (peerinfo)))
+        goto done;
+    while ((s1 = list_next (itr))) {
+        if (lmt_router_decode_v2_peerinfo (s1, &nid, &max, &tx, &min,
+                                           &queue) < 0)
+            goto done;
+        free (nid);
+    }
+    retval = 0;
+done:
+    if (itr)
+        list_iterator_destroy (itr);
+    if (name)
+        free (name);
+    if (niinfo)
+        list_destroy (niinfo);
+    if (peerinfo)
+        list_destroy (peerinfo);
+    return retval;
+}
+
 int
 _parse_mds_v2 (const char *s)
 {
@@ -538,6 +993,12 @@ parse_current_short (void)
     int n;
     char *mdt_v2_str_short = xstrdup (mdt_v2_str);
     char *ost_v2_str_short = xstrdup (ost_v2_str);
+    char *ost_v3_str_short = xstrdup (ost_v3_str);
+    char *mdt_v4_str_short = xstrdup (mdt_v4_str);
+    char *router_v2_str_short = xstrdup (router_v2_str);
+    char *job_v1_str_short = xstrdup (job_v1_str);
+    char *export_v1_str_short = xstrdup (export_v1_str);
+    char *client_v1_str_short = xstrdup (client_v1_str);
 
     mdt_v2_str_short[strlen (mdt_v2_str_short) - 35] = '\0';
     n = _parse_mdt_v2 (mdt_v2_str_short);
@@ -547,8 +1008,79 @@ parse_current_short (void)
     n = _parse_ost_v2 (ost_v2_str_short);
     msg ("ost_v2(truncated): %s", n < 0 ? "FAIL" : "OK");
 
+    /* cut off inside an OST's op counts */
+    ost_v3_str_short[strlen (ost_v3_str_short) - 4] = '\0';
+    n = _parse_ost_v3 (ost_v3_str_short);
+    msg ("ost_v3(truncated): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside the interface list */
+    strcpy (ost_v3_str_short, ost_v3_str);
+    *strstr (ost_v3_str_short, "mlx5_0") = '\0';
+    n = _parse_ost_v3 (ost_v3_str_short);
+    msg ("ost_v3(truncated interface): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside the service list */
+    strcpy (ost_v3_str_short, ost_v3_str);
+    *strstr (ost_v3_str_short, "ost;") = '\0';
+    n = _parse_ost_v3 (ost_v3_str_short);
+    msg ("ost_v3(truncated svc): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside the zpool list */
+    strcpy (ost_v3_str_short, ost_v3_str);
+    *strstr (ost_v3_str_short, "tycho1-pool1") = '\0';
+    n = _parse_ost_v3 (ost_v3_str_short);
+    msg ("ost_v3(truncated zpool): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside the disk list */
+    strcpy (ost_v3_str_short, ost_v3_str);
+    *strstr (ost_v3_str_short, "dm-1") = '\0';
+    n = _parse_ost_v3 (ost_v3_str_short);
+    msg ("ost_v3(truncated disk): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside the host resources */
+    strcpy (ost_v3_str_short, ost_v3_str);
+    *strstr (ost_v3_str_short, "4194304") = '\0';
+    n = _parse_ost_v3 (ost_v3_str_short);
+    msg ("ost_v3(truncated host): %s", n < 0 ? "FAIL" : "OK");
+
+    *strstr (mdt_v4_str_short, "mdt_readpage") = '\0';
+    n = _parse_mdt_v4 (mdt_v4_str_short);
+    msg ("mdt_v4(truncated): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside the host resources */
+    strcpy (mdt_v4_str_short, mdt_v4_str);
+    *strstr (mdt_v4_str_short, "16777216") = '\0';
+    n = _parse_mdt_v4 (mdt_v4_str_short);
+    msg ("mdt_v4(truncated host): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside the peer list */
+    *strstr (router_v2_str_short, "172.16.2.1@o2ib") = '\0';
+    n = _parse_router_v2 (router_v2_str_short);
+    msg ("router_v2(truncated): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside a target's job list */
+    *strstr (job_v1_str_short, "ior.2002") = '\0';
+    n = _parse_job_v1 (job_v1_str_short);
+    msg ("job_v1(truncated): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside a target's client list */
+    *strstr (export_v1_str_short, "10.0.0.12@o2ib") = '\0';
+    n = _parse_export_v1 (export_v1_str_short);
+    msg ("export_v1(truncated): %s", n < 0 ? "FAIL" : "OK");
+
+    /* cut off inside a mount's RPC counts */
+    *strstr (client_v1_str_short, "65536") = '\0';
+    n = _parse_client_v1 (client_v1_str_short);
+    msg ("client_v1(truncated): %s", n < 0 ? "FAIL" : "OK");
+
     free (mdt_v2_str_short);
     free (ost_v2_str_short);
+    free (ost_v3_str_short);
+    free (mdt_v4_str_short);
+    free (router_v2_str_short);
+    free (job_v1_str_short);
+    free (export_v1_str_short);
+    free (client_v1_str_short);
 }
 
 void
@@ -580,10 +1112,22 @@ parse_current (void)
 
     n = _parse_mdt_v3 (mdt_v3_str);
     msg ("mdt_v3: %s", n < 0 ? "FAIL" : "OK");
+    n = _parse_mdt_v4 (mdt_v4_str);
+    msg ("mdt_v4: %s", n < 0 ? "FAIL" : "OK");
     n = _parse_ost_v2 (ost_v2_str);
     msg ("ost_v2: %s", n < 0 ? "FAIL" : "OK");
+    n = _parse_ost_v3 (ost_v3_str);
+    msg ("ost_v3: %s", n < 0 ? "FAIL" : "OK");
+    n = _parse_router_v2 (router_v2_str);
+    msg ("router_v2: %s", n < 0 ? "FAIL" : "OK");
     n = _parse_osc_v1 (osc_v1_str);
     msg ("osc_v1: %s", n < 0 ? "FAIL" : "OK");
+    n = _parse_job_v1 (job_v1_str);
+    msg ("job_v1: %s", n < 0 ? "FAIL" : "OK");
+    n = _parse_export_v1 (export_v1_str);
+    msg ("export_v1: %s", n < 0 ? "FAIL" : "OK");
+    n = _parse_client_v1 (client_v1_str);
+    msg ("client_v1: %s", n < 0 ? "FAIL" : "OK");
 }
 
 void
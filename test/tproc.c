@@ -49,6 +49,9 @@ main (int argc, char *argv[])
     pctx_t ctx;
     uint64_t ktot, kfree;
     uint64_t usage = 0, total = 0;
+    meminfo_t mem;
+    cpustat_t all, *cpu = NULL;
+    int i, ncpu;
 
     err_init (argv[0]);
     if (argc != 2)
@@ -64,6 +67,22 @@ main (int argc, char *argv[])
         err_exit ("proc_stat2");
     msg ("cpu: %"PRIu64" usage, %"PRIu64" total", usage, total);
 
+    if (proc_meminfo2 (ctx, &mem) < 0)
+        err_exit ("proc_meminfo2");
+    msg ("memory: %"PRIu64"K cached, %"PRIu64"K buffers, %"PRIu64"K slab,"
+         " %"PRIu64"K dirty, %"PRIu64"K writeback", mem.cached, mem.buffers,
+         mem.slab, mem.dirty, mem.writeback);
+
+    if (proc_stat_cpus (ctx, &all, &cpu, &ncpu) < 0)
+        err_exit ("proc_stat_cpus");
+    msg ("cpu: %"PRIu64" iowait, %"PRIu64" softirq", all.iowait, all.softirq);
+    for (i = 0; i < ncpu; i++) {
+        if (cpu[i].online)
+            msg ("cpu%d: %"PRIu64" user, %"PRIu64" system, %"PRIu64" idle",
+                 i, cpu[i].usr, cpu[i].sys, cpu[i].idle);
+    }
+    free (cpu);
+
     proc_destroy (ctx);
 
     exit (0);
@@ -0,0 +1,108 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* trtrgroup.c - test router group lookup and incremental group totals */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+
+#include "lmtconf.h"
+#include "rtrgroup.h"
+
+static void
+_update (lmt_rtrgroup_t g, const char *router, uint64_t bytes)
+{
+    uint64_t group_bytes;
+    int id, nrouters;
+
+    id = lmt_rtrgroup_update (g, router, bytes);
+    if (lmt_rtrgroup_get (g, id, &group_bytes, &nrouters) < 0)
+        err_exit ("lmt_rtrgroup_get %d", id);
+    printf ("%s %"PRIu64": group %d (%s) %"PRIu64" bytes %d routers\n",
+            router, bytes, id, id > 0 ? lmt_conf_get_router_group_name (id)
+                                      : "none", group_bytes, nrouters);
+}
+
+int
+main (int argc, char *argv[])
+{
+    const char *hosts[] = { "rtr1", "rtr32.example.com", "rtr33", "rtrx",
+                            "rtr65" };
+    lmt_rtrgroup_t g;
+    int i;
+
+    err_init (argv[0]);
+    if (lmt_conf_add_router_group ("east", "rtr[1-32]") < 0)
+        err_exit ("lmt_conf_add_router_group east");
+    if (lmt_conf_add_router_group ("west", "rtr[33-64],rtrx") < 0)
+        err_exit ("lmt_conf_add_router_group west");
+    printf ("%d groups\n", lmt_conf_get_router_group_count ());
+    for (i = 0; i < sizeof (hosts) / sizeof (hosts[0]); i++)
+        printf ("%s: group %d\n", hosts[i],
+                lmt_conf_get_router_group (hosts[i]));
+
+    g = lmt_rtrgroup_create ();
+
+    /* first report of a router is its baseline */
+    _update (g, "rtr1", 1000);
+    _update (g, "rtr2", 5000);
+    _update (g, "rtr33", 100);
+    _update (g, "rtr65", 7);
+
+    /* growth of each router adds to its group */
+    _update (g, "rtr1", 1500);
+    _update (g, "rtr2", 6000);
+    _update (g, "rtrx", 0);
+    _update (g, "rtr33", 400);
+    _update (g, "rtr65", 10);
+
+    /* a router that restarts counting does not take its group back */
+    _update (g, "rtr2", 200);
+    _update (g, "rtr2", 300);
+
+    if (lmt_rtrgroup_get (g, 3, NULL, NULL) == 0)
+        msg_exit ("lmt_rtrgroup_get accepted a bad group id");
+    lmt_rtrgroup_destroy (g);
+
+    /* reloading the config replaces groups rather than appending */
+    if (lmt_conf_init (0, NULL) < 0)
+        err_exit ("lmt_conf_init");
+    i = lmt_conf_get_router_group_count ();
+    if (lmt_conf_init (0, NULL) < 0)
+        err_exit ("lmt_conf_init");
+    if (lmt_conf_get_router_group_count () != i)
+        msg_exit ("lmt_conf_init appended router groups");
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
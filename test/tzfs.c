@@ -0,0 +1,93 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* tzfs.c - test parsing of ZFS kstats for the pools backing OSTs */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+#include "lustre.h"
+#include "zfs.h"
+
+int
+main (int argc, char *argv[])
+{
+    pctx_t ctx;
+    arcstat_t a;
+    zpoolstat_t z;
+    List l;
+    ListIterator itr;
+    char *name, *pool;
+
+    err_init (argv[0]);
+    if (argc != 2)
+        msg_exit ("missing proc argument");
+
+    ctx = proc_create (argv[1]);
+
+    if (proc_zfs_arcstats (ctx, &a) < 0)
+        msg ("arcstats: not available");
+    else
+        msg ("arcstats: hits=%"PRIu64" misses=%"PRIu64" size=%"PRIu64
+             " c_max=%"PRIu64, a.hits, a.misses, a.size, a.c_max);
+
+    if (proc_lustre_ostlist (ctx, &l) < 0)
+        err_exit ("proc_lustre_ostlist");
+    itr = list_iterator_create (l);
+    while ((name = list_next (itr))) {
+        if (proc_lustre_zfs_pool (ctx, name, &pool) < 0) {
+            msg ("%s: not on zfs", name);
+            continue;
+        }
+        if (proc_zfs_pool (ctx, pool, &z) < 0)
+            msg ("%s: %s: no kstats", name, pool);
+        else
+            msg ("%s: %s: nread=%"PRIu64" nwritten=%"PRIu64" reads=%"PRIu64
+                 " writes=%"PRIu64" txg=%"PRIu64" txg_sync_ns=%"PRIu64,
+                 name, z.name, z.nread, z.nwritten, z.reads, z.writes,
+                 z.txg, z.txg_sync_ns);
+        free (pool);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (l);
+
+    proc_destroy (ctx);
+
+    exit (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,177 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+
+/* dist.c - streaming mean, variance and quantiles */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "dist.h"
+
+static const double dist_p[DIST_NQ] = { 0.50, 0.95, 0.99 };
+
+void
+dist_reset (dist_t d)
+{
+    int i;
+
+    memset (d, 0, sizeof (*d));
+    for (i = 0; i < DIST_NQ; i++)
+        d->pq[i].p = dist_p[i];
+}
+
+static int
+_cmp_double (const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x < y ? -1 : x > y ? 1 : 0);
+}
+
+/* Piecewise-parabolic prediction of marker i moved by d (+1 or -1).
+ */
+static double
+_parabolic (psquare_t *m, int i, double d)
+{
+    return m->q[i] + d / (m->n[i + 1] - m->n[i - 1])
+        * ((m->n[i] - m->n[i - 1] + d) * (m->q[i + 1] - m->q[i])
+                                       / (m->n[i + 1] - m->n[i])
+         + (m->n[i + 1] - m->n[i] - d) * (m->q[i] - m->q[i - 1])
+                                       / (m->n[i] - m->n[i - 1]));
+}
+
+static void
+_psquare_add (psquare_t *m, long count, double x)
+{
+    double dn[5] = { 0, m->p / 2, m->p, (1 + m->p) / 2, 1 };
+    double d, qp;
+    int i, k;
+
+    /* the first five values are kept sorted as the initial markers */
+    if (count <= 5) {
+        m->q[count - 1] = x;
+        if (count == 5) {
+            qsort (m->q, 5, sizeof (double), _cmp_double);
+            for (i = 0; i < 5; i++)
+                m->n[i] = i;
+            m->np[0] = 0;
+            m->np[1] = 2 * m->p;
+            m->np[2] = 4 * m->p;
+            m->np[3] = 2 + 2 * m->p;
+            m->np[4] = 4;
+        }
+        return;
+    }
+    if (x < m->q[0]) {
+        m->q[0] = x;
+        k = 0;
+    } else if (x >= m->q[4]) {
+        m->q[4] = x;
+        k = 3;
+    } else {
+        for (k = 0; k < 3 && x >= m->q[k + 1]; k++)
+            ;
+    }
+    for (i = k + 1; i < 5; i++)
+        m->n[i]++;
+    for (i = 0; i < 5; i++)
+        m->np[i] += dn[i];
+    for (i = 1; i < 4; i++) {
+        d = m->np[i] - m->n[i];
+        if ((d >= 1 && m->n[i + 1] - m->n[i] > 1)
+                    || (d <= -1 && m->n[i - 1] - m->n[i] < -1)) {
+            d = d > 0 ? 1 : -1;
+            qp = _parabolic (m, i, d);
+            if (!(m->q[i - 1] < qp && qp < m->q[i + 1]))
+                qp = m->q[i] + d * (m->q[i + (int)d] - m->q[i])
+                                 / (m->n[i + (int)d] - m->n[i]);
+            m->q[i] = qp;
+            m->n[i] += d;
+        }
+    }
+}
+
+void
+dist_add (dist_t d, double x)
+{
+    double delta = x - d->mean;
+    int i;
+
+    d->count++;
+    d->mean += delta / d->count;
+    d->m2 += delta * (x - d->mean);
+    for (i = 0; i < DIST_NQ; i++)
+        _psquare_add (&d->pq[i], d->count, x);
+}
+
+long
+dist_count (dist_t d)
+{
+    return d->count;
+}
+
+double
+dist_mean (dist_t d)
+{
+    return d->mean;
+}
+
+double
+dist_stddev (dist_t d)
+{
+    return d->count > 1 ? sqrt (d->m2 / d->count) : 0;
+}
+
+double
+dist_quantile (dist_t d, int i)
+{
+    psquare_t *m = &d->pq[i];
+    double q[5];
+
+    if (d->count == 0)
+        return 0;
+    if (d->count <= 5) {
+        memcpy (q, m->q, d->count * sizeof (double));
+        qsort (q, d->count, sizeof (double), _cmp_double);
+        return q[(int)(m->p * (d->count - 1) + 0.5)];
+    }
+    return m->q[2];
+}
+
+double
+dist_zscore (dist_t d, double x)
+{
+    double sd = dist_stddev (d);
+
+    return sd > 0 ? (x - d->mean) / sd : 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,43 @@
+/* Streaming statistics of one metric across many targets.
+ * Mean and variance use Welford's method; the p50, p95 and p99
+ * quantiles are estimated with the P-square algorithm (Jain and
+ * Chlamtac, 1985).  Adding a value is O(1) and no values are stored.
+ */
+
+#define DIST_NQ     3           /* p50, p95, p99 */
+
+typedef struct {
+    double p;                   /* quantile, e.g. 0.95 */
+    double q[5];                /* marker heights */
+    double n[5];                /* marker positions */
+    double np[5];               /* desired marker positions */
+} psquare_t;
+
+struct dist_struct {
+    long count;
+    double mean;
+    double m2;                  /* sum of squared deviations from mean */
+    psquare_t pq[DIST_NQ];
+};
+
+typedef struct dist_struct *dist_t;
+
+void dist_reset (dist_t d);
+void dist_add (dist_t d, double x);
+
+long dist_count (dist_t d);
+double dist_mean (dist_t d);
+double dist_stddev (dist_t d);
+
+/* Return the estimated p50 (i = 0), p95 (1) or p99 (2).
+ */
+double dist_quantile (dist_t d, int i);
+
+/* Return how many standard deviations x is from the mean (0 if the
+ * values are all the same).
+ */
+double dist_zscore (dist_t d, double x);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -33,6 +33,8 @@
 #include <unistd.h>
 #include <math.h>
 #include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #if HAVE_GETOPT_H
 #include <getopt.h>
 #endif
@@ -48,6 +50,7 @@
 #include "error.h"
 
 #include "proc.h"
+#include "lustre.h"
 #include "stat.h"
 #include "meminfo.h"
 
@@ -56,14 +59,18 @@
 #include "mdt.h"
 #include "osc.h"
 #include "router.h"
+#include "job.h"
+#include "export.h"
+#include "client.h"
 
-#define OPTIONS "m:r:t:"
+#define OPTIONS "m:r:t:b:"
 #if HAVE_GETOPT_LONG
 #define GETOPT(ac,av,opt,lopt) getopt_long (ac,av,opt,lopt,NULL)
 static const struct option longopts[] = {
     {"metric",          required_argument,  0, 'm'},
     {"proc-root",       required_argument,  0, 'r'},
     {"update-period",   required_argument,  0, 't'},
+    {"benchmark",       required_argument,  0, 'b'},
     {0, 0, 0, 0},
 };
 #else
@@ -71,15 +78,19 @@ static const struct option longopts[] = {
 #endif
 
 static int _sysstat (pctx_t ctx, char *buf, int len);
+static int _metric (pctx_t ctx, char *metric, char *buf, int len);
+static void _benchmark (pctx_t ctx, char *metric, int count);
 
 static void
 usage()
 {
     fprintf (stderr,
 "Usage: lmtmetric [OPTIONS]\n"
-"   -m,--metric NAME            select ost|mdt|osc|router|sysstat\n"
+"   -m,--metric NAME            select ost|mdt|osc|router|job|export|\n"
+"                               client|sysstat\n"
 "   -r,--root DIR               select root for (sys,proc) other than /\n"
 "   -t,--update-period SECS     [default: run once]\n"
+"   -b,--benchmark COUNT        report CPU time per collection, no output\n"
     );
     exit (1);
 }
@@ -92,6 +103,7 @@ main (int argc, char *argv[])
     char *proc_root = "/";
     char *metric = NULL;
     unsigned long update_period = 0;
+    int benchmark = 0;
     int c, n = 0;
 
     err_init (argv[0]);
@@ -111,6 +123,9 @@ main (int argc, char *argv[])
             case 't':   /* --update-period SECS */
                 update_period = strtoul (optarg, NULL, 10);
                 break;
+            case 'b':   /* --benchmark COUNT */
+                benchmark = strtoul (optarg, NULL, 10);
+                break;
             default:
                 usage ();
         }
@@ -119,7 +134,8 @@ main (int argc, char *argv[])
         usage();
     if (metric && strcmp (metric, "ost") && strcmp (metric, "mdt")
                && strcmp (metric, "osc") && strcmp (metric, "router")
-               && strcmp (metric, "sysstat"))
+               && strcmp (metric, "job") && strcmp (metric, "export")
+               && strcmp (metric, "client") && strcmp (metric, "sysstat"))
         usage();
     if (!metric)
         metric = "sysstat";
@@ -127,18 +143,14 @@ main (int argc, char *argv[])
     if (!(ctx = proc_create (proc_root)))
         err_exit ("proc_create");
 
+    if (benchmark > 0) {
+        _benchmark (ctx, metric, benchmark);
+        proc_destroy (ctx);
+        exit (0);
+    }
+
     do {
-        errno = 0;
-        if (!strcmp (metric, "sysstat"))
-            n = _sysstat (ctx, buf, sizeof (buf));
-        else if (!strcmp (metric, "ost"))
-            n = lmt_ost_string_v2 (ctx, buf, sizeof (buf));
-        else if (!strcmp (metric, "mdt"))
-            n = lmt_mdt_string_v3 (ctx, buf, sizeof (buf));
-        else if (!strcmp (metric, "osc"))
-            n = lmt_osc_string_v1 (ctx, buf, sizeof (buf));
-        else if (!strcmp (metric, "router"))
-            n = lmt_router_string_v1 (ctx, buf, sizeof (buf));
+        n = _metric (ctx, metric, buf, sizeof (buf));
         if (n < 0 && errno == 0)
             msg ("%s metric information unavailable", metric);
         else if (n < 0)
@@ -153,6 +165,62 @@ main (int argc, char *argv[])
     exit (0);
 }
 
+static int
+_metric (pctx_t ctx, char *metric, char *buf, int len)
+{
+    int n = 0;
+
+    errno = 0;
+    if (!strcmp (metric, "sysstat"))
+        n = _sysstat (ctx, buf, len);
+    else if (!strcmp (metric, "ost"))
+        n = lmt_ost_string_v3 (ctx, buf, len);
+    else if (!strcmp (metric, "mdt"))
+        n = lmt_mdt_string_v4 (ctx, buf, len);
+    else if (!strcmp (metric, "osc"))
+        n = lmt_osc_string_v1 (ctx, buf, len);
+    else if (!strcmp (metric, "router"))
+        n = lmt_router_string_v2 (ctx, buf, len);
+    else if (!strcmp (metric, "job"))
+        n = lmt_job_string_v1 (ctx, buf, len);
+    else if (!strcmp (metric, "export"))
+        n = lmt_export_string_v1 (ctx, buf, len);
+    else if (!strcmp (metric, "client"))
+        n = lmt_client_string_v1 (ctx, buf, len);
+    return n;
+}
+
+/* Collect the metric count times back to back and report the CPU time
+ * (user + system) used per collection, which is what a cerebro metric
+ * module costs the node each period.
+ */
+static void
+_benchmark (pctx_t ctx, char *metric, int count)
+{
+    char buf[CEREBRO_MAX_DATA_STRING_LEN];
+    struct rusage r0, r1;
+    double usecs;
+    int i;
+
+    lmt_conf_set_proto_debug (0);
+    if (_metric (ctx, metric, buf, sizeof (buf)) < 0) { /* warm up */
+        if (errno == 0)
+            msg_exit ("%s metric information unavailable", metric);
+        err_exit ("%s metric", metric);
+    }
+    getrusage (RUSAGE_SELF, &r0);
+    for (i = 0; i < count; i++)
+        if (_metric (ctx, metric, buf, sizeof (buf)) < 0)
+            err_exit ("%s metric", metric);
+    getrusage (RUSAGE_SELF, &r1);
+    usecs = (r1.ru_utime.tv_sec - r0.ru_utime.tv_sec) * 1E6
+          + (r1.ru_utime.tv_usec - r0.ru_utime.tv_usec)
+          + (r1.ru_stime.tv_sec - r0.ru_stime.tv_sec) * 1E6
+          + (r1.ru_stime.tv_usec - r0.ru_stime.tv_usec);
+    printf ("%s: %.3f ms CPU per collection (%d collections, %d bytes)\n",
+            metric, usecs / count / 1E3, count, (int)strlen (buf));
+}
+
 static int
 _sysstat (pctx_t ctx, char *buf, int len)
 {
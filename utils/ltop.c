@@ -45,12 +45,18 @@
 #include <time.h>
 #include <ctype.h>
 #include <assert.h>
+#include <sys/resource.h>
+#include <pthread.h>
+#include <sys/utsname.h>
 
 #include "list.h"
 #include "hash.h"
 #include "error.h"
 
 #include "proc.h"
+#include "stat.h"
+#include "meminfo.h"
+#include "lustre.h"
 #include "lmt.h"
 
 #include "util.h"
@@ -58,12 +64,19 @@
 #include "mdt.h"
 #include "osc.h"
 #include "router.h"
+#include "event.h"
+#include "job.h"
+#include "export.h"
+#include "client.h"
 
 #include "common.h"
 #include "lmtcerebro.h"
 #include "lmtconf.h"
 
 #include "sample.h"
+#include "dist.h"
+#include "ltopdb.h"
+#include "ltoprec.h"
 
 #ifndef MAXHOSTNAMELEN
 #define MAXHOSTNAMELEN 64
@@ -74,6 +87,7 @@
  * for OSTs, but needs to be visible to generic loop code.
  */
 typedef struct {
+    char key[MAXHOSTNAMELEN];   /* full target name, e.g. fs-OSTxxxx */
     char fsname[17];            /* file system name */
     char name[17];              /* target index (4 hex digits) */
     char servername[MAXHOSTNAMELEN];/* oss or mds hostname */
@@ -82,49 +96,75 @@ typedef struct {
                                             /* recovery status */
     char tgtstate[2];           /* single char state (blank if unknown), */
                                 /* from osc */
-    sample_t pct_cpu;
-    sample_t pct_mem;
-    sample_t pct_used;
+    sample_inline_t pct_cpu;
+    sample_inline_t pct_mem;
+    sample_inline_t pct_maxcpu; /* busiest cpu of the server */
+    sample_inline_t pct_iowait; /* server cpu time waiting on i/o */
+    sample_inline_t pct_softirq;/* server cpu time in softirqs */
+    sample_inline_t pct_used;
+    sample_inline_t svc_reqs;   /* server ptlrpc requests handled */
+    sample_inline_t svc_wait;   /* sum of their queue wait (usecs) */
+    sample_inline_t svc_qdepth; /* sum of queue depth at their arrival */
     int tag;                    /* display this target line underlined */
 } generic_target_t;
 
 typedef struct {
     generic_target_t common;    /* information common to all targets */
-    sample_t rbytes;            /* read bytes/sec */
-    sample_t wbytes;            /* write bytes/sec */
-    sample_t iops;              /* io operations (r/w) per second */
-    sample_t num_exports;       /* export count */
-    sample_t lock_count;        /* lock count */
-    sample_t grant_rate;        /* lock grant rate (LGR) */
-    sample_t cancel_rate;       /* lock cancel rate (LCR) */
-    sample_t connect;           /* connect+reconnect per second */
-    sample_t kbytes_free;       /* free space (kbytes) */
-    sample_t kbytes_total;      /* total space (kbytes) */
+    sample_inline_t rbytes;     /* read bytes/sec */
+    sample_inline_t wbytes;     /* write bytes/sec */
+    sample_inline_t iops;       /* io operations (r/w) per second */
+    sample_inline_t num_exports; /* export count */
+    sample_inline_t lock_count; /* lock count */
+    sample_inline_t grant_rate; /* lock grant rate (LGR) */
+    sample_inline_t cancel_rate; /* lock cancel rate (LCR) */
+    sample_inline_t connect;    /* connect+reconnect per second */
+    sample_inline_t kbytes_free; /* free space (kbytes) */
+    sample_inline_t kbytes_total; /* total space (kbytes) */
+    sample_inline_t nic_rbytes; /* oss network bytes received/sec */
+    sample_inline_t nic_wbytes; /* oss network bytes transmitted/sec */
+    sample_inline_t nic_mbps;   /* oss network link speed (Mbit/s) */
+    sample_inline_t arc_hits;   /* oss ZFS ARC hits */
+    sample_inline_t arc_misses; /* oss ZFS ARC misses */
+    sample_inline_t txg_sync;   /* sync time of the newest txg of the */
+                                /* zpool backing the ost (ms) */
+    sample_inline_t dev_ios;    /* reads+writes completed by the */
+                                /* block device under the ost */
+    sample_inline_t dev_ms;     /* time spent on them (ms) */
+    sample_inline_t dev_busy;   /* time the device was busy (ms) */
+    sample_inline_t dev_queue;  /* busy time weighted by queue depth (ms) */
     time_t ost_metric_timestamp;/* cerebro timestamp for ost metric (not osc) */
     char ossname[MAXHOSTNAMELEN];/* oss hostname */
 } oststat_t;
 
 typedef struct {
     generic_target_t common;    /* information common to all targets */
-    sample_t inodes_free;       /* free inode count */
-    sample_t inodes_total;      /* total inode count */
-    sample_t open;              /* open ops/sec */
-    sample_t close;             /* close ops/sec */
-    sample_t getattr;           /* getattr ops/sec */
-    sample_t setattr;           /* setattr ops/sec */
-    sample_t link;              /* link ops/sec */
-    sample_t unlink;            /* unlink ops/sec */
-    sample_t mkdir;             /* mkdir ops/sec */
-    sample_t rmdir;             /* rmdir ops/sec */
-    sample_t statfs;            /* statfs ops/sec */
-    sample_t rename;            /* rename ops/sec */
-    sample_t kbytes_free;       /* free space (kbytes) */
-    sample_t kbytes_total;      /* total space (kbytes) */
-    sample_t getxattr;          /* getxattr ops/sec */
-    sample_t read_bytes;        /* read_bytes bytes/sec */
-    sample_t write_bytes;       /* write_bytes bytes/sec */
+    sample_inline_t inodes_free; /* free inode count */
+    sample_inline_t inodes_total; /* total inode count */
+    sample_inline_t open;       /* open ops/sec */
+    sample_inline_t close;      /* close ops/sec */
+    sample_inline_t getattr;    /* getattr ops/sec */
+    sample_inline_t setattr;    /* setattr ops/sec */
+    sample_inline_t link;       /* link ops/sec */
+    sample_inline_t unlink;     /* unlink ops/sec */
+    sample_inline_t mkdir;      /* mkdir ops/sec */
+    sample_inline_t rmdir;      /* rmdir ops/sec */
+    sample_inline_t statfs;     /* statfs ops/sec */
+    sample_inline_t rename;     /* rename ops/sec */
+    sample_inline_t kbytes_free; /* free space (kbytes) */
+    sample_inline_t kbytes_total; /* total space (kbytes) */
+    sample_inline_t getxattr;   /* getxattr ops/sec */
+    sample_inline_t read_bytes; /* read_bytes bytes/sec */
+    sample_inline_t write_bytes; /* write_bytes bytes/sec */
 } mdtstat_t;
 
+/* Targets in display order, indexed by full target name so that
+ * decoding a sample is linear in the number of targets.
+ */
+typedef struct {
+    List list;
+    hash_t index;
+} tgtlist_t;
+
 typedef struct {
     ListCmpF fun;
     char k;
@@ -132,9 +172,9 @@ typedef struct {
 } sort_t;
 
 typedef struct {
-    long p;                     /* file offset */
-    uint64_t t;                 /* time stamp */
-} ts_t;
+    void *tgt;                  /* oststat_t or mdtstat_t */
+    int pos;                    /* list position before sorting */
+} sortent_t;
 
 typedef struct {
     char     fsname[17];       /* file system name */
@@ -142,6 +182,86 @@ typedef struct {
     uint64_t num_ost;          /* number of OSTs */
 } fsstat_t;
 
+typedef struct {
+    time_t t;                   /* time stamp */
+    char text[80];              /* e.g. "OST0001 FAILOVER oss1 -> oss2" */
+} evlog_t;
+
+typedef struct {
+    char id[64];                /* job id */
+    uint64_t read_bytes;        /* bytes read in the last secs seconds */
+    uint64_t write_bytes;       /* bytes written in the last secs seconds */
+    uint64_t ops;               /* requests in the last secs seconds */
+} jobrpt_t;
+
+typedef struct {
+    char name[64];              /* target name */
+    time_t trcv;                /* cerebro timestamp of the report */
+    int secs;                   /* seconds covered (0 before a baseline) */
+    int njobs;
+    jobrpt_t *job;              /* busiest jobs on the target */
+} jobtgt_t;
+
+typedef struct {
+    char id[64];                /* job id */
+    double rbps;                /* read bytes/sec summed over targets */
+    double wbps;                /* write bytes/sec summed over targets */
+    double ops;                 /* requests/sec summed over targets */
+    int ntgt;                   /* targets reporting the job */
+} jobsum_t;
+
+typedef struct {
+    char nid[64];               /* client nid */
+    uint64_t read_bytes;        /* bytes read in the last secs seconds */
+    uint64_t write_bytes;       /* bytes written in the last secs seconds */
+    uint64_t ops;               /* requests in the last secs seconds */
+    uint64_t locks;             /* lock enqueues in the last secs seconds */
+} exprpt_t;
+
+typedef struct {
+    char name[64];              /* target name */
+    char servername[MAXHOSTNAMELEN]; /* oss or mds hostname */
+    time_t trcv;                /* cerebro timestamp of the report */
+    int secs;                   /* seconds covered (0 before a baseline) */
+    int nclients;
+    exprpt_t *client;           /* busiest clients of the target */
+} exptgt_t;
+
+typedef struct {
+    char nid[64];               /* client nid */
+    double rbps;                /* read bytes/sec summed over targets */
+    double wbps;                /* write bytes/sec summed over targets */
+    double ops;                 /* requests/sec summed over targets */
+    double locks;               /* lock enqueues/sec summed over targets */
+    int ntgt;                   /* targets reporting the client */
+} expsum_t;
+
+typedef struct {
+    char key[MAXHOSTNAMELEN + 64]; /* host:mount */
+    char host[MAXHOSTNAMELEN];  /* client hostname */
+    time_t trcv;                /* cerebro timestamp of the report */
+    int secs;                   /* seconds covered (0 before a baseline) */
+    clistat_t c;                /* activity in the last secs seconds */
+} clirpt_t;
+
+typedef struct {
+    char name[MAXHOSTNAMELEN];  /* router hostname */
+    int group;                  /* router group id (0 if none) */
+    time_t trcv;                /* cerebro timestamp of the report */
+    sample_inline_t bytes;      /* bytes forwarded/sec */
+    sample_inline_t drops;      /* lnet messages dropped/sec */
+    float pct_cpu;
+    int nni;                    /* non-loopback NIs */
+    char ni_nid[64];            /* NI with the lowest min credits */
+    int ni_min;
+    int ni_max;
+    int npeer;                  /* peers in the peer table */
+    int nstarved;               /* peers whose min credits went < 0 */
+    uint64_t queue;             /* bytes waiting for peer credits */
+    char peer_nid[64];          /* peer with the lowest min credits */
+    int peer_min;
+} rtrstat_t;
+
 /* used by _update_display_target */
 typedef void (* _display_line_fn) (WINDOW *win, int line, void *o,
                                   int stale_secs, time_t tnow);
@@ -150,16 +270,27 @@ typedef void (* _display_line_fn) (WINDOW *win, int line, void *o,
 typedef void (* _tgt_update_summary) (void *tgt_v, void *summary_v);
 typedef void * (* _copy_tgtstat) (void *src);
 
-static void _poll_cerebro (char *fs, List mdt_data, List ost_data,
-                           int stale_secs, FILE *recf, time_t *tp);
-static void _play_file (char *fs, List mdt_data, List ost_data,
-                        List time_series, int stale_secs, FILE *playf,
+static void _poll_cerebro (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+                           int stale_secs, ltoprec_t recf, time_t *tp);
+static void _poll_local (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+                         int stale_secs, ltoprec_t recf, time_t *tp);
+static void _poll_start (int sample_period);
+static int _poll_late (time_t tnow, int sample_period);
+static void _play_file (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+                        int stale_secs, ltoprec_t playf,
                         time_t *tp, int *tdiffp);
+static void _play_db (ltopdb_t dbh, char *fs, tgtlist_t *mdt_data,
+                      tgtlist_t *ost_data,
+                      int stale_secs, time_t *tp);
 static void _update_display_help (WINDOW *win);
-static char *_choose_fs (WINDOW *win, FILE *playf, int stale_secs);
+static void _update_ost_dist (List ost_data, time_t tnow, int stale_secs);
+static void _update_terminal (void);
+static char *_choose_fs (WINDOW *win, ltoprec_t playf, int stale_secs);
 static void _update_display_top (WINDOW *win, char *fs, List mdt_data,
-                                 List ost_data, int stale_secs, FILE *recf,
-                                 FILE *playf, time_t tnow, int pause);
+                                 List ost_data, int stale_secs,
+                                 ltoprec_t recf, ltoprec_t playf,
+                                 ltopdb_t dbh, time_t tnow,
+                                 int pause, int late);
 static void _update_display_hdr (WINDOW *win, int cols, sort_t colhdr[],
                                  int selcol);
 static void _update_display_target (WINDOW *win, List target_data,
@@ -179,16 +310,47 @@ static void _summarize_mdt (List mdt_data, List mds_data, time_t tnow,
                             int stale_secs);
 static void _clear_tags (List ost_data);
 static void _tag_nth_ost (List ost_data, int selost, List ost_data2);
-static void _sort_tgtlist (List tgt_data, time_t tnow,
-                           ListCmpF comparison_function);
+static int  _sort_tgtlist (List tgt_data, time_t tnow,
+                           ListCmpF comparison_function, int k);
 static int  _get_sort_index (char k, int sort_index, sort_t c[], int nc);
-static char *_find_first_fs (FILE *playf, int stale_secs);
-static List _find_all_fs (FILE *playf, int stale_secs);
-static void _record_file (FILE *f, time_t tnow, time_t trcv, char *node,
-                          char *name, char *s);
-static int _rewind_file (FILE *f, List time_series, int count);
-static void _rewind_file_to (FILE *f, List time_series, time_t target);
+static char *_find_first_fs (ltoprec_t playf, int stale_secs);
+static void _benchmark (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+                        List oss_data, List mds_data,
+                        int stale_secs, ltoprec_t playf);
+static List _find_all_fs (ltoprec_t playf, int stale_secs);
+static void _batch (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+                    int stale_secs, int sample_period, ltoprec_t playf,
+                    int json, time_t tcycle);
+static void _convert_file (char *path, ltoprec_t rec);
+static void _ring_record (char *dir, int sample_period, int segments,
+                          int segsecs);
 static void _list_empty_out (List l);
+static int _index_remove_all (void *data, const void *key, void *arg);
+static tgtlist_t *_tgtlist_create (ListDelF del);
+static void _tgtlist_destroy (tgtlist_t *t);
+static void _tgtlist_empty (tgtlist_t *t);
+static void *_tgtlist_find (tgtlist_t *t, const char *name);
+static void _tgtlist_append (tgtlist_t *t, void *tgt);
+static int _parse_time (char *s, time_t *tp);
+static void _update_display_jobs (WINDOW *win, char *fs, time_t tnow,
+                                  int stale_secs);
+static void _clear_jobs (void);
+static void _destroy_jobtgt (jobtgt_t *t);
+static void _update_display_exports (WINDOW *win, char *name, int byserver,
+                                     time_t tnow, int stale_secs);
+static void _clear_exports (void);
+static void _destroy_exptgt (exptgt_t *t);
+static void _update_display_clients (WINDOW *win, char *fs, time_t tnow,
+                                     int stale_secs);
+static void _clear_clients (void);
+static void _update_display_routers (WINDOW *win, time_t tnow,
+                                     int stale_secs);
+static void _clear_routers (void);
+static generic_target_t *_nth_target (List l, int n);
+static void _update_display_events (WINDOW *win, char *fs);
+static void _clear_events (void);
+static void _track_target (char *target, char *server, char *recov_status,
+                           char *fs, time_t trcv);
 
 
 /* comparison functions needed to sort by different fields */
@@ -196,7 +358,10 @@ static void _list_empty_out (List l);
 static int _cmp_tgtstat_byserver (void *p1, void *p2);
 static int _cmp_tgtstat_bytarget (void *p1, void *p2);
 static int _cmp_tgtstat_bycpu (void *p1, void *p2);
+static int _cmp_tgtstat_bycore (void *p1, void *p2);
 static int _cmp_tgtstat_bymem (void *p1, void *p2);
+static int _cmp_tgtstat_byqueue (void *p1, void *p2);
+static int _cmp_tgtstat_bywait (void *p1, void *p2);
 static int _cmp_tgtstat_noop (void *p1, void *p2);
 
 /* OST/OSS */
@@ -204,11 +369,16 @@ static int _cmp_oststat_byexp (oststat_t *o1, oststat_t *o2);
 static int _cmp_oststat_bylocks (oststat_t *o1, oststat_t *o2);
 static int _cmp_oststat_bylgr (oststat_t *o1, oststat_t *o2);
 static int _cmp_oststat_bylcr (oststat_t *o1, oststat_t *o2);
+static int _cmp_oststat_byarc (oststat_t *o1, oststat_t *o2);
+static int _cmp_oststat_bytxg (oststat_t *o1, oststat_t *o2);
+static int _cmp_oststat_bydev (oststat_t *o1, oststat_t *o2);
+static int _cmp_oststat_byawait (oststat_t *o1, oststat_t *o2);
 static int _cmp_oststat_byconn (oststat_t *o1, oststat_t *o2);
 static int _cmp_oststat_byiops (oststat_t *o1, oststat_t *o2);
 static int _cmp_oststat_byrbw (oststat_t *o1, oststat_t *o2);
 static int _cmp_oststat_bywbw (oststat_t *o1, oststat_t *o2);
 static int _cmp_oststat_byspc (oststat_t *o1, oststat_t *o2);
+static int _cmp_oststat_bynic (oststat_t *o1, oststat_t *o2);
 
 /* MDT/MDS */
 static int _cmp_mdtstat_byrbw (mdtstat_t *m1, mdtstat_t *m2);
@@ -224,29 +394,123 @@ static int _cmp_mdtstat_byino     (mdtstat_t *m1, mdtstat_t *m2);
 
 /* Top of display fixed.
  */
-#define TOPWIN_LINES    7       /* lines in topwin */
+#define TOPWIN_LINES    8       /* lines in topwin */
+#define TGTHASH_SIZE    4096    /* buckets in target/server indexes */
 #define WINDOW_WIDTH   90       /* width of windows */
 
-#define OPTIONS "f:t:s:r:p:"
+#define BENCHMARK_ROWS  50      /* rows sorted per cycle by --benchmark */
+#define BENCHMARK_LOCAL_CYCLES 100 /* --local samples timed by --benchmark */
+#define LOCAL_BUFSIZE   65536   /* max length of a --local metric string */
+#define SPARK_WIDTH     (SAMPLE_RING - 1) /* rate history columns */
+
+#define EVENT_LOG_MAX       100     /* events kept for the 'e' window */
+#define EVENT_OVERLAY_SECS  300     /* show latest event in topwin this long */
+#define EVENT_DB_SECS       3600    /* db mode: events loaded before cursor */
+
+#define OPTIONS "f:t:s:r:p:d:a:bc:R:n:l:BF:w:Ez:LP:"
 #if HAVE_GETOPT_LONG
 #define GETOPT(ac,av,opt,lopt) getopt_long (ac,av,opt,lopt,NULL)
 static const struct option longopts[] = {
     {"filesystem",      required_argument,  0, 'f'},
     {"sample-period",   required_argument,  0, 't'},
+    {"interval",        required_argument,  0, 't'},
     {"stale-secs",      required_argument,  0, 's'},
     {"record",          required_argument,  0, 'r'},
     {"play",            required_argument,  0, 'p'},
+    {"db",              required_argument,  0, 'd'},
+    {"at",              required_argument,  0, 'a'},
+    {"benchmark",       no_argument,        0, 'b'},
+    {"convert",         required_argument,  0, 'c'},
+    {"ring",            required_argument,  0, 'R'},
+    {"ring-segments",   required_argument,  0, 'n'},
+    {"ring-length",     required_argument,  0, 'l'},
+    {"batch",           no_argument,        0, 'B'},
+    {"format",          required_argument,  0, 'F'},
+    {"rate-window",     required_argument,  0, 'w'},
+    {"ewma",            no_argument,        0, 'E'},
+    {"outlier-z",       required_argument,  0, 'z'},
+    {"local",           no_argument,        0, 'L'},
+    {"proc-root",       required_argument,  0, 'P'},
     {0, 0, 0, 0},
 };
 #else
 #define GETOPT(ac,av,opt,lopt) getopt (ac,av,opt)
 #endif
 
-/* N.B. This global is used ONLY for the purpose of allowing
+/* N.B. These globals are used ONLY for the purpose of allowing
  * _sort_tgtlist () to pass the current time to its various sorting
- * functions that operate on samples and must validate them.
+ * functions that operate on samples and must validate them, and to
+ * pass the sorting function to _cmp_sortent ().
  */
 static time_t sort_tnow = 0;
+static ListCmpF sort_fun = NULL;
+
+/* Transitions detected in live or playback data by evtrack, or read
+ * from EVENT_DATA in database mode (evtrack is then NULL).
+ * The event log is oldest first, at most EVENT_LOG_MAX entries.
+ */
+static lmt_evtrack_t evtrack = NULL;
+static List events = NULL;
+
+/* Latest lmt_job report of each target, by target name, for the 'J'
+ * window.  Targets only report their busiest jobs, so a job's total is
+ * a lower bound when it is busy on many targets.
+ */
+static hash_t jobtgts = NULL;
+
+/* Latest lmt_export report of each target, by target name, for the
+ * client drill-down window.  Sent only by servers with
+ * lmt_export_enable set in lmt.conf.
+ */
+static hash_t exptgts = NULL;
+
+/* Latest lmt_client report of each client mount, by host:mount, for
+ * the 'I' window.  Sent only by the lmt_client_sample percent of
+ * clients, every lmt_client_period seconds.
+ */
+static hash_t clirpts = NULL;
+
+/* Latest lmt_router report of each LNet router, by hostname, for the
+ * 'N' window.  Routers are not specific to a file system.
+ */
+static hash_t rtrstats = NULL;
+
+/* Latest cerebro metrics, fetched by _poll_fetch () and decoded by
+ * _poll_cerebro ().  Once _poll_start () is called, fetching is done by
+ * a background thread, since cerebro can take seconds to answer and the
+ * display loop must keep handling keys meanwhile.
+ */
+static pthread_mutex_t poll_lock = PTHREAD_MUTEX_INITIALIZER;
+static List poll_metrics = NULL;
+static time_t poll_time = 0;            /* when poll_metrics was fetched */
+static time_t poll_recorded = 0;        /* poll_time last written to recf */
+static int poll_threaded = 0;
+
+/* In --local mode, metrics are generated from /proc (or --proc-root) by
+ * calling the cerebro metric modules' string functions in-process, and
+ * _poll_cerebro () never talks to cerebro.
+ */
+static pctx_t local_ctx = NULL;
+
+/* Distribution of each OST (or OSS) metric across the targets being
+ * displayed, recomputed every time the display is drawn.  Lines whose
+ * z-score for any metric reaches outlier_z are highlighted.
+ */
+typedef enum {
+    DIST_RBW, DIST_WBW, DIST_IOPS, DIST_LOCKS, DIST_LGR, DIST_LCR, DIST_COUNT
+} ost_metric_t;
+static struct dist_struct ost_dist[DIST_COUNT];
+static double outlier_z = 3;
+
+/* Set by SIGINT or SIGTERM to stop _ring_record ().
+ */
+static volatile sig_atomic_t ring_done = 0;
+
+/* Bytes sent to the terminal by _update_terminal (), for the help window.
+ */
+static uint64_t term_bytes = 0;
+static uint64_t term_refreshes = 0;
+static uint64_t term_last = 0;
 
 /* The order of records in ost_col and mdt_col should match the order
  * the corresponding columns are displayed, so that when the user
@@ -266,7 +530,15 @@ sort_t ost_col[] = {
     { .fun = (ListCmpF)_cmp_oststat_bylocks, .k = 'l',  .h = "  %sLOCKS"    },
     { .fun = (ListCmpF)_cmp_oststat_bylgr,   .k = 'g',  .h = " %sLGR"       },
     { .fun = (ListCmpF)_cmp_oststat_bylcr,   .k = 'L',  .h = " %sLCR"       },
+    { .fun = (ListCmpF)_cmp_oststat_bynic,   .k = 'n',  .h = "%s%%nic"      },
+    { .fun = (ListCmpF)_cmp_tgtstat_byqueue, .k = 'Q',  .h = "%squeue"      },
+    { .fun = (ListCmpF)_cmp_tgtstat_bywait,  .k = 'W',  .h = "%swait ms"    },
+    { .fun = (ListCmpF)_cmp_oststat_byarc,   .k = 'A',  .h = "%sarc%%"      },
+    { .fun = (ListCmpF)_cmp_oststat_bytxg,   .k = 'X',  .h = "%stxg ms"     },
+    { .fun = (ListCmpF)_cmp_oststat_bydev,   .k = 'D',  .h = "%sdev%%"      },
+    { .fun = (ListCmpF)_cmp_oststat_byawait, .k = 'T',  .h = "%sawait"      },
     { .fun = (ListCmpF)_cmp_tgtstat_bycpu,   .k = 'u',  .h = "%s%%cpu"      },
+    { .fun = (ListCmpF)_cmp_tgtstat_bycore,  .k = 'H',  .h = "%s%%core"     },
     { .fun = (ListCmpF)_cmp_tgtstat_bymem,   .k = 'm',  .h = "%s%%mem"      },
     { .fun = (ListCmpF)_cmp_oststat_byspc,   .k = 'S',  .h = "%s%%spc"      },
 };
@@ -282,7 +554,10 @@ sort_t mdt_col[] = {
     { .fun = (ListCmpF)_cmp_mdtstat_byunlink, .k =  'U', .h = "%sUnlnk"      },
     { .fun = (ListCmpF)_cmp_mdtstat_bymkdir,  .k =  'M', .h = "%sMkdir"      },
     { .fun = (ListCmpF)_cmp_mdtstat_byrmdir,  .k =  'r', .h = "%sRmdir"      },
+    { .fun = (ListCmpF)_cmp_tgtstat_byqueue,  .k =  'Q', .h = "%squeue"      },
+    { .fun = (ListCmpF)_cmp_tgtstat_bywait,   .k =  'W', .h = "%swait ms"    },
     { .fun = (ListCmpF)_cmp_tgtstat_bycpu,    .k =  'u', .h = " %s%%cpu"     },
+    { .fun = (ListCmpF)_cmp_tgtstat_bycore,   .k =  'H', .h = "%s%%core"     },
     { .fun = (ListCmpF)_cmp_tgtstat_bymem,    .k =  'm', .h = " %s%%mem"     },
     { .fun = (ListCmpF)_cmp_mdtstat_byspc,    .k =  'T', .h = " %s%%spc"     },
     { .fun = (ListCmpF)_cmp_mdtstat_byino,    .k =  'T', .h = "%s%%ino"      },
@@ -298,6 +573,20 @@ usage (void)
 "   -r,--record FILE          record session to FILE\n"
 "   -p,--play FILE            play session from FILE\n"
 "   -s,--stale-secs SECS      ignore data older than SECS [default: 12]\n"
+"   -d,--db FS                play back file system FS from the LMT database\n"
+"   -a,--at TIME              start --db playback at TIME [default: now]\n"
+"   -b,--benchmark            time --play processing, no display\n"
+"   -c,--convert FILE         convert old text recording FILE to --record\n"
+"   -R,--ring DIR             record to a ring of files in DIR, no display\n"
+"   -n,--ring-segments N      keep N files in the --ring [default: 24]\n"
+"   -l,--ring-length SECS     start a new --ring file every SECS [default: 900]\n"
+"   -B,--batch                print a record per target each cycle, no display\n"
+"   -F,--format csv|json      --batch output format [default: csv]\n"
+"   -w,--rate-window SECS     average rates over SECS [default: 1 period]\n"
+"   -E,--ewma                 show rates as moving averages over --rate-window\n"
+"   -z,--outlier-z Z          highlight OSTs Z std devs from mean [default: 3]\n"
+"   -L,--local                read this server's /proc directly, not cerebro\n"
+"   -P,--proc-root DIR        --local root other than / (implies --local)\n"
     );
     exit (1);
 }
@@ -407,7 +696,10 @@ void
 create_target_window(WINDOW **targetwin, int targetlines, int start_y)
 {
     if (targetlines>=2) {
-        if (!(*targetwin = newwin (targetlines, WINDOW_WIDTH, start_y, 0)))
+        /* use the full width, if wider, to make room for History */
+        int width = COLS > WINDOW_WIDTH ? COLS : WINDOW_WIDTH;
+
+        if (!(*targetwin = newwin (targetlines, width, start_y, 0)))
                 err_exit ("error initializing subwindow");
     } else {
         *targetwin = NULL;
@@ -423,6 +715,7 @@ main (int argc, char *argv[])
     int ostcount, selost = -1, minost = 0;
     int mdtcount, selmdt = -1, minmdt = 0;
     int mdtlines = 0, ostlines = 0;
+    int mdt_sorted = 0, ost_sorted = 0; /* rows in sort order */
     int *mintgt = &minost, *seltgt = &selost, *tgtlines = &ostlines;
     int *tgtcount = &ostcount;
     int mdtview = 1, ostview = 1, resort = 0, recompute = 0, repoll = 0;
@@ -432,18 +725,39 @@ main (int argc, char *argv[])
     int sopt = 0;
     int sample_period = 2; /* seconds */
     int stale_secs = 12; /* seconds */
-    List ost_data = list_create ((ListDelF)_destroy_oststat);
+    tgtlist_t *ost_data = _tgtlist_create ((ListDelF)_destroy_oststat);
     List oss_data = list_create ((ListDelF)_destroy_oststat);
-    List mdt_data = list_create ((ListDelF)_destroy_mdtstat);
+    tgtlist_t *mdt_data = _tgtlist_create ((ListDelF)_destroy_mdtstat);
     List mds_data = list_create ((ListDelF)_destroy_oststat);
-    List time_series = list_create ((ListDelF)free);
     time_t tcycle, last_sample = 0;
     char *recpath = "ltop.log";
-    FILE *recf = NULL;
-    FILE *playf = NULL;
+    ltoprec_t recf = NULL;
+    ltoprec_t playf = NULL;
+    char *convpath = NULL;
+    char *ringdir = NULL;
+    int ring_segments = 24;
+    int ring_secs = 900;
+    ltopdb_t dbh = NULL;
+    char *dbfs = NULL;
+    time_t dbtime = 0;
+    int dbstep = 0, dbjump = 1;
     int pause = 0;
     int showhelp = 0;
+    int showevents = 0;
+    int showjobs = 0;
+    int showcli = 0;
+    int showrtr = 0;
+    char showclients[MAXHOSTNAMELEN] = "";
+    int showclients_server = 0;
+    generic_target_t *g;
     int mdt_fp = 0, ost_fp = 0;
+    int benchmark = 0;
+    int batch = 0;
+    int json = 0;
+    int rate_window = 0;
+    int ewma = 0;
+    int local = 0;
+    char *proc_root = "/";
 
     err_init (argv[0]);
     optind = 0;
@@ -463,14 +777,72 @@ main (int argc, char *argv[])
             case 's':   /* --stale-secs SECS */
                 stale_secs = strtoul (optarg, NULL, 10);
                 break;
+            case 'w':   /* --rate-window SECS */
+                rate_window = strtoul (optarg, NULL, 10);
+                break;
+            case 'E':   /* --ewma */
+                ewma = 1;
+                break;
+            case 'z':   /* --outlier-z Z */
+                outlier_z = strtod (optarg, NULL);
+                break;
+            case 'L':   /* --local */
+                local = 1;
+                break;
+            case 'P':   /* --proc-root DIR */
+                proc_root = optarg;
+                local = 1;
+                break;
             case 'r':   /* --record FILE */
                 recpath = optarg;
-                if (!(recf = fopen (recpath, "w+")))
+                if (!(recf = ltoprec_create (recpath)))
                     err_exit ("error opening %s for writing", recpath);
                 break;
             case 'p':   /* --play FILE */
-                if (!(playf = fopen (optarg, "r")))
+                if (!(playf = ltoprec_open (optarg))) {
+                    if (errno == EINVAL)
+                        msg_exit ("%s is not an ltop recording, "
+                                  "text recordings must be converted "
+                                  "with --convert", optarg);
                     err_exit ("error opening %s for reading", optarg);
+                }
+                break;
+            case 'd':   /* --db FS */
+                dbfs = optarg;
+                break;
+            case 'a':   /* --at TIME */
+                if (_parse_time (optarg, &dbtime) < 0)
+                    msg_exit ("error parsing time: %s", optarg);
+                break;
+            case 'b':   /* --benchmark */
+                benchmark = 1;
+                break;
+            case 'c':   /* --convert FILE */
+                convpath = optarg;
+                break;
+            case 'R':   /* --ring DIR */
+                ringdir = optarg;
+                break;
+            case 'n':   /* --ring-segments N */
+                ring_segments = strtoul (optarg, NULL, 10);
+                if (ring_segments < 1)
+                    msg_exit ("--ring-segments must be at least 1");
+                break;
+            case 'B':   /* --batch */
+                batch = 1;
+                break;
+            case 'F':   /* --format csv|json */
+                if (!strcmp (optarg, "json"))
+                    json = 1;
+                else if (!strcmp (optarg, "csv"))
+                    json = 0;
+                else
+                    msg_exit ("unknown --format: %s", optarg);
+                break;
+            case 'l':   /* --ring-length SECS */
+                ring_secs = strtoul (optarg, NULL, 10);
+                if (ring_secs < 1)
+                    msg_exit ("--ring-length must be at least 1");
                 break;
             default:
                 usage ();
@@ -478,12 +850,77 @@ main (int argc, char *argv[])
     }
     if (optind < argc)
         usage();
+    if (ewma && rate_window == 0)
+        msg_exit ("--ewma requires --rate-window");
+    sample_set_window (rate_window, ewma);
+    if (convpath) {
+        if (!recf || playf || dbfs)
+            msg_exit ("--convert can only be used with --record");
+        _convert_file (convpath, recf);
+        if (ltoprec_close (recf) < 0)
+            err_exit ("error writing %s", recpath);
+        msg ("Converted %s to %s", convpath, recpath);
+        exit (0);
+    }
+    if (local) {
+        if (playf || dbfs)
+            msg_exit ("--local cannot be used with --play or --db");
+        if (!(local_ctx = proc_create (proc_root)))
+            err_exit ("error opening %s", proc_root);
+        if (!sopt)
+            sample_period = 1;
+    }
+    if (ringdir) {
+        if (recf || playf || dbfs || benchmark)
+            msg_exit ("--ring cannot be used with --record, --play or --db");
+#if ! HAVE_CEREBRO_H
+        if (!local_ctx)
+            msg_exit ("ltop was not built with cerebro support");
+#endif
+        _ring_record (ringdir, sample_period, ring_segments, ring_secs);
+        exit (0);
+    }
+    if (benchmark && !playf && !local_ctx)
+        msg_exit ("--benchmark can only be used with --play or --local");
+    if (batch && (dbfs || benchmark))
+        msg_exit ("--batch cannot be used with --db or --benchmark");
     if (playf && sopt)
         msg_exit ("--sample-period and --play cannot be used together");
     if (playf && recf)
         msg_exit ("--record and --play cannot be used together");
+    if (dbtime && !dbfs)
+        msg_exit ("--at can only be used with --db");
+    /* for the database credentials and the router groups */
+    if (lmt_conf_init (1, NULL) < 0)
+        msg_exit ("error parsing lmt config file");
+    if (dbfs) {
+        if (playf || recf)
+            msg_exit ("--db cannot be used with --play or --record");
+#if HAVE_MYSQL
+        if (!(dbh = ltopdb_create (dbfs, dbtime ? dbtime : time (NULL))))
+            msg_exit ("error opening LMT database for file system `%s'", dbfs);
+        if (!sopt)
+            sample_period = ltopdb_interval (dbh);
+        if (fs)
+            free (fs);
+        fs = xstrdup (dbfs);
+#else
+        msg_exit ("ltop was not built with MySQL support");
+#endif
+    }
+    events = list_create ((ListDelF)free);
+    jobtgts = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                           (hash_cmp_f)strcmp, (hash_del_f)_destroy_jobtgt);
+    exptgts = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                           (hash_cmp_f)strcmp, (hash_del_f)_destroy_exptgt);
+    clirpts = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                           (hash_cmp_f)strcmp, (hash_del_f)free);
+    rtrstats = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                            (hash_cmp_f)strcmp, (hash_del_f)free);
+    if (!dbh)
+        evtrack = lmt_evtrack_create ();
 #if ! HAVE_CEREBRO_H
-    if (!playf)
+    if (!playf && !dbh && !local_ctx)
         msg_exit ("ltop was not built with cerebro support, use -p option");
 #endif
     if (!fs)
@@ -494,22 +931,33 @@ main (int argc, char *argv[])
     /* Poll cerebro for data, then sort the ost data for display.
      * If either the mds or any ost's are up, then ostcount > 0.
      */
-    if (playf) {
-        _play_file (fs, mdt_data, ost_data, time_series,
+    if (dbh)
+        _play_db (dbh, fs, mdt_data, ost_data, stale_secs, &tcycle);
+    else if (playf) {
+        _play_file (fs, mdt_data, ost_data,
                     stale_secs, playf, &tcycle, &sample_period);
-        if (feof (playf))
+        if (ltoprec_eof (playf))
             msg_exit ("premature end of file on playback file");
     } else
         _poll_cerebro (fs, mdt_data, ost_data, stale_secs, recf, &tcycle);
-    _sort_tgtlist (ost_data, tcycle, ost_col[ost_fp].fun);
-    _sort_tgtlist (mdt_data, tcycle, mdt_col[mdt_fp].fun);
     assert (ostview);
     assert (mdtview);
-    mdtcount = list_count (mdt_data);
-    ostcount = list_count (ost_data);
+    mdtcount = list_count (mdt_data->list);
+    ostcount = list_count (ost_data->list);
     if (mdtcount == 0 && ostcount == 0)
         msg_exit ("Neither MDT nor OST data found for file system `%s'", fs);
 
+    if (benchmark) {
+        _benchmark (fs, mdt_data, ost_data, oss_data, mds_data,
+                    stale_secs, playf);
+        exit (0);
+    }
+    if (batch) {
+        _batch (fs, mdt_data, ost_data, stale_secs, sample_period, playf,
+                json, tcycle);
+        exit (0);
+    }
+
     /* Initialize curses and create the windows.  more curses below. */
     if (!(topwin = initscr ()))
         err_exit ("error initializing parent window");
@@ -536,6 +984,9 @@ main (int argc, char *argv[])
     keypad (topwin, TRUE);
     curs_set (0);
 
+    if (!playf && !dbh && !local_ctx)
+        _poll_start (sample_period);
+
     /* Main processing loop:
      * Update display, read kbd (or timeout), update ost/mdt_data,
      *   create oss/mds_data (summary of ost/mdt_data), [repeat]
@@ -543,26 +994,70 @@ main (int argc, char *argv[])
     while (!isendwin ()) {
         if (showhelp) {
             _update_display_help (topwin);
+        } else if (showevents) {
+            _update_display_events (topwin, fs);
+        } else if (showjobs) {
+            _update_display_jobs (topwin, fs, tcycle, stale_secs);
+        } else if (showcli) {
+            _update_display_clients (topwin, fs, tcycle, stale_secs);
+        } else if (showrtr) {
+            _update_display_routers (topwin, tcycle, stale_secs);
+        } else if (showclients[0]) {
+            _update_display_exports (topwin, showclients, showclients_server,
+                                     tcycle, stale_secs);
         } else {
-            _update_display_top (topwin, fs, ost_data, mdt_data, stale_secs,
-                                 recf, playf, tcycle, pause);
+            _update_ost_dist (ostview ? ost_data->list : oss_data, tcycle,
+                              stale_secs);
+            _update_display_top (topwin, fs, ost_data->list, mdt_data->list, stale_secs,
+                                 recf, playf, dbh, tcycle, pause,
+                                 _poll_late (tcycle, sample_period));
+            /* Only the rows up to the bottom of each window need to be
+             * in order; sort further as the user pages down.
+             */
+            if (mdtwin && minmdt + mdtlines > mdt_sorted) {
+                mdt_sorted = minmdt + mdtlines;
+                _sort_tgtlist (mdt_data->list, tcycle, mdt_col[mdt_fp].fun,
+                               mdt_sorted);
+                _sort_tgtlist (mds_data, tcycle, mdt_col[mdt_fp].fun,
+                               mdt_sorted);
+            }
+            if (ostwin && minost + ostlines > ost_sorted) {
+                ost_sorted = minost + ostlines;
+                _sort_tgtlist (ost_data->list, tcycle, ost_col[ost_fp].fun,
+                               ost_sorted);
+                _sort_tgtlist (oss_data, tcycle, ost_col[ost_fp].fun,
+                               ost_sorted);
+            }
             if (mdtwin) {
                     _update_display_hdr (mdtwin,
                                          sizeof(mdt_col)/sizeof(mdt_col[0]),
                                          mdt_col, mdt_fp);
                     _update_display_target (mdtwin,
-                                            mdtview ? mdt_data : mds_data,
+                                            mdtview ? mdt_data->list : mds_data,
                                             minmdt, selmdt, stale_secs, tcycle,
                                             _update_display_mdt);
             }
             if (ostwin) {
                 _update_display_hdr (ostwin, sizeof(ost_col)/sizeof(ost_col[0]),
                                      ost_col, ost_fp);
-                _update_display_target (ostwin, ostview ? ost_data : oss_data,
+                _update_display_target (ostwin, ostview ? ost_data->list : oss_data,
                                         minost, selost, stale_secs, tcycle,
                                         _update_display_ost);
             }
         }
+        /* Fetch database samples around the cursor while the user
+         * is looking at the display.  ltopdb_prefetch () hands the
+         * queries to its own thread and connection, so it does not
+         * hold up getch ().  Tab/Backspace move one minute, or one day
+         * when showing hourly samples.
+         */
+        _update_terminal ();
+        if (dbh) {
+            ltopdb_prefetch (dbh);
+            dbjump = ltopdb_hourly (dbh) ? 24 : 60 / ltopdb_interval (dbh);
+            if (dbjump < 1)
+                dbjump = 1;
+        }
         switch ((c = getch ())) {
             case 'z':               /* z - toggle between OST and MDT window */
             case 'Z':
@@ -577,9 +1072,12 @@ main (int argc, char *argv[])
                 break;
             case KEY_DC:            /* Delete - turn off highlighting */
                 selost = selmdt = -1;
-                _clear_tags (ost_data);
+                _clear_tags (ost_data->list);
                 _clear_tags (oss_data);
                 break;
+            case 0x0c:              /* Ctrl-L - redraw screen */
+                clearok (curscr, TRUE);
+                break;
             case 'q':               /* q|Ctrl-C - quit */
             case 0x03:
                 if (ostwin)
@@ -621,11 +1119,13 @@ main (int argc, char *argv[])
                 break;
             case ' ':               /* SPACE - tag selected OST */
                 if (ostview)
-                    _tag_nth_ost (ost_data, selost, NULL);
+                    _tag_nth_ost (ost_data->list, selost, NULL);
                 else
-                    _tag_nth_ost (oss_data, selost, ost_data);
+                    _tag_nth_ost (oss_data, selost, ost_data->list);
                 break;
             case 'f':
+                if (dbh)
+                    break;
                 newfs = _choose_fs (topwin, playf, stale_secs);
                 if (newfs) {
                     if (strcmp (newfs, fs) != 0) {
@@ -652,80 +1152,113 @@ main (int argc, char *argv[])
             case 'L':
             case 'C':
             case 'u':
+            case 'H':
             case 'm':
             case 'S':
+            case 'n':
+            case 'Q':
+            case 'W':
+            case 'A':
+            case 'X':
+            case 'D':
+            case 'T':
                 if (in_ostwin) {
                     ost_fp = _get_sort_index (c, ost_fp, ost_col,
                                               sizeof(ost_col)/sizeof(ost_col[0]));
-                    _sort_tgtlist (ost_data, tcycle, ost_col[ost_fp].fun);
-                    _sort_tgtlist (oss_data, tcycle, ost_col[ost_fp].fun);
+                    ost_sorted = 0;
                 } else {
                     mdt_fp = _get_sort_index (c, mdt_fp, mdt_col,
                                               sizeof(mdt_col)/sizeof(mdt_col[0]));
-                    _sort_tgtlist (mdt_data, tcycle, mdt_col[mdt_fp].fun);
-                    _sort_tgtlist (mds_data, tcycle, mdt_col[mdt_fp].fun);
+                    mdt_sorted = 0;
                 }
                 break;
             case 'R':               /* R - toggle record mode */
-                if (!playf) {
+                if (!playf && !dbh) {
                     if (recf) {
-                        (void)fclose (recf);
+                        (void)ltoprec_close (recf);
                         recf = NULL;
                     } else
-                        recf = fopen (recpath, "w+");
+                        recf = ltoprec_create (recpath);
                 }
                 break;
             case 'p':               /* p - pause playback */
-                if (playf)
+                if (playf || dbh)
                     pause = !pause;
                 break;
+            case 'h':               /* h - toggle hourly database samples */
+                if (dbh) {
+                    ltopdb_set_hourly (dbh, !ltopdb_hourly (dbh));
+                    _play_db (dbh, fs, mdt_data, ost_data, stale_secs,
+                              &tcycle);
+                    last_sample = time (NULL);
+                    recompute = 1;
+                }
+                break;
             case KEY_LEFT:          /* LeftArrow - rewind 1 sample_period */
-                if (playf) {
-                    int count = _rewind_file (playf, time_series, 3);
+                if (dbh)
+                    dbstep = -1;
+                else if (playf) {
+                    int count = ltoprec_step (playf, -3);
 
                     if (count > 0) {
-                        _list_empty_out (mdt_data);
-                        _list_empty_out (ost_data);
+                        _tgtlist_empty (mdt_data);
+                        _tgtlist_empty (ost_data);
+                        _clear_events ();
+                        _clear_jobs ();
+                        _clear_exports ();
+                        _clear_clients ();
+                        _clear_routers ();
                     }
                     while (count-- > 1)
-                        _play_file (fs, mdt_data, ost_data, time_series,
+                        _play_file (fs, mdt_data, ost_data,
                                     stale_secs, playf, &tcycle, &sample_period);
                     last_sample = time (NULL);
                     recompute = 1;
                 }
                 break;
             case KEY_BACKSPACE:     /* BACKSPACE - rewind 1 minute */
-                if (playf) {
-                    _list_empty_out (mdt_data);
-                    _list_empty_out (ost_data);
-                    _rewind_file_to (playf, time_series, tcycle - 60);
-                    (void)_rewind_file (playf, time_series, 1);
-                    _play_file (fs, mdt_data, ost_data, time_series,
+                if (dbh)
+                    dbstep = -dbjump;
+                else if (playf) {
+                    _tgtlist_empty (mdt_data);
+                    _tgtlist_empty (ost_data);
+                    _clear_events ();
+                    _clear_jobs ();
+                    _clear_exports ();
+                    _clear_clients ();
+                    _clear_routers ();
+                    ltoprec_seek (playf, tcycle - 60 + 1);
+                    (void)ltoprec_step (playf, -2);
+                    _play_file (fs, mdt_data, ost_data,
                                 stale_secs, playf, &tcycle, &sample_period);
-                    _play_file (fs, mdt_data, ost_data, time_series,
+                    _play_file (fs, mdt_data, ost_data,
                                 stale_secs, playf, &tcycle, &sample_period);
                     last_sample = time (NULL);
                     recompute = 1;
                 }
                 break;
             case KEY_RIGHT:         /* RightArrow - ffwd 1 sample_period */
-                if (playf) {
-                    _list_empty_out (mdt_data);
-                    _list_empty_out (ost_data);
-                    _play_file (fs, mdt_data, ost_data, time_series,
+                if (dbh)
+                    dbstep = 1;
+                else if (playf) {
+                    _tgtlist_empty (mdt_data);
+                    _tgtlist_empty (ost_data);
+                    _play_file (fs, mdt_data, ost_data,
                                 stale_secs, playf, &tcycle, &sample_period);
                     last_sample = time (NULL);
                     recompute = 1;
                 }
                 break;
             case '\t':              /* tab - fast-fwd 1 minute */
-                if (playf) {
-                    time_t t1 = tcycle + 60;
-
-                    do {
-                        _play_file (fs, mdt_data, ost_data, time_series,
-                                    stale_secs, playf, &tcycle, &sample_period);
-                    } while (tcycle < t1 && !feof (playf));
+                if (dbh)
+                    dbstep = dbjump;
+                else if (playf) {
+                    ltoprec_seek (playf, tcycle + 60);
+                    (void)ltoprec_step (playf, -1);
+                    _play_file (fs, mdt_data, ost_data,
+                                stale_secs, playf, &tcycle, &sample_period);
+                    _play_file (fs, mdt_data, ost_data,
+                                stale_secs, playf, &tcycle, &sample_period);
                     last_sample = time (NULL);
                     recompute = 1;
                 }
@@ -733,11 +1266,56 @@ main (int argc, char *argv[])
             case '?':               /* ? - display help screen */
                 showhelp = 1;
                 break;
+            case 'e':               /* e - display event log */
+                showevents = 1;
+                break;
+            case 'J':               /* J - display busiest jobs */
+                showjobs = 1;
+                break;
+            case 'I':               /* I - display client mount activity */
+                showcli = 1;
+                break;
+            case 'N':               /* N - display lnet routers */
+                showrtr = 1;
+                break;
+            case '\n':              /* Enter - display busiest clients */
+            case KEY_ENTER:         /*   of the target under the cursor */
+                if (in_ostwin)
+                    g = _nth_target (ostview ? ost_data->list : oss_data,
+                                     selost);
+                else
+                    g = _nth_target (mdtview ? mdt_data->list : mds_data,
+                                     selmdt);
+                if (g) {
+                    showclients_server = in_ostwin ? !ostview : !mdtview;
+                    snprintf (showclients, sizeof (showclients), "%s",
+                              showclients_server ? g->servername : g->key);
+                }
+                break;
             case ERR:               /* timeout */
                 break;
         }
         if (c != ERR && c != '?')
             showhelp = 0;
+        if (c != ERR && c != 'e')
+            showevents = 0;
+        if (c != ERR && c != 'J')
+            showjobs = 0;
+        if (c != ERR && c != 'I')
+            showcli = 0;
+        if (c != ERR && c != 'N')
+            showrtr = 0;
+        if (c != ERR && c != '\n' && c != KEY_ENTER)
+            showclients[0] = '\0';
+
+        if (dbstep) {
+            if (ltopdb_step (dbh, dbstep) > 0) {
+                _play_db (dbh, fs, mdt_data, ost_data, stale_secs, &tcycle);
+                last_sample = time (NULL);
+                recompute = 1;
+            }
+            dbstep = 0;
+        }
 
         if (in_ostwin) {
             mintgt = &minost;
@@ -754,16 +1332,25 @@ main (int argc, char *argv[])
         }
 
         if (repoll) {
-            _list_empty_out (mdt_data);
-            _list_empty_out (ost_data);
+            _tgtlist_empty (mdt_data);
+            _tgtlist_empty (ost_data);
+            _clear_events ();
+            _clear_jobs ();
+            _clear_exports ();
+            _clear_clients ();
+            _clear_routers ();
             repoll = 0;
             last_sample = 0; /* force resample */
         }
 
         if (time (NULL) - last_sample >= sample_period) {
             if (!pause) {
-                if (playf)
-                    _play_file (fs, mdt_data, ost_data, time_series,
+                if (dbh) {
+                    (void)ltopdb_step (dbh, 1);
+                    _play_db (dbh, fs, mdt_data, ost_data, stale_secs,
+                              &tcycle);
+                } else if (playf)
+                    _play_file (fs, mdt_data, ost_data,
                                 stale_secs, playf, &tcycle, &sample_period);
                 else
                     _poll_cerebro (fs, mdt_data, ost_data, stale_secs, recf,
@@ -776,8 +1363,8 @@ main (int argc, char *argv[])
             timeout ((sample_period - (time (NULL) - last_sample)) * 1000);
 
         if (recompute) {
-            mdtcount = list_count (mdtview ? mdt_data : mds_data);
-            ostcount = list_count (ostview ? ost_data : oss_data);
+            mdtcount = list_count (mdtview ? mdt_data->list : mds_data);
+            ostcount = list_count (ostview ? ost_data->list : oss_data);
         }
 
         if (proportional_view)
@@ -798,30 +1385,40 @@ main (int argc, char *argv[])
             create_target_window(&ostwin, ostlines, TOPWIN_LINES + mdtlines);
 
             if (!ostview)
-                _summarize_ost (ost_data, oss_data, tcycle, stale_secs);
+                _summarize_ost (ost_data->list, oss_data, tcycle, stale_secs);
             if (!mdtview)
-                _summarize_mdt (mdt_data, mds_data, tcycle, stale_secs);
+                _summarize_mdt (mdt_data->list, mds_data, tcycle, stale_secs);
             resort = 1;
             recompute = 0;
         }
         if (resort) {
-            _sort_tgtlist (ost_data, tcycle, ost_col[ost_fp].fun);
-            _sort_tgtlist (oss_data, tcycle, ost_col[ost_fp].fun);
-            _sort_tgtlist (mdt_data, tcycle, mdt_col[mdt_fp].fun);
-            _sort_tgtlist (mds_data, tcycle, mdt_col[mdt_fp].fun);
+            ost_sorted = 0;
+            mdt_sorted = 0;
             resort = 0;
         }
     }
 
-    list_destroy (ost_data);
-    list_destroy (mdt_data);
+    _tgtlist_destroy (ost_data);
+    _tgtlist_destroy (mdt_data);
     list_destroy (oss_data);
     list_destroy (mds_data);
-    list_destroy (time_series);
+    list_destroy (events);
+    hash_destroy (jobtgts);
+    hash_destroy (exptgts);
+    hash_destroy (clirpts);
+    hash_destroy (rtrstats);
+    if (evtrack)
+        lmt_evtrack_destroy (evtrack);
     free (fs);
+    if (dbh)
+        ltopdb_destroy (dbh);
+    if (local_ctx)
+        proc_destroy (local_ctx);
 
+    if (playf)
+        (void)ltoprec_close (playf);
     if (recf) {
-        if (fclose (recf) == EOF)
+        if (ltoprec_close (recf) < 0)
             err ("Error closing %s", recpath);
         else
             msg ("Log recorded in %s", recpath);
@@ -830,6 +1427,46 @@ main (int argc, char *argv[])
     exit (0);
 }
 
+/* Bytes this process has passed to write(2) according to /proc/self/io,
+ * or -1 if unavailable.
+ */
+static int64_t
+_wchar (void)
+{
+    FILE *f = fopen ("/proc/self/io", "r");
+    char line[64];
+    int64_t n = -1;
+
+    if (!f)
+        return -1;
+    while (fgets (line, sizeof (line), f)) {
+        if (sscanf (line, "wchar: %"SCNd64, &n) == 1)
+            break;
+    }
+    (void)fclose (f);
+    return n;
+}
+
+/* Send the windows staged with wnoutrefresh () to the terminal in one
+ * update.  Curses only transmits what changed since the last update,
+ * so the display functions use werase () rather than wclear (), which
+ * would force the whole screen to be repainted every cycle.
+ */
+static void
+_update_terminal (void)
+{
+    int64_t w0 = _wchar ();
+    int64_t w1;
+
+    doupdate ();
+    w1 = _wchar ();
+    if (w0 >= 0 && w1 >= w0) {
+        term_last = w1 - w0;
+        term_bytes += term_last;
+        term_refreshes++;
+    }
+}
+
 /* Show help window.
  * Uppercase keys are used where lowercase is already taken.
  * For some keys, meaning depends on whether OST or MDT is the
@@ -839,12 +1476,16 @@ main (int argc, char *argv[])
 static void _update_display_help (WINDOW *win)
 {
     int y = 0;
-    wclear (win);
+    werase (win);
     wattron (win, A_REVERSE);
     mvwprintw (win, y++, 0,
               "Help for Interactive Commands - ltop version %s",
               PACKAGE_VERSION);
     wattroff (win, A_REVERSE);
+    if (term_refreshes > 0)
+        mvwprintw (win, y++, 0, "Terminal output: %"PRIu64" bytes last refresh,"
+                   " %"PRIu64" average", term_last,
+                   term_bytes / term_refreshes);
     y++;
     mvwprintw (win, y++, 2, "z/Z        switch between OST/MDT window");
     mvwprintw (win, y++, 2, "PageUp     Page up through targets");
@@ -859,8 +1500,15 @@ static void _update_display_help (WINDOW *win)
     mvwprintw (win, y++, 2, "LeftArrow  Rewind playback one sample period");
     mvwprintw (win, y++, 2, "Tab        Fast-fwd playback one minute");
     mvwprintw (win, y++, 2, "Backspace  Rewind playback one minute");
+    mvwprintw (win, y++, 2, "h          Toggle hourly/raw database samples");
     mvwprintw (win, y++, 2, "c          Toggle target/server view");
     mvwprintw (win, y++, 2, "f          Select filesystem to monitor");
+    mvwprintw (win, y++, 2, "e          Show recovery/failover/OSC state events");
+    mvwprintw (win, y++, 2, "J          Show busiest jobs (from job_stats)");
+    mvwprintw (win, y++, 2, "Enter      Show busiest clients of target/server"
+                            " under cursor");
+    mvwprintw (win, y++, 2, "I          Show I/O of sampled client mounts");
+    mvwprintw (win, y++, 2, "N          Show LNet routers by credit starvation");
     mvwprintw (win, y++, 2, ">          Sort on next right column");
     mvwprintw (win, y++, 2, "<          Sort on next left column");
     mvwprintw (win, y++, 2, "t          Sort on target name (ascending)");
@@ -874,6 +1522,11 @@ static void _update_display_help (WINDOW *win)
     mvwprintw (win, y++, 2, "l          Sort on lock count (descending/OST)");
     mvwprintw (win, y++, 2, "g          Sort on lock grant rate (descending/OST)");
     mvwprintw (win, y++, 2, "L          Sort on lock cancel  rate (descending/OST)");
+    mvwprintw (win, y++, 2, "n          Sort on %%network saturation (descending/OST)");
+    mvwprintw (win, y++, 2, "A          Sort on ZFS ARC hit rate (descending/OST)");
+    mvwprintw (win, y++, 2, "X          Sort on ZFS txg sync time (descending/OST)");
+    mvwprintw (win, y++, 2, "D          Sort on device utilization (descending/OST)");
+    mvwprintw (win, y++, 2, "T          Sort on device I/O latency (descending/OST)");
 
     mvwprintw (win, y++, 2, "o          Sort on open rate (descending/MDT)");
     mvwprintw (win, y++, 2, "C          Sort on close rate (descending/MDT)");
@@ -884,12 +1537,428 @@ static void _update_display_help (WINDOW *win)
     mvwprintw (win, y++, 2, "r          Sort on rmdir rate (descending/MDT)");
     mvwprintw (win, y++, 2, "R          Sort on rename rate (descending/MDT)");
 
+    mvwprintw (win, y++, 2, "Q          Sort on server request queue depth (descending)");
+    mvwprintw (win, y++, 2, "W          Sort on server request wait time (descending)");
     mvwprintw (win, y++, 2, "u          Sort on %%cpu utilization (descending)");
+    mvwprintw (win, y++, 2, "H          Sort on busiest cpu core (descending)");
     mvwprintw (win, y++, 2, "m          Sort on %%memory utilization (descending)");
     mvwprintw (win, y++, 2, "S          Sort on %%disk space utilization (descending)");
+    mvwprintw (win, y++, 2, "Ctrl-L     Redraw the screen");
     mvwprintw (win, y++, 2, "q          Quit");
 
-    wrefresh (win);
+    wnoutrefresh (win);
+}
+
+/* Show event log window.  Like tail(1), the newest event is at the
+ * bottom and older ones scroll off the top.
+ */
+static void
+_update_display_events (WINDOW *win, char *fs)
+{
+    ListIterator itr;
+    evlog_t *ev;
+    char ts[32];
+    int y = 0;
+    int skip = list_count (events) - (LINES - 2);
+
+    werase (win);
+    wattron (win, A_REVERSE);
+    mvwprintw (win, y++, 0, "Events for file system %s", fs);
+    wattroff (win, A_REVERSE);
+    y++;
+    if (list_is_empty (events))
+        mvwprintw (win, y++, 2, "No events");
+    itr = list_iterator_create (events);
+    while ((ev = list_next (itr))) {
+        if (skip-- > 0)
+            continue;
+        strftime (ts, sizeof (ts), "%Y-%m-%d %H:%M:%S", localtime (&ev->t));
+        mvwprintw (win, y++, 2, "%s  %s", ts, ev->text);
+    }
+    list_iterator_destroy (itr);
+    wnoutrefresh (win);
+}
+
+/* private arg structure for _sum_jobtgt () */
+struct jobsum_struct {
+    char *fs;
+    time_t tnow;
+    int stale_secs;
+    hash_t index;
+    List jobs;
+};
+
+/* Add the rates of the jobs on one target to the per-job sums.
+ */
+static int
+_sum_jobtgt (jobtgt_t *t, const char *key, struct jobsum_struct *a)
+{
+    jobsum_t *j;
+    int i;
+
+    if (t->secs <= 0 || a->tnow - t->trcv > a->stale_secs)
+        return 0;
+    if (a->fs && !_fsmatch (t->name, a->fs))
+        return 0;
+    for (i = 0; i < t->njobs; i++) {
+        if (!(j = hash_find (a->index, t->job[i].id))) {
+            j = xmalloc (sizeof (*j));
+            memset (j, 0, sizeof (*j));
+            snprintf (j->id, sizeof (j->id), "%s", t->job[i].id);
+            if (!hash_insert (a->index, j->id, j))
+                msg_exit ("out of memory");
+            list_append (a->jobs, j);
+        }
+        j->rbps += (double)t->job[i].read_bytes / t->secs;
+        j->wbps += (double)t->job[i].write_bytes / t->secs;
+        j->ops += (double)t->job[i].ops / t->secs;
+        j->ntgt++;
+    }
+    return 0;
+}
+
+static int
+_cmp_jobsum (jobsum_t *j1, jobsum_t *j2)
+{
+    double b1 = j1->rbps + j1->wbps;
+    double b2 = j2->rbps + j2->wbps;
+
+    if (b1 != b2)
+        return b1 < b2 ? 1 : -1;
+    return j1->ops < j2->ops ? 1 : j1->ops > j2->ops ? -1 : 0;
+}
+
+/* Show the busiest jobs, summed over the OSTs and MDTs of the file
+ * system, by bandwidth and then by request rate.
+ */
+static void
+_update_display_jobs (WINDOW *win, char *fs, time_t tnow, int stale_secs)
+{
+    struct jobsum_struct a = { .fs = fs, .tnow = tnow,
+                               .stale_secs = stale_secs };
+    ListIterator itr;
+    jobsum_t *j;
+    int y = 0;
+
+    a.index = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                           (hash_cmp_f)strcmp, NULL);
+    a.jobs = list_create ((ListDelF)free);
+    hash_for_each (jobtgts, (hash_arg_f)_sum_jobtgt, &a);
+    list_sort (a.jobs, (ListCmpF)_cmp_jobsum);
+
+    werase (win);
+    wattron (win, A_REVERSE);
+    mvwprintw (win, y++, 0, "Jobs for file system %s", fs);
+    wattroff (win, A_REVERSE);
+    y++;
+    if (list_is_empty (a.jobs))
+        mvwprintw (win, y++, 2, "No job activity");
+    else
+        mvwprintw (win, y++, 2, "%-32s %8s %8s %9s %5s", "JOBID",
+                   "rMB/s", "wMB/s", "Ops/s", "Tgts");
+    itr = list_iterator_create (a.jobs);
+    while ((j = list_next (itr)) && y < LINES) {
+        mvwprintw (win, y++, 2, "%-32.32s %8.0f %8.0f %9.0f %5d", j->id,
+                   j->rbps / (1024*1024), j->wbps / (1024*1024),
+                   j->ops, j->ntgt);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (a.jobs);
+    hash_destroy (a.index);
+    wnoutrefresh (win);
+}
+
+/* private arg structure for _sum_exptgt () */
+struct expsum_struct {
+    char *name;
+    int byserver;
+    time_t tnow;
+    int stale_secs;
+    hash_t index;
+    List clients;
+};
+
+/* Add the rates of the clients of one target to the per-client sums,
+ * if the target is the one selected or is on the selected server.
+ */
+static int
+_sum_exptgt (exptgt_t *t, const char *key, struct expsum_struct *a)
+{
+    expsum_t *e;
+    int i;
+
+    if (t->secs <= 0 || a->tnow - t->trcv > a->stale_secs)
+        return 0;
+    if (strcmp (a->byserver ? t->servername : t->name, a->name) != 0)
+        return 0;
+    for (i = 0; i < t->nclients; i++) {
+        if (!(e = hash_find (a->index, t->client[i].nid))) {
+            e = xmalloc (sizeof (*e));
+            memset (e, 0, sizeof (*e));
+            snprintf (e->nid, sizeof (e->nid), "%s", t->client[i].nid);
+            if (!hash_insert (a->index, e->nid, e))
+                msg_exit ("out of memory");
+            list_append (a->clients, e);
+        }
+        e->rbps += (double)t->client[i].read_bytes / t->secs;
+        e->wbps += (double)t->client[i].write_bytes / t->secs;
+        e->ops += (double)t->client[i].ops / t->secs;
+        e->locks += (double)t->client[i].locks / t->secs;
+        e->ntgt++;
+    }
+    return 0;
+}
+
+static int
+_cmp_expsum (expsum_t *e1, expsum_t *e2)
+{
+    double b1 = e1->rbps + e1->wbps;
+    double b2 = e2->rbps + e2->wbps;
+
+    if (b1 != b2)
+        return b1 < b2 ? 1 : -1;
+    if (e1->ops != e2->ops)
+        return e1->ops < e2->ops ? 1 : -1;
+    return e1->locks < e2->locks ? 1 : e1->locks > e2->locks ? -1 : 0;
+}
+
+/* Show the busiest clients of a target, or of all the targets on a
+ * server, by bandwidth, then request rate, then lock enqueue rate.
+ */
+static void
+_update_display_exports (WINDOW *win, char *name, int byserver, time_t tnow,
+                         int stale_secs)
+{
+    struct expsum_struct a = { .name = name, .byserver = byserver,
+                               .tnow = tnow, .stale_secs = stale_secs };
+    ListIterator itr;
+    expsum_t *e;
+    int y = 0;
+
+    a.index = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                           (hash_cmp_f)strcmp, NULL);
+    a.clients = list_create ((ListDelF)free);
+    hash_for_each (exptgts, (hash_arg_f)_sum_exptgt, &a);
+    list_sort (a.clients, (ListCmpF)_cmp_expsum);
+
+    werase (win);
+    wattron (win, A_REVERSE);
+    mvwprintw (win, y++, 0, "Clients of %s %s", byserver ? "server" : "target",
+               name);
+    wattroff (win, A_REVERSE);
+    y++;
+    if (list_is_empty (a.clients))
+        mvwprintw (win, y++, 2, "No client activity (is lmt_export_enable"
+                   " set in lmt.conf on the server?)");
+    else
+        mvwprintw (win, y++, 2, "%-32s %8s %8s %9s %8s %5s", "NID",
+                   "rMB/s", "wMB/s", "Ops/s", "Locks/s", "Tgts");
+    itr = list_iterator_create (a.clients);
+    while ((e = list_next (itr)) && y < LINES) {
+        mvwprintw (win, y++, 2, "%-32.32s %8.0f %8.0f %9.0f %8.0f %5d", e->nid,
+                   e->rbps / (1024*1024), e->wbps / (1024*1024),
+                   e->ops, e->locks, e->ntgt);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (a.clients);
+    hash_destroy (a.index);
+    wnoutrefresh (win);
+}
+
+/* private arg structure for _list_clirpt () */
+struct clisum_struct {
+    time_t tnow;
+    int stale_secs;
+    List rpts;
+};
+
+static int
+_cmp_clirpt (clirpt_t *r1, clirpt_t *r2)
+{
+    double b1 = (double)(r1->c.read_bytes + r1->c.write_bytes) / r1->secs;
+    double b2 = (double)(r2->c.read_bytes + r2->c.write_bytes) / r2->secs;
+    double o1 = (double)(r1->c.open + r1->c.close + r1->c.getattr) / r1->secs;
+    double o2 = (double)(r2->c.open + r2->c.close + r2->c.getattr) / r2->secs;
+
+    if (b1 != b2)
+        return b1 < b2 ? 1 : -1;
+    return o1 < o2 ? 1 : o1 > o2 ? -1 : 0;
+}
+
+static int
+_list_clirpt (clirpt_t *r, const char *key, struct clisum_struct *a)
+{
+    /* clients report every lmt_client_period, not every sample period */
+    if (r->secs > 0 && a->tnow - r->trcv <= a->stale_secs
+                                          + lmt_conf_get_client_period ())
+        list_append (a->rpts, r);
+    return 0;
+}
+
+/* Show the sampled client mounts of the file system, by bandwidth, then
+ * by metadata operation rate, with their RPCs in flight and average
+ * pages per bulk RPC.
+ */
+static void
+_update_display_clients (WINDOW *win, char *fs, time_t tnow, int stale_secs)
+{
+    struct clisum_struct a = { .tnow = tnow, .stale_secs = stale_secs };
+    ListIterator itr;
+    clirpt_t *r;
+    uint64_t rpcs;
+    int y = 0;
+
+    a.rpts = list_create (NULL);
+    hash_for_each (clirpts, (hash_arg_f)_list_clirpt, &a);
+    list_sort (a.rpts, (ListCmpF)_cmp_clirpt);
+
+    werase (win);
+    wattron (win, A_REVERSE);
+    mvwprintw (win, y++, 0, "Clients of file system %s (%d reporting)", fs,
+               list_count (a.rpts));
+    wattroff (win, A_REVERSE);
+    y++;
+    if (list_is_empty (a.rpts))
+        mvwprintw (win, y++, 2, "No client activity (is lmt_client_sample"
+                   " set in lmt.conf on the clients?)");
+    else
+        mvwprintw (win, y++, 2, "%-24s %8s %8s %7s %7s %7s %5s %6s",
+                   "CLIENT", "rMB/s", "wMB/s", "Open/s", "Close/s",
+                   "Gattr/s", "RPCs", "Pg/RPC");
+    itr = list_iterator_create (a.rpts);
+    while ((r = list_next (itr)) && y < LINES) {
+        rpcs = r->c.read_rpcs + r->c.write_rpcs;
+        mvwprintw (win, y++, 2, "%-24.24s %8.0f %8.0f %7.0f %7.0f %7.0f"
+                   " %5"PRIu64" %6.0f", r->host,
+                   (double)r->c.read_bytes / r->secs / (1024*1024),
+                   (double)r->c.write_bytes / r->secs / (1024*1024),
+                   (double)r->c.open / r->secs,
+                   (double)r->c.close / r->secs,
+                   (double)r->c.getattr / r->secs,
+                   r->c.in_flight,
+                   rpcs ? (double)(r->c.read_pages + r->c.write_pages) / rpcs
+                        : 0);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (a.rpts);
+    wnoutrefresh (win);
+}
+
+/* Rates of the routers of one router group, summed by _list_rtrstat ().
+ */
+typedef struct {
+    double bps;
+    double drops;
+    int nrtr;
+    int nstarved;               /* routers with starved peers */
+} rtrgrp_t;
+
+/* private arg structure for _list_rtrstat () */
+struct rtrsum_struct {
+    time_t tnow;
+    int stale_secs;
+    List rtrs;
+    rtrgrp_t *grp;              /* indexed by group id, 0 = no group */
+};
+
+/* Most credit starved first: lowest NI min credits, then most starved
+ * peers, then most bytes queued for peer credits.
+ */
+static int
+_cmp_rtrstat (rtrstat_t *r1, rtrstat_t *r2)
+{
+    if (r1->nni && r2->nni && r1->ni_min != r2->ni_min)
+        return r1->ni_min < r2->ni_min ? -1 : 1;
+    if (r1->nstarved != r2->nstarved)
+        return r1->nstarved > r2->nstarved ? -1 : 1;
+    if (r1->queue != r2->queue)
+        return r1->queue > r2->queue ? -1 : 1;
+    return strcmp (r1->name, r2->name);
+}
+
+static int
+_list_rtrstat (rtrstat_t *r, const char *key, struct rtrsum_struct *a)
+{
+    rtrgrp_t *g = &a->grp[r->group];
+
+    if (a->tnow - r->trcv <= a->stale_secs) {
+        list_append (a->rtrs, r);
+        g->bps += sample_rate (r->bytes, a->tnow);
+        g->drops += sample_rate (r->drops, a->tnow);
+        g->nrtr++;
+        if (r->nstarved > 0)
+            g->nstarved++;
+    }
+    return 0;
+}
+
+/* Show the router groups of lmt.conf, if any, with the summed rates of
+ * their routers.  Then show the LNet routers, most credit starved
+ * first, with their forwarding rate and their most depleted NI and peer.
+ */
+static void
+_update_display_routers (WINDOW *win, time_t tnow, int stale_secs)
+{
+    struct rtrsum_struct a = { .tnow = tnow, .stale_secs = stale_secs };
+    int i, ngrp = lmt_conf_get_router_group_count ();
+    ListIterator itr;
+    rtrstat_t *r;
+    char ni[16];
+    int y = 0;
+
+    a.rtrs = list_create (NULL);
+    a.grp = xmalloc ((ngrp + 1) * sizeof (rtrgrp_t));
+    memset (a.grp, 0, (ngrp + 1) * sizeof (rtrgrp_t));
+    hash_for_each (rtrstats, (hash_arg_f)_list_rtrstat, &a);
+    list_sort (a.rtrs, (ListCmpF)_cmp_rtrstat);
+
+    werase (win);
+    wattron (win, A_REVERSE);
+    mvwprintw (win, y++, 0, "LNet routers (%d reporting)",
+               list_count (a.rtrs));
+    wattroff (win, A_REVERSE);
+    y++;
+    if (ngrp > 0) {
+        mvwprintw (win, y++, 2, "%-16s %8s %7s %7s %7s", "GROUP", "MB/s",
+                   "drops/s", "routers", "starved");
+        for (i = 1; i <= ngrp + 1 && y < LINES; i++) {
+            rtrgrp_t *g = &a.grp[i <= ngrp ? i : 0];
+
+            if (i > ngrp && g->nrtr == 0)
+                break;
+            mvwprintw (win, y++, 2, "%-16.16s %8.0f %7.0f %7d %7d",
+                       i <= ngrp ? lmt_conf_get_router_group_name (i)
+                                 : "(none)",
+                       g->bps / (1024*1024), g->drops, g->nrtr, g->nstarved);
+        }
+        y++;
+    }
+    if (list_is_empty (a.rtrs))
+        mvwprintw (win, y++, 2, "No router activity");
+    else
+        mvwprintw (win, y++, 2, "%-16s %8s %7s %5s %-20s %9s %6s %7s %8s"
+                   " %-20s %5s", "ROUTER", "MB/s", "drops/s", "%cpu",
+                   "WORST NI", "min/max", "peers", "starved", "queue KB",
+                   "WORST PEER", "min");
+    itr = list_iterator_create (a.rtrs);
+    while ((r = list_next (itr)) && y < LINES) {
+        if (r->nni)
+            snprintf (ni, sizeof (ni), "%d/%d", r->ni_min, r->ni_max);
+        else
+            snprintf (ni, sizeof (ni), "-");
+        mvwprintw (win, y++, 2, "%-16.16s %8.0f %7.0f %5.0f %-20.20s %9s"
+                   " %6d %7d %8"PRIu64" %-20.20s", r->name,
+                   sample_rate (r->bytes, tnow) / (1024*1024),
+                   sample_rate (r->drops, tnow), r->pct_cpu,
+                   r->nni ? r->ni_nid : "-", ni, r->npeer, r->nstarved,
+                   r->queue / 1024, r->peer_nid[0] ? r->peer_nid : "-");
+        if (r->peer_nid[0])
+            wprintw (win, " %5d", r->peer_min);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (a.rtrs);
+    free (a.grp);
+    wnoutrefresh (win);
 }
 
 /* Update the top (summary) window of the display.
@@ -898,8 +1967,9 @@ static void _update_display_help (WINDOW *win)
  */
 static void
 _update_display_top (WINDOW *win, char *fs, List ost_data, List mdt_data,
-                     int stale_secs, FILE *recf, FILE *playf, time_t tnow,
-                     int pause)
+                     int stale_secs, ltoprec_t recf, ltoprec_t playf,
+                     ltopdb_t dbh,
+                     time_t tnow, int pause, int late)
 {
     time_t trcv = 0;
     int y = 0;
@@ -983,32 +2053,67 @@ _update_display_top (WINDOW *win, char *fs, List ost_data, List mdt_data,
     }
     list_iterator_destroy (itr);
 
-    wclear (win);
+    /*
+     * With no MDT in recovery, show the latest event if it is recent.
+     */
+    if (recovery_status[0] == '\0' && recov_status_len > 0) {
+        evlog_t *ev = NULL, *e;
 
-    mvwprintw (win, y, 0, "Filesystem: %s  %s", fs, recovery_status);
-    if (pause) {
-        wattron (win, A_REVERSE);
+        itr = list_iterator_create (events);
+        while ((e = list_next (itr)))
+            ev = e;
+        list_iterator_destroy (itr);
+        if (ev && ev->t <= tnow && tnow - ev->t < EVENT_OVERLAY_SECS) {
+            struct tm *tm = localtime (&ev->t);
+
+            snprintf (recovery_status, sizeof (recovery_status),
+                      "%02d:%02d:%02d %s", tm->tm_hour, tm->tm_min,
+                      tm->tm_sec, ev->text);
+            recovery_status[recov_status_len-1] = '\0';
+        }
+    }
+
+    werase (win);
+
+    mvwprintw (win, y, 0, "Filesystem: %s  %s", fs, recovery_status);
+    if (pause) {
+        wattron (win, A_REVERSE);
         mvwprintw (win, y, 73, "PAUSED");
         wattroff (win, A_REVERSE);
     } else if (recf) {
         wattron (win, A_REVERSE);
-        if (ferror (recf))
+        if (ltoprec_error (recf))
             mvwprintw (win, y, 68, "WRITE ERROR");
         else
             mvwprintw (win, y, 70, "RECORDING");
         wattroff (win, A_REVERSE);
+    } else if (dbh) {
+        char *ts = ctime (&tnow);
+
+        wattron (win, A_REVERSE);
+        if (tnow == 0)
+            mvwprintw (win, y, 72, "NO DATA");
+        else {
+            if (ltopdb_hourly (dbh))
+                mvwprintw (win, y, 48, "HOURLY");
+            mvwprintw (win, y, 55, "%*s", (int)strlen (ts) - 1, ts);
+        }
+        wattroff (win, A_REVERSE);
     } else if (playf) {
         char *ts = ctime (&tnow);
 
         wattron (win, A_REVERSE);
-        if (ferror (playf))
-            mvwprintw (win, y, 69, "READ ERROR");
-        else if (feof (playf))
+        if (ltoprec_eof (playf))
             mvwprintw (win, y, 68, "END OF FILE");
         else
             mvwprintw (win, y, 55, "%*s", strlen (ts) - 1, ts);
         wattroff (win, A_REVERSE);
     }
+    if (late > 0 && !pause) {
+        wattron (win, A_REVERSE);
+        mvwprintw (win, y, 57, "LATE %3ds", late);
+        wattroff (win, A_REVERSE);
+    }
     y++;
     if (tnow - trcv <= stale_secs) { /* mdt data is live */
         mvwprintw (win, y++, 0,
@@ -1050,7 +2155,76 @@ _update_display_top (WINDOW *win, char *fs, List ost_data, List mdt_data,
           "            %6s statfs, %6s rename, %6s getxattr",
                    "", "", "");
     }
-    wrefresh (win);
+    mvwprintw (win, y++, 0,
+      " p50/95/99: %4.0f/%4.0f/%4.0f rMB/s %4.0f/%4.0f/%4.0f wMB/s"
+      " %5.0f/%5.0f/%5.0f IOPS",
+               dist_quantile (&ost_dist[DIST_RBW], 0),
+               dist_quantile (&ost_dist[DIST_RBW], 1),
+               dist_quantile (&ost_dist[DIST_RBW], 2),
+               dist_quantile (&ost_dist[DIST_WBW], 0),
+               dist_quantile (&ost_dist[DIST_WBW], 1),
+               dist_quantile (&ost_dist[DIST_WBW], 2),
+               dist_quantile (&ost_dist[DIST_IOPS], 0),
+               dist_quantile (&ost_dist[DIST_IOPS], 1),
+               dist_quantile (&ost_dist[DIST_IOPS], 2));
+    wnoutrefresh (win);
+}
+
+/* Store the values of the OST metrics tracked in ost_dist in v[].
+ */
+static void
+_ost_metrics (oststat_t *o, time_t tnow, double v[DIST_COUNT])
+{
+    v[DIST_RBW] = sample_rate (o->rbytes, tnow) / (1024*1024);
+    v[DIST_WBW] = sample_rate (o->wbytes, tnow) / (1024*1024);
+    v[DIST_IOPS] = sample_rate (o->iops, tnow);
+    v[DIST_LOCKS] = sample_val (o->lock_count, tnow);
+    v[DIST_LGR] = sample_val (o->grant_rate, tnow);
+    v[DIST_LCR] = sample_val (o->cancel_rate, tnow);
+}
+
+/* Recompute ost_dist from the running, non-stale targets in ost_data.
+ * This is one pass over the list, with O(1) work per target.
+ */
+static void
+_update_ost_dist (List ost_data, time_t tnow, int stale_secs)
+{
+    ListIterator itr;
+    oststat_t *o;
+    double v[DIST_COUNT];
+    int i;
+
+    for (i = 0; i < DIST_COUNT; i++)
+        dist_reset (&ost_dist[i]);
+    itr = list_iterator_create (ost_data);
+    while ((o = list_next (itr))) {
+        if ((tnow - o->common.tgt_metric_timestamp) > stale_secs)
+            continue;
+        if (strncmp (o->common.recov_status, "COMPLETE", 8) != 0)
+            continue;
+        _ost_metrics (o, tnow, v);
+        for (i = 0; i < DIST_COUNT; i++)
+            dist_add (&ost_dist[i], v[i]);
+    }
+    list_iterator_destroy (itr);
+}
+
+/* Return true if any metric of o is an outlier (see outlier_z).
+ */
+static int
+_ost_outlier (oststat_t *o, time_t tnow)
+{
+    double v[DIST_COUNT];
+    int i;
+
+    if (outlier_z <= 0)
+        return 0;
+    _ost_metrics (o, tnow, v);
+    for (i = 0; i < DIST_COUNT; i++) {
+        if (fabs (dist_zscore (&ost_dist[i], v[i])) >= outlier_z)
+            return 1;
+    }
+    return 0;
 }
 
 /*  Used for list_find_first () of fsstat_t by filesystem name.
@@ -1094,7 +2268,7 @@ _update_display_choose_fs (int selfs, WINDOW *win, List fsl)
     fsitr = list_iterator_create (fsl);
     int hdr_rows = 3; /* rows in header */
 
-    wclear (win);
+    werase (win);
     mvwprintw (win, y++, 0, "Select a filesystem to monitor.");
     mvwprintw (win, y++, 0, "");
     wattron (win, A_REVERSE);
@@ -1117,23 +2291,26 @@ _update_display_choose_fs (int selfs, WINDOW *win, List fsl)
  * and OST counts for all available file systems.
  */
 static List
-_find_all_fs (FILE *playf, int stale_secs)
+_find_all_fs (ltoprec_t playf, int stale_secs)
 {
-    List ost_data = list_create ((ListDelF)_destroy_oststat);
-    List mdt_data = list_create ((ListDelF)_destroy_mdtstat);
+    tgtlist_t *ost_data = _tgtlist_create ((ListDelF)_destroy_oststat);
+    tgtlist_t *mdt_data = _tgtlist_create ((ListDelF)_destroy_mdtstat);
     List fsl      = list_create ((ListDelF)_destroy_fsstat);
     ListIterator itr;
     mdtstat_t *m;
     oststat_t *o;
     fsstat_t *f;
 
-    if (playf)
-        _play_file (NULL, mdt_data, ost_data, NULL, stale_secs,
-                    playf, NULL, NULL);
-    else
+    if (playf) {
+        if (!ltoprec_eof (playf)) {
+            _play_file (NULL, mdt_data, ost_data, stale_secs,
+                        playf, NULL, NULL);
+            (void)ltoprec_step (playf, -1);
+        }
+    } else
         _poll_cerebro (NULL, mdt_data, ost_data, stale_secs, NULL, NULL);
 
-    itr = list_iterator_create (mdt_data);
+    itr = list_iterator_create (mdt_data->list);
     while ((m = list_next (itr))) {
         if (!(f = list_find_first (fsl, (ListFindF)_match_fsstat,
                                    m->common.fsname)))
@@ -1142,7 +2319,7 @@ _find_all_fs (FILE *playf, int stale_secs)
             f->num_mdt++;
     }
     list_iterator_destroy (itr);
-    itr = list_iterator_create (ost_data);
+    itr = list_iterator_create (ost_data->list);
     while ((o = list_next (itr))) {
         if (!(f = list_find_first (fsl, (ListFindF)_match_fsstat,
                                    o->common.fsname)))
@@ -1152,8 +2329,8 @@ _find_all_fs (FILE *playf, int stale_secs)
     }
 
     list_iterator_destroy (itr);
-    list_destroy (ost_data);
-    list_destroy (mdt_data);
+    _tgtlist_destroy (ost_data);
+    _tgtlist_destroy (mdt_data);
     return fsl;
 }
 
@@ -1161,7 +2338,7 @@ _find_all_fs (FILE *playf, int stale_secs)
  * file system, or NULL if no selection was made.
  */
 static char *
-_choose_fs (WINDOW *win, FILE *playf, int stale_secs)
+_choose_fs (WINDOW *win, ltoprec_t playf, int stale_secs)
 {
     int selfs = 0, fscount = 0, i, loop, c;
     fsstat_t *f;
@@ -1220,14 +2397,102 @@ _update_display_hdr (WINDOW *win, int cols, sort_t colhdr[], int sel)
 {
     int i;
 
-    wclear (win);
+    werase (win);
     wmove (win, 0, 0);
     wattron (win, A_REVERSE);
     for(i=0;i<cols;i++) {
         wprintw (win, colhdr[i].h,  sel == i  ? ">" : " ");
     }
+    if (getmaxx (win) - SPARK_WIDTH > getcurx (win))
+        mvwprintw (win, 0, getmaxx (win) - SPARK_WIDTH, "%-*s", SPARK_WIDTH,
+                   "History");
     wattroff(win, A_REVERSE);
-    wrefresh (win);
+    wnoutrefresh (win);
+}
+
+/* Draw the n rates in hist as a sparkline, right justified in line,
+ * if there is room after the text already on it.
+ */
+static void
+_update_display_spark (WINDOW *win, int line, double *hist, int n)
+{
+    static const char level[] = " ._-~=*#";
+    int nlevel = sizeof (level) - 1;
+    int x = getmaxx (win) - SPARK_WIDTH;
+    double max = 0;
+    int i, c;
+
+    if (x <= getcurx (win))
+        return;
+    for (i = 0; i < n; i++) {
+        if (hist[i] > max)
+            max = hist[i];
+    }
+    wmove (win, line, x + SPARK_WIDTH - n);
+    for (i = 0; i < n; i++) {
+        c = max > 0 ? (int)(hist[i] / max * (nlevel - 1) + 0.5) : 0;
+        if (c == 0 && hist[i] > 0)
+            c = 1;
+        waddch (win, level[c]);
+    }
+}
+
+/* Rate history of all metadata operations on an MDT (or MDS).
+ */
+static int
+_mdt_history (mdtstat_t *m, double *hist, int n)
+{
+    sample_t ops[] = { m->open, m->close, m->getattr, m->setattr, m->link,
+                       m->unlink, m->mkdir, m->rmdir, m->statfs, m->rename,
+                       m->getxattr };
+    double h[SPARK_WIDTH];
+    int i, j;
+
+    n = sample_history (m->open, hist, n);
+    for (i = 1; i < sizeof (ops) / sizeof (ops[0]); i++) {
+        if (sample_history (ops[i], h, n) == n) {
+            for (j = 0; j < n; j++)
+                hist[j] += h[j];
+        }
+    }
+    return n;
+}
+
+/* Rate history of read plus write bandwidth of an OST (or OSS).
+ */
+static int
+_ost_history (oststat_t *o, double *hist, int n)
+{
+    double h[SPARK_WIDTH];
+    int j;
+
+    n = sample_history (o->rbytes, hist, n);
+    if (sample_history (o->wbytes, h, n) == n) {
+        for (j = 0; j < n; j++)
+            hist[j] += h[j];
+    }
+    return n;
+}
+
+/* Mean depth of the server's ptlrpc request queues seen by arriving
+ * requests, and the mean time those requests waited for a thread.
+ * Queueing with low disk latency means the service threads are the
+ * bottleneck.
+ */
+static double
+_svc_queue (generic_target_t *t, time_t tnow)
+{
+    double reqs = sample_rate (t->svc_reqs, tnow);
+
+    return reqs > 0 ? sample_rate (t->svc_qdepth, tnow) / reqs : 0;
+}
+
+static double
+_svc_wait_ms (generic_target_t *t, time_t tnow)
+{
+    double reqs = sample_rate (t->svc_reqs, tnow);
+
+    return reqs > 0 ? sample_rate (t->svc_wait, tnow) / reqs / 1000.0 : 0;
 }
 
 static void
@@ -1235,6 +2500,7 @@ _update_display_mdt (WINDOW *win, int line, void *target, int stale_secs,
                      time_t tnow)
 {
     mdtstat_t *m = (mdtstat_t *) target;
+    double hist[SPARK_WIDTH];
 
     /* Future enhancement: if all "osc status" reported by an
      * MDT are the same, print the corresponding single
@@ -1272,7 +2538,7 @@ _update_display_mdt (WINDOW *win, int line, void *target, int stale_secs,
         /* mdt is not in recovery */
         mvwprintw (win, line, 0, "%4.4s %12.12s"
                    " %5.0f %5.0f %5.0f %5.0f %5.0f %5.0f %5.0f %5.0f"
-                   " %5.0f %5.0f %5.0f %5.0f",
+                   " %5.1f %7.1f %5.0f %5.0f %5.0f %5.0f %5.0f",
                    m->common.name, _ltrunc (m->common.servername, 10),
                    sample_rate (m->open, tnow),
                    sample_rate (m->read_bytes, tnow),
@@ -1282,18 +2548,73 @@ _update_display_mdt (WINDOW *win, int line, void *target, int stale_secs,
                    sample_rate (m->unlink, tnow),
                    sample_rate (m->mkdir, tnow),
                    sample_rate (m->rmdir, tnow),
+                   _svc_queue (&m->common, tnow),
+                   _svc_wait_ms (&m->common, tnow),
                    sample_val (m->common.pct_cpu, tnow),
+                   sample_val (m->common.pct_maxcpu, tnow),
                    sample_val (m->common.pct_mem, tnow),
                    pct_used, ipct_used
                    );
+        _update_display_spark (win, line, hist,
+                               _mdt_history (m, hist, SPARK_WIDTH));
     }
 }
 
+/* Network saturation of the OSS serving an OST: the busier direction
+ * of its interfaces as a percentage of their combined link speed.
+ */
+static double
+_nic_pct (oststat_t *o, time_t tnow)
+{
+    double mbps = sample_val (o->nic_mbps, tnow);
+    double r = sample_rate (o->nic_rbytes, tnow);
+    double w = sample_rate (o->nic_wbytes, tnow);
+
+    if (mbps <= 0)
+        return 0;
+    return 100.0 * (r > w ? r : w) / (mbps * 1E6 / 8);
+}
+
+/* ZFS ARC hit rate of the OSS serving an OST, as a percentage.
+ */
+static double
+_arc_pct (oststat_t *o, time_t tnow)
+{
+    double h = sample_rate (o->arc_hits, tnow);
+    double m = sample_rate (o->arc_misses, tnow);
+
+    return h + m > 0 ? 100.0 * h / (h + m) : 0;
+}
+
+/* Utilization (%), mean queue depth, and mean I/O latency (ms) of the
+ * block device under an OST, as computed by iostat.
+ */
+static double
+_dev_util (oststat_t *o, time_t tnow)
+{
+    return sample_rate (o->dev_busy, tnow) / 10.0;
+}
+
+static double
+_dev_queue (oststat_t *o, time_t tnow)
+{
+    return sample_rate (o->dev_queue, tnow) / 1000.0;
+}
+
+static double
+_dev_await (oststat_t *o, time_t tnow)
+{
+    double ios = sample_rate (o->dev_ios, tnow);
+
+    return ios > 0 ? sample_rate (o->dev_ms, tnow) / ios : 0;
+}
+
 static void
 _update_display_ost (WINDOW *win, int line, void *target, int stale_secs,
                      time_t tnow)
 {
     oststat_t *o = (oststat_t *) target;
+    double hist[SPARK_WIDTH];
 
     double ktot = sample_val (o->kbytes_total, tnow);
     double kfree = sample_val (o->kbytes_free, tnow);
@@ -1311,9 +2632,14 @@ _update_display_ost (WINDOW *win, int line, void *target, int stale_secs,
                    o->common.recov_status);
     /* ost is not in running (state == COMPLETE) */
     } else {
+        int outlier = _ost_outlier (o, tnow);
+
+        if (outlier)
+            wattron (win, A_BOLD);
         mvwprintw (win, line, 0, "%4.4s %1.1s %10.10s"
                    " %5.0f %4.0f %5.0f %5.0f %5.0f %7.0f %4.0f %4.0f"
-                   " %4.0f %4.0f %4.0f",
+                   " %4.0f %5.1f %7.1f %4.0f %6.0f %4.0f %5.1f"
+                   " %4.0f %5.0f %4.0f %4.0f",
                    o->common.name, o->common.tgtstate,
                    _ltrunc (o->common.servername, 10),
                    sample_val (o->num_exports, tnow),
@@ -1324,9 +2650,21 @@ _update_display_ost (WINDOW *win, int line, void *target, int stale_secs,
                    sample_val (o->lock_count, tnow),
                    sample_val (o->grant_rate, tnow),
                    sample_val (o->cancel_rate, tnow),
+                   _nic_pct (o, tnow),
+                   _svc_queue (&o->common, tnow),
+                   _svc_wait_ms (&o->common, tnow),
+                   _arc_pct (o, tnow),
+                   sample_val (o->txg_sync, tnow),
+                   _dev_util (o, tnow),
+                   _dev_await (o, tnow),
                    sample_val (o->common.pct_cpu, tnow),
+                   sample_val (o->common.pct_maxcpu, tnow),
                    sample_val (o->common.pct_mem, tnow),
                    pct_used);
+        if (outlier)
+            wattroff (win, A_BOLD);
+        _update_display_spark (win, line, hist,
+                               _ost_history (o, hist, SPARK_WIDTH));
     }
 }
 
@@ -1345,9 +2683,10 @@ _update_display_target (WINDOW *win, List tgt_data, int mintgt, int seltgt,
     generic_target_t    *o;
     int                 y = 1;
     int                 skiptgt = mintgt;
+    int                 maxy = getmaxy (win);
 
     itr = list_iterator_create (tgt_data);
-    while ((o = (generic_target_t *) list_next (itr))) {
+    while ((o = (generic_target_t *) list_next (itr)) && y < maxy) {
         if (skiptgt-- > 0)
             continue;
         if (y - 1 + mintgt == seltgt)
@@ -1363,31 +2702,7 @@ _update_display_target (WINDOW *win, List tgt_data, int mintgt, int seltgt,
     }
     list_iterator_destroy (itr);
 
-    wrefresh (win);
-}
-
-/*  Used for list_find_first () of MDT by mds name.
- */
-static int
-_match_mdtstat2 (mdtstat_t *m, char *name)
-{
-    return (strcmp (m->common.servername, name) == 0);
-}
-
-/*  Used for list_find_first () of MDT by filesystem and target name,
- *  e.g. fs-MDTxxxx.
- */
-static int
-_match_mdtstat (mdtstat_t *m, char *name)
-{
-    int targetmatch;
-    int fsmatch;
-    char *p = strstr (name, "-MDT");
-
-    fsmatch = _fsmatch(name, m->common.fsname);
-    targetmatch = (strcmp (m->common.name, p ? p + 4 : name) == 0);
-
-    return (targetmatch && fsmatch);
+    wnoutrefresh (win);
 }
 
 /* Copy an mdtstat record.
@@ -1399,23 +2714,6 @@ _copy_mdtstat (void *src_v)
     mdtstat_t *m = xmalloc (sizeof (*m));
 
     memcpy (m, src, sizeof (*m));
-    m->inodes_free =  sample_copy (src->inodes_free);
-    m->inodes_total = sample_copy (src->inodes_total);
-    m->open =         sample_copy (src->open);
-    m->close =        sample_copy (src->close);
-    m->getattr =      sample_copy (src->getattr);
-    m->setattr =      sample_copy (src->setattr);
-    m->link =         sample_copy (src->link);
-    m->unlink =       sample_copy (src->unlink);
-    m->mkdir =        sample_copy (src->mkdir);
-    m->rmdir =        sample_copy (src->rmdir);
-    m->statfs =       sample_copy (src->statfs);
-    m->rename =       sample_copy (src->rename);
-    m->common.pct_cpu =      sample_copy (src->common.pct_cpu);
-    m->common.pct_mem =      sample_copy (src->common.pct_mem);
-    m->getxattr =     sample_copy (src->getxattr);
-    m->read_bytes =   sample_copy (src->read_bytes);
-    m->write_bytes =  sample_copy (src->write_bytes);
     return (void *) m;
 }
 
@@ -1428,30 +2726,37 @@ _create_mdtstat (char *name, int stale_secs)
     char *mdtx = strstr (name, "-MDT");
 
     memset (m, 0, sizeof (*m));
+    strncpy (m->common.key, name, sizeof (m->common.key) - 1);
     strncpy (m->common.name, mdtx ? mdtx + 4 : name, sizeof(m->common.name)-1);
     strncpy (m->common.fsname, name,
              mdtx ? mdtx - name : sizeof (m->common.fsname)-1);
     *m->common.tgtstate = '\0';
     *m->common.recov_status='\0';
-    m->inodes_free =  sample_create (stale_secs);
-    m->inodes_total = sample_create (stale_secs);
-    m->open =         sample_create (stale_secs);
-    m->close =        sample_create (stale_secs);
-    m->getattr =      sample_create (stale_secs);
-    m->setattr =      sample_create (stale_secs);
-    m->link =         sample_create (stale_secs);
-    m->unlink =       sample_create (stale_secs);
-    m->mkdir =        sample_create (stale_secs);
-    m->rmdir =        sample_create (stale_secs);
-    m->statfs =       sample_create (stale_secs);
-    m->rename =       sample_create (stale_secs);
-    m->kbytes_free =  sample_create (stale_secs);
-    m->kbytes_total = sample_create (stale_secs);
-    m->common.pct_cpu =      sample_create (stale_secs);
-    m->common.pct_mem =      sample_create (stale_secs);
-    m->getxattr =     sample_create (stale_secs);
-    m->read_bytes =   sample_create (stale_secs);
-    m->write_bytes =  sample_create (stale_secs);
+    sample_init (m->inodes_free, stale_secs);
+    sample_init (m->inodes_total, stale_secs);
+    sample_init (m->open, stale_secs);
+    sample_init (m->close, stale_secs);
+    sample_init (m->getattr, stale_secs);
+    sample_init (m->setattr, stale_secs);
+    sample_init (m->link, stale_secs);
+    sample_init (m->unlink, stale_secs);
+    sample_init (m->mkdir, stale_secs);
+    sample_init (m->rmdir, stale_secs);
+    sample_init (m->statfs, stale_secs);
+    sample_init (m->rename, stale_secs);
+    sample_init (m->kbytes_free, stale_secs);
+    sample_init (m->kbytes_total, stale_secs);
+    sample_init (m->common.pct_cpu, stale_secs);
+    sample_init (m->common.pct_mem, stale_secs);
+    sample_init (m->common.pct_maxcpu, stale_secs);
+    sample_init (m->common.pct_iowait, stale_secs);
+    sample_init (m->common.pct_softirq, stale_secs);
+    sample_init (m->common.svc_reqs, stale_secs);
+    sample_init (m->common.svc_wait, stale_secs);
+    sample_init (m->common.svc_qdepth, stale_secs);
+    sample_init (m->getxattr, stale_secs);
+    sample_init (m->read_bytes, stale_secs);
+    sample_init (m->write_bytes, stale_secs);
     return m;
 }
 
@@ -1460,51 +2765,9 @@ _create_mdtstat (char *name, int stale_secs)
 static void
 _destroy_mdtstat (mdtstat_t *m)
 {
-    sample_destroy (m->inodes_free);
-    sample_destroy (m->inodes_total);
-    sample_destroy (m->open);
-    sample_destroy (m->close);
-    sample_destroy (m->getattr);
-    sample_destroy (m->setattr);
-    sample_destroy (m->link);
-    sample_destroy (m->unlink);
-    sample_destroy (m->mkdir);
-    sample_destroy (m->rmdir);
-    sample_destroy (m->statfs);
-    sample_destroy (m->rename);
-    sample_destroy (m->kbytes_free);
-    sample_destroy (m->kbytes_total);
-    sample_destroy (m->common.pct_cpu);
-    sample_destroy (m->common.pct_mem);
-    sample_destroy (m->getxattr);
-    sample_destroy (m->read_bytes);
-    sample_destroy (m->write_bytes);
     free (m);
 }
 
-/*  Used for list_find_first () of OST by target name, e.g. fs-OSTxxxx.
- */
-static int
-_match_oststat (oststat_t *o, char *name)
-{
-    int targetmatch;
-    int fsmatch;
-    char *p = strstr (name, "-OST");
-
-    fsmatch = _fsmatch(name, o->common.fsname);
-    targetmatch = (strcmp (o->common.name, p ? p + 4 : name) == 0);
-
-    return (targetmatch && fsmatch);
-}
-
-/*  Used for list_find_first () of OST by oss name.
- */
-static int
-_match_oststat2 (oststat_t *o, char *name)
-{
-    return (strcmp (o->common.servername, name) == 0);
-}
-
 /* Helper for _cmp_server_names ()
  */
 static char *
@@ -1568,6 +2831,30 @@ _cmp_tgtstat_bymem (void *p1, void *p2)
                                 ((generic_target_t *) p2)->pct_mem, sort_tnow);
 }
 
+/* Used for list_sort () of OST/MDT list by server request queue depth
+ * (descending order).
+ */
+static int
+_cmp_tgtstat_byqueue (void *p1, void *p2)
+{
+    double q1 = _svc_queue ((generic_target_t *) p1, sort_tnow);
+    double q2 = _svc_queue ((generic_target_t *) p2, sort_tnow);
+
+    return (q1 < q2 ? 1 : q1 > q2 ? -1 : 0);
+}
+
+/* Used for list_sort () of OST/MDT list by server request wait time
+ * (descending order).
+ */
+static int
+_cmp_tgtstat_bywait (void *p1, void *p2)
+{
+    double w1 = _svc_wait_ms ((generic_target_t *) p1, sort_tnow);
+    double w2 = _svc_wait_ms ((generic_target_t *) p2, sort_tnow);
+
+    return (w1 < w2 ? 1 : w1 > w2 ? -1 : 0);
+}
+
 /* Used for list_sort () of OST/MDT list by pct_cpu (descending order).
  */
 static int
@@ -1577,6 +2864,17 @@ _cmp_tgtstat_bycpu (void *p1, void *p2)
                                 ((generic_target_t *) p2)->pct_cpu, sort_tnow);
 }
 
+/* Used for list_sort () of OST/MDT list by the busiest cpu of the
+ * server (descending order).
+ */
+static int
+_cmp_tgtstat_bycore (void *p1, void *p2)
+{
+    return -1 * sample_val_cmp (((generic_target_t *) p1)->pct_maxcpu,
+                                ((generic_target_t *) p2)->pct_maxcpu,
+                                sort_tnow);
+}
+
 /* Used for no-op list_sort () of OST/MDT list.
  */
 static int
@@ -1650,6 +2948,59 @@ _cmp_oststat_bywbw (oststat_t *o1, oststat_t *o2)
 }
 
 
+/* Used for list_sort () of OST list by OSS network saturation
+ * (descending order).
+ */
+static int
+_cmp_oststat_bynic (oststat_t *o1, oststat_t *o2)
+{
+    double p1 = _nic_pct (o1, sort_tnow);
+    double p2 = _nic_pct (o2, sort_tnow);
+
+    return (p1 < p2 ? 1 : p1 > p2 ? -1 : 0);
+}
+
+/* Used for list_sort () of OST list by OSS ARC hit rate (descending order).
+ */
+static int
+_cmp_oststat_byarc (oststat_t *o1, oststat_t *o2)
+{
+    double p1 = _arc_pct (o1, sort_tnow);
+    double p2 = _arc_pct (o2, sort_tnow);
+
+    return (p1 < p2 ? 1 : p1 > p2 ? -1 : 0);
+}
+
+/* Used for list_sort () of OST list by txg sync time (descending order).
+ */
+static int
+_cmp_oststat_bytxg (oststat_t *o1, oststat_t *o2)
+{
+    return -1 * sample_val_cmp (o1->txg_sync, o2->txg_sync, sort_tnow);
+}
+
+/* Used for list_sort () of OST list by device utilization (descending order).
+ */
+static int
+_cmp_oststat_bydev (oststat_t *o1, oststat_t *o2)
+{
+    double u1 = _dev_util (o1, sort_tnow);
+    double u2 = _dev_util (o2, sort_tnow);
+
+    return (u1 < u2 ? 1 : u1 > u2 ? -1 : 0);
+}
+
+/* Used for list_sort () of OST list by device I/O latency (descending order).
+ */
+static int
+_cmp_oststat_byawait (oststat_t *o1, oststat_t *o2)
+{
+    double a1 = _dev_await (o1, sort_tnow);
+    double a2 = _dev_await (o2, sort_tnow);
+
+    return (a1 < a2 ? 1 : a1 > a2 ? -1 : 0);
+}
+
 /* Used for list_sort () of OST list by pct space used (descending order).
  */
 static int
@@ -1788,23 +3139,40 @@ _create_oststat (char *name, int stale_secs)
     char *ostx = strstr (name, "-OST");
 
     memset (o, 0, sizeof (*o));
+    strncpy (o->common.key, name, sizeof (o->common.key) - 1);
     strncpy (o->common.name, ostx ? ostx + 4 : name, sizeof(o->common.name) - 1);
     strncpy (o->common.fsname, name,
              ostx ? ostx - name : sizeof (o->common.fsname) - 1);
     *o->common.tgtstate = '\0';
     *o->common.recov_status='\0';
-    o->rbytes =       sample_create (stale_secs);
-    o->wbytes =       sample_create (stale_secs);
-    o->iops =         sample_create (stale_secs);
-    o->num_exports =  sample_create (stale_secs);
-    o->lock_count =   sample_create (stale_secs);
-    o->grant_rate =   sample_create (stale_secs);
-    o->cancel_rate =  sample_create (stale_secs);
-    o->connect =      sample_create (stale_secs);
-    o->kbytes_free =  sample_create (stale_secs);
-    o->kbytes_total = sample_create (stale_secs);
-    o->common.pct_cpu      = sample_create (stale_secs);
-    o->common.pct_mem      = sample_create (stale_secs);
+    sample_init (o->rbytes, stale_secs);
+    sample_init (o->wbytes, stale_secs);
+    sample_init (o->iops, stale_secs);
+    sample_init (o->num_exports, stale_secs);
+    sample_init (o->lock_count, stale_secs);
+    sample_init (o->grant_rate, stale_secs);
+    sample_init (o->cancel_rate, stale_secs);
+    sample_init (o->connect, stale_secs);
+    sample_init (o->kbytes_free, stale_secs);
+    sample_init (o->kbytes_total, stale_secs);
+    sample_init (o->nic_rbytes, stale_secs);
+    sample_init (o->nic_wbytes, stale_secs);
+    sample_init (o->nic_mbps, stale_secs);
+    sample_init (o->arc_hits, stale_secs);
+    sample_init (o->arc_misses, stale_secs);
+    sample_init (o->txg_sync, stale_secs);
+    sample_init (o->dev_ios, stale_secs);
+    sample_init (o->dev_ms, stale_secs);
+    sample_init (o->dev_busy, stale_secs);
+    sample_init (o->dev_queue, stale_secs);
+    sample_init (o->common.pct_cpu, stale_secs);
+    sample_init (o->common.pct_mem, stale_secs);
+    sample_init (o->common.pct_maxcpu, stale_secs);
+    sample_init (o->common.pct_iowait, stale_secs);
+    sample_init (o->common.pct_softirq, stale_secs);
+    sample_init (o->common.svc_reqs, stale_secs);
+    sample_init (o->common.svc_wait, stale_secs);
+    sample_init (o->common.svc_qdepth, stale_secs);
     return o;
 }
 
@@ -1813,18 +3181,6 @@ _create_oststat (char *name, int stale_secs)
 static void
 _destroy_oststat (oststat_t *o)
 {
-    sample_destroy (o->rbytes);
-    sample_destroy (o->wbytes);
-    sample_destroy (o->iops);
-    sample_destroy (o->num_exports);
-    sample_destroy (o->lock_count);
-    sample_destroy (o->grant_rate);
-    sample_destroy (o->cancel_rate);
-    sample_destroy (o->connect);
-    sample_destroy (o->kbytes_free);
-    sample_destroy (o->kbytes_total);
-    sample_destroy (o->common.pct_cpu);
-    sample_destroy (o->common.pct_mem);
     free (o);
 }
 
@@ -1837,18 +3193,6 @@ _copy_oststat (void *src)
     oststat_t *o = xmalloc (sizeof (*o));
 
     memcpy (o, o1, sizeof (*o));
-    o->rbytes =       sample_copy (o1->rbytes);
-    o->wbytes =       sample_copy (o1->wbytes);
-    o->iops =         sample_copy (o1->iops);
-    o->num_exports =  sample_copy (o1->num_exports);
-    o->lock_count =   sample_copy (o1->lock_count);
-    o->grant_rate =   sample_copy (o1->grant_rate);
-    o->cancel_rate =  sample_copy (o1->cancel_rate);
-    o->connect =      sample_copy (o1->connect);
-    o->kbytes_free =  sample_copy (o1->kbytes_free);
-    o->kbytes_total = sample_copy (o1->kbytes_total);
-    o->common.pct_cpu      = sample_copy (o1->common.pct_cpu);
-    o->common.pct_mem      = sample_copy (o1->common.pct_mem);
     return (void *) o;
 }
 
@@ -1873,14 +3217,14 @@ _fsmatch (char *name, char *fs)
  * MDT's are reporting it under CMD and last in wins.
  */
 static void
-_update_osc (char *name, char *state, List ost_data,
+_update_osc (char *name, char *state, tgtlist_t *ost_data,
              time_t tnow, time_t trcv, int stale_secs)
 {
     oststat_t *o;
 
-    if (!(o = list_find_first (ost_data, (ListFindF)_match_oststat, name))) {
+    if (!(o = _tgtlist_find (ost_data, name))) {
         o = _create_oststat (name, stale_secs);
-        list_append (ost_data, o);
+        _tgtlist_append (ost_data, o);
     }
     if (tnow - trcv > stale_secs)
         strncpy (o->common.tgtstate, "", sizeof (o->common.tgtstate) - 1);
@@ -1888,8 +3232,67 @@ _update_osc (char *name, char *state, List ost_data,
         strncpy (o->common.tgtstate, state, sizeof (o->common.tgtstate) - 1);
 }
 
+/* Append an event to the event log, discarding the oldest if full.
+ */
+static void
+_append_event (time_t t, const char *event, const char *target,
+               const char *server, const char *comment)
+{
+    evlog_t *ev = xmalloc (sizeof (*ev));
+    const char *p = strrchr (target, '-');
+
+    ev->t = t;
+    if (!strcmp (event, lmt_event_name (LMT_EVENT_OSC_STATE)))
+        snprintf (ev->text, sizeof (ev->text), "%s %s %s %s",
+                  p ? p + 1 : target, event, server, comment);
+    else
+        snprintf (ev->text, sizeof (ev->text), "%s %s %s",
+                  p ? p + 1 : target, event, comment);
+    list_append (events, ev);
+    if (list_count (events) > EVENT_LOG_MAX)
+        free (list_dequeue (events));
+}
+
+/* private arg structure for _log_event () */
+struct evlog_struct {
+    char *fs;
+    time_t t;
+};
+
+static void
+_log_event (lmt_event_t e, const char *target, const char *server,
+            const char *comment, void *arg)
+{
+    struct evlog_struct *a = arg;
+
+    if (a->fs && !_fsmatch ((char *)target, a->fs))
+        return;
+    _append_event (a->t, lmt_event_name (e), target, server, comment);
+}
+
+static void
+_track_target (char *target, char *server, char *recov_status, char *fs,
+               time_t trcv)
+{
+    struct evlog_struct a = { .fs = fs, .t = trcv };
+
+    if (evtrack)
+        lmt_evtrack_target (evtrack, target, server, recov_status,
+                            _log_event, &a);
+}
+
+/* Forget logged events and detection state, e.g. when playback rewinds.
+ */
+static void
+_clear_events (void)
+{
+    _list_empty_out (events);
+    if (evtrack)
+        lmt_evtrack_clear (evtrack);
+}
+
 static void
-_decode_osc_v1 (char *val, char *fs, List ost_data,
+_decode_osc_v1 (char *val, char *fs, tgtlist_t *ost_data,
              time_t tnow, time_t trcv, int stale_secs)
 {
     char *s, *servername, *oscname, *tgtstate;
@@ -1911,6 +3314,11 @@ _decode_osc_v1 (char *val, char *fs, List ost_data,
     list_iterator_destroy (itr);
     list_destroy (oscinfo);
     free (servername);
+    if (evtrack) {
+        struct evlog_struct a = { .fs = fs, .t = trcv };
+
+        lmt_evtrack_osc_v1 (evtrack, val, _log_event, &a);
+    }
 }
 
 /* Update oststat_t record in ost_data list for specified ostname.
@@ -1922,13 +3330,13 @@ _update_ost (char *ostname, char *servername, uint64_t read_bytes,
              uint64_t lock_count, uint64_t grant_rate, uint64_t cancel_rate,
              uint64_t connect, char *recov_status, uint64_t kbytes_free,
              uint64_t kbytes_total, float pct_cpu, float pct_mem,
-             List ost_data, time_t tnow, time_t trcv, int stale_secs)
+             tgtlist_t *ost_data, time_t tnow, time_t trcv, int stale_secs)
 {
     oststat_t *o;
 
-    if (!(o = list_find_first (ost_data, (ListFindF)_match_oststat, ostname))) {
+    if (!(o = _tgtlist_find (ost_data, ostname))) {
         o = _create_oststat (ostname, stale_secs);
-        list_append (ost_data, o);
+        _tgtlist_append (ost_data, o);
     }
     if (o->common.tgt_metric_timestamp < trcv) {
         if (strcmp (servername, o->common.servername) != 0) { /*failover/back*/
@@ -1939,8 +3347,24 @@ _update_ost (char *ostname, char *servername, uint64_t read_bytes,
             sample_invalidate (o->lock_count);
             sample_invalidate (o->kbytes_free);
             sample_invalidate (o->kbytes_total);
+            sample_invalidate (o->nic_rbytes);
+            sample_invalidate (o->nic_wbytes);
+            sample_invalidate (o->nic_mbps);
+            sample_invalidate (o->arc_hits);
+            sample_invalidate (o->arc_misses);
+            sample_invalidate (o->txg_sync);
+            sample_invalidate (o->dev_ios);
+            sample_invalidate (o->dev_ms);
+            sample_invalidate (o->dev_busy);
+            sample_invalidate (o->dev_queue);
             sample_invalidate (o->common.pct_cpu);
             sample_invalidate (o->common.pct_mem);
+            sample_invalidate (o->common.pct_maxcpu);
+            sample_invalidate (o->common.pct_iowait);
+            sample_invalidate (o->common.pct_softirq);
+            sample_invalidate (o->common.svc_reqs);
+            sample_invalidate (o->common.svc_wait);
+            sample_invalidate (o->common.svc_qdepth);
             snprintf (o->common.servername, sizeof (o->common.servername),
                       "%s", servername);
         }
@@ -1962,73 +3386,601 @@ _update_ost (char *ostname, char *servername, uint64_t read_bytes,
     }
 }
 
+/* Update the OSS network samples of an OST that was just updated by
+ * _update_ost ().
+ */
 static void
-_decode_ost_v2 (char *val, char *fs, List ost_data,
-                time_t tnow, time_t trcv, int stale_secs)
+_update_ost_nic (char *ostname, uint64_t nic_rbytes, uint64_t nic_wbytes,
+                 uint64_t nic_mbps, tgtlist_t *ost_data, time_t trcv)
 {
-    List ostinfo;
-    char *s, *p, *servername, *ostname, *recov_status;
-    float pct_cpu, pct_mem;
-    uint64_t read_bytes, write_bytes;
-    uint64_t kbytes_free, kbytes_total;
-    uint64_t inodes_free, inodes_total;
-    uint64_t iops, num_exports;
-    uint64_t lock_count, grant_rate, cancel_rate;
-    uint64_t connect, reconnect;
-    ListIterator itr;
+    oststat_t *o;
 
-    if (lmt_ost_decode_v2 (val, &servername, &pct_cpu, &pct_mem, &ostinfo) < 0)
+    if (!(o = _tgtlist_find (ost_data, ostname)))
         return;
-    /* Issue 53: drop domain name, if any */
-    if ((p = strchr (servername, '.')))
-        *p = '\0';
-    itr = list_iterator_create (ostinfo);
-    while ((s = list_next (itr))) {
-        if (lmt_ost_decode_v2_ostinfo (s, &ostname,
-                                       &read_bytes, &write_bytes,
-                                       &kbytes_free, &kbytes_total,
-                                       &inodes_free, &inodes_total, &iops,
-                                       &num_exports, &lock_count,
-                                       &grant_rate, &cancel_rate,
-                                       &connect, &reconnect,
-                                       &recov_status) == 0) {
-            if (!fs || _fsmatch (ostname, fs)) {
-                _update_ost (ostname, servername, read_bytes, write_bytes,
-                             iops, num_exports, lock_count, grant_rate,
-                             cancel_rate, connect + reconnect, recov_status,
-                             kbytes_free, kbytes_total, pct_cpu, pct_mem,
-                             ost_data, tnow, trcv, stale_secs);
-            }
-            free (ostname);
-            free (recov_status);
-        }
+    if (o->common.tgt_metric_timestamp == trcv) {
+        sample_update (o->nic_rbytes, (double)nic_rbytes, trcv);
+        sample_update (o->nic_wbytes, (double)nic_wbytes, trcv);
+        sample_update (o->nic_mbps, (double)nic_mbps, trcv);
     }
-    list_iterator_destroy (itr);
-    list_destroy (ostinfo);
-    free (servername);
 }
 
-/* Update mdtstat_t record in mdt_data list for specified mdtname.
- * Create an entry if one doesn't exist.
+/* Update the ZFS samples of an OST that was just updated by
+ * _update_ost ().  txg_ms is negative if the OST is not on ZFS.
  */
 static void
-_update_mdt (char *mdtname, char *servername, uint64_t inodes_free,
-             uint64_t inodes_total, uint64_t kbytes_free,
-             uint64_t kbytes_total, float pct_cpu, float pct_mem,
-             char *recov_status, List mdops, List mdt_data, time_t tnow,
-             time_t trcv, int stale_secs, int version)
+_update_ost_zfs (char *ostname, uint64_t arc_hits, uint64_t arc_misses,
+                 double txg_ms, tgtlist_t *ost_data, time_t trcv)
 {
-    char *opname, *s;
-    ListIterator itr;
-    mdtstat_t *m;
-    uint64_t samples, sum, sumsquares;
+    oststat_t *o;
+
+    if (!(o = _tgtlist_find (ost_data, ostname)))
+        return;
+    if (o->common.tgt_metric_timestamp == trcv) {
+        sample_update (o->arc_hits, (double)arc_hits, trcv);
+        sample_update (o->arc_misses, (double)arc_misses, trcv);
+        if (txg_ms >= 0)
+            sample_update (o->txg_sync, txg_ms, trcv);
+    }
+}
+
+/* Update the block device samples of an OST that was just updated by
+ * _update_ost () from its diskinfo entry, if it has one.
+ */
+static void
+_update_ost_disk (char *ostname, List diskinfo, tgtlist_t *ost_data,
+                  time_t trcv)
+{
+    ListIterator itr;
+    oststat_t *o;
+    char *s, *name, *dev;
+    uint64_t reads, read_ms, writes, write_ms, in_flight, io_ms, queue_ms;
+
+    if (!(o = _tgtlist_find (ost_data, ostname)))
+        return;
+    if (o->common.tgt_metric_timestamp != trcv)
+        return;
+    itr = list_iterator_create (diskinfo);
+    while ((s = list_next (itr))) {
+        if (lmt_ost_decode_v3_diskinfo (s, &name, &dev, &reads, &read_ms,
+                                        &writes, &write_ms, &in_flight,
+                                        &io_ms, &queue_ms) < 0)
+            continue;
+        if (!strcmp (name, ostname)) {
+            sample_update (o->dev_ios, (double)(reads + writes), trcv);
+            sample_update (o->dev_ms, (double)(read_ms + write_ms), trcv);
+            sample_update (o->dev_busy, (double)io_ms, trcv);
+            sample_update (o->dev_queue, (double)queue_ms, trcv);
+        }
+        free (name);
+        free (dev);
+    }
+    list_iterator_destroy (itr);
+}
+
+/* Return the sync time in ms of the newest txg of the zpool backing
+ * ostname, or -1 if it is not in zpoolinfo.
+ */
+static double
+_zpool_txg_ms (List zpoolinfo, const char *ostname)
+{
+    ListIterator itr;
+    char *s, *pool, *ostlist, *tok, *saveptr;
+    uint64_t nread, nwritten, reads, writes, txg, txg_sync_ns;
+    double ms = -1;
+
+    itr = list_iterator_create (zpoolinfo);
+    while (ms < 0 && (s = list_next (itr))) {
+        if (lmt_ost_decode_v3_zpoolinfo (s, &pool, &ostlist, &nread,
+                                         &nwritten, &reads, &writes, &txg,
+                                         &txg_sync_ns) < 0)
+            continue;
+        for (tok = strtok_r (ostlist, ",", &saveptr); tok;
+                tok = strtok_r (NULL, ",", &saveptr)) {
+            if (!strcmp (tok, ostname))
+                ms = txg_sync_ns / 1E6;
+        }
+        free (pool);
+        free (ostlist);
+    }
+    list_iterator_destroy (itr);
+    return ms;
+}
+
+/* Sum the counters and link speeds of the OSS interfaces that are up.
+ */
+static void
+_sum_ifinfo (List ifinfo, uint64_t *rbp, uint64_t *wbp, uint64_t *mbpsp)
+{
+    ListIterator itr;
+    char *s, *ifname;
+    uint64_t rx_bytes, tx_bytes, errors, rate;
+    int link;
+
+    *rbp = *wbp = *mbpsp = 0;
+    itr = list_iterator_create (ifinfo);
+    while ((s = list_next (itr))) {
+        if (lmt_ost_decode_v3_ifinfo (s, &ifname, &rx_bytes, &tx_bytes,
+                                      &errors, &link, &rate) < 0)
+            continue;
+        if (link) {
+            *rbp += rx_bytes;
+            *wbp += tx_bytes;
+            *mbpsp += rate;
+        }
+        free (ifname);
+    }
+    list_iterator_destroy (itr);
+}
+
+/* Sum the counters of the server's ptlrpc services.
+ */
+static void
+_sum_svcinfo (List svcinfo, uint64_t *reqsp, uint64_t *waitp,
+              uint64_t *qdepthp)
+{
+    ListIterator itr;
+    char *s, *name;
+    uint64_t reqs, wait, qdepth, active, started, max;
+
+    *reqsp = *waitp = *qdepthp = 0;
+    itr = list_iterator_create (svcinfo);
+    while ((s = list_next (itr))) {
+        if (lmt_decode_svcinfo (s, &name, &reqs, &wait, &qdepth, &active,
+                                &started, &max) < 0)
+            continue;
+        *reqsp += reqs;
+        *waitp += wait;
+        *qdepthp += qdepth;
+        free (name);
+    }
+    list_iterator_destroy (itr);
+}
+
+/* Update the server service samples of a target that was just updated
+ * by _update_ost () or _update_mdt ().
+ */
+static void
+_update_svc (char *name, uint64_t reqs, uint64_t wait, uint64_t qdepth,
+             tgtlist_t *tgt_data, time_t trcv)
+{
+    generic_target_t *t;
+
+    if (!(t = _tgtlist_find (tgt_data, name)))
+        return;
+    if (t->tgt_metric_timestamp == trcv) {
+        sample_update (t->svc_reqs, (double)reqs, trcv);
+        sample_update (t->svc_wait, (double)wait, trcv);
+        sample_update (t->svc_qdepth, (double)qdepth, trcv);
+    }
+}
+
+/* Update the host resource samples of a target that was just updated by
+ * _update_ost () or _update_mdt (), from the hostinfo of its server.
+ */
+static void
+_update_host (char *name, char *hostinfo, tgtlist_t *tgt_data, time_t trcv)
+{
+    generic_target_t *t;
+    int ncpu;
+    float pct_maxcpu, pct_iowait, pct_softirq;
+    uint64_t kcached, kslab, kdirty, kwriteback;
+
+    if (!(t = _tgtlist_find (tgt_data, name)))
+        return;
+    if (t->tgt_metric_timestamp != trcv)
+        return;
+    if (lmt_decode_hostinfo (hostinfo, &ncpu, &pct_maxcpu, &pct_iowait,
+                             &pct_softirq, &kcached, &kslab, &kdirty,
+                             &kwriteback) < 0)
+        return;
+    sample_update (t->pct_maxcpu, (double)pct_maxcpu, trcv);
+    sample_update (t->pct_iowait, (double)pct_iowait, trcv);
+    sample_update (t->pct_softirq, (double)pct_softirq, trcv);
+}
+
+static void
+_destroy_jobtgt (jobtgt_t *t)
+{
+    free (t->job);
+    free (t);
+}
+
+/* Replace the job report of each target in an lmt_job metric.
+ */
+static void
+_decode_job_v1 (char *val, char *fs, time_t trcv)
+{
+    char *s, *ji, *jobid, *servername, *tgtname;
+    List tgtinfo, jobinfo;
+    ListIterator itr, itr2;
+    jobtgt_t *t;
+    jobrpt_t *j;
+    int secs;
+
+    if (lmt_job_decode_v1 (val, &servername, &tgtinfo) < 0)
+        return;
+    itr = list_iterator_create (tgtinfo);
+    while ((s = list_next (itr))) {
+        if (lmt_job_decode_v1_tgtinfo (s, &tgtname, &secs, &jobinfo) < 0)
+            continue;
+        if (!fs || _fsmatch (tgtname, fs)) {
+            if (!(t = hash_find (jobtgts, tgtname))) {
+                t = xmalloc (sizeof (*t));
+                memset (t, 0, sizeof (*t));
+                snprintf (t->name, sizeof (t->name), "%s", tgtname);
+                if (!hash_insert (jobtgts, t->name, t))
+                    msg_exit ("out of memory");
+            }
+            t->trcv = trcv;
+            t->secs = secs;
+            t->njobs = 0;
+            t->job = xrealloc (t->job, (list_count (jobinfo) + 1)
+                                       * sizeof (t->job[0]));
+            itr2 = list_iterator_create (jobinfo);
+            while ((ji = list_next (itr2))) {
+                j = &t->job[t->njobs];
+                if (lmt_job_decode_v1_jobinfo (ji, &jobid, &j->read_bytes,
+                                               &j->write_bytes, &j->ops) < 0)
+                    continue;
+                snprintf (j->id, sizeof (j->id), "%s", jobid);
+                free (jobid);
+                t->njobs++;
+            }
+            list_iterator_destroy (itr2);
+        }
+        list_destroy (jobinfo);
+        free (tgtname);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (tgtinfo);
+    free (servername);
+}
+
+/* Forget job reports, e.g. when playback rewinds.
+ */
+static void
+_clear_jobs (void)
+{
+    hash_delete_if (jobtgts, (hash_arg_f)_index_remove_all, NULL);
+}
+
+static void
+_destroy_exptgt (exptgt_t *t)
+{
+    free (t->client);
+    free (t);
+}
+
+/* Replace the client report of each target in an lmt_export metric.
+ */
+static void
+_decode_export_v1 (char *val, char *fs, time_t trcv)
+{
+    char *s, *ci, *nid, *servername, *tgtname;
+    List tgtinfo, clientinfo;
+    ListIterator itr, itr2;
+    exptgt_t *t;
+    exprpt_t *e;
+    int secs;
+
+    if (lmt_export_decode_v1 (val, &servername, &tgtinfo) < 0)
+        return;
+    itr = list_iterator_create (tgtinfo);
+    while ((s = list_next (itr))) {
+        if (lmt_export_decode_v1_tgtinfo (s, &tgtname, &secs,
+                                          &clientinfo) < 0)
+            continue;
+        if (!fs || _fsmatch (tgtname, fs)) {
+            if (!(t = hash_find (exptgts, tgtname))) {
+                t = xmalloc (sizeof (*t));
+                memset (t, 0, sizeof (*t));
+                snprintf (t->name, sizeof (t->name), "%s", tgtname);
+                if (!hash_insert (exptgts, t->name, t))
+                    msg_exit ("out of memory");
+            }
+            snprintf (t->servername, sizeof (t->servername), "%s",
+                      servername);
+            t->trcv = trcv;
+            t->secs = secs;
+            t->nclients = 0;
+            t->client = xrealloc (t->client, (list_count (clientinfo) + 1)
+                                             * sizeof (t->client[0]));
+            itr2 = list_iterator_create (clientinfo);
+            while ((ci = list_next (itr2))) {
+                e = &t->client[t->nclients];
+                if (lmt_export_decode_v1_clientinfo (ci, &nid, &e->read_bytes,
+                                                     &e->write_bytes, &e->ops,
+                                                     &e->locks) < 0)
+                    continue;
+                snprintf (e->nid, sizeof (e->nid), "%s", nid);
+                free (nid);
+                t->nclients++;
+            }
+            list_iterator_destroy (itr2);
+        }
+        list_destroy (clientinfo);
+        free (tgtname);
+    }
+    list_iterator_destroy (itr);
+    list_destroy (tgtinfo);
+    free (servername);
+}
+
+/* Forget client reports, e.g. when playback rewinds.
+ */
+static void
+_clear_exports (void)
+{
+    hash_delete_if (exptgts, (hash_arg_f)_index_remove_all, NULL);
+}
+
+/* Replace the report of each client mount in an lmt_client metric.
+ */
+static void
+_decode_client_v1 (char *val, char *fs, time_t trcv)
+{
+    char *s, *host, key[MAXHOSTNAMELEN + 64];
+    List mntinfo;
+    ListIterator itr;
+    clirpt_t *r;
+    clistat_t c;
+    int secs;
+
+    if (lmt_client_decode_v1 (val, &host, &mntinfo) < 0)
+        return;
+    itr = list_iterator_create (mntinfo);
+    while ((s = list_next (itr))) {
+        if (lmt_client_decode_v1_mntinfo (s, &secs, &c) < 0)
+            continue;
+        if (fs && !_fsmatch (c.name, fs))
+            continue;
+        snprintf (key, sizeof (key), "%s:%s", host, c.name);
+        if (!(r = hash_find (clirpts, key))) {
+            r = xmalloc (sizeof (*r));
+            memset (r, 0, sizeof (*r));
+            snprintf (r->key, sizeof (r->key), "%s", key);
+            snprintf (r->host, sizeof (r->host), "%s", host);
+            if (!hash_insert (clirpts, r->key, r))
+                msg_exit ("out of memory");
+        }
+        r->trcv = trcv;
+        r->secs = secs;
+        r->c = c;
+    }
+    list_iterator_destroy (itr);
+    list_destroy (mntinfo);
+    free (host);
+}
+
+/* Forget client mount reports, e.g. when playback rewinds.
+ */
+static void
+_clear_clients (void)
+{
+    hash_delete_if (clirpts, (hash_arg_f)_index_remove_all, NULL);
+}
+
+/* Update the report of an lmt_router.  lmt_router_v2 adds the lnet
+ * drop count, the lnet NIs and the peer table summary, of which only
+ * the most depleted NI and peer are kept.
+ */
+static void
+_decode_router_v1_v2 (char *val, int vers, time_t trcv, int stale_secs)
+{
+    char *s, *p, *name, *nid;
+    float pct_cpu, pct_mem;
+    uint64_t bytes, drops = 0, queue = 0, pqueue;
+    List niinfo = NULL, peerinfo = NULL;
+    int npeer = 0, nstarved = 0;
+    int up, peer, max, tx, min;
+    ListIterator itr;
+    rtrstat_t *r;
+    int rc;
+
+    if (vers == 2)
+        rc = lmt_router_decode_v2 (val, &name, &pct_cpu, &pct_mem, &bytes,
+                                   &drops, &niinfo, &npeer, &nstarved,
+                                   &queue, &peerinfo);
+    else
+        rc = lmt_router_decode_v1 (val, &name, &pct_cpu, &pct_mem, &bytes);
+    if (rc < 0)
+        return;
+    /* Issue 53: drop domain name, if any */
+    if ((p = strchr (name, '.')))
+        *p = '\0';
+    if (!(r = hash_find (rtrstats, name))) {
+        r = xmalloc (sizeof (*r));
+        memset (r, 0, sizeof (*r));
+        snprintf (r->name, sizeof (r->name), "%s", name);
+        r->group = lmt_conf_get_router_group (name);
+        sample_init (r->bytes, stale_secs);
+        sample_init (r->drops, stale_secs);
+        if (!hash_insert (rtrstats, r->name, r))
+            msg_exit ("out of memory");
+    }
+    r->trcv = trcv;
+    r->pct_cpu = pct_cpu;
+    sample_update (r->bytes, (double)bytes, trcv);
+    sample_update (r->drops, (double)drops, trcv);
+    r->nni = 0;
+    r->ni_nid[0] = '\0';
+    r->npeer = npeer;
+    r->nstarved = nstarved;
+    r->queue = queue;
+    r->peer_nid[0] = '\0';
+    if (niinfo) {
+        itr = list_iterator_create (niinfo);
+        while ((s = list_next (itr))) {
+            if (lmt_router_decode_v2_niinfo (s, &nid, &up, &peer, &max, &tx,
+                                             &min) < 0)
+                continue;
+            if (r->nni++ == 0 || min < r->ni_min) {
+                snprintf (r->ni_nid, sizeof (r->ni_nid), "%s", nid);
+                r->ni_min = min;
+                r->ni_max = max;
+            }
+            free (nid);
+        }
+        list_iterator_destroy (itr);
+        list_destroy (niinfo);
+    }
+    /* peers arrive most starved first */
+    if (peerinfo) {
+        if ((s = list_peek (peerinfo))
+                && lmt_router_decode_v2_peerinfo (s, &nid, &max, &tx, &min,
+                                                  &pqueue) == 0) {
+            snprintf (r->peer_nid, sizeof (r->peer_nid), "%s", nid);
+            r->peer_min = min;
+            free (nid);
+        }
+        list_destroy (peerinfo);
+    }
+    free (name);
+}
+
+/* Forget router reports, e.g. when playback rewinds.
+ */
+static void
+_clear_routers (void)
+{
+    hash_delete_if (rtrstats, (hash_arg_f)_index_remove_all, NULL);
+}
+
+/* lmt_ost_v3 adds per-op counts, which ltop ignores, and, shown per OST:
+ * - oss network interfaces, summarized as %nic
+ * - oss services, summarized as queue and wait
+ * - the oss ZFS ARC as arc%, and the zpools backing the OSTs as txg ms
+ * - the diskstats of the OST block devices as dev% and await
+ * - the oss host resources as %core
+ */
+static void
+_decode_ost_v2_v3 (char *val, int vers, char *fs,
+                   tgtlist_t *ost_data, time_t tnow, time_t trcv,
+                   int stale_secs)
+{
+    List ostinfo, ops, ifinfo = NULL, svcinfo = NULL, zpoolinfo = NULL;
+    List diskinfo = NULL;
+    uint64_t nic_rbytes = 0, nic_wbytes = 0, nic_mbps = 0;
+    uint64_t svc_reqs = 0, svc_wait = 0, svc_qdepth = 0;
+    uint64_t arc_hits = 0, arc_misses = 0, arc_size, arc_c_max;
+    char *arcinfo = NULL, *hostinfo = NULL;
+    char *s, *p, *servername, *ostname, *recov_status;
+    float pct_cpu, pct_mem;
+    uint64_t read_bytes, write_bytes;
+    uint64_t kbytes_free, kbytes_total;
+    uint64_t inodes_free, inodes_total;
+    uint64_t iops, num_exports;
+    uint64_t lock_count, grant_rate, cancel_rate;
+    uint64_t connect, reconnect;
+    ListIterator itr;
+    int rc;
+
+    if (vers == 3)
+        rc = lmt_ost_decode_v3 (val, &servername, &pct_cpu, &pct_mem, &ifinfo,
+                                &svcinfo, &arcinfo, &zpoolinfo, &diskinfo,
+                                &hostinfo, &ostinfo);
+    else
+        rc = lmt_ost_decode_v2 (val, &servername, &pct_cpu, &pct_mem, &ostinfo);
+    if (rc < 0)
+        return;
+    if (ifinfo)
+        _sum_ifinfo (ifinfo, &nic_rbytes, &nic_wbytes, &nic_mbps);
+    if (svcinfo)
+        _sum_svcinfo (svcinfo, &svc_reqs, &svc_wait, &svc_qdepth);
+    if (arcinfo)
+        (void)lmt_ost_decode_v3_arcinfo (arcinfo, &arc_hits, &arc_misses,
+                                         &arc_size, &arc_c_max);
+    /* Issue 53: drop domain name, if any */
+    if ((p = strchr (servername, '.')))
+        *p = '\0';
+    itr = list_iterator_create (ostinfo);
+    while ((s = list_next (itr))) {
+        ops = NULL;
+        if (vers >= 3)
+            rc = lmt_ost_decode_v3_ostinfo (s, &ostname,
+                                       &read_bytes, &write_bytes,
+                                       &kbytes_free, &kbytes_total,
+                                       &inodes_free, &inodes_total, &iops,
+                                       &num_exports, &lock_count,
+                                       &grant_rate, &cancel_rate,
+                                       &connect, &reconnect,
+                                       &recov_status, &ops);
+        else
+            rc = lmt_ost_decode_v2_ostinfo (s, &ostname,
+                                       &read_bytes, &write_bytes,
+                                       &kbytes_free, &kbytes_total,
+                                       &inodes_free, &inodes_total, &iops,
+                                       &num_exports, &lock_count,
+                                       &grant_rate, &cancel_rate,
+                                       &connect, &reconnect,
+                                       &recov_status);
+        if (rc == 0) {
+            if (!fs || _fsmatch (ostname, fs)) {
+                _update_ost (ostname, servername, read_bytes, write_bytes,
+                             iops, num_exports, lock_count, grant_rate,
+                             cancel_rate, connect + reconnect, recov_status,
+                             kbytes_free, kbytes_total, pct_cpu, pct_mem,
+                             ost_data, tnow, trcv, stale_secs);
+                if (ifinfo)
+                    _update_ost_nic (ostname, nic_rbytes, nic_wbytes,
+                                     nic_mbps, ost_data, trcv);
+                if (svcinfo)
+                    _update_svc (ostname, svc_reqs, svc_wait, svc_qdepth,
+                                 ost_data, trcv);
+                if (zpoolinfo)
+                    _update_ost_zfs (ostname, arc_hits, arc_misses,
+                                     _zpool_txg_ms (zpoolinfo, ostname),
+                                     ost_data, trcv);
+                if (diskinfo)
+                    _update_ost_disk (ostname, diskinfo, ost_data, trcv);
+                if (hostinfo)
+                    _update_host (ostname, hostinfo, ost_data, trcv);
+                _track_target (ostname, servername, recov_status, fs, trcv);
+            }
+            free (ostname);
+            free (recov_status);
+            if (ops)
+                list_destroy (ops);
+        }
+    }
+    list_iterator_destroy (itr);
+    list_destroy (ostinfo);
+    if (ifinfo)
+        list_destroy (ifinfo);
+    if (svcinfo)
+        list_destroy (svcinfo);
+    if (zpoolinfo)
+        list_destroy (zpoolinfo);
+    if (diskinfo)
+        list_destroy (diskinfo);
+    if (arcinfo)
+        free (arcinfo);
+    if (hostinfo)
+        free (hostinfo);
+    free (servername);
+}
+
+/* Update mdtstat_t record in mdt_data list for specified mdtname.
+ * Create an entry if one doesn't exist.
+ */
+static void
+_update_mdt (char *mdtname, char *servername, uint64_t inodes_free,
+             uint64_t inodes_total, uint64_t kbytes_free,
+             uint64_t kbytes_total, float pct_cpu, float pct_mem,
+             char *recov_status, List mdops, tgtlist_t *mdt_data, time_t tnow,
+             time_t trcv, int stale_secs, int version)
+{
+    char *opname, *s;
+    ListIterator itr;
+    mdtstat_t *m;
+    uint64_t samples, sum, sumsquares;
 
     assert (version==1 || version==2 || version == 3);
     assert (version==1 ? recov_status==NULL : recov_status!=NULL );
 
-    if (!(m = list_find_first (mdt_data, (ListFindF)_match_mdtstat, mdtname))) {
+    if (!(m = _tgtlist_find (mdt_data, mdtname))) {
         m = _create_mdtstat (mdtname, stale_secs);
-        list_append (mdt_data, m);
+        _tgtlist_append (mdt_data, m);
     }
     if (m->common.tgt_metric_timestamp < trcv) {
         if (strcmp (servername, m->common.servername) != 0) { /*failover/back*/
@@ -2049,6 +4001,12 @@ _update_mdt (char *mdtname, char *servername, uint64_t inodes_free,
             sample_invalidate (m->getxattr);
             sample_invalidate (m->common.pct_cpu);
             sample_invalidate (m->common.pct_mem);
+            sample_invalidate (m->common.pct_maxcpu);
+            sample_invalidate (m->common.pct_iowait);
+            sample_invalidate (m->common.pct_softirq);
+            sample_invalidate (m->common.svc_reqs);
+            sample_invalidate (m->common.svc_wait);
+            sample_invalidate (m->common.svc_qdepth);
             sample_invalidate (m->read_bytes);
             sample_invalidate (m->write_bytes);
             snprintf (m->common.servername, sizeof (m->common.servername),
@@ -2103,7 +4061,7 @@ _update_mdt (char *mdtname, char *servername, uint64_t inodes_free,
 }
 
 static void
-_decode_mdt_v2 (char *val, char *fs, List mdt_data,
+_decode_mdt_v2 (char *val, char *fs, tgtlist_t *mdt_data,
                 time_t tnow, time_t trcv, int stale_secs)
 {
     List mdops, mdtinfo;
@@ -2123,11 +4081,13 @@ _decode_mdt_v2 (char *val, char *fs, List mdt_data,
                                        &inodes_total, &kbytes_free,
                                        &kbytes_total, &recov_info,
                                        &mdops) == 0) {
-            if (!fs || _fsmatch (mdtname, fs))
+            if (!fs || _fsmatch (mdtname, fs)) {
                 _update_mdt (mdtname, mdsname, inodes_free, inodes_total,
                              kbytes_free, kbytes_total, pct_cpu, pct_mem,
                              recov_info, mdops, mdt_data, tnow, trcv,
                              stale_secs, 2);
+                _track_target (mdtname, mdsname, recov_info, fs, trcv);
+            }
             free (mdtname);
             list_destroy (mdops);
         }
@@ -2137,58 +4097,170 @@ _decode_mdt_v2 (char *val, char *fs, List mdt_data,
     free (mdsname);
 }
 
+/* lmt_mdt_v4 adds mds services, summarized per MDT as queue and wait,
+ * and the mds host resources, shown per MDT as %core.
+ */
 static void
-_decode_mdt_v3 (char *val, char *fs, List mdt_data,
-                time_t tnow, time_t trcv, int stale_secs)
+_decode_mdt_v3_v4 (char *val, int vers, char *fs, tgtlist_t *mdt_data,
+                   time_t tnow, time_t trcv, int stale_secs)
 {
-    List mdops, mdtinfo;
-    char *s, *mdsname, *mdtname;
+    List mdops, mdtinfo, svcinfo = NULL;
+    char *s, *mdsname, *mdtname, *hostinfo = NULL;
     float pct_cpu, pct_mem;
     uint64_t kbytes_free, kbytes_total;
     uint64_t inodes_free, inodes_total;
+    uint64_t svc_reqs = 0, svc_wait = 0, svc_qdepth = 0;
     ListIterator itr;
+    int rc;
 
     char *recov_info;
 
-    if (lmt_mdt_decode_v1_v2_v3 (val, &mdsname, &pct_cpu, &pct_mem, &mdtinfo, 3) < 0)
+    if (vers == 4)
+        rc = lmt_mdt_decode_v4 (val, &mdsname, &pct_cpu, &pct_mem, &svcinfo,
+                                &hostinfo, &mdtinfo);
+    else
+        rc = lmt_mdt_decode_v1_v2_v3 (val, &mdsname, &pct_cpu, &pct_mem,
+                                      &mdtinfo, 3);
+    if (rc < 0)
         return;
+    if (svcinfo)
+        _sum_svcinfo (svcinfo, &svc_reqs, &svc_wait, &svc_qdepth);
     itr = list_iterator_create (mdtinfo);
     while ((s = list_next (itr))) {
         if (lmt_mdt_decode_v3_mdtinfo (s, &mdtname, &inodes_free,
                                        &inodes_total, &kbytes_free,
                                        &kbytes_total, &recov_info,
                                        &mdops) == 0) {
-            if (!fs || _fsmatch (mdtname, fs))
+            if (!fs || _fsmatch (mdtname, fs)) {
                 _update_mdt (mdtname, mdsname, inodes_free, inodes_total,
                              kbytes_free, kbytes_total, pct_cpu, pct_mem,
                              recov_info, mdops, mdt_data, tnow, trcv,
                              stale_secs, 3);
+                if (svcinfo)
+                    _update_svc (mdtname, svc_reqs, svc_wait, svc_qdepth,
+                                 mdt_data, trcv);
+                if (hostinfo)
+                    _update_host (mdtname, hostinfo, mdt_data, trcv);
+                _track_target (mdtname, mdsname, recov_info, fs, trcv);
+            }
             free (mdtname);
             list_destroy (mdops);
         }
     }
     list_iterator_destroy (itr);
     list_destroy (mdtinfo);
+    if (svcinfo)
+        list_destroy (svcinfo);
+    if (hostinfo)
+        free (hostinfo);
     free (mdsname);
 }
 
+/* Fetch the metrics from cerebro and make them the latest snapshot.
+ * The previous snapshot is kept if the fetch fails.
+ */
 static void
-_poll_cerebro (char *fs, List mdt_data, List ost_data, int stale_secs,
-               FILE *recf, time_t *tp)
+_poll_fetch (void)
 {
-    time_t trcv, tnow = time (NULL);
-    cmetric_t c;
+#if HAVE_CEREBRO_H
+    time_t t = time (NULL);
     List l = NULL;
+
+    if (lmt_cbr_get_metrics ("lmt_mdt,lmt_ost,lmt_osc,lmt_job,lmt_export,"
+                             "lmt_client,lmt_router", &l) < 0)
+        return;
+    pthread_mutex_lock (&poll_lock);
+    if (poll_metrics)
+        list_destroy (poll_metrics);
+    poll_metrics = l;
+    poll_time = t;
+    pthread_mutex_unlock (&poll_lock);
+#endif
+}
+
+static void *
+_poll_thread (void *arg)
+{
+    int sample_period = *(int *)arg;
+    time_t t;
+
+    free (arg);
+    for (;;) {
+        t = time (NULL);
+        _poll_fetch ();
+        t += sample_period - time (NULL);
+        if (t > 0)
+            sleep (t);
+    }
+    return NULL;
+}
+
+/* Start fetching cerebro metrics every sample_period seconds in the
+ * background.
+ */
+static void
+_poll_start (int sample_period)
+{
+    pthread_t tid;
+    pthread_attr_t attr;
+    int *arg = xmalloc (sizeof (int));
+    int e;
+
+    *arg = sample_period;
+    pthread_attr_init (&attr);
+    pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+    if ((e = pthread_create (&tid, &attr, _poll_thread, arg)) != 0) {
+        errno = e;
+        err_exit ("pthread_create");
+    }
+    pthread_attr_destroy (&attr);
+    poll_threaded = 1;
+}
+
+/* Return how many seconds old the snapshot taken at tnow is if it is
+ * overdue for replacement by the poller thread, else 0.
+ */
+static int
+_poll_late (time_t tnow, int sample_period)
+{
+    time_t age = time (NULL) - tnow;
+
+    if (!poll_threaded || tnow == 0 || age <= 2 * sample_period)
+        return 0;
+    return age;
+}
+
+/* Decode the latest cerebro snapshot into mdt_data and ost_data.
+ * Before _poll_start () is called, fetch it first.  Samples are only
+ * updated by newer data, so decoding a snapshot twice is harmless.
+ */
+static void
+_poll_cerebro (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+               int stale_secs,
+               ltoprec_t recf, time_t *tp)
+{
+    time_t trcv, tnow;
+    cmetric_t c;
     char *s, *name, *node;
     ListIterator itr;
     float vers;
 
+    if (local_ctx) {
+        _poll_local (fs, mdt_data, ost_data, stale_secs, recf, tp);
+        return;
+    }
 #if ! HAVE_CEREBRO_H
     return;
 #endif
-    if (lmt_cbr_get_metrics ("lmt_mdt,lmt_ost,lmt_osc", &l) < 0)
-        return;
-    itr = list_iterator_create (l);
+    if (!poll_threaded)
+        _poll_fetch ();
+    pthread_mutex_lock (&poll_lock);
+    if (!poll_metrics)
+        goto done;
+    tnow = poll_time;
+    if (recf && poll_recorded == tnow)
+        goto done_time;
+    itr = list_iterator_create (poll_metrics);
     while ((c = list_next (itr))) {
         if (!(name = lmt_cbr_get_name (c)))
             continue;
@@ -2200,141 +4272,591 @@ _poll_cerebro (char *fs, List mdt_data, List ost_data, int stale_secs,
             continue;
         trcv = lmt_cbr_get_time (c);
         if (recf)
-            _record_file (recf, tnow, trcv, node, name, s);
+            (void)ltoprec_append (recf, tnow, trcv, node, name, s);
         else if (!strcmp (name, "lmt_mdt") && vers == 2)
             _decode_mdt_v2 (s, fs, mdt_data, tnow, trcv, stale_secs);
-        else if (!strcmp (name, "lmt_mdt") && vers == 3)
-            _decode_mdt_v3 (s, fs, mdt_data, tnow, trcv, stale_secs);
-        else if (!strcmp (name, "lmt_ost") && vers == 2)
-            _decode_ost_v2 (s, fs, ost_data, tnow, trcv, stale_secs);
+        else if (!strcmp (name, "lmt_mdt") && (vers >= 3 && vers <= 4))
+            _decode_mdt_v3_v4 (s, (int)vers, fs, mdt_data, tnow, trcv,
+                               stale_secs);
+        else if (!strcmp (name, "lmt_ost") && (vers >= 2 && vers <= 3))
+            _decode_ost_v2_v3 (s, (int)vers, fs, ost_data, tnow, trcv,
+                               stale_secs);
         else if (!strcmp (name, "lmt_osc") && vers == 1)
             _decode_osc_v1 (s, fs, ost_data, tnow, trcv, stale_secs);
+        else if (!strcmp (name, "lmt_job") && vers == 1)
+            _decode_job_v1 (s, fs, trcv);
+        else if (!strcmp (name, "lmt_export") && vers == 1)
+            _decode_export_v1 (s, fs, trcv);
+        else if (!strcmp (name, "lmt_client") && vers == 1)
+            _decode_client_v1 (s, fs, trcv);
+        else if (!strcmp (name, "lmt_router") && (vers >= 1 && vers <= 2))
+            _decode_router_v1_v2 (s, (int)vers, trcv, stale_secs);
     }
     list_iterator_destroy (itr);
-    list_destroy (l);
+    if (recf)
+        poll_recorded = tnow;
+done_time:
     if (tp)
         *tp = tnow;
+done:
+    pthread_mutex_unlock (&poll_lock);
 }
 
-/* Write a cerebro metric record and some other info to a line in a file.
- * Ignore any errors, check with ferror () elsewhere.
+/* Print s as a JSON string.
  */
 static void
-_record_file (FILE *f, time_t tnow, time_t trcv, char *node,
-              char *name, char *s)
+_json_str (const char *s)
 {
-    (void)fprintf (f, "%"PRIu64" %"PRIu64" %s %s %s\n",
-                   (uint64_t)tnow, (uint64_t)trcv, node, name, s);
+    putchar ('"');
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            printf ("\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            printf ("\\u%04x", *s);
+        else
+            putchar (*s);
+    }
+    putchar ('"');
 }
 
-/* Create a (time, offset) tuple to be added to time_series List.
+/* Print s as a CSV field, quoted if necessary.
  */
-static ts_t *
-_ts_create (long p, uint64_t t)
+static void
+_csv_str (const char *s)
 {
-    ts_t *ts = xmalloc (sizeof (ts_t));
+    if (!strpbrk (s, ",\"\n")) {
+        fputs (s, stdout);
+        return;
+    }
+    putchar ('"');
+    for (; *s; s++) {
+        if (*s == '"')
+            putchar ('"');
+        putchar (*s);
+    }
+    putchar ('"');
+}
 
-    ts->p = p;
-    ts->t = t;
-    return ts;
+/* Print the fields common to OST and MDT --batch records.  Recovery
+ * status is empty unless the target is recovering or not running.
+ */
+static void
+_batch_common (generic_target_t *g, const char *type, int stale_secs,
+               time_t tnow, int json)
+{
+    int stale = (tnow - g->tgt_metric_timestamp) > stale_secs;
+    char *recov = strncmp (g->recov_status, "COMPLETE", 8) ? g->recov_status
+                                                          : "";
+
+    if (json) {
+        printf ("{\"time\":%"PRIu64",\"type\":\"%s\",\"fs\":", (uint64_t)tnow,
+                type);
+        _json_str (g->fsname);
+        printf (",\"target\":");
+        _json_str (g->name);
+        printf (",\"server\":");
+        _json_str (g->servername);
+        printf (",\"state\":");
+        _json_str (g->tgtstate);
+        printf (",\"recovery\":");
+        _json_str (recov);
+        printf (",\"stale\":%d", stale);
+    } else {
+        printf ("%s,%"PRIu64",", type, (uint64_t)tnow);
+        _csv_str (g->fsname);
+        putchar (',');
+        _csv_str (g->name);
+        putchar (',');
+        _csv_str (g->servername);
+        putchar (',');
+        _csv_str (g->tgtstate);
+        putchar (',');
+        _csv_str (recov);
+        printf (",%d", stale);
+    }
 }
 
-/* Analagous to _poll_cerebro (), except input is taken from a file
- * written by _record_file ().   The wall clock time recorded in the first
- * field groups records into batches.  This function reads only one batch,
- * and places its wall clock time in *tp.
+/* Print named values following the common fields of a --batch record.
  */
 static void
-_play_file (char *fs, List mdt_data, List ost_data, List time_series,
-            int stale_secs, FILE *f, time_t *tp, int *tdiffp)
+_batch_vals (const char *names[], double vals[], int n, int json)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (json)
+            printf (",\"%s\":%.15g", names[i], vals[i]);
+        else
+            printf (",%.15g", vals[i]);
+    }
+    printf (json ? "}\n" : "\n");
+}
+
+static const char *batch_ost_names[] = {
+    "exports", "connects", "read_bytes", "write_bytes", "iops",
+    "locks", "lock_grants", "lock_cancels", "pct_nic", "queue", "wait_ms",
+    "pct_arc", "txg_ms", "pct_dev", "dev_queue", "dev_await_ms",
+    "pct_cpu", "pct_core", "pct_iowait", "pct_softirq", "pct_mem",
+    "pct_space",
+};
+
+static const char *batch_mdt_names[] = {
+    "open", "close", "getattr", "setattr", "link", "unlink", "mkdir",
+    "rmdir", "statfs", "rename", "getxattr", "read_bytes", "write_bytes",
+    "queue", "wait_ms", "pct_cpu", "pct_core", "pct_iowait", "pct_softirq",
+    "pct_mem", "pct_space", "pct_inodes",
+};
+
+#define BATCH_NVALS(a)  (sizeof (a) / sizeof (a[0]))
+
+/* Print the CSV header lines, one per record type.
+ */
+static void
+_batch_header (void)
+{
+    const char *common = "time,fs,target,server,state,recovery,stale";
+    int i;
+
+    printf ("ost,%s", common);
+    for (i = 0; i < BATCH_NVALS (batch_ost_names); i++)
+        printf (",%s", batch_ost_names[i]);
+    printf ("\nmdt,%s", common);
+    for (i = 0; i < BATCH_NVALS (batch_mdt_names); i++)
+        printf (",%s", batch_mdt_names[i]);
+    printf ("\n");
+}
+
+static void
+_batch_ost (oststat_t *o, int stale_secs, time_t tnow, int json)
+{
+    double ktot = sample_val (o->kbytes_total, tnow);
+    double kfree = sample_val (o->kbytes_free, tnow);
+    double vals[] = {
+        sample_val (o->num_exports, tnow),
+        sample_rate (o->connect, tnow),
+        sample_rate (o->rbytes, tnow),
+        sample_rate (o->wbytes, tnow),
+        sample_rate (o->iops, tnow),
+        sample_val (o->lock_count, tnow),
+        sample_val (o->grant_rate, tnow),
+        sample_val (o->cancel_rate, tnow),
+        _nic_pct (o, tnow),
+        _svc_queue (&o->common, tnow),
+        _svc_wait_ms (&o->common, tnow),
+        _arc_pct (o, tnow),
+        sample_val (o->txg_sync, tnow),
+        _dev_util (o, tnow),
+        _dev_queue (o, tnow),
+        _dev_await (o, tnow),
+        sample_val (o->common.pct_cpu, tnow),
+        sample_val (o->common.pct_maxcpu, tnow),
+        sample_val (o->common.pct_iowait, tnow),
+        sample_val (o->common.pct_softirq, tnow),
+        sample_val (o->common.pct_mem, tnow),
+        ktot > 0 ? ((ktot - kfree) / ktot) * 100.0 : 0,
+    };
+
+    _batch_common (&o->common, "ost", stale_secs, tnow, json);
+    _batch_vals (batch_ost_names, vals, BATCH_NVALS (vals), json);
+}
+
+static void
+_batch_mdt (mdtstat_t *m, int stale_secs, time_t tnow, int json)
+{
+    double ktot = sample_val (m->kbytes_total, tnow);
+    double kfree = sample_val (m->kbytes_free, tnow);
+    double itot = sample_val (m->inodes_total, tnow);
+    double ifree = sample_val (m->inodes_free, tnow);
+    double vals[] = {
+        sample_rate (m->open, tnow),
+        sample_rate (m->close, tnow),
+        sample_rate (m->getattr, tnow),
+        sample_rate (m->setattr, tnow),
+        sample_rate (m->link, tnow),
+        sample_rate (m->unlink, tnow),
+        sample_rate (m->mkdir, tnow),
+        sample_rate (m->rmdir, tnow),
+        sample_rate (m->statfs, tnow),
+        sample_rate (m->rename, tnow),
+        sample_rate (m->getxattr, tnow),
+        sample_rate (m->read_bytes, tnow),
+        sample_rate (m->write_bytes, tnow),
+        _svc_queue (&m->common, tnow),
+        _svc_wait_ms (&m->common, tnow),
+        sample_val (m->common.pct_cpu, tnow),
+        sample_val (m->common.pct_maxcpu, tnow),
+        sample_val (m->common.pct_iowait, tnow),
+        sample_val (m->common.pct_softirq, tnow),
+        sample_val (m->common.pct_mem, tnow),
+        ktot > 0 ? ((ktot - kfree) / ktot) * 100.0 : 0,
+        itot > 0 ? ((itot - ifree) / itot) * 100.0 : 0,
+    };
+
+    _batch_common (&m->common, "mdt", stale_secs, tnow, json);
+    _batch_vals (batch_mdt_names, vals, BATCH_NVALS (vals), json);
+}
+
+/* Headless mode: print one record per target for each cycle, polling
+ * cerebro every sample_period, or for each frame of playf as fast as
+ * possible.  The first cycle (tcycle) has already been read.
+ */
+static void
+_batch (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data, int stale_secs,
+        int sample_period, ltoprec_t playf, int json, time_t tcycle)
+{
+    ListIterator itr;
+    mdtstat_t *m;
+    oststat_t *o;
+    time_t t, tpoll = tcycle;
+
+    if (!json)
+        _batch_header ();
+    for (;;) {
+        itr = list_iterator_create (mdt_data->list);
+        while ((m = list_next (itr)))
+            _batch_mdt (m, stale_secs, tcycle, json);
+        list_iterator_destroy (itr);
+        itr = list_iterator_create (ost_data->list);
+        while ((o = list_next (itr)))
+            _batch_ost (o, stale_secs, tcycle, json);
+        list_iterator_destroy (itr);
+        if (fflush (stdout) == EOF)
+            err_exit ("stdout");
+        if (playf) {
+            if (ltoprec_eof (playf))
+                break;
+            _play_file (fs, mdt_data, ost_data, stale_secs, playf,
+                        &tcycle, NULL);
+        } else {
+            t = tpoll + sample_period - time (NULL);
+            if (t > 0)
+                sleep (t);
+            tpoll = time (NULL);
+            _poll_cerebro (fs, mdt_data, ost_data, stale_secs, NULL,
+                           &tcycle);
+        }
+    }
+}
+
+/* Copy a text recording made by earlier versions of ltop, one metric
+ * per line, into rec.
+ */
+static void
+_convert_file (char *path, ltoprec_t rec)
 {
     static char s[65536];
-    float vers;
-    uint64_t tnow, trcv, tmark = 0;
-    char node[64], name[16];
-    long pos = 0;
-    int tdiff = 0;
-    ts_t *ts = NULL;
+    uint64_t tnow, trcv;
+    char node[65], name[17];
+    FILE *f;
+    int n = 0;
 
-    if (feof (f) || ferror (f))
-        return;
-    while (fscanf (f, "%"PRIu64" %"PRIu64" %64s %16s %65536[^\n]\n",
+    if (!(f = fopen (path, "r")))
+        err_exit ("error opening %s for reading", path);
+    while (fscanf (f, "%"PRIu64" %"PRIu64" %64s %16s %65535[^\n]\n",
                    &tnow, &trcv, node, name, s) == 5) {
-        if (tmark != 0 && tmark != tnow) {
-            if (fseek (f, pos, SEEK_SET) < 0)
-                err_exit ("fseek failed on playback file");
-            tdiff = tnow - tmark;
-            break;
-        }
-        if (sscanf (s, "%f;", &vers) != 1)
-            msg_exit ("Parse error reading metric version in playback file");
-        if (!strcmp (name, "lmt_mdt") && vers == 2)
-            _decode_mdt_v2 (s, fs, mdt_data, tnow, trcv, stale_secs);
-        if (!strcmp (name, "lmt_mdt") && vers == 3)
-            _decode_mdt_v3 (s, fs, mdt_data, tnow, trcv, stale_secs);
-        else if (!strcmp (name, "lmt_ost") && vers == 2)
-            _decode_ost_v2 (s, fs, ost_data, tnow, trcv, stale_secs);
-        else if (!strcmp (name, "lmt_osc") && vers == 1)
-            _decode_osc_v1 (s, fs, ost_data, tnow, trcv, stale_secs);
-        if ((pos = ftell (f)) < 0)
-            err_exit ("ftell failed on playback file");
-        if (!ts && time_series)
-            ts = _ts_create (pos, tnow);
-        tmark = tnow;
+        if (ltoprec_append (rec, tnow, trcv, node, name, s) < 0)
+            err_exit ("error writing recording");
+        n++;
     }
     if (ferror (f))
-        err_exit ("Error reading playback file");
-    if (tmark == 0)
-        msg_exit ("Error parsing playback file");
+        err_exit ("error reading %s", path);
+    if (!feof (f))
+        msg_exit ("%s: parse error after %d records", path, n);
+    (void)fclose (f);
+}
+
+static void
+_ring_signal (int sig)
+{
+    ring_done = 1;
+}
+
+/* Flight recorder mode: poll cerebro every sample_period and record the
+ * metrics into a ring of recordings in dir, starting a new one every
+ * segsecs and keeping the newest segments.  Memory and disk use are
+ * bounded by the segment length.  Runs until SIGINT or SIGTERM.
+ */
+static void
+_ring_record (char *dir, int sample_period, int segments, int segsecs)
+{
+    ltoprec_t rec = NULL;
+    time_t t, tseg = 0;
+
+    (void)signal (SIGINT, _ring_signal);
+    (void)signal (SIGTERM, _ring_signal);
+    while (!ring_done) {
+        t = time (NULL);
+        if (!rec || t - tseg >= segsecs) {
+            if (rec && ltoprec_close (rec) < 0)
+                err ("error writing ring segment in %s", dir);
+            if (!(rec = ltoprec_create_ring (dir, t, segments)))
+                err_exit ("error creating ring segment in %s", dir);
+            tseg = t;
+        }
+        _poll_cerebro (NULL, NULL, NULL, 0, rec, NULL);
+        t += sample_period - time (NULL);
+        if (t > 0 && !ring_done)
+            sleep (t);
+    }
+    if (rec && ltoprec_close (rec) < 0)
+        err ("error writing ring segment in %s", dir);
+}
+
+/* private arg structure for _play_file_metric () and _play_db_metric () */
+struct playdb_struct {
+    char *fs;
+    tgtlist_t *mdt_data;
+    tgtlist_t *ost_data;
+    time_t tnow;
+    int stale_secs;
+};
+
+static void
+_play_file_metric (char *node, char *name, char *s, time_t trcv, void *arg)
+{
+    struct playdb_struct *p = arg;
+    float vers;
+
+    if (sscanf (s, "%f;", &vers) != 1)
+        msg_exit ("Parse error reading metric version in playback file");
+    if (!strcmp (name, "lmt_mdt") && vers == 2)
+        _decode_mdt_v2 (s, p->fs, p->mdt_data, p->tnow, trcv, p->stale_secs);
+    else if (!strcmp (name, "lmt_mdt") && (vers >= 3 && vers <= 4))
+        _decode_mdt_v3_v4 (s, (int)vers, p->fs, p->mdt_data, p->tnow,
+                           trcv, p->stale_secs);
+    else if (!strcmp (name, "lmt_ost") && (vers >= 2 && vers <= 3))
+        _decode_ost_v2_v3 (s, (int)vers, p->fs, p->ost_data,
+                           p->tnow, trcv, p->stale_secs);
+    else if (!strcmp (name, "lmt_osc") && vers == 1)
+        _decode_osc_v1 (s, p->fs, p->ost_data, p->tnow, trcv, p->stale_secs);
+    else if (!strcmp (name, "lmt_job") && vers == 1)
+        _decode_job_v1 (s, p->fs, trcv);
+    else if (!strcmp (name, "lmt_export") && vers == 1)
+        _decode_export_v1 (s, p->fs, trcv);
+    else if (!strcmp (name, "lmt_client") && vers == 1)
+        _decode_client_v1 (s, p->fs, trcv);
+    else if (!strcmp (name, "lmt_router") && (vers >= 1 && vers <= 2))
+        _decode_router_v1_v2 (s, (int)vers, trcv, p->stale_secs);
+}
+
+/* Analagous to _poll_cerebro (), except the metrics of this server are
+ * generated from local_ctx as its cerebro metric modules would, and
+ * decoded (or recorded) straight away.  Metrics with nothing to report,
+ * e.g. lmt_mdt on an OSS, are skipped.
+ */
+static void
+_poll_local (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+             int stale_secs, ltoprec_t recf, time_t *tp)
+{
+    static const struct {
+        char *name;
+        int (*fn) (pctx_t ctx, char *s, int len);
+    } metrics[] = {
+        { "lmt_mdt", lmt_mdt_string_v4 },
+        { "lmt_ost", lmt_ost_string_v3 },
+        { "lmt_osc", lmt_osc_string_v1 },
+        { "lmt_job", lmt_job_string_v1 },
+        { "lmt_client", lmt_client_string_v1 },
+        { "lmt_router", lmt_router_string_v2 },
+    };
+    struct playdb_struct p = { .fs = fs, .mdt_data = mdt_data,
+                               .ost_data = ost_data,
+                               .stale_secs = stale_secs };
+    static char buf[LOCAL_BUFSIZE];
+    struct utsname uts;
+    int i, debug = lmt_conf_get_proto_debug ();
+
+    p.tnow = time (NULL);
+    if (uname (&uts) < 0)
+        err_exit ("uname");
+    /* don't let collection errors (e.g. no job_stats) garble the screen */
+    lmt_conf_set_proto_debug (0);
+    for (i = 0; i < sizeof (metrics) / sizeof (metrics[0]); i++) {
+        if (metrics[i].fn (local_ctx, buf, sizeof (buf)) < 0)
+            continue;
+        if (recf)
+            (void)ltoprec_append (recf, p.tnow, p.tnow, uts.nodename,
+                                  metrics[i].name, buf);
+        else
+            _play_file_metric (uts.nodename, metrics[i].name, buf, p.tnow,
+                               &p);
+    }
+    lmt_conf_set_proto_debug (debug);
+    if (tp)
+        *tp = p.tnow;
+}
+
+/* Analagous to _poll_cerebro (), except input is taken from a recording
+ * made with --record.  This function reads only the frame (one poll's
+ * worth of metrics) under the cursor, and places its wall clock time
+ * in *tp and the time until the next frame in *tdiffp.
+ */
+static void
+_play_file (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+            int stale_secs, ltoprec_t f, time_t *tp, int *tdiffp)
+{
+    struct playdb_struct p;
+
+    if (ltoprec_eof (f))
+        return;
+    p.fs = fs;
+    p.mdt_data = mdt_data;
+    p.ost_data = ost_data;
+    p.tnow = ltoprec_time (f);
+    p.stale_secs = stale_secs;
+
+    if (ltoprec_read (f, _play_file_metric, &p, NULL) < 0)
+        return;
     if (tp)
-        *tp = tmark;
-    if (tdiffp && !feof (f))
-        *tdiffp = tdiff;
-    if (ts && time_series)
-        list_prepend (time_series, ts);
+        *tp = p.tnow;
+    if (tdiffp && !ltoprec_eof (f))
+        *tdiffp = ltoprec_time (f) - p.tnow;
+}
+
+static double
+_cpu_msec (void)
+{
+    struct rusage ru;
 
+    if (getrusage (RUSAGE_SELF, &ru) < 0)
+        err_exit ("getrusage");
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000.0
+         + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000.0;
 }
 
-/* Seek to [count] batches of cerebro data ago.
- * (position at beginning of batch).
+/* Replay the rest of playf as fast as possible, doing the per-cycle work
+ * of the display loop (decode, summarize, sort) without curses, and
+ * report the CPU time spent per cycle.
  */
-static int
-_rewind_file (FILE *f, List time_series, int count)
+static void
+_benchmark (char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+            List oss_data, List mds_data,
+            int stale_secs, ltoprec_t playf)
 {
-    ts_t *ts;
-    int res = 0;
+    double t0, t, total = 0, max = 0;
+    time_t tcycle;
+    int cycles = 0;
 
-    while (count-- && (ts = list_dequeue (time_series))) {
-        if (fseek (f, ts->p, SEEK_SET) < 0)
-            err_exit ("fseek failed on playback file");
-        res++;
-        free (ts);
+    /* --local: time reading /proc too, so the trees in test/lustre_versions
+     * can be used as reproducible benchmarks.
+     */
+    while (playf ? !ltoprec_eof (playf) : cycles < BENCHMARK_LOCAL_CYCLES) {
+        t0 = _cpu_msec ();
+        if (playf)
+            _play_file (fs, mdt_data, ost_data,
+                        stale_secs, playf, &tcycle, NULL);
+        else
+            _poll_cerebro (fs, mdt_data, ost_data, stale_secs, NULL, &tcycle);
+        _summarize_ost (ost_data->list, oss_data, tcycle, stale_secs);
+        _summarize_mdt (mdt_data->list, mds_data, tcycle, stale_secs);
+        _update_ost_dist (ost_data->list, tcycle, stale_secs);
+        _sort_tgtlist (ost_data->list, tcycle, ost_col[0].fun,
+                       BENCHMARK_ROWS);
+        _sort_tgtlist (mdt_data->list, tcycle, mdt_col[0].fun,
+                       BENCHMARK_ROWS);
+        t = _cpu_msec () - t0;
+        total += t;
+        if (t > max)
+            max = t;
+        cycles++;
     }
-    return res;
+    printf ("cycles: %d\n", cycles);
+    printf ("targets: %d OST %d MDT\n", list_count (ost_data->list),
+            list_count (mdt_data->list));
+    printf ("servers: %d OSS %d MDS\n", list_count (oss_data),
+            list_count (mds_data));
+    printf ("cpu/cycle: %.3f ms avg %.3f ms max\n",
+            cycles > 0 ? total / cycles : 0, max);
+}
+
+static void
+_play_db_metric (char *node, char *name, char *s, time_t trcv, void *arg)
+{
+    struct playdb_struct *p = arg;
+    float vers;
+
+    if (sscanf (s, "%f;", &vers) != 1)
+        return;
+    if (!strcmp (name, "lmt_mdt") && vers == 3)
+        _decode_mdt_v3_v4 (s, 3, p->fs, p->mdt_data, p->tnow, trcv,
+                           p->stale_secs);
+    else if (!strcmp (name, "lmt_ost") && vers == 2)
+        _decode_ost_v2_v3 (s, 2, p->fs, p->ost_data, p->tnow, trcv,
+                           p->stale_secs);
+}
+
+static int
+_db_event (time_t t, const char *event, const char *target,
+           const char *server, const char *comment, void *arg)
+{
+    _append_event (t, event, target, server, comment);
+    return 0;
 }
 
-/* Seek to previous batch repeatedly until target time is reached.
+/* Replace ost/mdt_data with the database sample under the cursor,
+ * and the event log with the events leading up to it.
  */
 static void
-_rewind_file_to (FILE *f, List time_series, time_t target)
+_play_db (ltopdb_t dbh, char *fs, tgtlist_t *mdt_data, tgtlist_t *ost_data,
+          int stale_secs, time_t *tp)
 {
-    ts_t *ts;
-    int found = 0;
+    struct playdb_struct p;
+
+    p.fs = fs;
+    p.mdt_data = mdt_data;
+    p.ost_data = ost_data;
+    p.tnow = ltopdb_time (dbh);
+    p.stale_secs = stale_secs;
+
+    _tgtlist_empty (mdt_data);
+    _tgtlist_empty (ost_data);
+    ltopdb_replay (dbh, _play_db_metric, &p);
+    _list_empty_out (events);
+    _clear_jobs ();
+    _clear_exports ();
+    _clear_clients ();
+    _clear_routers ();
+    if (p.tnow > 0)
+        (void)ltopdb_events (dbh, p.tnow - EVENT_DB_SECS, p.tnow + 1,
+                             _db_event, NULL);
+    if (tp)
+        *tp = p.tnow;
+}
 
-    while (!found && (ts = list_dequeue (time_series))) {
-        if (fseek (f, ts->p, SEEK_SET) < 0)
-            err_exit ("fseek failed on playback file");
-        if (ts->t <= target)
-            found = 1;
-        free (ts);
+/* Parse --at TIME: seconds since the epoch, or local time in the form
+ * "YYYY-MM-DD [HH:MM[:SS]]".
+ */
+static int
+_parse_time (char *s, time_t *tp)
+{
+    struct tm tm;
+    char *end;
+    unsigned long t;
+    int n;
+
+    t = strtoul (s, &end, 10);
+    if (*s && *end == '\0') {
+        *tp = t;
+        return 0;
     }
+    memset (&tm, 0, sizeof (tm));
+    n = sscanf (s, "%d-%d-%d %d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                &tm.tm_hour, &tm.tm_min, &tm.tm_sec);
+    if (n != 3 && n < 5)
+        return -1;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    if ((*tp = mktime (&tm)) == (time_t)-1)
+        return -1;
+    return 0;
 }
 
 /* Peek at the data to find a default file system to monitor.
  * Ignore file systems with no OSTs and no MDTs.
  */
 static char *
-_find_first_fs (FILE *playf, int stale_secs)
+_find_first_fs (ltoprec_t playf, int stale_secs)
 {
     List fsl = _find_all_fs (playf, stale_secs);
     ListIterator itr;
@@ -2368,6 +4890,15 @@ _single_ost_update_summary (void *ost_v, void *summary_v)
     sample_add (summary->cancel_rate, ost->cancel_rate);
     sample_add (summary->connect, ost->connect);
 
+    /* OSTs on different zpools: show the slowest txg sync */
+    sample_max (summary->txg_sync, ost->txg_sync);
+
+    /* await over all the devices; dev% adds up like %cpu in top */
+    sample_add (summary->dev_ios, ost->dev_ios);
+    sample_add (summary->dev_ms, ost->dev_ms);
+    sample_add (summary->dev_busy, ost->dev_busy);
+    sample_add (summary->dev_queue, ost->dev_queue);
+
     /* Any "missing clients" on OST's should be reflected in OSS exp.
      */
     sample_min (summary->num_exports, ost->num_exports);
@@ -2379,18 +4910,20 @@ _single_ost_update_summary (void *ost_v, void *summary_v)
 static void
 _summarize_target (List target_data, List server_data, time_t tnow,
                    int stale_secs, _tgt_update_summary update_fn,
-                   _copy_tgtstat copy_fn, ListFindF cmp_fn)
+                   _copy_tgtstat copy_fn)
 {
     generic_target_t *target, *server;
     ListIterator itr;
+    hash_t index;
 
     _list_empty_out (server_data);
+    index = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                         (hash_cmp_f)strcmp, NULL);
     itr = list_iterator_create (target_data);
     while ((target = list_next (itr))) {
         if (tnow - target->tgt_metric_timestamp > stale_secs)
             continue;
-        server = list_find_first (server_data, (ListFindF) cmp_fn,
-                                  target->servername);
+        server = hash_find (index, target->servername);
         if (server) {
             update_fn( (void *) target, (void *) server );
             if (target->tgt_metric_timestamp < server->tgt_metric_timestamp)
@@ -2412,9 +4945,12 @@ _summarize_target (List target_data, List server_data, time_t tnow,
             server = (generic_target_t *) copy_fn ((void *) target);
             snprintf (server->name, sizeof (server->name), "(%d)", 1);
             list_append (server_data, server);
+            if (!hash_insert (index, server->servername, server))
+                err_exit ("hash_insert");
         }
     }
     list_iterator_destroy (itr);
+    hash_destroy (index);
 }
 
 static void
@@ -2442,7 +4978,7 @@ _single_mdt_update_summary (void *mdt_v, void *summary_v)
     sample_add (summary->read_bytes, mdt->read_bytes);
     sample_add (summary->write_bytes, mdt->write_bytes);
 
-    /* %cpu and %mem are per-server, and so the initial copy
+    /* %cpu, %mem and service stats are per-server, and so the initial copy
      * made by _copy_mdtstat() is correct for the summarized
      * view with no further processing
      */
@@ -2455,8 +4991,7 @@ static void
 _summarize_mdt (List mdt_data, List mds_data, time_t tnow, int stale_secs)
 {
     _summarize_target (mdt_data, mds_data, tnow, stale_secs,
-                       _single_mdt_update_summary, _copy_mdtstat,
-                       (ListFindF)  _match_mdtstat2);
+                       _single_mdt_update_summary, _copy_mdtstat);
     list_sort (mds_data, (ListCmpF)_cmp_tgtstat_byserver);
 }
 
@@ -2467,8 +5002,7 @@ static void
 _summarize_ost (List ost_data, List oss_data, time_t tnow, int stale_secs)
 {
     _summarize_target (ost_data, oss_data, tnow, stale_secs,
-                       _single_ost_update_summary, _copy_oststat,
-                       (ListFindF)  _match_oststat2);
+                       _single_ost_update_summary, _copy_oststat);
     list_sort (oss_data, (ListCmpF)_cmp_tgtstat_byserver);
 }
 
@@ -2503,14 +5037,97 @@ _get_sort_index (char k, int sort_index, sort_t c[], int nc)
     return sort_index;
 }
 
-/* Sort the list of MDT's using the specified comparison function.
- * tnow required for comparisons that operate on samples.
+/* Order sortent_t's by sort_fun, keeping ties in their previous order.
+ */
+static int
+_cmp_sortent (const sortent_t *e1, const sortent_t *e2)
+{
+    int rc = sort_fun (e1->tgt, e2->tgt);
+
+    return (rc != 0 ? rc : e1->pos - e2->pos);
+}
+
+/* Rearrange a[] so that a[k] is the entry that would be there if a[]
+ * were sorted (quickselect).
  */
 static void
-_sort_tgtlist (List tgt_data, time_t tnow, ListCmpF comparison_function)
+_select_sortent (sortent_t *a, int n, int k)
+{
+    int lo = 0, hi = n - 1;
+    int i, j;
+    sortent_t pivot, tmp;
+
+    while (lo < hi) {
+        pivot = a[lo + (hi - lo) / 2];
+        i = lo;
+        j = hi;
+        while (i <= j) {
+            while (_cmp_sortent (&a[i], &pivot) < 0)
+                i++;
+            while (_cmp_sortent (&a[j], &pivot) > 0)
+                j--;
+            if (i <= j) {
+                tmp = a[i];
+                a[i++] = a[j];
+                a[j--] = tmp;
+            }
+        }
+        if (k <= j)
+            hi = j;
+        else if (k >= i)
+            lo = i;
+        else
+            break;
+    }
+}
+
+/* Sort the list of targets using the specified comparison function.
+ * tnow required for comparisons that operate on samples.
+ * Only the first k targets are put in order (all if k <= 0); the rest
+ * follow in their previous order.  Returns the number put in order.
+ * N.B. list_sort () is an insertion sort, too slow for large target lists,
+ * so sort an array of the targets and rebuild the list from it.
+ */
+static int
+_sort_tgtlist (List tgt_data, time_t tnow, ListCmpF comparison_function,
+               int k)
 {
+    int i, nhead = 0, ntail = 0, n = list_count (tgt_data);
+    sortent_t *a, *b, kth;
+
+    if (k <= 0 || k > n)
+        k = n;
+    if (n < 2)
+        return k;
     sort_tnow = tnow;
-    list_sort (tgt_data, comparison_function);
+    sort_fun = comparison_function;
+    a = xmalloc (n * sizeof (*a));
+    for (i = 0; i < n; i++) {
+        a[i].tgt = list_dequeue (tgt_data);
+        a[i].pos = i;
+    }
+    if (k < n) {
+        /* Split into the k first targets and the rest, keeping the
+         * rest in order so ties sort the same as with a full sort.
+         */
+        b = xmalloc (n * sizeof (*b));
+        memcpy (b, a, n * sizeof (*b));
+        _select_sortent (b, n, k - 1);
+        kth = b[k - 1];
+        for (i = 0; i < n; i++) {
+            if (_cmp_sortent (&a[i], &kth) <= 0)
+                a[nhead++] = a[i];
+            else
+                b[ntail++] = a[i];
+        }
+        memcpy (a + nhead, b, ntail * sizeof (*b));
+        free (b);
+    }
+    qsort (a, k, sizeof (*a), (int (*)(const void *, const void *))_cmp_sortent);
+    for (i = 0; i < n; i++)
+        list_append (tgt_data, a[i].tgt);
+    free (a);
+    return k;
 }
 
 /* Helper for _list_empty_out ().
@@ -2530,6 +5147,60 @@ _list_empty_out (List l)
     list_delete_all (l, (ListFindF)_list_find_all, NULL);
 }
 
+/* Deletion callback matching every hash entry.  For _tgtlist_empty (),
+ * the index entries belong to the list; for _clear_jobs (), the hash
+ * frees them.
+ */
+static int
+_index_remove_all (void *data, const void *key, void *arg)
+{
+    return 1;
+}
+
+static tgtlist_t *
+_tgtlist_create (ListDelF del)
+{
+    tgtlist_t *t = xmalloc (sizeof (*t));
+
+    t->list = list_create (del);
+    t->index = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                            (hash_cmp_f)strcmp, NULL);
+    return t;
+}
+
+static void
+_tgtlist_destroy (tgtlist_t *t)
+{
+    hash_destroy (t->index);
+    list_destroy (t->list);
+    free (t);
+}
+
+/* Destroy all targets, leaving an empty tgtlist.
+ */
+static void
+_tgtlist_empty (tgtlist_t *t)
+{
+    hash_delete_if (t->index, (hash_arg_f)_index_remove_all, NULL);
+    _list_empty_out (t->list);
+}
+
+static void *
+_tgtlist_find (tgtlist_t *t, const char *name)
+{
+    return hash_find (t->index, name);
+}
+
+static void
+_tgtlist_append (tgtlist_t *t, void *tgt)
+{
+    generic_target_t *g = tgt;
+
+    list_append (t->list, g);
+    if (!hash_insert (t->index, g->key, g))
+        err_exit ("failed to index %s", g->key);
+}
+
 /* Clear all tags.
  */
 static void
@@ -2564,6 +5235,25 @@ _tag_ost_byoss (List ost_data, char *ossname, int tagval)
  * If tagging oss_data (first param), set the last parmater to ost_data,
  * and all ost's on this oss will get tagged too.
  */
+/* Return the nth row of a target or server list, or NULL.
+ */
+static generic_target_t *
+_nth_target (List l, int n)
+{
+    generic_target_t *g;
+    ListIterator itr;
+    int i = 0;
+
+    if (n < 0)
+        return NULL;
+    itr = list_iterator_create (l);
+    while ((g = list_next (itr)))
+        if (i++ == n)
+            break;
+    list_iterator_destroy (itr);
+    return g;
+}
+
 static void
 _tag_nth_ost (List ost_data, int selost, List ost_data2)
 {
@@ -0,0 +1,1007 @@
+/*****************************************************************************
+ *  Copyright (C) 2010 Lawrence Livermore National Security, LLC.
+ *  This module was written by Jim Garlick <garlick@llnl.gov>
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* ltopdb.c - reconstruct ltop input from the LMT database */
+
+/* Samples are cached as frames (one per time stamp) in a window around
+ * the cursor.  The window is extended a chunk at a time in the direction
+ * the cursor is moving and trimmed on the other side, so memory use is
+ * bounded no matter how far the user travels.
+ *
+ * Prefetching is done by a thread with its own database connection, so
+ * that a slow query never holds up the display.  The thread fetches one
+ * chunk per request and hands the frames back under a lock; they are
+ * merged into the window only if it still adjoins them.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <stdarg.h>
+#include <pthread.h>
+
+#include "list.h"
+#include "hash.h"
+#include "error.h"
+
+#include "proc.h"
+
+#include "util.h"
+#include "lmtconf.h"
+#include "mdt.h"
+#if HAVE_MYSQL
+#include "lmtmysql.h"
+#endif
+
+#include "ltopdb.h"
+
+#if HAVE_MYSQL
+
+#define RAW_INTERVAL    5           /* default secs between raw samples */
+#define HOUR            3600
+#define RAW_CHUNK       300         /* secs of raw data fetched at once */
+#define HOUR_CHUNK      (24*HOUR)   /* secs of hourly data fetched at once */
+#define KEEP_CHUNKS     2           /* chunks cached on each side of cursor */
+#define GAP_CHUNKS      12          /* empty chunks crossed before giving up */
+#define TGTHASH_SIZE    1024
+
+#define PF_OFF          0           /* no prefetch thread */
+#define PF_IDLE         1           /* waiting for a request */
+#define PF_POSTED       2           /* fetching pf_t0 to pf_t1 */
+#define PF_DONE         3           /* pf_frames ready to be merged */
+
+typedef struct {
+    char key[64];               /* hash key: "ost_ID" or "mdt_ID" */
+    char *name;                 /* target name */
+    char *host;                 /* oss or mds hostname */
+} tgt_t;
+
+typedef struct {
+    tgt_t *tgt;
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t kbytes_free;
+    uint64_t kbytes_used;
+    uint64_t inodes_free;
+    uint64_t inodes_used;
+} ostrow_t;
+
+typedef struct {
+    tgt_t *tgt;
+    float pct_cpu;
+    uint64_t kbytes_free;
+    uint64_t kbytes_used;
+    uint64_t inodes_free;
+    uint64_t inodes_used;
+    uint64_t *ops;              /* samples, sum, sumsq per v3 op (or NULL) */
+} mdtrow_t;
+
+typedef struct {
+    time_t t;
+    List ost;                   /* list of ostrow_t */
+    List mdt;                   /* list of mdtrow_t */
+} frame_t;
+
+struct ltopdb_struct {
+    lmt_db_t db;
+    hash_t tgts;                /* "ost_ID" or "mdt_ID" -> tgt_t */
+    uint64_t *opid;             /* OPERATION_ID indexed like optab_mdt_v3 */
+    int nops;
+    List frames;                /* list of frame_t, ascending time */
+    time_t lo, hi;              /* frames cover [lo, hi) */
+    time_t cursor;              /* time of frame under cursor */
+    int interval;               /* secs between raw samples */
+    int hourly;
+    char *dbname;
+    /* prefetch thread state, protected by lock */
+    pthread_t tid;
+    int threaded;               /* tid is valid */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int pf_state;
+    int pf_quit;
+    int pf_hourly;
+    time_t pf_t0, pf_t1;
+    List pf_frames;
+};
+
+/* private arg structure for the batch callbacks */
+struct fetch_struct {
+    ltopdb_t d;
+    List frames;                /* new frames, ascending time */
+    frame_t *last;              /* most recently used frame */
+};
+
+static void
+_destroy_tgt (tgt_t *tgt)
+{
+    free (tgt->name);
+    free (tgt->host);
+    free (tgt);
+}
+
+static void
+_destroy_mdtrow (mdtrow_t *m)
+{
+    if (m->ops)
+        free (m->ops);
+    free (m);
+}
+
+static frame_t *
+_create_frame (time_t t)
+{
+    frame_t *fr = xmalloc (sizeof (*fr));
+
+    fr->t = t;
+    fr->ost = list_create ((ListDelF)free);
+    fr->mdt = list_create ((ListDelF)_destroy_mdtrow);
+    return fr;
+}
+
+static void
+_destroy_frame (frame_t *fr)
+{
+    list_destroy (fr->ost);
+    list_destroy (fr->mdt);
+    free (fr);
+}
+
+static tgt_t *
+_find_tgt (ltopdb_t d, char *svctype, uint64_t id)
+{
+    char key[64];
+
+    snprintf (key, sizeof (key), "%s_%"PRIu64, svctype, id);
+    return hash_find (d->tgts, key);
+}
+
+static int
+_host_map (const char *name, const char *host, void *arg)
+{
+    tgt_t *tgt = xmalloc (sizeof (*tgt));
+
+    tgt->name = xstrdup (name);
+    tgt->host = xstrdup (host);
+    list_append ((List)arg, tgt);
+    return 0;
+}
+
+/* Build the id -> (name, host) map for one service type.
+ * The database connection is busy during lmt_db_host_map (), so
+ * ids are looked up afterwards.
+ */
+static int
+_map_tgts (ltopdb_t d, char *svctype)
+{
+    List l = list_create ((ListDelF)_destroy_tgt);
+    tgt_t *tgt;
+    uint64_t id;
+    int retval = -1;
+
+    if (lmt_db_host_map (d->db, svctype, _host_map, l) < 0)
+        goto done;
+    while ((tgt = list_dequeue (l))) {
+        if (lmt_db_lookup_id (d->db, svctype, tgt->name, &id) < 0
+                                            || _find_tgt (d, svctype, id)) {
+            _destroy_tgt (tgt);
+            continue;
+        }
+        snprintf (tgt->key, sizeof (tgt->key), "%s_%"PRIu64, svctype, id);
+        if (!hash_insert (d->tgts, tgt->key, tgt))
+            _destroy_tgt (tgt);
+    }
+    retval = 0;
+done:
+    list_destroy (l);
+    return retval;
+}
+
+static frame_t *
+_get_frame (struct fetch_struct *f, time_t t)
+{
+    ListIterator itr;
+    frame_t *fr;
+
+    if (f->last && f->last->t == t)
+        return f->last;
+    itr = list_iterator_create (f->frames);
+    while ((fr = list_next (itr))) {
+        if (fr->t == t)
+            break;
+        if (fr->t > t) {
+            fr = list_insert (itr, _create_frame (t));
+            break;
+        }
+    }
+    list_iterator_destroy (itr);
+    if (!fr)
+        fr = list_append (f->frames, _create_frame (t));
+    f->last = fr;
+    return fr;
+}
+
+static int
+_match_mdtrow (mdtrow_t *m, tgt_t *tgt)
+{
+    return (m->tgt == tgt);
+}
+
+static mdtrow_t *
+_get_mdtrow (frame_t *fr, tgt_t *tgt)
+{
+    mdtrow_t *m;
+
+    if (!(m = list_find_first (fr->mdt, (ListFindF)_match_mdtrow, tgt))) {
+        m = xmalloc (sizeof (*m));
+        memset (m, 0, sizeof (*m));
+        m->tgt = tgt;
+        list_append (fr->mdt, m);
+    }
+    return m;
+}
+
+static int
+_ost_batch (lmt_db_ost_batch_t *b, void *arg)
+{
+    struct fetch_struct *f = arg;
+    ostrow_t *o;
+    tgt_t *tgt;
+    int i;
+
+    for (i = 0; i < b->nrows; i++) {
+        if (!(tgt = _find_tgt (f->d, "ost", b->ost_id[i])))
+            continue;
+        o = xmalloc (sizeof (*o));
+        o->tgt = tgt;
+        o->read_bytes = b->read_bytes[i];
+        o->write_bytes = b->write_bytes[i];
+        o->kbytes_free = b->kbytes_free[i];
+        o->kbytes_used = b->kbytes_used[i];
+        o->inodes_free = b->inodes_free[i];
+        o->inodes_used = b->inodes_used[i];
+        list_append (_get_frame (f, b->timestamp[i])->ost, o);
+    }
+    return 0;
+}
+
+static int
+_mds_batch (lmt_db_mds_batch_t *b, void *arg)
+{
+    struct fetch_struct *f = arg;
+    mdtrow_t *m;
+    tgt_t *tgt;
+    int i;
+
+    for (i = 0; i < b->nrows; i++) {
+        if (!(tgt = _find_tgt (f->d, "mdt", b->mds_id[i])))
+            continue;
+        m = _get_mdtrow (_get_frame (f, b->timestamp[i]), tgt);
+        m->pct_cpu = b->pct_cpu[i];
+        m->kbytes_free = b->kbytes_free[i];
+        m->kbytes_used = b->kbytes_used[i];
+        m->inodes_free = b->inodes_free[i];
+        m->inodes_used = b->inodes_used[i];
+    }
+    return 0;
+}
+
+static int
+_mds_ops_batch (lmt_db_mds_ops_batch_t *b, void *arg)
+{
+    struct fetch_struct *f = arg;
+    ltopdb_t d = f->d;
+    mdtrow_t *m;
+    tgt_t *tgt;
+    int i, op;
+
+    for (i = 0; i < b->nrows; i++) {
+        if (!(tgt = _find_tgt (d, "mdt", b->mds_id[i])))
+            continue;
+        for (op = 0; op < d->nops; op++)
+            if (d->opid[op] == b->op_id[i])
+                break;
+        if (op == d->nops)
+            continue;
+        m = _get_mdtrow (_get_frame (f, b->timestamp[i]), tgt);
+        if (!m->ops) {
+            m->ops = xmalloc (3 * d->nops * sizeof (uint64_t));
+            memset (m->ops, 0, 3 * d->nops * sizeof (uint64_t));
+        }
+        m->ops[3*op] = b->samples[i];
+        m->ops[3*op + 1] = b->sum[i];
+        m->ops[3*op + 2] = b->sumsquares[i];
+    }
+    return 0;
+}
+
+/* Fetch frames in [t0, t1) over connection db, hourly or raw.
+ * A failed query yields the frames fetched so far.  This is called by
+ * the prefetch thread too, so it only reads the target map from d.
+ */
+static List
+_fetch (ltopdb_t d, lmt_db_t db, int hourly, time_t t0, time_t t1)
+{
+    struct fetch_struct f;
+    int rc;
+
+    f.d = d;
+    f.frames = list_create ((ListDelF)_destroy_frame);
+    f.last = NULL;
+    if (hourly) {
+        rc = lmt_db_query_ost_hour_range (db, t0, t1, NULL,
+                                          _ost_batch, &f);
+        if (rc == 0)
+            rc = lmt_db_query_mds_hour_range (db, t0, t1, NULL,
+                                              _mds_batch, &f);
+    } else {
+        rc = lmt_db_query_ost_range (db, t0, t1, NULL, _ost_batch, &f);
+        if (rc == 0)
+            rc = lmt_db_query_mds_range (db, t0, t1, NULL,
+                                         _mds_batch, &f);
+        if (rc == 0)
+            rc = lmt_db_query_mds_ops_range (db, t0, t1, NULL,
+                                             _mds_ops_batch, &f);
+    }
+    if (rc < 0 && lmt_conf_get_db_debug ())
+        msg ("error fetching %s data for %s", hourly ? "hourly" : "raw",
+             lmt_db_fsname (db));
+    return f.frames;
+}
+
+static int
+_chunk (ltopdb_t d)
+{
+    return d->hourly ? HOUR_CHUNK : RAW_CHUNK;
+}
+
+/* The most recent samples may still be arriving, so the window is not
+ * extended into the last few sample periods.
+ */
+static time_t
+_tmax (ltopdb_t d)
+{
+    return time (NULL) - 2 * ltopdb_interval (d);
+}
+
+/* Add the frames l covering [t0, t1) to the window, after it
+ * (t0 == hi) or before it (t1 == lo), and destroy l.
+ * Returns the number of frames added.
+ */
+static int
+_merge (ltopdb_t d, List l, time_t t0, time_t t1)
+{
+    frame_t *fr;
+    int n = list_count (l);
+
+    if (t0 >= d->hi) {
+        while ((fr = list_dequeue (l)))
+            list_append (d->frames, fr);
+        list_destroy (l);
+        d->hi = t1;
+    } else {
+        while ((fr = list_dequeue (d->frames)))
+            list_append (l, fr);
+        list_destroy (d->frames);
+        d->frames = l;
+        d->lo = t0;
+    }
+    return n;
+}
+
+/* Extend the cached window forward (t0 == hi) or backward (t1 == lo).
+ * Returns the number of frames added.
+ */
+static int
+_extend (ltopdb_t d, time_t t0, time_t t1)
+{
+    time_t tmax = _tmax (d);
+
+    if (t0 >= d->hi) {
+        if (t1 > tmax)
+            t1 = tmax;
+        if (t1 <= t0)
+            return 0;
+    }
+    return _merge (d, _fetch (d, d->db, d->hourly, t0, t1), t0, t1);
+}
+
+static void *
+_prefetch_thread (void *arg)
+{
+    ltopdb_t d = arg;
+    lmt_db_t db;
+    List l;
+    int hourly;
+    time_t t0, t1;
+
+    if (lmt_db_create (1, d->dbname, &db) < 0) {
+        if (lmt_conf_get_db_debug ())
+            msg ("%s: prefetch disabled", d->dbname);
+        pthread_mutex_lock (&d->lock);
+        d->pf_state = PF_OFF;
+        pthread_cond_broadcast (&d->cond);
+        pthread_mutex_unlock (&d->lock);
+        return NULL;
+    }
+    pthread_mutex_lock (&d->lock);
+    for (;;) {
+        while (d->pf_state != PF_POSTED && !d->pf_quit)
+            pthread_cond_wait (&d->cond, &d->lock);
+        if (d->pf_quit)
+            break;
+        hourly = d->pf_hourly;
+        t0 = d->pf_t0;
+        t1 = d->pf_t1;
+        pthread_mutex_unlock (&d->lock);
+        l = _fetch (d, db, hourly, t0, t1);
+        pthread_mutex_lock (&d->lock);
+        d->pf_frames = l;
+        d->pf_state = PF_DONE;
+        pthread_cond_broadcast (&d->cond);
+    }
+    pthread_mutex_unlock (&d->lock);
+    lmt_db_destroy (db);
+    return NULL;
+}
+
+/* Ask the prefetch thread for frames in [t0, t1), unless it is busy.
+ */
+static void
+_prefetch_post (ltopdb_t d, time_t t0, time_t t1)
+{
+    pthread_mutex_lock (&d->lock);
+    if (d->pf_state == PF_IDLE) {
+        d->pf_hourly = d->hourly;
+        d->pf_t0 = t0;
+        d->pf_t1 = t1;
+        d->pf_state = PF_POSTED;
+        pthread_cond_broadcast (&d->cond);
+    }
+    pthread_mutex_unlock (&d->lock);
+}
+
+/* Take the frames fetched by the prefetch thread, first waiting for
+ * a request in progress if wait is set, and merge them if they still
+ * adjoin the window.  Returns 1 if the window was extended.
+ */
+static int
+_prefetch_collect (ltopdb_t d, int wait)
+{
+    List l = NULL;
+    int hourly = 0;
+    time_t t0 = 0, t1 = 0;
+
+    pthread_mutex_lock (&d->lock);
+    while (wait && d->pf_state == PF_POSTED)
+        pthread_cond_wait (&d->cond, &d->lock);
+    if (d->pf_state == PF_DONE) {
+        l = d->pf_frames;
+        hourly = d->pf_hourly;
+        t0 = d->pf_t0;
+        t1 = d->pf_t1;
+        d->pf_frames = NULL;
+        d->pf_state = PF_IDLE;
+    }
+    pthread_mutex_unlock (&d->lock);
+    if (!l)
+        return 0;
+    if (hourly != d->hourly || (t0 != d->hi && t1 != d->lo)) {
+        list_destroy (l);
+        return 0;
+    }
+    (void)_merge (d, l, t0, t1);
+    return 1;
+}
+
+/* Drop frames more than KEEP_CHUNKS chunks from the cursor.
+ */
+static void
+_trim (ltopdb_t d)
+{
+    time_t span = KEEP_CHUNKS * _chunk (d);
+    ListIterator itr;
+    frame_t *fr;
+
+    itr = list_iterator_create (d->frames);
+    while ((fr = list_next (itr))) {
+        if (fr->t < d->cursor - span) {
+            d->lo = fr->t + 1;
+            _destroy_frame (list_remove (itr));
+        } else if (fr->t > d->cursor + span) {
+            if (fr->t < d->hi)
+                d->hi = fr->t;
+            _destroy_frame (list_remove (itr));
+        }
+    }
+    list_iterator_destroy (itr);
+}
+
+/* Discard the cache and fetch one chunk around time t.
+ */
+static void
+_reload (ltopdb_t d, time_t t)
+{
+    ListIterator itr;
+    frame_t *fr;
+    time_t t0 = t - _chunk (d) / 2;
+    time_t tlast = 0;
+    int interval = 0;
+
+    if (d->hourly)
+        t0 -= t0 % HOUR;
+    list_destroy (d->frames);
+    d->frames = list_create ((ListDelF)_destroy_frame);
+    d->lo = d->hi = t0;
+    (void)_extend (d, t0, t0 + _chunk (d));
+
+    if (!d->hourly) {
+        itr = list_iterator_create (d->frames);
+        while ((fr = list_next (itr))) {
+            if (tlast && (!interval || fr->t - tlast < interval))
+                interval = fr->t - tlast;
+            tlast = fr->t;
+        }
+        list_iterator_destroy (itr);
+        if (interval > 0)
+            d->interval = interval;
+    }
+}
+
+static frame_t *
+_find_frame (ltopdb_t d, time_t t, frame_t **prevp)
+{
+    ListIterator itr;
+    frame_t *fr, *prev = NULL;
+
+    itr = list_iterator_create (d->frames);
+    while ((fr = list_next (itr))) {
+        if (fr->t >= t)
+            break;
+        prev = fr;
+    }
+    list_iterator_destroy (itr);
+    if (prevp)
+        *prevp = prev;
+    return fr;
+}
+
+static frame_t *
+_next_frame (ltopdb_t d, time_t t)
+{
+    return _find_frame (d, t + 1, NULL);
+}
+
+static frame_t *
+_prev_frame (ltopdb_t d, time_t t)
+{
+    frame_t *prev;
+
+    (void)_find_frame (d, t, &prev);
+    return prev;
+}
+
+ltopdb_t
+ltopdb_create (char *fs, time_t t)
+{
+    ltopdb_t d = xmalloc (sizeof (*d));
+    const char *name;
+    int i, e;
+
+    memset (d, 0, sizeof (*d));
+    pthread_mutex_init (&d->lock, NULL);
+    pthread_cond_init (&d->cond, NULL);
+    d->pf_state = PF_OFF;
+    d->interval = RAW_INTERVAL;
+    d->frames = list_create ((ListDelF)_destroy_frame);
+    d->tgts = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                           (hash_cmp_f)strcmp, (hash_del_f)_destroy_tgt);
+
+    d->dbname = xmalloc (strlen (fs) + 12);
+    sprintf (d->dbname, "filesystem_%s", fs);
+    if (lmt_db_create (1, d->dbname, &d->db) < 0)
+        goto error;
+    if (_map_tgts (d, "ost") < 0 || _map_tgts (d, "mdt") < 0)
+        goto error;
+    for (d->nops = 0; get_opname_v3 (d->nops); d->nops++)
+        ;
+    d->opid = xmalloc (d->nops * sizeof (uint64_t));
+    for (i = 0; i < d->nops; i++) {
+        name = get_opname_v3 (i);
+        if (lmt_db_lookup_id (d->db, "op", (char *)name, &d->opid[i]) < 0)
+            d->opid[i] = 0;
+    }
+    ltopdb_seek (d, t);
+    d->pf_state = PF_IDLE;
+    if ((e = pthread_create (&d->tid, NULL, _prefetch_thread, d)) != 0) {
+        if (lmt_conf_get_db_debug ())
+            msg ("pthread_create: %s", strerror (e));
+        d->pf_state = PF_OFF;
+    } else
+        d->threaded = 1;
+    return d;
+error:
+    ltopdb_destroy (d);
+    return NULL;
+}
+
+void
+ltopdb_destroy (ltopdb_t d)
+{
+    pthread_mutex_lock (&d->lock);
+    d->pf_quit = 1;
+    pthread_cond_broadcast (&d->cond);
+    pthread_mutex_unlock (&d->lock);
+    if (d->threaded)
+        pthread_join (d->tid, NULL);
+    if (d->pf_frames)
+        list_destroy (d->pf_frames);
+    pthread_cond_destroy (&d->cond);
+    pthread_mutex_destroy (&d->lock);
+    if (d->dbname)
+        free (d->dbname);
+    if (d->frames)
+        list_destroy (d->frames);
+    if (d->tgts)
+        hash_destroy (d->tgts);
+    if (d->opid)
+        free (d->opid);
+    if (d->db)
+        lmt_db_destroy (d->db);
+    free (d);
+}
+
+void
+ltopdb_seek (ltopdb_t d, time_t t)
+{
+    frame_t *fr = NULL, *prev = NULL;
+
+    if (t >= d->lo && t < d->hi)
+        fr = _find_frame (d, t, &prev);
+    if (!fr && !prev) {
+        _reload (d, t);
+        if (list_is_empty (d->frames) && !d->hourly) {
+            d->hourly = 1; /* raw data has been purged */
+            _reload (d, t);
+        }
+        fr = _find_frame (d, t, &prev);
+    }
+    if (fr)
+        d->cursor = fr->t;
+    else if (prev)
+        d->cursor = prev->t;
+    else
+        d->cursor = t;
+}
+
+int
+ltopdb_step (ltopdb_t d, int n)
+{
+    int dir = n > 0 ? 1 : -1;
+    int moved = 0, empty = 0;
+    frame_t *fr;
+
+    while (n != 0 && empty < GAP_CHUNKS) {
+        fr = dir > 0 ? _next_frame (d, d->cursor) : _prev_frame (d, d->cursor);
+        if (fr) {
+            d->cursor = fr->t;
+            n -= dir;
+            moved++;
+            empty = 0;
+        } else if (_prefetch_collect (d, 1)) {
+            continue;
+        } else if (dir > 0) {
+            if (_extend (d, d->hi, d->hi + _chunk (d)) == 0) {
+                if (d->hi >= _tmax (d))
+                    break;
+                empty++;
+            }
+        } else {
+            if (_extend (d, d->lo - _chunk (d), d->lo) == 0)
+                empty++;
+        }
+    }
+    return moved;
+}
+
+void
+ltopdb_prefetch (ltopdb_t d)
+{
+    time_t margin = _chunk (d) / 2;
+    time_t t1 = d->hi + _chunk (d);
+
+    (void)_prefetch_collect (d, 0);
+    if (d->hi - d->cursor < margin) {
+        if (t1 > _tmax (d))
+            t1 = _tmax (d);
+        if (t1 > d->hi)
+            _prefetch_post (d, d->hi, t1);
+    } else if (d->cursor - d->lo < margin)
+        _prefetch_post (d, d->lo - _chunk (d), d->lo);
+    _trim (d);
+}
+
+/* Per-server metric string under construction.  The buffer grows
+ * geometrically and is inserted into the server hash once.
+ */
+typedef struct {
+    char *s;
+    int len;
+    int size;
+} srvbuf_t;
+
+static void
+_destroy_srvbuf (srvbuf_t *b)
+{
+    free (b->s);
+    free (b);
+}
+
+static srvbuf_t *
+_get_srvbuf (hash_t srv, char *host)
+{
+    srvbuf_t *b;
+
+    if (!(b = hash_find (srv, host))) {
+        b = xmalloc (sizeof (*b));
+        b->size = 256;
+        b->s = xmalloc (b->size);
+        b->s[0] = '\0';
+        b->len = 0;
+        hash_insert (srv, host, b);
+    }
+    return b;
+}
+
+static void
+_srvbuf_append (srvbuf_t *b, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    for (;;) {
+        va_start (ap, fmt);
+        n = vsnprintf (b->s + b->len, b->size - b->len, fmt, ap);
+        va_end (ap);
+        if (n < b->size - b->len)
+            break;
+        while (b->size - b->len <= n)
+            b->size *= 2;
+        b->s = xrealloc (b->s, b->size);
+    }
+    b->len += n;
+}
+
+/* Append the lmt_ost v2 fields for one OST to its server's metric string.
+ * Values not stored in the database (iops, exports, locks) are zero.
+ */
+static void
+_append_ost (hash_t srv, ostrow_t *o, int zero)
+{
+    srvbuf_t *b = _get_srvbuf (srv, o->tgt->host);
+
+    if (b->len == 0)
+        _srvbuf_append (b, "2;%s;0.0;0.0;", o->tgt->host);
+    _srvbuf_append (b, "%s;%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64
+                    ";%"PRIu64";%"PRIu64";0;0;0;0;0;0;0;COMPLETE;",
+                    o->tgt->name,
+                    o->inodes_free, o->inodes_free + o->inodes_used,
+                    o->kbytes_free, o->kbytes_free + o->kbytes_used,
+                    zero ? 0 : o->read_bytes, zero ? 0 : o->write_bytes);
+}
+
+static void
+_append_mdt (ltopdb_t d, hash_t srv, mdtrow_t *m, int zero)
+{
+    srvbuf_t *b = _get_srvbuf (srv, m->tgt->host);
+    int i;
+
+    if (b->len == 0)
+        _srvbuf_append (b, "3;%s;%f;0.0;", m->tgt->host, m->pct_cpu);
+    _srvbuf_append (b, "%s;%"PRIu64";%"PRIu64";%"PRIu64";%"PRIu64
+                    ";COMPLETE;", m->tgt->name,
+                    m->inodes_free, m->inodes_free + m->inodes_used,
+                    m->kbytes_free, m->kbytes_free + m->kbytes_used);
+    for (i = 0; i < 3 * d->nops; i++)
+        _srvbuf_append (b, "%"PRIu64";", zero || !m->ops ? 0 : m->ops[i]);
+}
+
+/* private arg structure for _emit_srv () */
+struct emit_struct {
+    char *name;
+    time_t t;
+    ltopdb_metric_f fn;
+    void *arg;
+};
+
+static int
+_emit_srv (srvbuf_t *b, char *host, struct emit_struct *e)
+{
+    if (b->len > 0 && b->s[b->len - 1] == ';') /* chomp trailing semicolon */
+        b->s[--b->len] = '\0';
+    e->fn (host, e->name, b->s, e->t, e->arg);
+    return 0;
+}
+
+/* Deliver frame fr as if it had been received at time t.
+ * If zero is set, byte and op counters are zeroed.
+ */
+static void
+_emit (ltopdb_t d, frame_t *fr, time_t t, int zero,
+       ltopdb_metric_f fn, void *arg)
+{
+    hash_t srv = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                              (hash_cmp_f)strcmp, (hash_del_f)_destroy_srvbuf);
+    struct emit_struct e = { .t = t, .fn = fn, .arg = arg };
+    ListIterator itr;
+    ostrow_t *o;
+    mdtrow_t *m;
+
+    itr = list_iterator_create (fr->ost);
+    while ((o = list_next (itr)))
+        _append_ost (srv, o, zero);
+    list_iterator_destroy (itr);
+    e.name = "lmt_ost";
+    hash_for_each (srv, (hash_arg_f)_emit_srv, &e);
+    hash_destroy (srv);
+
+    srv = hash_create (TGTHASH_SIZE, (hash_key_f)hash_key_string,
+                       (hash_cmp_f)strcmp, (hash_del_f)_destroy_srvbuf);
+    itr = list_iterator_create (fr->mdt);
+    while ((m = list_next (itr)))
+        _append_mdt (d, srv, m, zero);
+    list_iterator_destroy (itr);
+    e.name = "lmt_mdt";
+    hash_for_each (srv, (hash_arg_f)_emit_srv, &e);
+    hash_destroy (srv);
+}
+
+void
+ltopdb_replay (ltopdb_t d, ltopdb_metric_f fn, void *arg)
+{
+    frame_t *fr, *prev;
+
+    if (!(fr = _find_frame (d, d->cursor, &prev)) || fr->t != d->cursor)
+        return;
+    /* Hourly rows hold bytes moved during the hour rather than running
+     * totals, so rates are computed against a zero sample an hour back.
+     */
+    if (d->hourly)
+        _emit (d, fr, fr->t - HOUR, 1, fn, arg);
+    else if (prev)
+        _emit (d, prev, prev->t, 0, fn, arg);
+    _emit (d, fr, fr->t, 0, fn, arg);
+}
+
+void
+ltopdb_set_hourly (ltopdb_t d, int hourly)
+{
+    if (d->hourly == !!hourly)
+        return;
+    d->hourly = !!hourly;
+    d->lo = d->hi = 0;
+    ltopdb_seek (d, d->cursor);
+}
+
+int
+ltopdb_hourly (ltopdb_t d)
+{
+    return d->hourly;
+}
+
+time_t
+ltopdb_time (ltopdb_t d)
+{
+    frame_t *fr = _find_frame (d, d->cursor, NULL);
+
+    return (fr && fr->t == d->cursor) ? fr->t : 0;
+}
+
+int
+ltopdb_interval (ltopdb_t d)
+{
+    return d->hourly ? HOUR : d->interval;
+}
+
+int
+ltopdb_events (ltopdb_t d, time_t t0, time_t t1, ltopdb_event_f fn, void *arg)
+{
+    return lmt_db_query_events (d->db, t0, t1, fn, arg);
+}
+
+#else /* !HAVE_MYSQL */
+
+ltopdb_t
+ltopdb_create (char *fs, time_t t)
+{
+    return NULL;
+}
+
+void
+ltopdb_destroy (ltopdb_t d)
+{
+}
+
+int
+ltopdb_step (ltopdb_t d, int n)
+{
+    return 0;
+}
+
+void
+ltopdb_seek (ltopdb_t d, time_t t)
+{
+}
+
+void
+ltopdb_replay (ltopdb_t d, ltopdb_metric_f fn, void *arg)
+{
+}
+
+void
+ltopdb_prefetch (ltopdb_t d)
+{
+}
+
+void
+ltopdb_set_hourly (ltopdb_t d, int hourly)
+{
+}
+
+int
+ltopdb_hourly (ltopdb_t d)
+{
+    return 0;
+}
+
+time_t
+ltopdb_time (ltopdb_t d)
+{
+    return 0;
+}
+
+int
+ltopdb_interval (ltopdb_t d)
+{
+    return 0;
+}
+
+int
+ltopdb_events (ltopdb_t d, time_t t0, time_t t1, ltopdb_event_f fn, void *arg)
+{
+    return 0;
+}
+
+#endif /* HAVE_MYSQL */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,59 @@
+typedef struct ltopdb_struct *ltopdb_t;
+
+/* Callback used by ltopdb_replay () to deliver one reconstructed
+ * cerebro metric (e.g. lmt_ost v2, lmt_mdt v3) received at time trcv.
+ */
+typedef void (*ltopdb_metric_f) (char *node, char *name, char *val,
+                                 time_t trcv, void *arg);
+
+/* Open the LMT database for file system fs, positioned at the first
+ * sample at or after time t.  Returns NULL on error.
+ */
+ltopdb_t ltopdb_create (char *fs, time_t t);
+void ltopdb_destroy (ltopdb_t d);
+
+/* Move the cursor by n samples (negative is backwards), or to the
+ * first sample at or after time t.  Return the number of samples moved.
+ */
+int ltopdb_step (ltopdb_t d, int n);
+void ltopdb_seek (ltopdb_t d, time_t t);
+
+/* Emit the sample under the cursor and the one preceding it, so that
+ * rates can be computed.
+ */
+void ltopdb_replay (ltopdb_t d, ltopdb_metric_f fn, void *arg);
+
+/* Fetch samples ahead of and behind the cursor, if needed, so that
+ * stepping is instantaneous.  The fetch is done in the background;
+ * this only picks up the previous one and asks for the next chunk.
+ */
+void ltopdb_prefetch (ltopdb_t d);
+
+/* Select raw (OST_DATA, MDS_DATA) or hourly aggregate data.
+ * Hourly data is selected automatically when the raw data at the
+ * cursor has been purged.
+ */
+void ltopdb_set_hourly (ltopdb_t d, int hourly);
+int ltopdb_hourly (ltopdb_t d);
+
+/* Time stamp of the sample under the cursor (0 if none).
+ */
+time_t ltopdb_time (ltopdb_t d);
+
+/* Seconds between samples at the current resolution.
+ */
+int ltopdb_interval (ltopdb_t d);
+
+/* Call fn for each event recorded in EVENT_DATA in the time range
+ * [t0, t1), in time order.  Returns -1 on error.
+ */
+typedef int (*ltopdb_event_f) (time_t t, const char *event,
+                               const char *target, const char *server,
+                               const char *comment, void *arg);
+
+int ltopdb_events (ltopdb_t d, time_t t0, time_t t1, ltopdb_event_f fn,
+                   void *arg);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,594 @@
+/*****************************************************************************
+ *  Copyright (C) 2024 Lawrence Livermore National Security, LLC.
+ *  UCRL-CODE-232438 All Rights Reserved.
+ *
+ *  This file is part of the Lustre Monitoring Tool.
+ *  For details, see http://github.com/chaos/lmt.
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the license, or (at your option)
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE. See the terms and conditions of the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA or see
+ *  http://www.gnu.org/licenses.
+ *****************************************************************************/
+
+/* ltoprec.c - indexed binary recordings of ltop input */
+
+/* A recording is a file header, then one frame per poll of cerebro
+ * (all the metrics sharing a wall clock time stamp), then an index of
+ * frame times and offsets and a trailer locating the index.  Integers
+ * are in host byte order; the header records which.  Records within a
+ * frame, and frames, are padded to 8 bytes.
+ *
+ * Playback maps the file and seeks with a binary search of the index.
+ * If the index is missing (ltop did not exit cleanly), it is rebuilt
+ * by walking the frames, dropping a truncated last frame.  A frame is
+ * checked whole before any of its records are delivered, so a damaged
+ * frame is skipped rather than played back as a partial sample.
+ *
+ * A ring is a directory of recordings named by their start time, which
+ * sorts them in time order.  Playback of a ring maps every segment and
+ * concatenates their indices.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <dirent.h>
+
+#include "list.h"
+
+#include "util.h"
+
+#include "ltoprec.h"
+
+#define REC_MAGIC       "LTOPREC1"
+#define REC_BYTEORDER   0x01020304
+#define FRAME_MAGIC     0x4c544652  /* "LTFR" */
+#define INDEX_MAGIC     0x4c544958  /* "LTIX" */
+
+#define PAD8(n)         (((n) + 7) & ~(uint64_t)7)
+
+#define RING_SUFFIX     ".rec"
+#define RING_NAMELEN    10          /* digits of start time */
+
+typedef struct {
+    char magic[8];
+    uint32_t byteorder;
+    uint32_t reserved;
+} filehdr_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t nrec;
+    uint64_t len;               /* bytes of records following */
+    uint64_t tnow;
+} framehdr_t;
+
+typedef struct {
+    uint64_t trcv;
+    uint16_t nodelen;           /* string lengths, excluding NUL */
+    uint16_t namelen;
+    uint32_t vallen;
+} rechdr_t;
+
+typedef struct {
+    uint64_t tnow;
+    uint64_t off;
+} index_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t off;               /* offset of first index_t */
+} trailer_t;
+
+typedef struct {
+    uint64_t tnow;
+    uint64_t off;
+    int seg;                    /* segment holding the frame */
+} frame_t;
+
+typedef struct {
+    char *map;
+    size_t maplen;
+    uint64_t end;               /* offset just past the last frame */
+} segment_t;
+
+struct ltoprec_struct {
+    frame_t *idx;               /* one entry per frame */
+    int count;
+    int size;
+    /* recording */
+    FILE *f;
+    uint64_t off;               /* file offset of the next frame */
+    char *buf;                  /* records of the frame being built */
+    size_t len;
+    size_t bufsize;
+    uint32_t nrec;
+    time_t tnow;
+    int error;
+    /* playback */
+    segment_t *seg;
+    int nseg;
+    int cur;                    /* frame under the cursor */
+};
+
+static ltoprec_t
+_create_rec (void)
+{
+    ltoprec_t r = xmalloc (sizeof (*r));
+
+    memset (r, 0, sizeof (*r));
+    return r;
+}
+
+static void
+_add_index (ltoprec_t r, uint64_t tnow, uint64_t off, int seg)
+{
+    if (r->count == r->size) {
+        r->size = r->size ? r->size * 2 : 1024;
+        r->idx = xrealloc (r->idx, r->size * sizeof (frame_t));
+    }
+    r->idx[r->count].tnow = tnow;
+    r->idx[r->count].off = off;
+    r->idx[r->count].seg = seg;
+    r->count++;
+}
+
+static int
+_write (ltoprec_t r, const void *p, size_t len)
+{
+    if (len > 0 && fwrite (p, len, 1, r->f) != 1) {
+        r->error = 1;
+        return -1;
+    }
+    return 0;
+}
+
+ltoprec_t
+ltoprec_create (const char *path)
+{
+    ltoprec_t r = _create_rec ();
+    filehdr_t h;
+
+    if (!(r->f = fopen (path, "w")))
+        goto error;
+    memset (&h, 0, sizeof (h));
+    memcpy (h.magic, REC_MAGIC, sizeof (h.magic));
+    h.byteorder = REC_BYTEORDER;
+    if (_write (r, &h, sizeof (h)) < 0)
+        goto error;
+    r->off = sizeof (h);
+    return r;
+error:
+    if (r->f)
+        (void)fclose (r->f);
+    free (r);
+    return NULL;
+}
+
+/* Select segment files in a ring directory.
+ */
+static int
+_ring_filter (const struct dirent *d)
+{
+    int len = strlen (d->d_name);
+
+    return (len == RING_NAMELEN + strlen (RING_SUFFIX)
+            && strspn (d->d_name, "0123456789") == RING_NAMELEN
+            && !strcmp (d->d_name + RING_NAMELEN, RING_SUFFIX));
+}
+
+static char *
+_ring_path (const char *dir, const char *name)
+{
+    char *path = xmalloc (strlen (dir) + strlen (name) + 2);
+
+    sprintf (path, "%s/%s", dir, name);
+    return path;
+}
+
+ltoprec_t
+ltoprec_create_ring (const char *dir, time_t t, int segments)
+{
+    struct dirent **names;
+    char name[RING_NAMELEN + sizeof (RING_SUFFIX)];
+    char *path;
+    ltoprec_t r;
+    int i, n;
+
+    if ((n = scandir (dir, &names, _ring_filter, alphasort)) < 0)
+        return NULL;
+    for (i = 0; i < n; i++) {
+        if (i <= n - segments) {
+            path = _ring_path (dir, names[i]->d_name);
+            (void)unlink (path);
+            free (path);
+        }
+        free (names[i]);
+    }
+    free (names);
+    snprintf (name, sizeof (name), "%0*lu%s", RING_NAMELEN, (unsigned long)t,
+              RING_SUFFIX);
+    path = _ring_path (dir, name);
+    r = ltoprec_create (path);
+    free (path);
+    return r;
+}
+
+static int
+_flush_frame (ltoprec_t r)
+{
+    framehdr_t fh;
+
+    if (r->nrec == 0)
+        return 0;
+    fh.magic = FRAME_MAGIC;
+    fh.nrec = r->nrec;
+    fh.len = r->len;
+    fh.tnow = r->tnow;
+    if (_write (r, &fh, sizeof (fh)) < 0 || _write (r, r->buf, r->len) < 0)
+        return -1;
+    /* let playback of a ring see the frame while recording continues */
+    if (fflush (r->f) == EOF) {
+        r->error = 1;
+        return -1;
+    }
+    _add_index (r, r->tnow, r->off, 0);
+    r->off += sizeof (fh) + r->len;
+    r->len = 0;
+    r->nrec = 0;
+    return 0;
+}
+
+int
+ltoprec_append (ltoprec_t r, time_t tnow, time_t trcv, const char *node,
+                const char *name, const char *val)
+{
+    rechdr_t rh;
+    size_t need;
+    char *p;
+
+    if (r->nrec > 0 && r->tnow != tnow && _flush_frame (r) < 0)
+        return -1;
+    rh.trcv = trcv;
+    rh.nodelen = strlen (node);
+    rh.namelen = strlen (name);
+    rh.vallen = strlen (val);
+    need = PAD8 (sizeof (rh) + rh.nodelen + rh.namelen + rh.vallen + 3);
+    if (r->len + need > r->bufsize) {
+        while (r->len + need > r->bufsize)
+            r->bufsize = r->bufsize ? r->bufsize * 2 : 65536;
+        r->buf = xrealloc (r->buf, r->bufsize);
+    }
+    p = r->buf + r->len;
+    memset (p, 0, need);
+    memcpy (p, &rh, sizeof (rh));
+    p += sizeof (rh);
+    memcpy (p, node, rh.nodelen);
+    p += rh.nodelen + 1;
+    memcpy (p, name, rh.namelen);
+    p += rh.namelen + 1;
+    memcpy (p, val, rh.vallen);
+    r->len += need;
+    r->nrec++;
+    r->tnow = tnow;
+    return 0;
+}
+
+int
+ltoprec_error (ltoprec_t r)
+{
+    return r->error;
+}
+
+/* Locate the index via the trailer.  Return -1 if there is none.
+ */
+static int
+_load_index (ltoprec_t r, int seg)
+{
+    segment_t *s = &r->seg[seg];
+    trailer_t t;
+    index_t ix;
+    uint64_t end;
+    uint32_t i;
+
+    if (s->maplen < sizeof (filehdr_t) + sizeof (t))
+        return -1;
+    end = s->maplen - sizeof (t);
+    memcpy (&t, s->map + end, sizeof (t));
+    if (t.magic != INDEX_MAGIC || t.off < sizeof (filehdr_t) || t.off > end
+                               || (end - t.off) / sizeof (index_t) != t.count
+                               || (end - t.off) % sizeof (index_t) != 0)
+        return -1;
+    for (i = 0; i < t.count; i++) {
+        memcpy (&ix, s->map + t.off + i * sizeof (ix), sizeof (ix));
+        if (ix.off < sizeof (filehdr_t) || ix.off >= t.off)
+            return -1;
+    }
+    for (i = 0; i < t.count; i++) {
+        memcpy (&ix, s->map + t.off + i * sizeof (ix), sizeof (ix));
+        _add_index (r, ix.tnow, ix.off, seg);
+    }
+    s->end = t.off;
+    return 0;
+}
+
+/* Check the whole frame at off before any of it is used: it must lie
+ * before the end of the segment's frames, and its records must be
+ * NUL terminated and exactly fill it.  Return -1 if it does not.
+ */
+static int
+_check_frame (segment_t *s, uint64_t off, framehdr_t *fhp)
+{
+    framehdr_t fh;
+    rechdr_t rh;
+    char *p, *end, *node, *name, *val;
+    uint64_t len;
+    uint32_t i;
+
+    if (off < sizeof (filehdr_t) || off > s->end
+                                 || s->end - off < sizeof (fh))
+        return -1;
+    memcpy (&fh, s->map + off, sizeof (fh));
+    if (fh.magic != FRAME_MAGIC || fh.len > s->end - off - sizeof (fh))
+        return -1;
+    p = s->map + off + sizeof (fh);
+    end = p + fh.len;
+    for (i = 0; i < fh.nrec; i++) {
+        if (end - p < sizeof (rh))
+            return -1;
+        memcpy (&rh, p, sizeof (rh));
+        len = PAD8 (sizeof (rh) + rh.nodelen + rh.namelen + rh.vallen + 3);
+        if (end - p < len)
+            return -1;
+        node = p + sizeof (rh);
+        name = node + rh.nodelen + 1;
+        val = name + rh.namelen + 1;
+        if (node[rh.nodelen] || name[rh.namelen] || val[rh.vallen])
+            return -1;
+        p += len;
+    }
+    if (p != end)
+        return -1;
+    *fhp = fh;
+    return 0;
+}
+
+/* Rebuild the index by walking the frames.
+ */
+static void
+_scan_index (ltoprec_t r, int seg)
+{
+    segment_t *s = &r->seg[seg];
+    uint64_t off = sizeof (filehdr_t);
+    framehdr_t fh;
+
+    while (_check_frame (s, off, &fh) == 0) {
+        _add_index (r, fh.tnow, off, seg);
+        off += sizeof (fh) + fh.len;
+    }
+}
+
+/* Map the recording at path as the next segment and index its frames.
+ * Frames older than those already indexed are dropped.
+ */
+static int
+_open_segment (ltoprec_t r, const char *path)
+{
+    segment_t *s;
+    filehdr_t h;
+    struct stat sb;
+    int fd, first = r->count;
+    int i, j;
+
+    if ((fd = open (path, O_RDONLY)) < 0)
+        return -1;
+    if (fstat (fd, &sb) < 0)
+        goto error;
+    if (!S_ISREG (sb.st_mode) || sb.st_size < sizeof (h)) {
+        errno = EINVAL;
+        goto error;
+    }
+    r->seg = xrealloc (r->seg, (r->nseg + 1) * sizeof (segment_t));
+    s = &r->seg[r->nseg];
+    s->maplen = sb.st_size;
+    s->end = s->maplen;
+    /* private and writable so that callbacks may modify the strings */
+    s->map = mmap (NULL, s->maplen, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                   fd, 0);
+    if (s->map == MAP_FAILED)
+        goto error;
+    (void)close (fd);
+    r->nseg++;
+    memcpy (&h, s->map, sizeof (h));
+    if (memcmp (h.magic, REC_MAGIC, sizeof (h.magic)) != 0
+                                || h.byteorder != REC_BYTEORDER) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (_load_index (r, r->nseg - 1) < 0)
+        _scan_index (r, r->nseg - 1);
+    for (i = j = first; i < r->count; i++) {
+        if (j == 0 || r->idx[i].tnow > r->idx[j - 1].tnow)
+            r->idx[j++] = r->idx[i];
+    }
+    r->count = j;
+    return 0;
+error:
+    (void)close (fd);
+    return -1;
+}
+
+ltoprec_t
+ltoprec_open (const char *path)
+{
+    ltoprec_t r = _create_rec ();
+    struct dirent **names;
+    char *segpath;
+    int i, n;
+
+    if ((n = scandir (path, &names, _ring_filter, alphasort)) < 0) {
+        if (errno != ENOTDIR || _open_segment (r, path) < 0)
+            goto error;
+        return r;
+    }
+    for (i = 0; i < n; i++) {
+        /* the recorder may remove or still be starting a segment */
+        segpath = _ring_path (path, names[i]->d_name);
+        (void)_open_segment (r, segpath);
+        free (segpath);
+        free (names[i]);
+    }
+    free (names);
+    if (r->count == 0) {
+        errno = ENOENT;
+        goto error;
+    }
+    return r;
+error:
+    (void)ltoprec_close (r);
+    return NULL;
+}
+
+int
+ltoprec_close (ltoprec_t r)
+{
+    trailer_t t;
+    index_t ix;
+    int i, ret = 0;
+
+    if (r->f) {
+        if (_flush_frame (r) == 0) {
+            t.magic = INDEX_MAGIC;
+            t.count = r->count;
+            t.off = r->off;
+            for (i = 0; i < r->count; i++) {
+                ix.tnow = r->idx[i].tnow;
+                ix.off = r->idx[i].off;
+                if (_write (r, &ix, sizeof (ix)) < 0)
+                    break;
+            }
+            if (i == r->count)
+                (void)_write (r, &t, sizeof (t));
+        }
+        if (fclose (r->f) == EOF)
+            r->error = 1;
+        if (r->error)
+            ret = -1;
+    }
+    for (i = 0; i < r->nseg; i++)
+        (void)munmap (r->seg[i].map, r->seg[i].maplen);
+    if (r->seg)
+        free (r->seg);
+    if (r->idx)
+        free (r->idx);
+    if (r->buf)
+        free (r->buf);
+    free (r);
+    return ret;
+}
+
+int
+ltoprec_read (ltoprec_t r, ltoprec_metric_f fn, void *arg, time_t *tp)
+{
+    framehdr_t fh;
+    rechdr_t rh;
+    segment_t *s;
+    char *p, *node, *name, *val;
+    uint32_t i;
+
+again:
+    if (r->cur >= r->count)
+        return -1;
+    s = &r->seg[r->idx[r->cur].seg];
+    if (_check_frame (s, r->idx[r->cur].off, &fh) < 0)
+        goto corrupt;
+    p = s->map + r->idx[r->cur].off + sizeof (fh);
+    for (i = 0; i < fh.nrec; i++) {
+        memcpy (&rh, p, sizeof (rh));
+        node = p + sizeof (rh);
+        name = node + rh.nodelen + 1;
+        val = name + rh.namelen + 1;
+        fn (node, name, val, rh.trcv, arg);
+        p += PAD8 (sizeof (rh) + rh.nodelen + rh.namelen + rh.vallen + 3);
+    }
+    if (tp)
+        *tp = fh.tnow;
+    r->cur++;
+    return 0;
+corrupt:
+    /* drop a damaged frame from the index and move on to the next */
+    memmove (&r->idx[r->cur], &r->idx[r->cur + 1],
+             (r->count - r->cur - 1) * sizeof (frame_t));
+    r->count--;
+    goto again;
+}
+
+int
+ltoprec_step (ltoprec_t r, int n)
+{
+    int cur = r->cur + n;
+
+    if (cur < 0)
+        cur = 0;
+    if (cur > r->count)
+        cur = r->count;
+    n = abs (cur - r->cur);
+    r->cur = cur;
+    return n;
+}
+
+void
+ltoprec_seek (ltoprec_t r, time_t t)
+{
+    int lo = 0, hi = r->count;
+    int mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (r->idx[mid].tnow < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    r->cur = lo;
+}
+
+time_t
+ltoprec_time (ltoprec_t r)
+{
+    return r->cur < r->count ? r->idx[r->cur].tnow : 0;
+}
+
+int
+ltoprec_eof (ltoprec_t r)
+{
+    return r->cur >= r->count;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
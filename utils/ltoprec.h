@@ -0,0 +1,61 @@
+typedef struct ltoprec_struct *ltoprec_t;
+
+/* Callback used by ltoprec_read () to deliver one recorded cerebro
+ * metric (e.g. lmt_ost v2, lmt_mdt v3) received at time trcv.
+ */
+typedef void (*ltoprec_metric_f) (char *node, char *name, char *val,
+                                  time_t trcv, void *arg);
+
+/* Create a new recording at path.  Returns NULL on error.
+ */
+ltoprec_t ltoprec_create (const char *path);
+
+/* Create a new segment starting at time t in the ring directory dir,
+ * first removing the oldest segments so that no more than the given
+ * number remain.  Returns NULL on error.
+ */
+ltoprec_t ltoprec_create_ring (const char *dir, time_t t, int segments);
+
+/* Add a metric to the recording.  Metrics with the same tnow form one
+ * frame, which is written out when tnow changes or the recording is
+ * closed.  Returns -1 on error, which is also remembered for
+ * ltoprec_error ().
+ */
+int ltoprec_append (ltoprec_t r, time_t tnow, time_t trcv, const char *node,
+                    const char *name, const char *val);
+int ltoprec_error (ltoprec_t r);
+
+/* Open a recording, or a ring directory, for playback, positioned at
+ * the first frame.  Returns NULL on error (errno is EINVAL if path is
+ * not a recording).
+ */
+ltoprec_t ltoprec_open (const char *path);
+
+/* Finish a recording (writing its index) or end playback.
+ * Returns -1 if the recording could not be written.
+ */
+int ltoprec_close (ltoprec_t r);
+
+/* Deliver each metric of the frame under the cursor, and advance the
+ * cursor to the next frame.  Returns -1 at the end of the recording.
+ */
+int ltoprec_read (ltoprec_t r, ltoprec_metric_f fn, void *arg, time_t *tp);
+
+/* Move the cursor by n frames (negative is backwards), or to the first
+ * frame at or after time t.  ltoprec_step () returns the number of
+ * frames moved.
+ */
+int ltoprec_step (ltoprec_t r, int n);
+void ltoprec_seek (ltoprec_t r, time_t t);
+
+/* Time stamp of the frame under the cursor (0 at the end).
+ */
+time_t ltoprec_time (ltoprec_t r);
+
+/* True if the cursor is past the last frame.
+ */
+int ltoprec_eof (ltoprec_t r);
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -22,7 +22,14 @@
  *  http://www.gnu.org/licenses.
  *****************************************************************************/
 
-/* sample.c - ADT for 2-point data values used in rate calculation */
+/* sample.c - ADT for data values used in rate calculation */
+
+/* Each sample keeps a ring of the last SAMPLE_RING (time, value) points.
+ * Values are treated as counters for rate purposes: when a value goes
+ * backwards the counter is assumed to have been reset to zero, and the
+ * stored values are adjusted so that they keep increasing.  The newest
+ * value as reported is kept separately for sample_val ().
+ */
 
 #if HAVE_CONFIG_H
 #include "config.h"
@@ -30,29 +37,44 @@
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 
 #include "list.h"
 #include "util.h"
 #include "sample.h"
 
-struct sample_struct {
-    double val[2];
-    time_t time[2];
-    int valid; /* count of valid samples [0,1,2] */
-    int stale_secs;
-};
+/* logical index i (0 is newest) to ring index */
+#define RING_IDX(s,i)   (((s)->head - (i) + SAMPLE_RING) % SAMPLE_RING)
+
+static int rate_window = 0;
+static int rate_ewma = 0;
+
+void
+sample_set_window (int secs, int ewma)
+{
+    rate_window = secs;
+    rate_ewma = ewma;
+}
 
 sample_t
 sample_create (int stale_secs)
 {
     sample_t s = xmalloc (sizeof (*s));
 
-    memset (s, 0, sizeof (*s));
-    s->stale_secs = stale_secs;
+    sample_init (s, stale_secs);
 
     return s;
 }
 
+/* Initialize a sample in place, e.g. a sample_inline_t.
+ */
+void
+sample_init (sample_t s, int stale_secs)
+{
+    memset (s, 0, sizeof (*s));
+    s->stale_secs = stale_secs;
+}
+
 void
 sample_destroy (sample_t s)
 {
@@ -69,33 +91,84 @@ sample_copy (sample_t s1)
     return s;
 }
 
-/* Invalidate both data points.
+/* Invalidate all data points.
  */
 void
 sample_invalidate (sample_t s)
 {
     s->valid = 0;
+    s->nwin = 0;
+    s->ewma = 0;
 }
 
 /* Update sample with val @ timestamp t.
+ * The window start and EWMA are maintained incrementally, so this is
+ * O(1) amortized.
  */
 void
 sample_update (sample_t s, double val, time_t t)
 {
+    double adj, rate;
+    time_t dt;
+    int i;
+
     if (s->valid == 0) {
-        s->time[1] = t;
-        s->val[1] = val;
+        s->head = 0;
+        s->time[0] = t;
+        s->val[0] = val;
+        s->last = val;
+        s->valid = s->nwin = 1;
+        return;
+    }
+    if (s->time[s->head] >= t)
+        return;
+    dt = t - s->time[s->head];
+    if (val >= s->last)
+        adj = s->val[s->head] + (val - s->last);
+    else
+        adj = s->val[s->head] + val;        /* counter reset */
+    rate = (adj - s->val[s->head]) / dt;
+
+    s->head = (s->head + 1) % SAMPLE_RING;
+    s->time[s->head] = t;
+    s->val[s->head] = adj;
+    s->last = val;
+    if (s->valid < SAMPLE_RING)
         s->valid++;
-    } else if (s->time[1] < t) {
-        s->time[0] = s->time[1];
-        s->val[0] = s->val[1];
-        s->time[1] = t;
-        s->val[1] = val;
-        if (s->valid < 2)
-            s->valid++;
+    if (s->valid == 2 || rate_window == 0)
+        s->ewma = rate;
+    else
+        s->ewma += (1 - exp (-(double)dt / rate_window)) * (rate - s->ewma);
+
+    /* drop points older than the window, keeping at least two */
+    if (s->nwin < s->valid)
+        s->nwin++;
+    while (s->nwin > 2) {
+        i = RING_IDX (s, s->nwin - 1);
+        if (s->time[i] >= t - rate_window)
+            break;
+        s->nwin--;
     }
 }
 
+/* Return true if s1 and s2 have points at the same times.  Only the
+ * ends are checked, as targets of a server are updated together.
+ */
+static int
+_aligned (sample_t s1, sample_t s2)
+{
+    if (s1->valid != s2->valid)
+        return 0;
+    if (s1->valid == 0)
+        return 1;
+    if (s1->time[s1->head] != s2->time[s2->head])
+        return 0;
+    if (s1->time[RING_IDX (s1, s1->valid - 1)]
+                            != s2->time[RING_IDX (s2, s2->valid - 1)])
+        return 0;
+    return 1;
+}
+
 /* s1 += s2
  * Only has an effect if samples were collected at the same times.
  * (This is a somewhat contrived interface for ltop aggregation of ost data)
@@ -103,16 +176,14 @@ sample_update (sample_t s, double val, time_t t)
 void
 sample_add (sample_t s1, sample_t s2)
 {
-    if (s1->valid != s2->valid)
-        return;
-    if (s1->valid > 0 && s1->time[1] != s2->time[1])
-        return;
-    if (s1->valid > 1 && s1->time[0] != s2->time[0])
+    int i;
+
+    if (!_aligned (s1, s2))
         return;
-    if (s1->valid > 0)
-        s1->val[1] += s2->val[1];
-    if (s1->valid > 1)
-        s1->val[0] += s2->val[0];
+    for (i = 0; i < s1->valid; i++)
+        s1->val[RING_IDX (s1, i)] += s2->val[RING_IDX (s2, i)];
+    s1->last += s2->last;
+    s1->ewma += s2->ewma;
 }
 
 #ifndef MAX
@@ -129,50 +200,51 @@ sample_add (sample_t s1, sample_t s2)
 void
 sample_max (sample_t s1, sample_t s2)
 {
-    if (s1->valid != s2->valid)
-        return;
-    if (s1->valid > 0 && s1->time[1] != s2->time[1])
-        return;
-    if (s1->valid > 1 && s1->time[0] != s2->time[0])
+    int i, j;
+
+    if (!_aligned (s1, s2))
         return;
-    if (s1->valid > 0)
-        s1->val[1] = MAX (s1->val[1], s2->val[1]);
-    if (s1->valid > 1)
-        s1->val[0] = MAX (s1->val[0], s2->val[0]);
+    for (i = 0; i < s1->valid; i++) {
+        j = RING_IDX (s1, i);
+        s1->val[j] = MAX (s1->val[j], s2->val[RING_IDX (s2, i)]);
+    }
+    s1->last = MAX (s1->last, s2->last);
+    s1->ewma = MAX (s1->ewma, s2->ewma);
 }
 
-/* s1 = MAX (s1, s2)
+/* s1 = MIN (s1, s2)
  * Only has an effect if samples were collected at the same times.
  * (This is a somewhat contrived interface for ltop aggregation of ost data)
  */
 void
 sample_min (sample_t s1, sample_t s2)
 {
-    if (s1->valid != s2->valid)
-        return;
-    if (s1->valid > 0 && s1->time[1] != s2->time[1])
-        return;
-    if (s1->valid > 1 && s1->time[0] != s2->time[0])
+    int i, j;
+
+    if (!_aligned (s1, s2))
         return;
-    if (s1->valid > 0)
-        s1->val[1] = MIN (s1->val[1], s2->val[1]);
-    if (s1->valid > 1)
-        s1->val[0] = MIN (s1->val[0], s2->val[0]);
+    for (i = 0; i < s1->valid; i++) {
+        j = RING_IDX (s1, i);
+        s1->val[j] = MIN (s1->val[j], s2->val[RING_IDX (s2, i)]);
+    }
+    s1->last = MIN (s1->last, s2->last);
+    s1->ewma = MIN (s1->ewma, s2->ewma);
 }
 
-/* Return delta(val) / delta(time),
+/* Return delta(val) / delta(time) over the rate window, or the EWMA rate.
  * Returns 0 if expired, or < 2 valid data points.
  */
 double
 sample_rate (sample_t s, time_t tnow)
 {
-    double val = 0;
+    int i;
 
-    if (s->valid == 2 && (tnow - s->time[1]) <= s->stale_secs)
-        val = (s->val[1] - s->val[0]) / (s->time[1] - s->time[0]);
-    if (val < 0)
-        val = 0;
-    return val;
+    if (s->valid < 2 || (tnow - s->time[s->head]) > s->stale_secs)
+        return 0;
+    if (rate_ewma)
+        return s->ewma;
+    i = RING_IDX (s, s->nwin - 1);
+    return (s->val[s->head] - s->val[i]) / (s->time[s->head] - s->time[i]);
 }
 
 /* Return newest data point.
@@ -181,11 +253,26 @@ sample_rate (sample_t s, time_t tnow)
 double
 sample_val (sample_t s, time_t tnow)
 {
-    if (s->valid > 0 && (tnow - s->time[1]) <= s->stale_secs)
-        return s->val[1];
+    if (s->valid > 0 && (tnow - s->time[s->head]) <= s->stale_secs)
+        return s->last;
     return 0;
 }
 
+int
+sample_history (sample_t s, double *rates, int n)
+{
+    int i, j, k;
+
+    if (n > s->valid - 1)
+        n = s->valid - 1;
+    for (k = 0; k < n; k++) {
+        i = RING_IDX (s, n - k);
+        j = RING_IDX (s, n - k - 1);
+        rates[k] = (s->val[j] - s->val[i]) / (s->time[j] - s->time[i]);
+    }
+    return n < 0 ? 0 : n;
+}
+
 /* Compare sample values for sorting.
  */
 int
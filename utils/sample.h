@@ -1,6 +1,29 @@
+/* Number of data points kept, so rates can be computed over up to
+ * SAMPLE_RING - 1 intervals.
+ */
+#define SAMPLE_RING 8
+
+struct sample_struct {
+    double val[SAMPLE_RING];    /* ring of values, adjusted for resets */
+    time_t time[SAMPLE_RING];
+    int head;                   /* index of the newest point */
+    int valid;                  /* count of valid points [0,SAMPLE_RING] */
+    int nwin;                   /* points within the rate window */
+    double last;                /* newest value as reported */
+    double ewma;                /* exponentially weighted rate */
+    int stale_secs;
+};
+
 typedef struct sample_struct *sample_t;
 
+/* A sample stored by value inside another structure, so that a record
+ * holding many samples is one allocation and is copied with memcpy.
+ * Declared as an array of one so it can be passed as a sample_t.
+ */
+typedef struct sample_struct sample_inline_t[1];
+
 sample_t sample_create (int stale_secs);
+void sample_init (sample_t s, int stale_secs);
 void sample_destroy (sample_t s);
 sample_t sample_copy (sample_t s1);
 
@@ -14,6 +37,18 @@ void sample_min (sample_t s1, sample_t s2);
 double sample_rate (sample_t s, time_t tnow);
 double sample_val (sample_t s, time_t tnow);
 
+/* Set the window in seconds over which sample_rate () is computed,
+ * which is also the time constant of the EWMA rate.  Window 0 (the
+ * default) means the last two points.  If ewma is set, sample_rate ()
+ * returns the EWMA rate.  Call before any samples are updated.
+ */
+void sample_set_window (int secs, int ewma);
+
+/* Store the rates over each of the last n intervals in rates[], oldest
+ * first, and return how many were stored.
+ */
+int sample_history (sample_t s, double *rates, int n);
+
 int sample_val_cmp (sample_t s1, sample_t s2, time_t tnow);
 int sample_rate_cmp (sample_t s1, sample_t s2, time_t tnow);
 